@@ -0,0 +1,288 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stdio.h>
+#include "ArtifactBlanker.h"
+#include "ArtifactBlankerEditor.h"
+
+
+ArtifactBlanker::ArtifactBlanker()
+    : GenericProcessor  ("Artifact Blanker")
+    , triggerEvent      (-1)
+    , triggerLine       (0)
+    , windowMs          (2.0f)
+    , mode              (BLANK_INTERPOLATE)
+    , sampleRate        (0)
+    , overflowTrigger   (-1)
+    , carryOver         (0)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+
+    triggers.ensureStorageAllocated (MAX_WINDOWS_PER_BLOCK);
+    windows.ensureStorageAllocated (MAX_WINDOWS_PER_BLOCK + 1);
+}
+
+
+ArtifactBlanker::~ArtifactBlanker()
+{
+}
+
+
+AudioProcessorEditor* ArtifactBlanker::createEditor()
+{
+    editor = new ArtifactBlankerEditor (this, true);
+
+    return editor;
+}
+
+
+void ArtifactBlanker::updateSettings()
+{
+    const int numChannels = dataChannelArray.size();
+
+    for (int n = shouldBlankChannel.size(); n < numChannels; ++n)
+        shouldBlankChannel.add (dataChannelArray[n]->getChannelType() == DataChannel::HEADSTAGE_CHANNEL);
+
+    shouldBlankChannel.resize (numChannels);
+
+    lastSample.allocate ((size_t) jmax (1, numChannels), true);
+
+    sampleRate = numChannels > 0 ? dataChannelArray[0]->getSampleRate() : 0;
+
+    if (triggerEvent >= eventChannelArray.size())
+        triggerEvent = -1;
+}
+
+
+bool ArtifactBlanker::enable()
+{
+    carryOver = 0;
+    lastSample.clear ((size_t) jmax (1, shouldBlankChannel.size()));
+
+    return true;
+}
+
+
+void ArtifactBlanker::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case TRIGGER_EVENT:
+            triggerEvent = (int) newValue;
+            break;
+        case TRIGGER_LINE:
+            triggerLine = (int) newValue;
+            break;
+        case WINDOW_MS:
+            windowMs = jmax (0.0f, newValue);
+            break;
+        case MODE:
+            mode = (BlankingMode) jlimit ((int) BLANK_ZERO, (int) BLANK_INTERPOLATE, (int) newValue);
+            break;
+        case CHANNEL_ACTIVE:
+            if (currentChannel >= 0 && currentChannel < shouldBlankChannel.size())
+                shouldBlankChannel.set (currentChannel, newValue > 0.5f);
+            break;
+        default:
+            break;
+    }
+}
+
+
+float ArtifactBlanker::getParameterValue (int parameterIndex) const
+{
+    switch (parameterIndex)
+    {
+        case TRIGGER_EVENT: return (float) triggerEvent;
+        case TRIGGER_LINE: return (float) triggerLine;
+        case WINDOW_MS: return windowMs;
+        case MODE: return (float) mode;
+        default: return 0.0f;
+    }
+}
+
+
+bool ArtifactBlanker::isChannelActive (int chan) const
+{
+    return shouldBlankChannel[chan];
+}
+
+
+void ArtifactBlanker::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition)
+{
+    if (triggerEvent < 0
+        || eventInfo->getChannelType() != EventChannel::TTL
+        || eventInfo != eventChannelArray[triggerEvent])
+        return;
+
+    // read straight from the message, so triggers do not allocate on the audio thread
+    if (Event::getChannel (event) == triggerLine && TTLEvent::getState (event))
+    {
+        if (triggers.size() < MAX_WINDOWS_PER_BLOCK)
+            triggers.add (samplePosition);
+        else
+            overflowTrigger = samplePosition;
+    }
+}
+
+
+void ArtifactBlanker::blank (int chan, float* data, int start, int end, bool endsInBlock)
+{
+    const int length = end - start;
+    if (length <= 0)
+        return;
+
+    if (mode == BLANK_ZERO)
+    {
+        FloatVectorOperations::clear (data + start, length);
+        return;
+    }
+
+    // last clean sample before the window, possibly from the previous block
+    const float before = start > 0 ? data[start - 1] : lastSample[chan];
+
+    if (mode == BLANK_HOLD || !endsInBlock)
+    {
+        FloatVectorOperations::fill (data + start, before, length);
+        return;
+    }
+
+    const float after = data[end];
+    const float step = (after - before) / (length + 1);
+
+    for (int i = 0; i < length; ++i)
+        data[start + i] = before + step * (i + 1);
+}
+
+
+void ArtifactBlanker::process (AudioSampleBuffer& buffer)
+{
+    triggers.clearQuick();
+    overflowTrigger = -1;
+
+    checkForEvents();
+
+    if (triggers.size() == 0 && carryOver == 0)
+    {
+        // nothing to blank, just remember where each channel ended
+        for (int n = 0; n < shouldBlankChannel.size() && n < buffer.getNumChannels(); ++n)
+        {
+            const int nSamples = getNumSamples (n);
+            if (nSamples > 0)
+                lastSample[n] = buffer.getSample (n, nSamples - 1);
+        }
+
+        return;
+    }
+
+    const int windowSamples = jmax (1, roundFloatToInt (windowMs * sampleRate / 1000.0f));
+
+    // merge the windows of all triggers, starting with the one left open by the previous block
+    windows.clearQuick();
+
+    Range<int> current (0, carryOver);
+    bool isOpen = carryOver > 0;
+
+    for (int t = 0; t < triggers.size(); ++t)
+    {
+        const int start = triggers[t];
+
+        if (isOpen && start <= current.getEnd())
+        {
+            current.setEnd (jmax (current.getEnd(), start + windowSamples));
+        }
+        else
+        {
+            if (isOpen)
+                windows.add (current);
+
+            current = Range<int> (start, start + windowSamples);
+            isOpen = true;
+        }
+    }
+
+    if (overflowTrigger >= 0)
+        current.setEnd (jmax (current.getEnd(), overflowTrigger + windowSamples));
+
+    if (isOpen)
+        windows.add (current);
+
+    int blockSamples = 0;
+
+    for (int n = 0; n < shouldBlankChannel.size() && n < buffer.getNumChannels(); ++n)
+    {
+        const int nSamples = getNumSamples (n);
+        if (nSamples <= 0)
+            continue;
+
+        blockSamples = jmax (blockSamples, nSamples);
+        float* data = buffer.getWritePointer (n);
+
+        if (shouldBlankChannel[n])
+        {
+            for (int w = 0; w < windows.size(); ++w)
+            {
+                const Range<int>& window = windows.getReference (w);
+
+                if (window.getStart() >= nSamples)
+                    break;
+
+                blank (n, data, window.getStart(), jmin (window.getEnd(), nSamples), window.getEnd() < nSamples);
+            }
+        }
+
+        lastSample[n] = data[nSamples - 1];
+    }
+
+    const int lastEnd = windows.size() > 0 ? windows.getLast().getEnd() : 0;
+    carryOver = jmax (0, lastEnd - blockSamples);
+}
+
+
+void ArtifactBlanker::saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType)
+{
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNumber > -1
+        && channelNumber < shouldBlankChannel.size())
+    {
+        XmlElement* channelParams = channelInfo->createNewChildElement ("PARAMETERS");
+        channelParams->setAttribute ("shouldBlank", shouldBlankChannel[channelNumber]);
+    }
+}
+
+
+void ArtifactBlanker::loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType)
+{
+    int channelNum = channelInfo->getIntAttribute ("number");
+
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNum > -1
+        && channelNum < shouldBlankChannel.size())
+    {
+        forEachXmlChildElement (*channelInfo, subNode)
+        {
+            if (subNode->hasTagName ("PARAMETERS"))
+                shouldBlankChannel.set (channelNum, subNode->getBoolAttribute ("shouldBlank", true));
+        }
+    }
+}
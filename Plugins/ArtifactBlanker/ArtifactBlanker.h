@@ -0,0 +1,122 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ARTIFACTBLANKER_H_INCLUDED
+#define ARTIFACTBLANKER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/** Most blanking windows that can start within one block; later triggers are merged into the last one */
+#define MAX_WINDOWS_PER_BLOCK 64
+
+/**
+
+    Removes stimulation artifacts before they reach spike detection.
+
+    Every rising edge on the selected TTL line opens a window, starting at the
+    sample of the event, during which the selected channels are replaced by
+    zeros, by the last clean sample, or by a straight line between the clean
+    samples on either side. Windows may span several blocks. Overlapping
+    windows are merged.
+
+    Interpolation cannot look past the end of a block, so when a window
+    straddles a block boundary the last clean value is held until the block
+    ends and the line is drawn from it to the first clean sample once that
+    sample arrives. The output is continuous either way and no latency is added.
+
+    Everything runs in place; the only state is one held value per channel,
+    allocated when the settings change.
+
+    @see GenericProcessor, ArtifactBlankerEditor
+*/
+class ArtifactBlanker : public GenericProcessor
+{
+public:
+    ArtifactBlanker();
+    ~ArtifactBlanker();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+
+    void saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType) override;
+    void loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType) override;
+
+    enum BlankingMode
+    {
+        BLANK_ZERO = 0,
+        BLANK_HOLD,
+        BLANK_INTERPOLATE
+    };
+
+    enum Parameters
+    {
+        TRIGGER_EVENT = 0,
+        TRIGGER_LINE,
+        WINDOW_MS,
+        MODE,
+        CHANNEL_ACTIVE
+    };
+
+    float getParameterValue (int parameterIndex) const;
+    bool isChannelActive (int chan) const;
+
+private:
+    void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition) override;
+
+    /** Replaces samples [start, end) of a channel. endsInBlock is false if the
+        window runs up to the end of the block, so there is no clean sample after it yet. */
+    void blank (int chan, float* data, int start, int end, bool endsInBlock);
+
+    int triggerEvent;
+    int triggerLine;
+    float windowMs;
+    BlankingMode mode;
+
+    Array<bool> shouldBlankChannel;
+    float sampleRate;
+
+    /** Last output sample of each channel in the previous block */
+    HeapBlock<float> lastSample;
+
+    /** Sample positions of the triggers in the current block */
+    Array<int> triggers;
+    int overflowTrigger;
+
+    /** Merged blanking windows of the current block, in samples */
+    Array<Range<int>> windows;
+
+    /** Samples of the current window left to blank at the start of the next block */
+    int carryOver;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ArtifactBlanker);
+};
+
+#endif  // ARTIFACTBLANKER_H_INCLUDED
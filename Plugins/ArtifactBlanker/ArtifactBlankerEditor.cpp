@@ -0,0 +1,235 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ArtifactBlankerEditor.h"
+#include "ArtifactBlanker.h"
+
+
+ArtifactBlankerEditor::ArtifactBlankerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+{
+    desiredWidth = 220;
+
+    addLabel ("Trigger:", 10, 25);
+    triggerSelector = new ComboBox ("trigger");
+    triggerSelector->setBounds (75, 27, 130, 18);
+    triggerSelector->setTooltip ("TTL line whose rising edges start a blanking window");
+    triggerSelector->addListener (this);
+    addAndMakeVisible (triggerSelector);
+
+    addLabel ("Window:", 10, 50);
+    windowValue = new Label ("window", "2");
+    windowValue->setBounds (75, 52, 50, 18);
+    windowValue->setFont (Font ("Default", 15, Font::plain));
+    windowValue->setColour (Label::textColourId, Colours::white);
+    windowValue->setColour (Label::backgroundColourId, Colours::grey);
+    windowValue->setEditable (true);
+    windowValue->addListener (this);
+    windowValue->setTooltip ("Length of the blanked window after each trigger, in ms");
+    addAndMakeVisible (windowValue);
+    addLabel ("ms", 128, 50);
+
+    addLabel ("Mode:", 10, 75);
+    modeSelector = new ComboBox ("mode");
+    modeSelector->addItem ("Zero", ArtifactBlanker::BLANK_ZERO + 1);
+    modeSelector->addItem ("Hold", ArtifactBlanker::BLANK_HOLD + 1);
+    modeSelector->addItem ("Interpolate", ArtifactBlanker::BLANK_INTERPOLATE + 1);
+    modeSelector->setSelectedId (ArtifactBlanker::BLANK_INTERPOLATE + 1, dontSendNotification);
+    modeSelector->setBounds (75, 77, 130, 18);
+    modeSelector->addListener (this);
+    addAndMakeVisible (modeSelector);
+
+    channelButton = new UtilityButton ("+CH", Font ("Default", 10, Font::plain));
+    channelButton->addListener (this);
+    channelButton->setBounds (165, 100, 40, 18);
+    channelButton->setClickingTogglesState (true);
+    channelButton->setToggleState (true, dontSendNotification);
+    channelButton->setTooltip ("When this button is off, selected channels are not blanked");
+    addAndMakeVisible (channelButton);
+}
+
+
+ArtifactBlankerEditor::~ArtifactBlankerEditor()
+{
+}
+
+
+Label* ArtifactBlankerEditor::addLabel (const String& text, int x, int y)
+{
+    Label* label = new Label (text, text);
+    label->setBounds (x, y, 65, 20);
+    label->setFont (Font ("Small Text", 12, Font::plain));
+    label->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (label);
+    labels.add (label);
+
+    return label;
+}
+
+
+void ArtifactBlankerEditor::updateSettings()
+{
+    GenericProcessor* processor = getProcessor();
+
+    triggerSources.clear();
+    triggerSelector->clear (dontSendNotification);
+    triggerSelector->addItem ("None", 1);
+
+    for (int i = 0; i < processor->getTotalEventChannels(); ++i)
+    {
+        const EventChannel* event = processor->getEventChannel (i);
+
+        if (event->getChannelType() == EventChannel::TTL)
+        {
+            for (int c = 0; c < (int) event->getNumChannels(); ++c)
+            {
+                TriggerSource source;
+                source.eventIndex = i;
+                source.line = c;
+                triggerSources.add (source);
+
+                triggerSelector->addItem (event->getSourceName() + " (TTL" + String (c + 1) + ")", triggerSources.size() + 1);
+            }
+        }
+    }
+
+    showTrigger();
+}
+
+
+void ArtifactBlankerEditor::showTrigger()
+{
+    ArtifactBlanker* processor = (ArtifactBlanker*) getProcessor();
+    const int eventIndex = (int) processor->getParameterValue (ArtifactBlanker::TRIGGER_EVENT);
+    const int line = (int) processor->getParameterValue (ArtifactBlanker::TRIGGER_LINE);
+
+    int id = 1;
+    for (int i = 0; i < triggerSources.size(); ++i)
+    {
+        if (triggerSources[i].eventIndex == eventIndex && triggerSources[i].line == line)
+            id = i + 2;
+    }
+
+    triggerSelector->setSelectedId (id, dontSendNotification);
+}
+
+
+void ArtifactBlankerEditor::labelTextChanged (Label* label)
+{
+    ArtifactBlanker* processor = (ArtifactBlanker*) getProcessor();
+
+    if (label == windowValue)
+    {
+        float requestedValue = label->getText().getFloatValue();
+
+        if (requestedValue <= 0.0f || requestedValue > 1000.0f)
+            CoreServices::sendStatusMessage ("Value out of range.");
+        else
+            processor->setParameter (ArtifactBlanker::WINDOW_MS, requestedValue);
+
+        label->setText (String (processor->getParameterValue (ArtifactBlanker::WINDOW_MS)), dontSendNotification);
+    }
+}
+
+
+void ArtifactBlankerEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    GenericProcessor* processor = getProcessor();
+
+    if (comboBox == triggerSelector)
+    {
+        const int index = triggerSelector->getSelectedId() - 2;
+
+        if (index >= 0 && index < triggerSources.size())
+        {
+            processor->setParameter (ArtifactBlanker::TRIGGER_LINE, triggerSources[index].line);
+            processor->setParameter (ArtifactBlanker::TRIGGER_EVENT, triggerSources[index].eventIndex);
+        }
+        else
+        {
+            processor->setParameter (ArtifactBlanker::TRIGGER_EVENT, -1);
+        }
+    }
+    else if (comboBox == modeSelector)
+    {
+        processor->setParameter (ArtifactBlanker::MODE, modeSelector->getSelectedId() - 1);
+    }
+}
+
+
+void ArtifactBlankerEditor::channelChanged (int channel, bool /*newState*/)
+{
+    ArtifactBlanker* processor = (ArtifactBlanker*) getProcessor();
+
+    channelButton->setToggleState (processor->isChannelActive (channel), dontSendNotification);
+}
+
+
+void ArtifactBlankerEditor::buttonEvent (Button* button)
+{
+    if (button == channelButton)
+    {
+        GenericProcessor* processor = getProcessor();
+
+        Array<int> chans = getActiveChannels();
+
+        for (int n = 0; n < chans.size(); n++)
+        {
+            processor->setCurrentChannel (chans[n]);
+            processor->setParameter (ArtifactBlanker::CHANNEL_ACTIVE, button->getToggleState() ? 1.0f : 0.0f);
+        }
+    }
+}
+
+
+void ArtifactBlankerEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "ArtifactBlankerEditor");
+
+    ArtifactBlanker* processor = (ArtifactBlanker*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("VALUES");
+    settings->setAttribute ("TriggerEvent", (int) processor->getParameterValue (ArtifactBlanker::TRIGGER_EVENT));
+    settings->setAttribute ("TriggerLine", (int) processor->getParameterValue (ArtifactBlanker::TRIGGER_LINE));
+    settings->setAttribute ("Window", processor->getParameterValue (ArtifactBlanker::WINDOW_MS));
+    settings->setAttribute ("Mode", (int) processor->getParameterValue (ArtifactBlanker::MODE));
+}
+
+
+void ArtifactBlankerEditor::loadCustomParameters (XmlElement* xml)
+{
+    GenericProcessor* processor = getProcessor();
+
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("VALUES"))
+        {
+            processor->setParameter (ArtifactBlanker::TRIGGER_LINE, xmlNode->getIntAttribute ("TriggerLine", 0));
+            processor->setParameter (ArtifactBlanker::TRIGGER_EVENT, xmlNode->getIntAttribute ("TriggerEvent", -1));
+            showTrigger();
+
+            modeSelector->setSelectedId (xmlNode->getIntAttribute ("Mode", ArtifactBlanker::BLANK_INTERPOLATE) + 1, sendNotificationSync);
+            windowValue->setText (xmlNode->getStringAttribute ("Window", "2"), sendNotificationSync);
+        }
+    }
+}
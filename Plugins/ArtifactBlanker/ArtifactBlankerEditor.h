@@ -0,0 +1,80 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ARTIFACTBLANKEREDITOR_H_INCLUDED
+#define ARTIFACTBLANKEREDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the ArtifactBlanker processor.
+
+  @see ArtifactBlanker
+
+*/
+
+class ArtifactBlankerEditor : public GenericEditor,
+    public Label::Listener,
+    public ComboBox::Listener
+{
+public:
+    ArtifactBlankerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~ArtifactBlankerEditor();
+
+    void buttonEvent (Button* button) override;
+    void labelTextChanged (Label* label) override;
+    void comboBoxChanged (ComboBox* comboBox) override;
+
+    void channelChanged (int chan, bool newState) override;
+
+    void updateSettings() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    Label* addLabel (const String& text, int x, int y);
+
+    /** Selects the trigger item matching the processor settings */
+    void showTrigger();
+
+    struct TriggerSource
+    {
+        int eventIndex;
+        int line;
+    };
+
+    Array<TriggerSource> triggerSources;
+
+    OwnedArray<Label> labels;
+
+    ScopedPointer<ComboBox> triggerSelector;
+    ScopedPointer<ComboBox> modeSelector;
+    ScopedPointer<Label> windowValue;
+    ScopedPointer<UtilityButton> channelButton;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ArtifactBlankerEditor);
+};
+
+#endif  // ARTIFACTBLANKEREDITOR_H_INCLUDED
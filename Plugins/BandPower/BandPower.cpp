@@ -0,0 +1,417 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stdio.h>
+#include "BandPower.h"
+#include "BandPowerEditor.h"
+
+
+BandPower::BandPower()
+    : GenericProcessor  ("Band Power")
+    , lowCut            (150.0f)
+    , highCut           (250.0f)
+    , envelopeType      (ENVELOPE_RMS)
+    , windowMs          (10.0f)
+    , threshold         (50.0f)
+    , hysteresis        (0.8f)
+    , minDurationMs     (15.0f)
+    , outputEnvelope    (false)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+BandPower::~BandPower()
+{
+}
+
+
+AudioProcessorEditor* BandPower::createEditor()
+{
+    editor = new BandPowerEditor (this, true);
+
+    return editor;
+}
+
+
+void BandPower::updateSettings()
+{
+    Array<bool> wasActive;
+    for (int n = 0; n < channels.size(); ++n)
+        wasActive.add (channels[n]->isActive);
+
+    channels.clear();
+    groups.clear();
+
+    scratch.setSize (1, MAX_BLOCK_SIZE);
+
+    for (int n = 0; n < dataChannelArray.size(); ++n)
+    {
+        const DataChannel* in = dataChannelArray[n];
+
+        ChannelState* ch = new ChannelState();
+        ch->sampleRate = in->getSampleRate();
+        ch->historySize = jmax (1, roundFloatToInt (MAX_RMS_WINDOW_MS * ch->sampleRate / 1000.0f));
+        ch->history.allocate (ch->historySize, true);
+        ch->historyPos = 0;
+        ch->windowSamples = 1;
+        ch->sum = 0;
+        ch->power = 0;
+        ch->alpha = 1.0f;
+        ch->minSamples = 0;
+        ch->samplesAbove = 0;
+        ch->isAbove = false;
+        ch->isActive = n < wasActive.size() ? wasActive[n] : in->getChannelType() == DataChannel::HEADSTAGE_CHANNEL;
+
+        // one TTL channel per source subprocessor, so event timestamps share the clock of their inputs
+        ch->group = -1;
+        for (int g = 0; g < groups.size(); ++g)
+        {
+            if (groups[g]->sourceNodeId == in->getSourceNodeID()
+                && groups[g]->subProcessorIdx == in->getSubProcessorIdx())
+            {
+                ch->group = g;
+                break;
+            }
+        }
+
+        if (ch->group < 0)
+        {
+            EventGroup* group = new EventGroup();
+            group->channel = nullptr;
+            group->firstInput = in;
+            group->sourceNodeId = in->getSourceNodeID();
+            group->subProcessorIdx = in->getSubProcessorIdx();
+            ch->group = groups.size();
+            groups.add (group);
+        }
+
+        ch->line = 0;
+        for (int m = 0; m < n; ++m)
+        {
+            if (channels[m]->group == ch->group)
+                ch->line++;
+        }
+
+        channels.add (ch);
+    }
+
+    for (int g = 0; g < groups.size(); ++g)
+    {
+        EventGroup* group = groups[g];
+        const DataChannel* in = group->firstInput;
+
+        int numLines = 0;
+        for (int n = 0; n < channels.size(); ++n)
+        {
+            if (channels[n]->group == g)
+                numLines++;
+        }
+
+        EventChannel* ev = new EventChannel (EventChannel::TTL, numLines, 1, in, this);
+        ev->setName ("Band power " + String (g + 1));
+        ev->setDescription ("High while the band power of an input channel is above threshold");
+        ev->setIdentifier ("dataderived.bandpower.threshold");
+
+        MetaDataDescriptor md (MetaDataDescriptor::UINT16, 3, "Source Channel",
+            "Index at its source, Source processor ID and Sub Processor index of the first channel of this group", "source.channel.identifier.full");
+        MetaDataValue mv (md);
+        uint16 sourceInfo[3];
+        sourceInfo[0] = in->getSourceIndex();
+        sourceInfo[1] = in->getSourceNodeID();
+        sourceInfo[2] = in->getSubProcessorIdx();
+        mv.setValue (static_cast<const uint16*> (sourceInfo));
+        ev->addMetaData (md, mv);
+
+        eventChannelArray.add (ev);
+
+        group->channel = ev;
+        group->state.allocate (ev->getDataSize(), true);
+    }
+
+    applySettings();
+}
+
+
+void BandPower::applySettings()
+{
+    for (int n = 0; n < channels.size(); ++n)
+    {
+        ChannelState& ch = *channels[n];
+        const float nyquist = ch.sampleRate / 2.0f;
+        const float high = jmin (highCut, nyquist * 0.95f);
+        const float low = jmin (lowCut, high * 0.95f);
+
+        ch.filter.setup (2, ch.sampleRate, (high + low) / 2.0, high - low);
+        ch.filter.reset();
+
+        ch.windowSamples = jlimit (1, ch.historySize, roundFloatToInt (windowMs * ch.sampleRate / 1000.0f));
+        ch.history.clear (ch.historySize);
+        ch.historyPos = 0;
+        ch.sum = 0;
+
+        ch.power = 0;
+        ch.alpha = 1.0f - std::exp (-1000.0f / (jmax (0.01f, windowMs) * ch.sampleRate));
+
+        ch.minSamples = roundFloatToInt (minDurationMs * ch.sampleRate / 1000.0f);
+        ch.samplesAbove = 0;
+    }
+}
+
+
+bool BandPower::enable()
+{
+    for (int n = 0; n < channels.size(); ++n)
+        channels[n]->isAbove = false;
+
+    for (int g = 0; g < groups.size(); ++g)
+        groups[g]->state.clear (groups[g]->channel->getDataSize());
+
+    applySettings();
+    settingsChanged = 0;
+
+    return true;
+}
+
+
+void BandPower::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case LOW_CUT:
+            lowCut = newValue;
+            break;
+        case HIGH_CUT:
+            highCut = newValue;
+            break;
+        case ENVELOPE_TYPE:
+            envelopeType = newValue > 0.5f ? ENVELOPE_IIR : ENVELOPE_RMS;
+            break;
+        case WINDOW_MS:
+            windowMs = jlimit (0.1f, (float) MAX_RMS_WINDOW_MS, newValue);
+            break;
+        case THRESHOLD:
+            // thresholds and outputs are read per sample, no need to reset the envelopes
+            threshold = newValue;
+            return;
+        case HYSTERESIS:
+            hysteresis = jlimit (0.0f, 1.0f, newValue);
+            return;
+        case MIN_DURATION_MS:
+            minDurationMs = jmax (0.0f, newValue);
+            break;
+        case OUTPUT_ENVELOPE:
+            outputEnvelope = newValue > 0.5f;
+            return;
+        case CHANNEL_ACTIVE:
+            if (currentChannel >= 0 && currentChannel < channels.size())
+                channels[currentChannel]->isActive = newValue > 0.5f;
+            return;
+        default:
+            return;
+    }
+
+    // filter and window changes are picked up at the start of the next block
+    settingsChanged = 1;
+}
+
+
+float BandPower::getParameterValue (int parameterIndex) const
+{
+    switch (parameterIndex)
+    {
+        case LOW_CUT: return lowCut;
+        case HIGH_CUT: return highCut;
+        case ENVELOPE_TYPE: return (float) envelopeType;
+        case WINDOW_MS: return windowMs;
+        case THRESHOLD: return threshold;
+        case HYSTERESIS: return hysteresis;
+        case MIN_DURATION_MS: return minDurationMs;
+        case OUTPUT_ENVELOPE: return outputEnvelope ? 1.0f : 0.0f;
+        default: return 0.0f;
+    }
+}
+
+
+bool BandPower::isChannelActive (int chan) const
+{
+    return chan >= 0 && chan < channels.size() && channels[chan]->isActive;
+}
+
+
+void BandPower::computeEnvelope (ChannelState& ch, float* power, int nSamples)
+{
+    if (envelopeType == ENVELOPE_RMS)
+    {
+        float* history = ch.history.getData();
+        const int window = ch.windowSamples;
+        double sum = ch.sum;
+        int pos = ch.historyPos;
+
+        for (int i = 0; i < nSamples; ++i)
+        {
+            int oldest = pos - window;
+            if (oldest < 0)
+                oldest += ch.historySize;
+
+            sum += power[i] - history[oldest];
+            history[pos] = power[i];
+
+            if (++pos == ch.historySize)
+                pos = 0;
+
+            power[i] = jmax (0.0f, (float) sum / window);
+        }
+
+        ch.sum = sum;
+        ch.historyPos = pos;
+    }
+    else
+    {
+        const float alpha = ch.alpha;
+        float y = ch.power;
+
+        for (int i = 0; i < nSamples; ++i)
+        {
+            y += alpha * (power[i] - y);
+            power[i] = y;
+        }
+
+        ch.power = y;
+    }
+}
+
+
+void BandPower::setLine (int chan, bool state, int sampleNum)
+{
+    ChannelState& ch = *channels[chan];
+    EventGroup& group = *groups[ch.group];
+
+    const uint8 bit = (uint8) (1 << (ch.line % 8));
+    if (state)
+        group.state[ch.line / 8] |= bit;
+    else
+        group.state[ch.line / 8] &= ~bit;
+
+    ch.isAbove = state;
+
+    TTLEventPtr event = TTLEvent::createTTLEvent (group.channel, getTimestamp (chan) + sampleNum,
+                                                  group.state, (int) group.channel->getDataSize(), (uint16) ch.line);
+    addEvent (group.channel, event, sampleNum);
+}
+
+
+void BandPower::process (AudioSampleBuffer& buffer)
+{
+    if (settingsChanged.compareAndSetBool (0, 1))
+        applySettings();
+
+    // preallocated in updateSettings(), never resized here
+    float* power = scratch.getWritePointer (0);
+
+    // compare powers rather than amplitudes, to avoid a square root per sample
+    const float onLevel = threshold * threshold;
+    const float offLevel = onLevel * hysteresis * hysteresis;
+
+    const int nChannels = jmin (channels.size(), buffer.getNumChannels());
+
+    for (int n = 0; n < nChannels; ++n)
+    {
+        ChannelState& ch = *channels[n];
+
+        if (!ch.isActive)
+        {
+            if (ch.isAbove)
+                setLine (n, false, 0);
+            continue;
+        }
+
+        const int nSamples = jmin ((int) getNumSamples (n), buffer.getNumSamples(), MAX_BLOCK_SIZE);
+        if (nSamples <= 0)
+            continue;
+
+        float* data = buffer.getWritePointer (n);
+
+        FloatVectorOperations::copy (power, data, nSamples);
+        ch.filter.process (nSamples, &power);
+        FloatVectorOperations::multiply (power, power, nSamples);
+
+        computeEnvelope (ch, power, nSamples);
+
+        for (int i = 0; i < nSamples; ++i)
+        {
+            if (ch.isAbove)
+            {
+                if (power[i] < offLevel)
+                {
+                    setLine (n, false, i);
+                    ch.samplesAbove = 0;
+                }
+            }
+            else if (power[i] > onLevel)
+            {
+                if (++ch.samplesAbove > ch.minSamples)
+                    setLine (n, true, i);
+            }
+            else
+            {
+                ch.samplesAbove = 0;
+            }
+        }
+
+        if (outputEnvelope)
+        {
+            for (int i = 0; i < nSamples; ++i)
+                data[i] = std::sqrt (power[i]);
+        }
+    }
+}
+
+
+void BandPower::saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType)
+{
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNumber > -1
+        && channelNumber < channels.size())
+    {
+        XmlElement* channelParams = channelInfo->createNewChildElement ("PARAMETERS");
+        channelParams->setAttribute ("active", channels[channelNumber]->isActive);
+    }
+}
+
+
+void BandPower::loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType)
+{
+    int channelNum = channelInfo->getIntAttribute ("number");
+
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNum > -1
+        && channelNum < channels.size())
+    {
+        forEachXmlChildElement (*channelInfo, subNode)
+        {
+            if (subNode->hasTagName ("PARAMETERS"))
+                channels[channelNum]->isActive = subNode->getBoolAttribute ("active", true);
+        }
+    }
+}
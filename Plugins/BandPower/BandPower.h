@@ -0,0 +1,161 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BANDPOWER_H_INCLUDED
+#define BANDPOWER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include <DspLib.h>
+
+/** Longest sliding RMS window, sets the size of the per-channel history */
+#define MAX_RMS_WINDOW_MS 200
+
+/** Larger than any audio buffer the AudioComponent accepts, sets the size of the scratch buffer */
+#define MAX_BLOCK_SIZE 10000
+
+/**
+
+    Computes the power of each selected channel in a frequency band and turns
+    threshold crossings into TTL events, for closed-loop stimulation on
+    ripples, beta bursts and the like.
+
+    The band is isolated with a Butterworth band-pass from the DSP library and
+    its power smoothed either by a sliding RMS window or by a first order IIR
+    envelope. A TTL line goes high, at the exact sample, once the envelope has
+    stayed above the threshold for the minimum duration, and goes low when it
+    falls below threshold * hysteresis. There is one TTL channel per source
+    subprocessor, with one line per input channel of that subprocessor.
+
+    Optionally the selected channels are replaced by their envelope (RMS
+    amplitude, in the channel units) so it can be displayed or recorded.
+
+    @see GenericProcessor, BandPowerEditor
+*/
+class BandPower : public GenericProcessor
+{
+public:
+    BandPower();
+    ~BandPower();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+
+    void saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType) override;
+    void loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType) override;
+
+    enum EnvelopeType
+    {
+        ENVELOPE_RMS = 0,
+        ENVELOPE_IIR
+    };
+
+    enum Parameters
+    {
+        LOW_CUT = 0,
+        HIGH_CUT,
+        ENVELOPE_TYPE,
+        WINDOW_MS,
+        THRESHOLD,
+        HYSTERESIS,
+        MIN_DURATION_MS,
+        OUTPUT_ENVELOPE,
+        CHANNEL_ACTIVE
+    };
+
+    float getParameterValue (int parameterIndex) const;
+    bool isChannelActive (int chan) const;
+
+private:
+    struct ChannelState
+    {
+        Dsp::SimpleFilter<Dsp::Butterworth::BandPass<2>, 1> filter;
+
+        float sampleRate;
+
+        // sliding RMS
+        HeapBlock<float> history;
+        int historySize;
+        int historyPos;
+        int windowSamples;
+        double sum;
+
+        // IIR envelope
+        float power;
+        float alpha;
+
+        int minSamples;
+        int samplesAbove;
+        bool isAbove;
+        bool isActive;
+
+        int group;
+        int line;
+    };
+
+    /** TTL channel shared by the inputs of one source subprocessor */
+    struct EventGroup
+    {
+        const EventChannel* channel;
+        const DataChannel* firstInput;
+        HeapBlock<uint8> state;
+        uint16 sourceNodeId;
+        uint16 subProcessorIdx;
+    };
+
+    /** Recomputes filters and envelope lengths and resets the envelopes.
+        Does not allocate, so process() can call it between blocks. */
+    void applySettings();
+
+    /** Computes the band power envelope of nSamples in place */
+    void computeEnvelope (ChannelState& ch, float* power, int nSamples);
+
+    void setLine (int chan, bool state, int sampleNum);
+
+    OwnedArray<ChannelState> channels;
+    OwnedArray<EventGroup> groups;
+
+    AudioSampleBuffer scratch;
+
+    float lowCut;
+    float highCut;
+    EnvelopeType envelopeType;
+    float windowMs;
+    float threshold;
+    float hysteresis;
+    float minDurationMs;
+    bool outputEnvelope;
+
+    Atomic<int> settingsChanged;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandPower);
+};
+
+#endif  // BANDPOWER_H_INCLUDED
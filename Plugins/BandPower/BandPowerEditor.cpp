@@ -0,0 +1,241 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BandPowerEditor.h"
+#include "BandPower.h"
+
+
+BandPowerEditor::BandPowerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+{
+    desiredWidth = 250;
+
+    addLabel ("Low cut:", 10, 25, 60);
+    addValue (BandPower::LOW_CUT, 70, 27, "Lower edge of the band, in Hz");
+
+    addLabel ("High cut:", 10, 47, 60);
+    addValue (BandPower::HIGH_CUT, 70, 49, "Upper edge of the band, in Hz");
+
+    addLabel ("Window:", 10, 69, 60);
+    addValue (BandPower::WINDOW_MS, 70, 71, "RMS window length or IIR time constant, in ms");
+
+    envelopeSelector = new ComboBox ("envelope type");
+    envelopeSelector->addItem ("RMS", BandPower::ENVELOPE_RMS + 1);
+    envelopeSelector->addItem ("IIR", BandPower::ENVELOPE_IIR + 1);
+    envelopeSelector->setSelectedId (BandPower::ENVELOPE_RMS + 1, dontSendNotification);
+    envelopeSelector->setBounds (15, 95, 100, 20);
+    envelopeSelector->setTooltip ("Sliding RMS window or exponential (IIR) envelope of the band power");
+    envelopeSelector->addListener (this);
+    addAndMakeVisible (envelopeSelector);
+
+    addLabel ("Threshold:", 125, 25, 65);
+    addValue (BandPower::THRESHOLD, 190, 27, "RMS amplitude of the band that turns the TTL line on, in channel units");
+
+    addLabel ("Off ratio:", 125, 47, 65);
+    addValue (BandPower::HYSTERESIS, 190, 49, "The line turns off below threshold * off ratio");
+
+    addLabel ("Min dur:", 125, 69, 65);
+    addValue (BandPower::MIN_DURATION_MS, 190, 71, "Time the band power must stay above threshold before the line turns on, in ms");
+
+    outputEnvelopeButton = new UtilityButton ("ENV", Font ("Default", 10, Font::plain));
+    outputEnvelopeButton->addListener (this);
+    outputEnvelopeButton->setBounds (140, 97, 40, 18);
+    outputEnvelopeButton->setClickingTogglesState (true);
+    outputEnvelopeButton->setTooltip ("When this button is on, monitored channels are replaced by their band power envelope");
+    addAndMakeVisible (outputEnvelopeButton);
+
+    channelButton = new UtilityButton ("+CH", Font ("Default", 10, Font::plain));
+    channelButton->addListener (this);
+    channelButton->setBounds (190, 97, 40, 18);
+    channelButton->setClickingTogglesState (true);
+    channelButton->setToggleState (true, dontSendNotification);
+    channelButton->setTooltip ("When this button is off, selected channels are not monitored");
+    addAndMakeVisible (channelButton);
+}
+
+
+BandPowerEditor::~BandPowerEditor()
+{
+}
+
+
+Label* BandPowerEditor::addLabel (const String& text, int x, int y, int width)
+{
+    Label* label = new Label (text, text);
+    label->setBounds (x, y, width, 20);
+    label->setFont (Font ("Small Text", 12, Font::plain));
+    label->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (label);
+    labels.add (label);
+
+    return label;
+}
+
+
+Label* BandPowerEditor::addValue (int parameterIndex, int x, int y, const String& tooltip)
+{
+    Label* value = new Label (String (parameterIndex), String());
+    value->setBounds (x, y, 45, 18);
+    value->setFont (Font ("Default", 15, Font::plain));
+    value->setColour (Label::textColourId, Colours::white);
+    value->setColour (Label::backgroundColourId, Colours::grey);
+    value->setEditable (true);
+    value->addListener (this);
+    value->setTooltip (tooltip);
+    value->getProperties().set ("parameter", parameterIndex);
+    addAndMakeVisible (value);
+    values.add (value);
+
+    updateValue (value);
+
+    return value;
+}
+
+
+void BandPowerEditor::updateValue (Label* label)
+{
+    BandPower* processor = (BandPower*) getProcessor();
+    int parameterIndex = label->getProperties()["parameter"];
+
+    label->setText (String (processor->getParameterValue (parameterIndex)), dontSendNotification);
+}
+
+
+void BandPowerEditor::labelTextChanged (Label* label)
+{
+    BandPower* processor = (BandPower*) getProcessor();
+    int parameterIndex = label->getProperties()["parameter"];
+    float requestedValue = label->getText().getFloatValue();
+
+    bool isValid = requestedValue >= 0;
+
+    switch (parameterIndex)
+    {
+        case BandPower::LOW_CUT:
+            isValid = requestedValue > 0 && requestedValue < processor->getParameterValue (BandPower::HIGH_CUT);
+            break;
+        case BandPower::HIGH_CUT:
+            isValid = requestedValue > processor->getParameterValue (BandPower::LOW_CUT);
+            break;
+        case BandPower::WINDOW_MS:
+            isValid = requestedValue > 0 && requestedValue <= MAX_RMS_WINDOW_MS;
+            break;
+        case BandPower::HYSTERESIS:
+            isValid = requestedValue >= 0 && requestedValue <= 1;
+            break;
+        default:
+            break;
+    }
+
+    if (!isValid)
+    {
+        CoreServices::sendStatusMessage ("Value out of range.");
+    }
+    else
+    {
+        processor->setParameter (parameterIndex, requestedValue);
+    }
+
+    updateValue (label);
+}
+
+
+void BandPowerEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == envelopeSelector)
+    {
+        getProcessor()->setParameter (BandPower::ENVELOPE_TYPE, envelopeSelector->getSelectedId() - 1);
+    }
+}
+
+
+void BandPowerEditor::channelChanged (int channel, bool /*newState*/)
+{
+    BandPower* processor = (BandPower*) getProcessor();
+
+    channelButton->setToggleState (processor->isChannelActive (channel), dontSendNotification);
+}
+
+
+void BandPowerEditor::buttonEvent (Button* button)
+{
+    if (button == outputEnvelopeButton)
+    {
+        getProcessor()->setParameter (BandPower::OUTPUT_ENVELOPE, button->getToggleState() ? 1.0f : 0.0f);
+    }
+    else if (button == channelButton)
+    {
+        BandPower* processor = (BandPower*) getProcessor();
+
+        Array<int> chans = getActiveChannels();
+
+        for (int n = 0; n < chans.size(); n++)
+        {
+            processor->setCurrentChannel (chans[n]);
+            processor->setParameter (BandPower::CHANNEL_ACTIVE, button->getToggleState() ? 1.0f : 0.0f);
+        }
+    }
+}
+
+
+void BandPowerEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "BandPowerEditor");
+
+    BandPower* processor = (BandPower*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("VALUES");
+    settings->setAttribute ("LowCut", processor->getParameterValue (BandPower::LOW_CUT));
+    settings->setAttribute ("HighCut", processor->getParameterValue (BandPower::HIGH_CUT));
+    settings->setAttribute ("Envelope", (int) processor->getParameterValue (BandPower::ENVELOPE_TYPE));
+    settings->setAttribute ("Window", processor->getParameterValue (BandPower::WINDOW_MS));
+    settings->setAttribute ("Threshold", processor->getParameterValue (BandPower::THRESHOLD));
+    settings->setAttribute ("OffRatio", processor->getParameterValue (BandPower::HYSTERESIS));
+    settings->setAttribute ("MinDuration", processor->getParameterValue (BandPower::MIN_DURATION_MS));
+    settings->setAttribute ("OutputEnvelope", outputEnvelopeButton->getToggleState());
+}
+
+
+void BandPowerEditor::loadCustomParameters (XmlElement* xml)
+{
+    BandPower* processor = (BandPower*) getProcessor();
+
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("VALUES"))
+        {
+            processor->setParameter (BandPower::LOW_CUT, xmlNode->getDoubleAttribute ("LowCut", processor->getParameterValue (BandPower::LOW_CUT)));
+            processor->setParameter (BandPower::HIGH_CUT, xmlNode->getDoubleAttribute ("HighCut", processor->getParameterValue (BandPower::HIGH_CUT)));
+            processor->setParameter (BandPower::WINDOW_MS, xmlNode->getDoubleAttribute ("Window", processor->getParameterValue (BandPower::WINDOW_MS)));
+            processor->setParameter (BandPower::THRESHOLD, xmlNode->getDoubleAttribute ("Threshold", processor->getParameterValue (BandPower::THRESHOLD)));
+            processor->setParameter (BandPower::HYSTERESIS, xmlNode->getDoubleAttribute ("OffRatio", processor->getParameterValue (BandPower::HYSTERESIS)));
+            processor->setParameter (BandPower::MIN_DURATION_MS, xmlNode->getDoubleAttribute ("MinDuration", processor->getParameterValue (BandPower::MIN_DURATION_MS)));
+
+            envelopeSelector->setSelectedId (xmlNode->getIntAttribute ("Envelope", BandPower::ENVELOPE_RMS) + 1, sendNotificationSync);
+            outputEnvelopeButton->setToggleState (xmlNode->getBoolAttribute ("OutputEnvelope", false), sendNotification);
+        }
+    }
+
+    for (int i = 0; i < values.size(); ++i)
+        updateValue (values[i]);
+}
@@ -0,0 +1,74 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BANDPOWEREDITOR_H_INCLUDED
+#define BANDPOWEREDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the BandPower processor.
+
+  Band, envelope and threshold settings apply to every channel; the channel
+  selector and the +CH button choose which channels are monitored.
+
+  @see BandPower
+
+*/
+
+class BandPowerEditor : public GenericEditor,
+    public Label::Listener,
+    public ComboBox::Listener
+{
+public:
+    BandPowerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~BandPowerEditor();
+
+    void buttonEvent (Button* button) override;
+    void labelTextChanged (Label* label) override;
+    void comboBoxChanged (ComboBox* comboBox) override;
+
+    void channelChanged (int chan, bool newState) override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    Label* addLabel (const String& text, int x, int y, int width);
+    Label* addValue (int parameterIndex, int x, int y, const String& tooltip);
+
+    /** Shows the processor's current value of a parameter */
+    void updateValue (Label* label);
+
+    OwnedArray<Label> labels;
+    OwnedArray<Label> values;
+
+    ScopedPointer<ComboBox> envelopeSelector;
+    ScopedPointer<UtilityButton> outputEnvelopeButton;
+    ScopedPointer<UtilityButton> channelButton;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandPowerEditor);
+};
+
+#endif  // BANDPOWEREDITOR_H_INCLUDED
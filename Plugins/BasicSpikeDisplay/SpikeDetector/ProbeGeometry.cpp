@@ -0,0 +1,180 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ProbeGeometry.h"
+
+
+ProbeGeometry::ProbeGeometry()
+{
+}
+
+
+ProbeGeometry::~ProbeGeometry()
+{
+}
+
+
+String ProbeGeometry::loadFromFile (const File& file)
+{
+    FileInputStream inputStream (file);
+
+    if (! inputStream.openedOk())
+        return "Could not open " + file.getFileName();
+
+    var json = JSON::parse (inputStream);
+
+    Array<var>* chans = json[Identifier ("channels")].getArray();
+    Array<var>* xcoords = json[Identifier ("xcoords")].getArray();
+    Array<var>* ycoords = json[Identifier ("ycoords")].getArray();
+
+    if (chans == nullptr || xcoords == nullptr || ycoords == nullptr
+        || chans->size() != xcoords->size() || chans->size() != ycoords->size())
+    {
+        return "Not a valid probe geometry file.";
+    }
+
+    clear();
+
+    for (int i = 0; i < chans->size(); ++i)
+    {
+        addSite (chans->getUnchecked (i),
+                 xcoords->getUnchecked (i),
+                 ycoords->getUnchecked (i));
+    }
+
+    return "Loaded " + String (getNumSites()) + " probe sites from " + file.getFileName();
+}
+
+
+void ProbeGeometry::clear()
+{
+    channels.clear();
+    positions.clear();
+    neighbours.clear();
+}
+
+
+void ProbeGeometry::addSite (int channel, float x, float y)
+{
+    channels.add (channel);
+    positions.add (Point<float> (x, y));
+    neighbours.add (Array<int>());
+}
+
+
+int ProbeGeometry::getNumSites() const
+{
+    return channels.size();
+}
+
+
+int ProbeGeometry::getSiteChannel (int site) const
+{
+    return channels[site];
+}
+
+
+Point<float> ProbeGeometry::getSitePosition (int site) const
+{
+    return positions[site];
+}
+
+
+void ProbeGeometry::updateNeighbourhoods (float radius)
+{
+    const int nSites = getNumSites();
+
+    for (int i = 0; i < nSites; ++i)
+    {
+        Array<int>& n = neighbours.getReference (i);
+        n.clearQuick();
+
+        for (int j = 0; j < nSites; ++j)
+        {
+            if (j != i && positions[i].getDistanceFrom (positions[j]) <= radius
+                && channels[j] != channels[i])
+                n.add (j);
+        }
+    }
+}
+
+
+const Array<int>& ProbeGeometry::getNeighbours (int site) const
+{
+    return neighbours.getReference (site);
+}
+
+
+Array<int> ProbeGeometry::getClosestSites (int site, int maxSites) const
+{
+    Array<int> sites;
+    Array<float> distances;
+
+    sites.add (site);
+    distances.add (0.0f);
+
+    for (int j = 0; j < getNumSites(); ++j)
+    {
+        if (j == site)
+            continue;
+
+        const float d = positions[site].getDistanceFrom (positions[j]);
+
+        // insertion sort by distance; the site itself always stays first
+        int pos = 1;
+        while (pos < sites.size() && distances[pos] <= d)
+            ++pos;
+
+        sites.insert (pos, j);
+        distances.insert (pos, d);
+    }
+
+    sites.resize (jmin (maxSites, sites.size()));
+
+    return sites;
+}
+
+
+void ProbeGeometry::saveToXml (XmlElement* probeNode) const
+{
+    for (int i = 0; i < getNumSites(); ++i)
+    {
+        XmlElement* siteNode = probeNode->createNewChildElement ("SITE");
+        siteNode->setAttribute ("ch", channels[i]);
+        siteNode->setAttribute ("x",  positions[i].x);
+        siteNode->setAttribute ("y",  positions[i].y);
+    }
+}
+
+
+void ProbeGeometry::loadFromXml (const XmlElement* probeNode)
+{
+    clear();
+
+    forEachXmlChildElementWithTagName (*probeNode, siteNode, "SITE")
+    {
+        addSite (siteNode->getIntAttribute ("ch"),
+                 (float) siteNode->getDoubleAttribute ("x"),
+                 (float) siteNode->getDoubleAttribute ("y"));
+    }
+}
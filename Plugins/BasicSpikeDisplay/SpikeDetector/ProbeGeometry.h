@@ -0,0 +1,91 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __PROBEGEOMETRY_H_7A1C3E52__
+#define __PROBEGEOMETRY_H_7A1C3E52__
+
+#include <ProcessorHeaders.h>
+
+
+/**
+    Holds the site layout of a dense silicon probe.
+
+    Each site is an input channel with a position in micrometers. Sites closer
+    than the neighbourhood radius are considered neighbours, which the
+    SpikeDetector uses to keep a single event per spike across channels.
+
+    Geometry files are JSON channel maps with three arrays of equal length:
+
+    { "channels": [0, 1, ...], "xcoords": [16.0, 48.0, ...], "ycoords": [0.0, 0.0, ...] }
+
+    Channels are 0-based input channel indices.
+
+    @see SpikeDetector
+*/
+class ProbeGeometry
+{
+public:
+    ProbeGeometry();
+    ~ProbeGeometry();
+
+    /** Loads site coordinates from a JSON channel map. Returns a status message. */
+    String loadFromFile (const File& file);
+
+    /** Removes all sites. */
+    void clear();
+
+    /** Adds a site for an input channel at a given position (in micrometers). */
+    void addSite (int channel, float x, float y);
+
+    /** Returns the number of sites on the probe. */
+    int getNumSites() const;
+
+    /** Returns the input channel recorded by a site. */
+    int getSiteChannel (int site) const;
+
+    /** Returns the position of a site, in micrometers. */
+    Point<float> getSitePosition (int site) const;
+
+    /** Recomputes the neighbourhood of every site. Sites within radius
+        (in micrometers) of each other are neighbours. */
+    void updateNeighbourhoods (float radius);
+
+    /** Returns the sites within the neighbourhood radius of a site, excluding itself. */
+    const Array<int>& getNeighbours (int site) const;
+
+    /** Returns up to maxSites sites closest to a site, starting with the site itself. */
+    Array<int> getClosestSites (int site, int maxSites) const;
+
+    void saveToXml (XmlElement* probeNode) const;
+    void loadFromXml (const XmlElement* probeNode);
+
+private:
+    Array<int> channels;
+    Array<Point<float>> positions;
+    Array<Array<int>> neighbours;
+
+    JUCE_LEAK_DETECTOR (ProbeGeometry);
+};
+
+
+#endif  // __PROBEGEOMETRY_H_7A1C3E52__
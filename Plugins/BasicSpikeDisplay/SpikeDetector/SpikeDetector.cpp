@@ -24,6 +24,16 @@
 #include <stdio.h>
 #include "SpikeDetector.h"
 
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define SPIKEDETECTOR_USE_SSE2 1
+#else
+ #define SPIKEDETECTOR_USE_SSE2 0
+#endif
+
+#define PROBE_DEFAULT_RADIUS        50.0f
+#define PROBE_DEFAULT_DEDUP_WINDOW  10
+
 
 SpikeDetector::SpikeDetector()
     : GenericProcessor      ("Spike Detector")
@@ -32,6 +42,13 @@ SpikeDetector::SpikeDetector()
       overflowBufferSize    (100)
     , currentElectrode      (-1)
     , uniqueID              (0)
+    , probeThreshold        (getDefaultThreshold())
+    , probeRadius           (PROBE_DEFAULT_RADIUS)
+    , probeDedupWindow      (PROBE_DEFAULT_DEDUP_WINDOW)
+    , probePrePeakSamples   (8)
+    , probePostPeakSamples  (32)
+    , probeLookahead        (0)
+    , probeHistorySize      (1)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
@@ -67,6 +84,7 @@ SpikeDetector::SpikeDetector()
         electrodeCounter.add (0);
     }
 
+    updateProbeSettings();
 }
 
 
@@ -102,17 +120,44 @@ void SpikeDetector::createSpikeChannels()
 		spk->setNumSamples(elec->prePeakSamples, elec->postPeakSamples);
 		spikeChannelArray.add(spk);
 	}
-}
 
+	// one spike channel per probe site, carrying the waveforms of the closest sites
+	probeSpikeChannel.clearQuick();
+	probeWaveformSites.clearQuick();
 
-void SpikeDetector::updateSettings()
-{
-	if (getNumInputs() > 0)
+	// largest electrode type available for the number of sites
+	const int nWaveformSites = probe.getNumSites() >= 4 ? 4 : jmin(probe.getNumSites(), 2);
+
+	for (int site = 0; site < probe.getNumSites(); ++site)
 	{
-		overflowBuffer.setSize(getNumInputs(), overflowBufferSize);
-		overflowBuffer.clear();
+		Array<int> sites = probe.getClosestSites(site, nWaveformSites);
+		Array<const DataChannel*> chans;
+		for (int c = 0; c < sites.size(); c++)
+		{
+			const DataChannel* ch = getDataChannel(probe.getSiteChannel(sites[c]));
+			if (ch)
+				chans.add(ch);
+		}
+
+		probeWaveformSites.add(sites);
+
+		if (chans.size() != sites.size())
+		{
+			probeSpikeChannel.add(-1);
+			continue;
+		}
+
+		SpikeChannel* spk = new SpikeChannel(SpikeChannel::typeFromNumChannels(chans.size()), this, chans);
+		spk->setNumSamples(probePrePeakSamples, probePostPeakSamples);
+		probeSpikeChannel.add(spikeChannelArray.size());
+		spikeChannelArray.add(spk);
 	}
+}
 
+
+void SpikeDetector::updateSettings()
+{
+	updateProbeSettings();
 }
 
 
@@ -321,6 +366,83 @@ double SpikeDetector::getChannelThreshold(int electrodeNum, int channelNum) cons
 }
 
 
+String SpikeDetector::loadProbeGeometry (const File& file)
+{
+    String status = probe.loadFromFile (file);
+
+    updateProbeSettings();
+
+    return status;
+}
+
+
+void SpikeDetector::clearProbeGeometry()
+{
+    probe.clear();
+
+    updateProbeSettings();
+}
+
+
+bool SpikeDetector::hasProbeGeometry() const
+{
+    return probe.getNumSites() > 0;
+}
+
+
+void SpikeDetector::setProbeThreshold (float threshold)
+{
+    setParameter (97, threshold);
+}
+
+
+void SpikeDetector::setProbeRadius (float radius)
+{
+    setParameter (96, radius);
+}
+
+
+void SpikeDetector::setProbeDedupWindow (int samples)
+{
+    setParameter (95, (float) samples);
+}
+
+
+float SpikeDetector::getProbeThreshold() const
+{
+    return probeThreshold;
+}
+
+
+float SpikeDetector::getProbeRadius() const
+{
+    return probeRadius;
+}
+
+
+int SpikeDetector::getProbeDedupWindow() const
+{
+    return probeDedupWindow;
+}
+
+
+void SpikeDetector::updateProbeSettings()
+{
+    probe.updateNeighbourhoods (probeRadius);
+
+    // a threshold crossing may need the peak search window, the deduplication
+    // window and the post-peak waveform after it before it can be decided
+    probeLookahead = 2 * probeDedupWindow + probePostPeakSamples;
+    probeHistorySize = probeLookahead + jmax (probePrePeakSamples, probeDedupWindow) + 1;
+
+    probeHistory.setSize (jmax (1, getNumInputs()), probeHistorySize);
+    probeHistory.clear();
+
+    probeNextIndex.clearQuick();
+    probeNextIndex.insertMultiple (0, -probeLookahead, probe.getNumSites());
+}
+
+
 void SpikeDetector::setParameter (int parameterIndex, float newValue)
 {
     //editor->updateParameterButtons(parameterIndex);
@@ -336,6 +458,21 @@ void SpikeDetector::setParameter (int parameterIndex, float newValue)
         else
             *(electrodes[currentElectrode]->isActive + currentChannelIndex) = true;
     }
+    else if (parameterIndex == 97)
+    {
+        probeThreshold = newValue;
+    }
+    else if (parameterIndex == 96)
+    {
+        // resizes the probe history, only changed while acquisition is stopped
+        probeRadius = newValue;
+        updateProbeSettings();
+    }
+    else if (parameterIndex == 95)
+    {
+        probeDedupWindow = jlimit (0, overflowBufferSize, (int) newValue);
+        updateProbeSettings();
+    }
 }
 
 
@@ -348,6 +485,11 @@ bool SpikeDetector::enable()
     for (int i = 0; i < electrodes.size(); ++i)
         useOverflowBuffer.add (false);
 
+    // holds the end of each block for spikes that straddle two blocks
+    requestScratchBuffer (overflowBuffer, jmax (1, getNumInputs()), overflowBufferSize, true);
+
+    updateProbeSettings();
+
     return true;
 }
 
@@ -508,6 +650,192 @@ void SpikeDetector::process (AudioSampleBuffer& buffer)
 
     // end cycle through electrodes
     }
+
+    if (probe.getNumSites() > 0)
+        detectProbeSpikes (buffer);
+}
+
+
+void SpikeDetector::detectProbeSpikes (const AudioSampleBuffer& buffer)
+{
+    for (int site = 0; site < probe.getNumSites(); ++site)
+    {
+        const int chan = probe.getSiteChannel (site);
+
+        if (probeSpikeChannel[site] < 0 || chan >= buffer.getNumChannels()
+            || chan >= probeHistory.getNumChannels())
+            continue;
+
+        const int nSamples = getNumSamples (chan);
+        const int scanEnd = nSamples - probeLookahead;
+
+        int index = probeNextIndex[site];
+
+        while (index < scanEnd)
+        {
+            index = findProbeCrossing (buffer, chan, index, scanEnd);
+
+            if (index == scanEnd)
+                break;
+
+            // the peak is the lowest sample within the window after the crossing
+            int peakIndex = index;
+
+            for (int i = index + 1; i <= index + probeDedupWindow; ++i)
+            {
+                if (getProbeSample (buffer, chan, i) < getProbeSample (buffer, chan, peakIndex))
+                    peakIndex = i;
+            }
+
+            // neighbouring sites with a larger peak report this spike themselves
+            if (isLocalProbePeak (buffer, site, peakIndex))
+                addProbeSpike (buffer, site, peakIndex);
+
+            index = peakIndex + probePostPeakSamples;
+        }
+
+        probeNextIndex.set (site, jmax (index, scanEnd) - nSamples);
+    }
+
+    updateProbeHistory (buffer);
+}
+
+
+float SpikeDetector::getProbeSample (const AudioSampleBuffer& buffer, int chan, int index) const
+{
+    if (index < 0)
+        return *probeHistory.getReadPointer (chan, probeHistorySize + index);
+    else if (index < buffer.getNumSamples())
+        return *buffer.getReadPointer (chan, index);
+    else
+        return 0;
+}
+
+
+int SpikeDetector::findProbeCrossing (const AudioSampleBuffer& buffer, int chan, int start, int end) const
+{
+    // -sample > threshold, written as sample < -threshold so that four
+    // samples can be compared at once
+    const float limit = -probeThreshold;
+    int index = start;
+
+    for (; index < jmin (0, end); ++index) // probe history
+    {
+        if (getProbeSample (buffer, chan, index) < limit)
+            return index;
+    }
+
+   #if SPIKEDETECTOR_USE_SSE2
+    const float* const data = buffer.getReadPointer (chan);
+    const int bufferEnd = jmin (end, buffer.getNumSamples());
+    const __m128 limits = _mm_set1_ps (limit);
+
+    for (; index + 4 <= bufferEnd; index += 4)
+    {
+        if (_mm_movemask_ps (_mm_cmplt_ps (_mm_loadu_ps (data + index), limits)) != 0)
+            break; // the scalar loop below finds the exact sample
+    }
+   #endif
+
+    for (; index < end; ++index)
+    {
+        if (getProbeSample (buffer, chan, index) < limit)
+            return index;
+    }
+
+    return end;
+}
+
+
+bool SpikeDetector::isLocalProbePeak (const AudioSampleBuffer& buffer, int site, int peakIndex) const
+{
+    const float peakValue = getProbeSample (buffer, probe.getSiteChannel (site), peakIndex);
+    const Array<int>& neighbours = probe.getNeighbours (site);
+
+    for (int n = 0; n < neighbours.size(); ++n)
+    {
+        const int neighbour = neighbours[n];
+        const int chan = probe.getSiteChannel (neighbour);
+
+        if (probeSpikeChannel[neighbour] < 0 || chan >= buffer.getNumChannels()
+            || chan >= probeHistory.getNumChannels())
+            continue;
+
+        for (int i = peakIndex - probeDedupWindow; i <= peakIndex + probeDedupWindow; ++i)
+        {
+            const float value = getProbeSample (buffer, chan, i);
+
+            // equal peaks go to the lower site index
+            if (-value > probeThreshold
+                && (value < peakValue || (value == peakValue && neighbour < site)))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+
+void SpikeDetector::addProbeSpike (const AudioSampleBuffer& buffer, int site, int peakIndex)
+{
+    const SpikeChannel* spikeChan = getSpikeChannel (probeSpikeChannel[site]);
+    const Array<int>& sites = probeWaveformSites.getReference (site);
+
+    const int spikeLength = probePrePeakSamples + probePostPeakSamples;
+    const int firstSample = peakIndex - probePrePeakSamples;
+
+    SpikeEvent::SpikeBuffer spikeData (spikeChan);
+    Array<float> thresholds;
+
+    for (int channel = 0; channel < sites.size(); ++channel)
+    {
+        const int chan = probe.getSiteChannel (sites[channel]);
+
+        if (firstSample >= 0)
+        {
+            spikeData.set (channel, buffer.getReadPointer (chan, firstSample), spikeLength);
+        }
+        else
+        {
+            for (int sample = 0; sample < spikeLength; ++sample)
+                spikeData.set (channel, sample, getProbeSample (buffer, chan, firstSample + sample));
+        }
+
+        thresholds.add (probeThreshold);
+    }
+
+    const int64 timestamp = getTimestamp (probe.getSiteChannel (site)) + peakIndex;
+    SpikeEventPtr newSpike = SpikeEvent::createSpikeEvent (spikeChan, timestamp, thresholds, spikeData, 0);
+
+    addSpike (spikeChan, newSpike, peakIndex);
+}
+
+
+void SpikeDetector::updateProbeHistory (const AudioSampleBuffer& buffer)
+{
+    for (int site = 0; site < probe.getNumSites(); ++site)
+    {
+        const int chan = probe.getSiteChannel (site);
+
+        if (chan >= buffer.getNumChannels() || chan >= probeHistory.getNumChannels())
+            continue;
+
+        const int nSamples = getNumSamples (chan);
+        float* history = probeHistory.getWritePointer (chan);
+
+        if (nSamples >= probeHistorySize)
+        {
+            FloatVectorOperations::copy (history, buffer.getReadPointer (chan, nSamples - probeHistorySize),
+                                         probeHistorySize);
+        }
+        else
+        {
+            // short buffer: shift the history and append the new samples
+            memmove (history, history + nSamples, (probeHistorySize - nSamples) * sizeof (float));
+            FloatVectorOperations::copy (history + probeHistorySize - nSamples, buffer.getReadPointer (chan),
+                                         nSamples);
+        }
+    }
 }
 
 
@@ -578,6 +906,15 @@ void SpikeDetector::saveCustomParametersToXml (XmlElement* parentElement)
             channelNode->setAttribute ("isActive",  *(electrodes[i]->isActive + j));
         }
     }
+
+    if (probe.getNumSites() > 0)
+    {
+        XmlElement* probeNode = parentElement->createNewChildElement ("PROBE");
+        probeNode->setAttribute ("threshold",   probeThreshold);
+        probeNode->setAttribute ("radius",      probeRadius);
+        probeNode->setAttribute ("dedupWindow", probeDedupWindow);
+        probe.saveToXml (probeNode);
+    }
 }
 
 
@@ -618,11 +955,19 @@ void SpikeDetector::loadCustomParametersFromXml()
                         std::cout << "Subchannel " << channelIndex << std::endl;
 
                         setChannel          (electrodeIndex, channelIndex, channelNode->getIntAttribute ("ch"));
-                        setChannelThreshold (electrodeIndex, channelIndex, channelNode->getDoubleAttribute ("thresh"));
+                        setChannelThreshold (electrodeIndex, channelIndex, channelNode->getDoubleAttribute ("thresh", getDefaultThreshold()));
                         setChannelActive    (electrodeIndex, channelIndex, channelNode->getBoolAttribute ("isActive"));
                     }
                 }
             }
+            else if (xmlNode->hasTagName ("PROBE"))
+            {
+                probe.loadFromXml (xmlNode);
+
+                setProbeThreshold   ((float) xmlNode->getDoubleAttribute ("threshold", getDefaultThreshold()));
+                setProbeRadius      ((float) xmlNode->getDoubleAttribute ("radius", PROBE_DEFAULT_RADIUS));
+                setProbeDedupWindow (xmlNode->getIntAttribute ("dedupWindow", PROBE_DEFAULT_DEDUP_WINDOW));
+            }
         }
 
         sde->checkSettings();
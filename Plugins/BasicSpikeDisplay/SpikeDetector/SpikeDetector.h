@@ -26,6 +26,7 @@
 
 #include <ProcessorHeaders.h>
 #include "SpikeDetectorEditor.h"
+#include "ProbeGeometry.h"
 
 
 class SpikeDetectorEditor;
@@ -144,6 +145,35 @@ public:
     double getChannelThreshold (int electrodeNum, int channelNum) const;
 
 
+    // PROBE GEOMETRY
+    // =====================================================================
+    /** Loads site coordinates from a probe geometry file. Every site is then
+        searched for spikes, in addition to the manually configured electrodes.
+        Returns a status message. */
+    String loadProbeGeometry (const File& file);
+
+    /** Removes the probe geometry, leaving only the manually configured electrodes. */
+    void clearProbeGeometry();
+
+    /** Returns true if a probe geometry is loaded. */
+    bool hasProbeGeometry() const;
+
+    /** Sets the detection threshold shared by all probe sites. */
+    void setProbeThreshold (float threshold);
+
+    /** Sets the radius (in micrometers) within which sites are considered neighbours. */
+    void setProbeRadius (float radius);
+
+    /** Sets the time window (in samples) over which a spike must be the largest
+        among neighbouring sites to be kept. */
+    void setProbeDedupWindow (int samples);
+
+    float getProbeThreshold() const;
+    float getProbeRadius() const;
+    int getProbeDedupWindow() const;
+    // =====================================================================
+
+
 private:
 
     float getDefaultThreshold() const;
@@ -159,6 +189,26 @@ private:
 
     void resetElectrode (SimpleElectrode*);
 
+    /** Recomputes neighbourhoods and history sizes after the probe settings change. */
+    void updateProbeSettings();
+
+    /** Detects spikes on every probe site, keeping only the largest one per neighbourhood. */
+    void detectProbeSpikes (const AudioSampleBuffer& buffer);
+
+    /** Returns a sample of the current buffer; negative indices read the probe history. */
+    float getProbeSample (const AudioSampleBuffer& buffer, int chan, int index) const;
+
+    /** Returns the first index in [start, end) where a channel crosses the probe threshold, or end. */
+    int findProbeCrossing (const AudioSampleBuffer& buffer, int chan, int start, int end) const;
+
+    /** Returns true if no neighbouring site crosses threshold with a larger peak around peakIndex. */
+    bool isLocalProbePeak (const AudioSampleBuffer& buffer, int site, int peakIndex) const;
+
+    void addProbeSpike (const AudioSampleBuffer& buffer, int site, int peakIndex);
+
+    /** Keeps the last samples of every channel so that spikes can straddle buffers. */
+    void updateProbeHistory (const AudioSampleBuffer& buffer);
+
     /** Pointer to a continuous buffer. */
     AudioSampleBuffer* dataBuffer;
 
@@ -182,6 +232,25 @@ private:
 
     uint16_t sampleRateForElectrode;
 
+    ProbeGeometry probe;
+    float probeThreshold;
+    float probeRadius;
+    int probeDedupWindow;
+    int probePrePeakSamples;
+    int probePostPeakSamples;
+
+    /** Samples kept at the end of each buffer for peak search, deduplication and waveforms. */
+    int probeLookahead;
+    int probeHistorySize;
+    AudioSampleBuffer probeHistory;
+
+    /** Per site: next sample to examine, relative to the start of the next buffer. */
+    Array<int> probeNextIndex;
+    /** Per site: index of its spike channel, or -1 if the site has no valid input channel. */
+    Array<int> probeSpikeChannel;
+    /** Per site: the sites whose waveforms are stored with its spikes. */
+    Array<Array<int>> probeWaveformSites;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpikeDetector);
 };
 
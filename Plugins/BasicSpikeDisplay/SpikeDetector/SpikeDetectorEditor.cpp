@@ -37,7 +37,7 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
     Typeface::Ptr typeface = new CustomTypeface(mis);
     font = Font(typeface);
 
-    desiredWidth = 300;
+    desiredWidth = 380;
 
     electrodeTypes = new ComboBox("Electrode Types");
 
@@ -86,6 +86,13 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
     plusButton->setBounds(15,42,14,14);
     addAndMakeVisible(plusButton);
 
+    probeButton = new UtilityButton("PROBE", titleFont);
+    probeButton->addListener(this);
+    probeButton->setRadius(3.0f);
+    probeButton->setBounds(290,35,80,18);
+    probeButton->setTooltip("Load a probe geometry to detect spikes over neighbouring sites");
+    addAndMakeVisible(probeButton);
+
     ElectrodeEditorButton* e1 = new ElectrodeEditorButton("EDIT",font);
     e1->addListener(this);
     addAndMakeVisible(e1);
@@ -119,6 +126,11 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
     thresholdLabel->setColour(Label::textColourId, Colours::grey);
     addAndMakeVisible(thresholdLabel);
 
+    probeThresholdValue = addProbeSetting("THRESH", "Detection threshold of every probe site", 60);
+    probeRadiusValue = addProbeSetting("RADIUS", "Distance (in micrometers) within which sites are neighbours", 80);
+    probeWindowValue = addProbeSetting("WINDOW", "Samples over which a spike must be the largest of its neighbourhood", 100);
+    refreshProbeControls();
+
     // create a custom channel selector
     //deleteAndZero(channelSelector);
 
@@ -134,6 +146,27 @@ SpikeDetectorEditor::SpikeDetectorEditor(GenericProcessor* parentNode, bool useD
 
 }
 
+Label* SpikeDetectorEditor::addProbeSetting(const String& caption, const String& tooltip, int y)
+{
+    Label* captionLabel = new Label(caption, caption);
+    captionLabel->setFont(font);
+    captionLabel->setBounds(288, y, 45, 16);
+    captionLabel->setColour(Label::textColourId, Colours::grey);
+    addAndMakeVisible(captionLabel);
+
+    Label* value = new Label(caption + " value", String());
+    value->setBounds(335, y, 35, 16);
+    value->setFont(Font("Default", 12, Font::plain));
+    value->setColour(Label::textColourId, Colours::white);
+    value->setColour(Label::backgroundColourId, Colours::grey);
+    value->setEditable(true);
+    value->addListener(this);
+    value->setTooltip(tooltip);
+    addAndMakeVisible(value);
+
+    return value;
+}
+
 SpikeDetectorEditor::~SpikeDetectorEditor()
 {
 
@@ -277,6 +310,40 @@ void SpikeDetectorEditor::buttonEvent(Button* button)
         return;
 
     }
+    else if (button == probeButton)
+    {
+        if (acquisitionIsActive)
+        {
+            CoreServices::sendStatusMessage("Stop acquisition before changing the probe geometry.");
+            return;
+        }
+
+        SpikeDetector* processor = (SpikeDetector*) getProcessor();
+
+        if (processor->hasProbeGeometry())
+        {
+            processor->clearProbeGeometry();
+            CoreServices::sendStatusMessage("Probe geometry cleared.");
+        }
+        else
+        {
+            FileChooser fc("Choose a probe geometry file...",
+                           CoreServices::getDefaultUserSaveDirectory(),
+                           "*.json",
+                           true);
+
+            if (fc.browseForFileToOpen())
+            {
+                CoreServices::sendStatusMessage(processor->loadProbeGeometry(fc.getResult()));
+            }
+        }
+
+        refreshProbeControls();
+
+        CoreServices::updateSignalChain(this);
+        CoreServices::highlightEditor(this);
+        return;
+    }
     else if (button == electrodeEditorButtons[0])   // EDIT
     {
 
@@ -432,6 +499,17 @@ void SpikeDetectorEditor::refreshElectrodeList()
     }
 }
 
+void SpikeDetectorEditor::refreshProbeControls()
+{
+    SpikeDetector* processor = (SpikeDetector*) getProcessor();
+
+    probeButton->setToggleState(processor->hasProbeGeometry(), dontSendNotification);
+
+    probeThresholdValue->setText(String(processor->getProbeThreshold()), dontSendNotification);
+    probeRadiusValue->setText(String(processor->getProbeRadius()), dontSendNotification);
+    probeWindowValue->setText(String(processor->getProbeDedupWindow()), dontSendNotification);
+}
+
 bool SpikeDetectorEditor::addElectrode(int nChans, int electrodeID)
 {
     SpikeDetector* processor = (SpikeDetector*) getProcessor();
@@ -471,6 +549,43 @@ void SpikeDetectorEditor::removeElectrode(int index)
 
 void SpikeDetectorEditor::labelTextChanged(Label* label)
 {
+    if (label == probeThresholdValue || label == probeRadiusValue || label == probeWindowValue)
+    {
+        SpikeDetector* processor = (SpikeDetector*) getProcessor();
+        const float value = label->getText().getFloatValue();
+
+        if (label == probeThresholdValue)
+        {
+            if (value > 0)
+                processor->setProbeThreshold(value);
+            else
+                CoreServices::sendStatusMessage("Value out of range.");
+        }
+        else if (acquisitionIsActive)
+        {
+            // the neighbourhoods and history are rebuilt, which cannot happen while processing
+            CoreServices::sendStatusMessage("Stop acquisition before changing the probe neighbourhoods.");
+        }
+        else if (label == probeRadiusValue)
+        {
+            if (value > 0)
+                processor->setProbeRadius(value);
+            else
+                CoreServices::sendStatusMessage("Value out of range.");
+        }
+        else
+        {
+            if (value >= 0)
+                processor->setProbeDedupWindow(roundFloatToInt(value));
+            else
+                CoreServices::sendStatusMessage("Value out of range.");
+        }
+
+        // shows the value that was applied, or restores the previous one
+        refreshProbeControls();
+        return;
+    }
+
     if (label->getText().equalsIgnoreCase("1") && isPlural)
     {
         for (int n = 1; n < electrodeTypes->getNumItems()+1; n++)
@@ -545,6 +660,7 @@ void SpikeDetectorEditor::checkSettings()
 {
     electrodeList->setSelectedId(0);
     drawElectrodeButtons(0);
+    refreshProbeControls();
 
 	CoreServices::updateSignalChain(this);
 	CoreServices::highlightEditor(this);
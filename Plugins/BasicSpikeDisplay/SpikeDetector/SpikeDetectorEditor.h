@@ -66,6 +66,9 @@ public:
     void checkSettings();
     void refreshElectrodeList();
 
+    /** Updates the probe button and settings after a probe geometry is loaded or cleared. */
+    void refreshProbeControls();
+
 private:
 
     void drawElectrodeButtons(int);
@@ -77,6 +80,11 @@ private:
     TriangleButton* upButton;
     TriangleButton* downButton;
     UtilityButton* plusButton;
+    UtilityButton* probeButton;
+
+    Label* probeThresholdValue;
+    Label* probeRadiusValue;
+    Label* probeWindowValue;
 
     ThresholdSlider* thresholdSlider;
 
@@ -85,6 +93,9 @@ private:
 
     void editElectrode(int index, int chan, int newChan);
 
+    /** Creates a caption and an editable value for one of the probe settings. */
+    Label* addProbeSetting(const String& caption, const String& tooltip, int y);
+
     int lastId;
     bool isPlural;
 
@@ -31,8 +31,6 @@ CAR::CAR()
     : GenericProcessor ("Common Avg Ref") //, threshold(200.0), state(true)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
-
-    m_avgBuffer = AudioSampleBuffer (1, 10000); // 1-dimensional buffer to hold the avg
 }
 
 
@@ -48,6 +46,14 @@ AudioProcessorEditor* CAR::createEditor()
 }
 
 
+bool CAR::enable()
+{
+    requestScratchBuffer (m_avgBuffer, 1, 10000); // 1-dimensional buffer to hold the avg
+
+    return true;
+}
+
+
 float CAR::getGainLevel()
 {
     m_gainLevel.updateTarget();
@@ -62,6 +62,9 @@ public:
     */
     void process (AudioSampleBuffer& buffer) override;
 
+    /** Requests the buffer that holds the average from the graph's scratch memory */
+    bool enable() override;
+
     /** Returns the current gain level that is set in the processor */
     float getGainLevel();
 
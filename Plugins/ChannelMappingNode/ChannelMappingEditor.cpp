@@ -987,65 +987,129 @@ String ChannelMappingEditor::loadPrbFile(File filename)
 {
     FileInputStream inputStream(filename);
 
+    if (inputStream.failedToOpen())
+        return "Could not open " + filename.getFileName();
+
     var json = JSON::parse(inputStream);
 
-    var returnVal = -255;
+    PrbMap map;
+    String error = parsePrbFile(json, map);
+
+    // nothing is changed unless the whole file is valid
+    if (error.isNotEmpty())
+        return "Not a valid .prb file: " + error;
+
+    applyChannelMap(map);
+
+    return "Loaded " + filename.getFileName();
+
+}
+
+String ChannelMappingEditor::parsePrbFile(const var& json, PrbMap& map)
+{
+    var channelGroup = json[Identifier("0")];
+    Array<var>* mapping = channelGroup[Identifier("mapping")].getArray();
+
+    if (mapping == nullptr || mapping->size() == 0)
+        return "no channel mapping";
+
+    const int numChannels = mapping->size();
 
-    var channelGroup = json.getProperty(Identifier("0"), returnVal);
+    // every channel must appear exactly once
+    Array<bool> used;
+    used.insertMultiple(0, false, numChannels);
 
-    if (channelGroup.equalsWithSameType(returnVal))
+    for (int i = 0; i < numChannels; i++)
     {
-        return "Not a valid .prb file.";
+        const var& entry = mapping->getReference(i);
+        const int ch = entry;
+
+        if (! (entry.isInt() || entry.isInt64() || entry.isDouble()) || ch < 1 || ch > numChannels || used[ch-1])
+            return "mapping is not an ordering of channels 1 to " + String(numChannels);
+
+        used.set(ch-1, true);
+        map.mapping.add(ch);
     }
 
-    var mapping = channelGroup[Identifier("mapping")];
-    Array<var>* map = mapping.getArray();
+    // the other arrays are optional: channels default to enabled, without reference
+    Array<var>* reference = channelGroup[Identifier("reference")].getArray();
+
+    if (reference != nullptr && reference->size() != numChannels)
+        return "reference list does not match the mapping";
 
-    var reference = channelGroup[Identifier("reference")];
-    Array<var>* ref = reference.getArray();
+    for (int i = 0; i < numChannels; i++)
+    {
+        const int rf = reference != nullptr ? (int) reference->getUnchecked(i) : -1;
+
+        if (rf < -1 || rf >= NUM_REFERENCES)
+            return "reference of position " + String(i+1) + " out of range";
 
-    var enabled = channelGroup[Identifier("enabled")];
-    Array<var>* enbl = enabled.getArray();
+        map.reference.add(rf);
+    }
 
-    std::cout << "We found this many: " << map->size() << std::endl;
+    Array<var>* enabled = channelGroup[Identifier("enabled")].getArray();
 
-	if (map->size() > previousChannelCount)
-		createElectrodeButtons(map->size(), false);
+    for (int i = 0; i < numChannels; i++)
+        map.enabled.add(enabled != nullptr && i < enabled->size() ? (bool) enabled->getReference(i) : true);
 
-    for (int i = 0; i < map->size(); i++)
+    Array<var>* channels = json[Identifier("refs")][Identifier("channels")].getArray();
+
+    for (int i = 0; i < NUM_REFERENCES; i++)
     {
-        int ch = map->getUnchecked(i); 
-        channelArray.set(i, ch);
+        const int ch = channels != nullptr && i < channels->size() ? (int) channels->getReference(i) : -1;
 
-        int rf = ref->getUnchecked(i);
-        referenceArray.set(ch-1, rf);
+        if (ch < -1 || ch >= numChannels)
+            return "reference channel " + String::charToString('A'+i) + " out of range";
 
-        bool en = enbl->getUnchecked(i);
-        enabledChannelArray.set(ch-1, en);
+        map.referenceChannels.add(ch);
+    }
 
-        electrodeButtons[i]->setChannelNum(ch);
-        electrodeButtons[i]->setEnabled(en);
-		
-		getProcessor()->setCurrentChannel(i);
-		getProcessor()->setParameter(0,ch-1);
-		getProcessor()->setCurrentChannel(ch-1);
-		getProcessor()->setParameter(1, rf);
-		getProcessor()->setParameter(3, en ? 1 : 0);
+    Array<var>* recording = json[Identifier("recording")][Identifier("channels")].getArray();
+
+    if (recording != nullptr)
+    {
+        for (int i = 0; i < recording->size(); i++)
+            map.recording.add(recording->getReference(i));
     }
-	checkUnusedChannels();
 
-    var refChans = json[Identifier("refs")];
-    var channels = refChans[Identifier("channels")];
-    Array<var>* chans = channels.getArray();
+    return String::empty;
+}
+
+void ChannelMappingEditor::applyChannelMap(const PrbMap& map)
+{
+    const int numChannels = map.mapping.size();
+
+	if (numChannels > previousChannelCount)
+		createElectrodeButtons(numChannels, false);
+
+    // positions the file does not cover keep their own channel, so none is used twice
+    for (int i = numChannels; i < electrodeButtons.size(); i++)
+        channelArray.set(i, i+1);
 
-    for (int i = 0; i < chans->size(); i++)
+    for (int i = 0; i < numChannels; i++)
     {
-        int ch = chans->getUnchecked(i);
-        referenceChannels.set(i,ch);
-        getProcessor()->setCurrentChannel(ch);
-        getProcessor()->setParameter(2,i);
+        const int ch = map.mapping[i];
+        channelArray.set(i, ch);
+        referenceArray.set(ch-1, map.reference[i]);
+        enabledChannelArray.set(ch-1, map.enabled[i]);
     }
 
+    for (int i = 0; i < NUM_REFERENCES; i++)
+        referenceChannels.set(i, map.referenceChannels[i]);
+
+    for (int i = 0; i < electrodeButtons.size(); i++)
+        electrodeButtons[i]->setChannelNum(channelArray[i]);
+
+    // the processor gets the whole map at once, instead of a parameter per channel
+    Array<int> processorOrder;
+    for (int i = 0; i < channelArray.size(); i++)
+        processorOrder.add(channelArray[i]-1);
+
+    ChannelMappingNode* processor = static_cast<ChannelMappingNode*>(getProcessor());
+    processor->setChannelMap(processorOrder, referenceArray, enabledChannelArray, referenceChannels);
+
+	checkUnusedChannels();
+
     referenceButtons[0]->setToggleState(true, sendNotificationSync);
 
     for (int i = 0; i < electrodeButtons.size(); i++)
@@ -1060,19 +1124,12 @@ String ChannelMappingEditor::loadPrbFile(File filename)
         }
     }
 
+    refreshButtonLocations();
+
 	setConfigured(true);
 	CoreServices::updateSignalChain(this);
 
-	var recChans = json[Identifier("recording")];
-	var recording = recChans[Identifier("channels")];
-	Array<var>* rec = recording.getArray();
-
-	for (int i = 0; i < rec->size(); i++)
-	{
-		bool recEnabled = rec->getUnchecked(i);
-		channelSelector->setRecordStatus(i,recEnabled);
-	}
-
-    return "Loaded " + filename.getFileName();
+	for (int i = 0; i < map.recording.size(); i++)
+		channelSelector->setRecordStatus(i, map.recording[i]);
 
 }
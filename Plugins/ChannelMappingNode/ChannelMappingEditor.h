@@ -70,8 +70,24 @@ public:
     String writePrbFile(File filename);
     String loadPrbFile(File filename);
 
+    /** A channel map read from a .prb file, checked in full before any of it is applied */
+    struct PrbMap
+    {
+        Array<int> mapping;           // input channel (from 1) at each position
+        Array<int> reference;         // reference group of the channel at each position, -1 for none
+        Array<bool> enabled;          // enabled state of the channel at each position
+        Array<int> referenceChannels; // input channel (from 0) of each reference group, -1 for none
+        Array<bool> recording;        // record state of each output channel
+    };
+
+    /** Reads the JSON of a .prb file into map. Returns a description of the first
+        problem found, or an empty string if the whole file is valid. */
+    static String parsePrbFile(const var& json, PrbMap& map);
+
 private:
 
+    void applyChannelMap(const PrbMap& map);
+
     void setChannelReference(ElectrodeButton* button);
     void setChannelPosition(int position, int channel);
     void checkUnusedChannels();
@@ -27,7 +27,6 @@
 
 ChannelMappingNode::ChannelMappingNode()
     : GenericProcessor  ("Channel Map")
-    , channelBuffer     (1, 10000)
 {
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
@@ -65,9 +64,6 @@ AudioProcessorEditor* ChannelMappingNode::createEditor()
 
 void ChannelMappingNode::updateSettings()
 {
-    if (getNumInputs() > 0)
-        channelBuffer.setSize (getNumInputs(), 10000);
-
     if (editorIsConfigured)
     {
         OwnedArray<DataChannel> oldChannels;
@@ -124,14 +120,56 @@ void ChannelMappingNode::setParameter (int parameterIndex, float newValue)
 }
 
 
+void ChannelMappingNode::setChannelMap (const Array<int>& newChannelOrder,
+                                        const Array<int>& newReferences,
+                                        const Array<bool>& newEnabled,
+                                        const Array<int>& newReferenceChannels)
+{
+    // probes can have more channels than the room made in the constructor
+    for (int i = channelArray.size(); i < newChannelOrder.size(); ++i)
+    {
+        channelArray.add        (i);
+        referenceArray.add      (-1);
+        enabledChannelArray.add (true);
+    }
+
+    for (int i = 0; i < newChannelOrder.size(); ++i)
+        channelArray.set (i, newChannelOrder[i]);
+
+    for (int i = 0; i < newReferences.size(); ++i)
+        referenceArray.set (i, newReferences[i]);
+
+    for (int i = 0; i < newEnabled.size(); ++i)
+        enabledChannelArray.set (i, newEnabled[i]);
+
+    for (int i = 0; i < jmin (NUM_REFERENCES, newReferenceChannels.size()); ++i)
+        referenceChannels.set (i, newReferenceChannels[i]);
+
+    editorIsConfigured = true;
+}
+
+
+bool ChannelMappingNode::enable()
+{
+    // only needed during process(), so the memory is shared with other processors
+    requestScratchBuffer (channelBuffer, jmax (1, getNumInputs()), 10000);
+
+    return true;
+}
+
+
 void ChannelMappingNode::process (AudioSampleBuffer& buffer)
 {
     int j = 0;
     int i = 0;
     int realChan;
 
-    // use copy constructor to set the data to refer to
-    channelBuffer = buffer;
+    // copy the input, without resizing the scratch buffer
+    const int numChannels = jmin (buffer.getNumChannels(), channelBuffer.getNumChannels());
+    const int numSamples = jmin (buffer.getNumSamples(), channelBuffer.getNumSamples());
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        channelBuffer.copyFrom (ch, 0, buffer, ch, 0, numSamples);
 
    // buffer.clear();
 
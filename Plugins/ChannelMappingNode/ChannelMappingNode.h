@@ -51,6 +51,20 @@ public:
 
     void updateSettings() override;
 
+    bool enable() override;
+
+    /** Replaces the whole map in one step, while acquisition is stopped.
+
+        channelOrder holds the input channel of each output position, references and
+        enabled are indexed by input channel, and referenceChannels holds the input
+        channel of each reference group (-1 for none). Channels beyond the end of
+        the arrays keep their previous settings.
+    */
+    void setChannelMap (const Array<int>& channelOrder,
+                        const Array<int>& references,
+                        const Array<bool>& enabled,
+                        const Array<int>& referenceChannels);
+
 
 private:
     Array<int> referenceArray;
@@ -0,0 +1,293 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ControlServer.h"
+#include "ControlSocket.h"
+
+#if JUCE_LINUX || JUCE_MAC
+ #include <sys/socket.h>
+ #include <sys/stat.h>
+ #include <sys/un.h>
+ #include <poll.h>
+ #include <unistd.h>
+ #include <errno.h>
+ #define CONTROL_SERVER_AVAILABLE 1
+
+ // a client that disconnects before its reply must not raise SIGPIPE
+ #ifdef MSG_NOSIGNAL
+  #define CONTROL_SEND_FLAGS MSG_NOSIGNAL
+ #else
+  #define CONTROL_SEND_FLAGS 0
+ #endif
+#endif
+
+/** How often a blocked server checks whether it should exit */
+#define SERVER_POLL_MS 100
+
+/** Longest command line; longer ones are dropped */
+#define MAX_COMMAND_LENGTH 4096
+
+
+ControlServer::ControlServer (ControlSocket& owner_, const String& path_)
+    : Thread  ("Control socket")
+    , owner   (owner_)
+    , path    (path_)
+{
+}
+
+
+ControlServer::~ControlServer()
+{
+    stopThread (2 * SERVER_POLL_MS + CONTROL_COMMAND_TIMEOUT_MS);
+}
+
+
+const String& ControlServer::getPath() const
+{
+    return path;
+}
+
+
+String ControlServer::getStatus() const
+{
+    const ScopedLock sl (statusLock);
+    return status;
+}
+
+
+void ControlServer::setStatus (const String& newStatus)
+{
+    const ScopedLock sl (statusLock);
+    status = newStatus;
+}
+
+
+#if CONTROL_SERVER_AVAILABLE
+
+/** The fallback folder for the socket, in the shared temporary directory */
+static File getPrivateTempFolder()
+{
+    return File ("/tmp/open-ephys-" + String ((int) getuid()));
+}
+
+
+String ControlServer::getDefaultPath()
+{
+    // the runtime directory belongs to the user alone, and is cleared when they log out
+    const char* runtimeDir = getenv ("XDG_RUNTIME_DIR");
+
+    if (runtimeDir != nullptr && File::isAbsolutePath (runtimeDir) && File (runtimeDir).isDirectory())
+        return File (runtimeDir).getChildFile (CONTROL_SOCKET_NAME).getFullPathName();
+
+    return getPrivateTempFolder().getChildFile (CONTROL_SOCKET_NAME).getFullPathName();
+}
+
+
+void ControlServer::run()
+{
+    sockaddr_un address;
+    zerostruct (address);
+    address.sun_family = AF_UNIX;
+
+    if (path.isEmpty() || (size_t) path.getNumBytesAsUTF8() >= sizeof (address.sun_path))
+    {
+        setStatus ("Invalid socket path");
+        return;
+    }
+
+    path.copyToUTF8 (address.sun_path, sizeof (address.sun_path));
+
+    const File folder = File (path).getParentDirectory();
+
+    if (! folder.isDirectory() && mkdir (folder.getFullPathName().toRawUTF8(), 0700) != 0)
+    {
+        setStatus ("Could not create " + folder.getFullPathName());
+        return;
+    }
+
+    // anyone can create the fallback folder first, so only use it if it is ours alone
+    if (folder == getPrivateTempFolder())
+    {
+        struct stat folderInfo;
+        if (lstat (folder.getFullPathName().toRawUTF8(), &folderInfo) != 0 || ! S_ISDIR (folderInfo.st_mode)
+            || folderInfo.st_uid != getuid() || (folderInfo.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+        {
+            setStatus (folder.getFullPathName() + " is not private");
+            return;
+        }
+    }
+
+    const int listener = socket (AF_UNIX, SOCK_STREAM, 0);
+
+    if (listener < 0)
+    {
+        setStatus ("Could not create socket");
+        return;
+    }
+
+    // a socket file nobody answers on is left over from a crash, and can go
+    struct stat info;
+    if (lstat (address.sun_path, &info) == 0 && S_ISSOCK (info.st_mode))
+    {
+        const int probe = socket (AF_UNIX, SOCK_STREAM, 0);
+        const bool inUse = probe >= 0 && connect (probe, (const sockaddr*) &address, sizeof (address)) == 0;
+
+        if (probe >= 0)
+            close (probe);
+
+        if (inUse)
+        {
+            close (listener);
+            setStatus ("In use by another program");
+            return;
+        }
+
+        unlink (address.sun_path);
+    }
+
+    // connecting needs write permission on the socket, which other users must not have
+    if (bind (listener, (const sockaddr*) &address, sizeof (address)) != 0
+        || chmod (address.sun_path, S_IRUSR | S_IWUSR) != 0
+        || listen (listener, 1) != 0)
+    {
+        close (listener);
+        setStatus ("Could not listen: " + String (strerror (errno)));
+        return;
+    }
+
+    setStatus ("Listening");
+
+    while (! threadShouldExit())
+    {
+        pollfd pfd;
+        pfd.fd = listener;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll (&pfd, 1, SERVER_POLL_MS) <= 0)
+            continue;
+
+        const int client = accept (listener, nullptr, nullptr);
+
+        if (client < 0)
+            continue;
+
+       #ifdef SO_NOSIGPIPE
+        const int noSigPipe = 1;
+        setsockopt (client, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof (noSigPipe));
+       #endif
+
+        setStatus ("Connected");
+        serveClient (client);
+        close (client);
+
+        if (! threadShouldExit())
+            setStatus ("Listening");
+    }
+
+    close (listener);
+    unlink (address.sun_path);
+}
+
+
+void ControlServer::serveClient (int client)
+{
+    MemoryBlock line;
+    bool discarding = false;
+    char buffer[512];
+
+    while (! threadShouldExit())
+    {
+        pollfd pfd;
+        pfd.fd = client;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        if (poll (&pfd, 1, SERVER_POLL_MS) <= 0)
+            continue;
+
+        const ssize_t numRead = read (client, buffer, sizeof (buffer));
+
+        if (numRead <= 0)
+            return;
+
+        for (ssize_t i = 0; i < numRead; ++i)
+        {
+            if (buffer[i] != '\n')
+            {
+                if (line.getSize() < MAX_COMMAND_LENGTH)
+                    line.append (buffer + i, 1);
+                else
+                    discarding = true;
+
+                continue;
+            }
+
+            String reply;
+
+            if (discarding)
+                reply = "ERROR command too long";
+            else
+                reply = owner.handleCommand (String::fromUTF8 ((const char*) line.getData(), (int) line.getSize()).trim());
+
+            line.setSize (0);
+            discarding = false;
+
+            reply << "\n";
+
+            const char* data = reply.toRawUTF8();
+            size_t remaining = reply.getNumBytesAsUTF8();
+
+            while (remaining > 0)
+            {
+                const ssize_t written = send (client, data, remaining, CONTROL_SEND_FLAGS);
+
+                if (written <= 0)
+                    return;
+
+                data += written;
+                remaining -= (size_t) written;
+            }
+        }
+    }
+}
+
+#else
+
+String ControlServer::getDefaultPath()
+{
+    return File::getSpecialLocation (File::tempDirectory).getChildFile (CONTROL_SOCKET_NAME).getFullPathName();
+}
+
+
+void ControlServer::run()
+{
+    setStatus ("Not available on this platform");
+}
+
+
+void ControlServer::serveClient (int)
+{
+}
+
+#endif
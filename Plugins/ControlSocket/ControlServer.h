@@ -0,0 +1,78 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONTROLSERVER_H_INCLUDED
+#define CONTROLSERVER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+class ControlSocket;
+
+/**
+
+    Listens on a Unix-domain socket and hands every line received to the
+    ControlSocket, writing its reply back.
+
+    One client is served at a time, and its commands are run in order; a
+    second client is accepted once the first disconnects. The socket is only
+    reachable from the local machine and only usable by the user running the
+    GUI, and is removed when the server stops. A live socket left at the same
+    path by another instance is not taken over.
+
+    Unix-domain sockets are only used on Linux and macOS; elsewhere the
+    server reports that it is unavailable.
+
+    @see ControlSocket
+*/
+class ControlServer : public Thread
+{
+public:
+    ControlServer (ControlSocket& owner, const String& path);
+    ~ControlServer();
+
+    void run() override;
+
+    const String& getPath() const;
+
+    /** Returns the socket path in the user's runtime directory ($XDG_RUNTIME_DIR),
+        or else in a folder of the temporary directory private to the user */
+    static String getDefaultPath();
+
+    String getStatus() const;
+
+private:
+    void setStatus (const String& status);
+
+    /** Reads and answers commands until the client disconnects or the thread is stopped */
+    void serveClient (int clientSocket);
+
+    ControlSocket& owner;
+    const String path;
+
+    CriticalSection statusLock;
+    String status;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControlServer);
+};
+
+#endif  // CONTROLSERVER_H_INCLUDED
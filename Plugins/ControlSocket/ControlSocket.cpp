@@ -0,0 +1,396 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ControlSocket.h"
+#include "ControlServer.h"
+#include "ControlSocketEditor.h"
+
+
+ControlSocket::ControlSocket()
+    : GenericProcessor      ("Control Socket")
+    , annotationChannel     (nullptr)
+    , blockStart            (-1)
+    , blockEnd              (-1)
+    , blockTicks            (0)
+    , sampleRate            (0.0f)
+    , firstBlockStart       (-1)
+    , acquisitionStarts     (0)
+    , acquisitionStops      (0)
+    , recordStarts          (0)
+    , recordStops           (0)
+    , annotationState       (IDLE)
+    , annotationTimestamp   (-1)
+{
+    setProcessorType (PROCESSOR_TYPE_UTILITY);
+
+    zeromem (annotationText, sizeof (annotationText));
+
+    server = new ControlServer (*this, ControlServer::getDefaultPath());
+    server->startThread();
+}
+
+
+ControlSocket::~ControlSocket()
+{
+    // stops the socket thread before anything it uses goes away
+    server = nullptr;
+}
+
+
+AudioProcessorEditor* ControlSocket::createEditor()
+{
+    editor = new ControlSocketEditor (this, true);
+    return editor;
+}
+
+
+void ControlSocket::updateSettings()
+{
+    annotationChannel = nullptr;
+
+    if (dataChannelArray.size() == 0)
+        return;
+
+    EventChannel* ev = new EventChannel (EventChannel::TEXT, 1, MAX_ANNOTATION_LENGTH, dataChannelArray[0], this);
+    ev->setName ("Control socket annotations");
+    ev->setDescription ("Text received through the control socket, sent at the start of the next block");
+    ev->setIdentifier ("external.control.annotation");
+    eventChannelArray.add (ev);
+    annotationChannel = ev;
+}
+
+
+bool ControlSocket::enable()
+{
+    blockStart = -1;
+    blockEnd = -1;
+    firstBlockStart = -1;
+
+    if (dataChannelArray.size() > 0)
+        sampleRate = dataChannelArray[0]->getSampleRate();
+    else
+        sampleRate = CoreServices::getGlobalSampleRate();
+
+    ++acquisitionStarts;
+
+    return true;
+}
+
+
+bool ControlSocket::disable()
+{
+    ++acquisitionStops;
+
+    return true;
+}
+
+
+void ControlSocket::startRecording()
+{
+    ++recordStarts;
+}
+
+
+void ControlSocket::stopRecording()
+{
+    ++recordStops;
+}
+
+
+void ControlSocket::process (AudioSampleBuffer& buffer)
+{
+    const juce::int64 start = (juce::int64) getTimestamp (0);
+
+    blockTicks = Time::getHighResolutionTicks();
+    blockStart = start;
+    blockEnd = start + getNumSamples (0);
+
+    if (firstBlockStart < 0)
+        firstBlockStart = start;
+
+    if (annotationState == PENDING && annotationChannel != nullptr)
+    {
+        TextEventPtr event = TextEvent::createTextEvent (annotationChannel, start, String::fromUTF8 (annotationText));
+        addEvent (annotationChannel, event, 0);
+
+        annotationTimestamp = start;
+        annotationState = SENT;
+    }
+}
+
+
+String ControlSocket::handleCommand (const String& command)
+{
+    const String name = command.upToFirstOccurrenceOf (" ", false, false);
+    const String argument = command.fromFirstOccurrenceOf (" ", false, false).trim();
+
+    if (name.isEmpty())
+        return "ERROR empty command";
+
+    if (name.equalsIgnoreCase ("Ping"))
+        return "OK";
+
+    if (name.equalsIgnoreCase ("StartAcquisition"))
+        return startAcquisition();
+
+    if (name.equalsIgnoreCase ("StopAcquisition"))
+        return stopAcquisition();
+
+    if (name.equalsIgnoreCase ("StartRecord"))
+        return startRecord();
+
+    if (name.equalsIgnoreCase ("StopRecord"))
+        return stopRecord();
+
+    if (name.equalsIgnoreCase ("Annotate"))
+        return annotate (argument);
+
+    if (name.equalsIgnoreCase ("IsAcquiring"))
+        return isAcquiring() ? "OK 1" : "OK 0";
+
+    if (name.equalsIgnoreCase ("IsRecording"))
+        return isRecording() ? "OK 1" : "OK 0";
+
+    if (name.equalsIgnoreCase ("GetTimestamp"))
+        return "OK " + String (estimateCurrentTimestamp());
+
+    if (name.equalsIgnoreCase ("GetSampleRate"))
+        return "OK " + String (sampleRate.load());
+
+    return "ERROR unknown command " + name;
+}
+
+
+bool ControlSocket::isAcquiring() const
+{
+    return acquisitionStarts != acquisitionStops;
+}
+
+
+bool ControlSocket::isRecording() const
+{
+    return recordStarts != recordStops;
+}
+
+
+bool ControlSocket::keepWaiting (uint32 startTime) const
+{
+    if (Thread::currentThreadShouldExit() || Time::getMillisecondCounter() - startTime > CONTROL_COMMAND_TIMEOUT_MS)
+        return false;
+
+    Thread::sleep (1);
+    return true;
+}
+
+
+juce::int64 ControlSocket::estimateCurrentTimestamp() const
+{
+    if (! isAcquiring() || blockStart < 0)
+        return -1;
+
+    const double elapsed = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - blockTicks);
+    return blockStart + (juce::int64) (elapsed * sampleRate);
+}
+
+
+String ControlSocket::effectReply (juce::int64 effectTimestamp, juce::int64 receivedTimestamp)
+{
+    return "OK " + String (effectTimestamp) + " " + String (receivedTimestamp);
+}
+
+
+String ControlSocket::startAcquisition()
+{
+    if (isAcquiring())
+        return "ERROR already acquiring";
+
+    const int starts = acquisitionStarts;
+
+    {
+        // the click is still queued, but not behind the message that would otherwise carry the command
+        const MessageManagerLock mmLock (Thread::getCurrentThread());
+
+        if (! mmLock.lockWasGained())
+            return "ERROR shutting down";
+
+        CoreServices::setAcquisitionStatus (true);
+    }
+
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    while (acquisitionStarts == starts || firstBlockStart < 0)
+    {
+        if (! keepWaiting (startTime))
+            return "ERROR acquisition did not start";
+    }
+
+    return effectReply (firstBlockStart, -1);
+}
+
+
+String ControlSocket::stopAcquisition()
+{
+    if (! isAcquiring())
+        return "ERROR not acquiring";
+
+    const int stops = acquisitionStops;
+    const juce::int64 received = estimateCurrentTimestamp();
+
+    {
+        const MessageManagerLock mmLock (Thread::getCurrentThread());
+
+        if (! mmLock.lockWasGained())
+            return "ERROR shutting down";
+
+        CoreServices::setAcquisitionStatus (false);
+    }
+
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    while (acquisitionStops == stops)
+    {
+        if (! keepWaiting (startTime))
+            return "ERROR acquisition did not stop";
+    }
+
+    // callbacks have ended, so this was the last block
+    return effectReply (blockEnd, received);
+}
+
+
+String ControlSocket::startRecord()
+{
+    if (isRecording())
+        return "ERROR already recording";
+
+    const int starts = recordStarts;
+    const juce::int64 received = estimateCurrentTimestamp();
+
+    {
+        const MessageManagerLock mmLock (Thread::getCurrentThread());
+
+        if (! mmLock.lockWasGained())
+            return "ERROR shutting down";
+
+        CoreServices::setRecordingStatus (true);
+    }
+
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    // the record node has been set up once startRecording() is called, and clears its start timestamp
+    while (recordStarts == starts || CoreServices::RecordNode::getRecordingStartTimestamp() < 0)
+    {
+        if (! keepWaiting (startTime))
+            return "ERROR recording did not start";
+    }
+
+    return effectReply (CoreServices::RecordNode::getRecordingStartTimestamp(), received);
+}
+
+
+String ControlSocket::stopRecord()
+{
+    if (! isRecording())
+        return "ERROR not recording";
+
+    const int stops = recordStops;
+    const juce::int64 received = estimateCurrentTimestamp();
+
+    {
+        const MessageManagerLock mmLock (Thread::getCurrentThread());
+
+        if (! mmLock.lockWasGained())
+            return "ERROR shutting down";
+
+        CoreServices::setRecordingStatus (false);
+    }
+
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    while (recordStops == stops)
+    {
+        if (! keepWaiting (startTime))
+            return "ERROR recording did not stop";
+    }
+
+    return effectReply (CoreServices::RecordNode::getRecordingEndTimestamp(), received);
+}
+
+
+String ControlSocket::annotate (const String& text)
+{
+    if (! isAcquiring())
+        return "ERROR not acquiring";
+
+    if (annotationChannel == nullptr)
+        return "ERROR no input channels";
+
+    if (text.isEmpty())
+        return "ERROR empty annotation";
+
+    const juce::int64 received = estimateCurrentTimestamp();
+
+    text.copyToUTF8 (annotationText, MAX_ANNOTATION_LENGTH);
+    annotationState = PENDING;
+
+    const uint32 startTime = Time::getMillisecondCounter();
+
+    while (annotationState != SENT)
+    {
+        if (! isAcquiring() || ! keepWaiting (startTime))
+        {
+            // process() may still pick it up while this gives up
+            int expected = PENDING;
+            if (annotationState.compare_exchange_strong (expected, IDLE))
+                return "ERROR annotation was not sent";
+        }
+    }
+
+    const juce::int64 sentAt = annotationTimestamp;
+    annotationState = IDLE;
+
+    return effectReply (sentAt, received);
+}
+
+
+void ControlSocket::setSocketPath (const String& path)
+{
+    if (path == server->getPath())
+        return;
+
+    server = nullptr;
+    server = new ControlServer (*this, path);
+    server->startThread();
+}
+
+
+String ControlSocket::getSocketPath() const
+{
+    return server->getPath();
+}
+
+
+String ControlSocket::getServerStatus() const
+{
+    return server->getStatus();
+}
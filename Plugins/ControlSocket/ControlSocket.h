@@ -0,0 +1,154 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONTROLSOCKET_H_INCLUDED
+#define CONTROLSOCKET_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include <atomic>
+
+/** File name of the socket in the default folder, see ControlServer::getDefaultPath() */
+#define CONTROL_SOCKET_NAME "open-ephys-control.sock"
+
+/** Longest annotation text, including the terminating null */
+#define MAX_ANNOTATION_LENGTH 256
+
+/** How long a command waits for the GUI to act on it */
+#define CONTROL_COMMAND_TIMEOUT_MS 10000
+
+class ControlServer;
+
+/**
+
+    Lets an experiment controller on the same machine start and stop
+    acquisition and recording, and add annotations to the event stream,
+    through a Unix-domain socket.
+
+    Commands are lines of text; every one gets a single line back:
+
+        StartAcquisition, StopAcquisition, StartRecord, StopRecord
+        Annotate <text>
+        IsAcquiring, IsRecording, GetTimestamp, GetSampleRate, Ping
+
+    A command that changes state is answered once it has taken effect, with
+    "OK <effect> <received>": the timestamp of the first sample it applies to
+    and the estimated timestamp of the sample being acquired when the command
+    arrived. Their difference is the command-to-effect latency. Errors are
+    answered with "ERROR <reason>".
+
+    Timestamps are those of the first input channel, except for the recording
+    commands, whose effect is the first (or one past the last) sample written
+    for the first recorded channel. An annotation is sent as a text event at
+    the start of the next block, which is the sample it reports.
+
+    State changes take the message manager lock on the socket thread instead
+    of waiting in the message queue behind GUI clicks, and the timestamps are
+    read where the change actually happens, so the reply is exact however
+    long the GUI takes to act.
+
+    @see ControlServer, ControlSocketEditor
+*/
+class ControlSocket : public GenericProcessor
+{
+public:
+    ControlSocket();
+    ~ControlSocket();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+    bool disable() override;
+
+    void startRecording() override;
+    void stopRecording() override;
+
+    /** Runs one command line and returns the reply, without its newline. Called on the socket thread. */
+    String handleCommand (const String& command);
+
+    /** Moves the socket to a new path, restarting the server */
+    void setSocketPath (const String& path);
+    String getSocketPath() const;
+
+    /** Returns a one-line description of the server state, for the editor */
+    String getServerStatus() const;
+
+private:
+    String startAcquisition();
+    String stopAcquisition();
+    String startRecord();
+    String stopRecord();
+    String annotate (const String& text);
+
+    bool isAcquiring() const;
+    bool isRecording() const;
+
+    /** Sleeps for a millisecond on the socket thread, unless the command has timed out or the server is stopping */
+    bool keepWaiting (uint32 startTime) const;
+
+    /** Timestamp of the sample being acquired now, extrapolated from the last block */
+    juce::int64 estimateCurrentTimestamp() const;
+
+    /** Formats an "OK <effect> <received>" reply */
+    static String effectReply (juce::int64 effectTimestamp, juce::int64 receivedTimestamp);
+
+    ScopedPointer<ControlServer> server;
+
+    const EventChannel* annotationChannel;
+
+    /** The block last processed, for GetTimestamp and latency estimates; -1 when not acquiring */
+    std::atomic<juce::int64> blockStart;
+    std::atomic<juce::int64> blockEnd;
+    std::atomic<juce::int64> blockTicks;
+    std::atomic<float> sampleRate;
+
+    /** First block of the current acquisition, -1 until it has been processed */
+    std::atomic<juce::int64> firstBlockStart;
+
+    /** Bumped on the message thread when acquisition or recording starts and stops */
+    std::atomic<int> acquisitionStarts;
+    std::atomic<int> acquisitionStops;
+    std::atomic<int> recordStarts;
+    std::atomic<int> recordStops;
+
+    /** The single pending annotation: the socket thread fills it and sets PENDING,
+        process() sends it and sets SENT with the timestamp it was sent at */
+    enum AnnotationState
+    {
+        IDLE = 0,
+        PENDING,
+        SENT
+    };
+
+    char annotationText[MAX_ANNOTATION_LENGTH];
+    std::atomic<int> annotationState;
+    std::atomic<juce::int64> annotationTimestamp;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControlSocket);
+};
+
+#endif  // CONTROLSOCKET_H_INCLUDED
@@ -0,0 +1,135 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ControlSocketEditor.h"
+#include "ControlSocket.h"
+#include "ControlServer.h"
+
+/** How often the editor shows the server status */
+#define STATUS_REFRESH_MS 500
+
+
+ControlSocketEditor::ControlSocketEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+    , statusTimer   (*this)
+{
+    desiredWidth = 220;
+
+    ControlSocket* processor = (ControlSocket*) getProcessor();
+
+    pathLabel = new Label ("path label", "Socket:");
+    pathLabel->setBounds (10, 30, 60, 20);
+    pathLabel->setFont (Font ("Small Text", 12, Font::plain));
+    pathLabel->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (pathLabel);
+
+    pathValue = new Label ("path", processor->getSocketPath());
+    pathValue->setBounds (15, 52, 195, 18);
+    pathValue->setFont (Font ("Default", 13, Font::plain));
+    pathValue->setColour (Label::textColourId, Colours::white);
+    pathValue->setColour (Label::backgroundColourId, Colours::grey);
+    pathValue->setEditable (true);
+    pathValue->addListener (this);
+    pathValue->setTooltip ("Path of the Unix-domain socket that accepts commands");
+    addAndMakeVisible (pathValue);
+
+    statusLabel = new Label ("status label", "Status:");
+    statusLabel->setBounds (10, 80, 60, 20);
+    statusLabel->setFont (Font ("Small Text", 12, Font::plain));
+    statusLabel->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (statusLabel);
+
+    statusValue = new Label ("status", String());
+    statusValue->setBounds (65, 80, 145, 20);
+    statusValue->setFont (Font ("Small Text", 12, Font::plain));
+    statusValue->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (statusValue);
+
+    updateStatus();
+    statusTimer.startTimer (STATUS_REFRESH_MS);
+}
+
+
+ControlSocketEditor::~ControlSocketEditor()
+{
+    statusTimer.stopTimer();
+}
+
+
+ControlSocketEditor::StatusTimer::StatusTimer (ControlSocketEditor& editor_)
+    : editor (editor_)
+{
+}
+
+
+void ControlSocketEditor::StatusTimer::timerCallback()
+{
+    editor.updateStatus();
+}
+
+
+void ControlSocketEditor::updateStatus()
+{
+    ControlSocket* processor = (ControlSocket*) getProcessor();
+
+    statusValue->setText (processor->getServerStatus(), dontSendNotification);
+}
+
+
+void ControlSocketEditor::labelTextChanged (Label* label)
+{
+    if (label == pathValue)
+    {
+        ControlSocket* processor = (ControlSocket*) getProcessor();
+
+        processor->setSocketPath (pathValue->getText().trim());
+        pathValue->setText (processor->getSocketPath(), dontSendNotification);
+
+        updateStatus();
+    }
+}
+
+
+void ControlSocketEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "ControlSocketEditor");
+
+    ControlSocket* processor = (ControlSocket*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("SOCKET");
+    settings->setAttribute ("Path", processor->getSocketPath());
+}
+
+
+void ControlSocketEditor::loadCustomParameters (XmlElement* xml)
+{
+    ControlSocket* processor = (ControlSocket*) getProcessor();
+
+    forEachXmlChildElementWithTagName (*xml, settings, "SOCKET")
+    {
+        processor->setSocketPath (settings->getStringAttribute ("Path", ControlServer::getDefaultPath()));
+        pathValue->setText (processor->getSocketPath(), dontSendNotification);
+    }
+
+    updateStatus();
+}
@@ -0,0 +1,74 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONTROLSOCKETEDITOR_H_INCLUDED
+#define CONTROLSOCKETEDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the ControlSocket processor: the path of the socket,
+  and whether a client is connected.
+
+  @see ControlSocket
+
+*/
+
+class ControlSocketEditor : public GenericEditor,
+    public Label::Listener
+{
+public:
+    ControlSocketEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~ControlSocketEditor();
+
+    void labelTextChanged (Label* label) override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    /** Polls the server status; GenericEditor's own timer is taken */
+    class StatusTimer : public Timer
+    {
+    public:
+        StatusTimer (ControlSocketEditor& editor);
+        void timerCallback() override;
+
+    private:
+        ControlSocketEditor& editor;
+    };
+
+    void updateStatus();
+
+    ScopedPointer<Label> pathLabel;
+    ScopedPointer<Label> pathValue;
+    ScopedPointer<Label> statusLabel;
+    ScopedPointer<Label> statusValue;
+
+    StatusTimer statusTimer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControlSocketEditor);
+};
+
+#endif  // CONTROLSOCKETEDITOR_H_INCLUDED
@@ -0,0 +1,181 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ElementwiseKernels.h"
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define ELEMENTWISE_USE_SSE2 1
+#else
+ #define ELEMENTWISE_USE_SSE2 0
+#endif
+
+namespace
+{
+    /** Runs a kernel over a block. With SSE2 the last few samples go through the
+        vector path as well, padded to a full register. */
+    template <typename Kernel>
+    void applyKernel (float* dest, const float* source, int numSamples, Kernel kernel)
+    {
+        // the kernel is copied, so stores to dest cannot alias its constants
+        int i = 0;
+
+#if ELEMENTWISE_USE_SSE2
+        for (; i + 4 <= numSamples; i += 4)
+            _mm_storeu_ps (dest + i, kernel (_mm_loadu_ps (source + i)));
+
+        if (i < numSamples)
+        {
+            float tail[4] = { 0, 0, 0, 0 };
+            for (int j = i; j < numSamples; ++j)
+                tail[j - i] = source[j];
+
+            _mm_storeu_ps (tail, kernel (_mm_loadu_ps (tail)));
+
+            for (int j = i; j < numSamples; ++j)
+                dest[j] = tail[j - i];
+        }
+#else
+        for (; i < numSamples; ++i)
+            dest[i] = kernel (source[i]);
+#endif
+    }
+
+    struct ScaleOffsetKernel
+    {
+        float scale, offset;
+
+#if ELEMENTWISE_USE_SSE2
+        __m128 operator() (__m128 v) const
+        {
+            return _mm_add_ps (_mm_mul_ps (v, _mm_set1_ps (scale)), _mm_set1_ps (offset));
+        }
+#else
+        float operator() (float x) const { return x * scale + offset; }
+#endif
+    };
+
+    struct ThresholdKernel
+    {
+        float level;
+
+#if ELEMENTWISE_USE_SSE2
+        __m128 operator() (__m128 v) const
+        {
+            return _mm_and_ps (_mm_cmpge_ps (v, _mm_set1_ps (level)), _mm_set1_ps (1.0f));
+        }
+#else
+        float operator() (float x) const { return x >= level ? 1.0f : 0.0f; }
+#endif
+    };
+
+    /** Natural log, after the Cephes logf: the input is split into exponent and
+        mantissa, and the log of the mantissa comes from a polynomial. */
+    struct LogKernel
+    {
+#if ELEMENTWISE_USE_SSE2
+        __m128 operator() (__m128 x) const
+        {
+            const __m128 one = _mm_set1_ps (1.0f);
+
+            // also turns NaNs into the smallest normal float
+            x = _mm_max_ps (x, _mm_set1_ps (std::numeric_limits<float>::min()));
+
+            __m128i exponent = _mm_srli_epi32 (_mm_castps_si128 (x), 23);
+            x = _mm_and_ps (x, _mm_castsi128_ps (_mm_set1_epi32 (~0x7f800000)));
+            x = _mm_or_ps (x, _mm_set1_ps (0.5f));
+
+            exponent = _mm_sub_epi32 (exponent, _mm_set1_epi32 (0x7f));
+            __m128 e = _mm_add_ps (_mm_cvtepi32_ps (exponent), one);
+
+            // keep the mantissa in [sqrt(1/2), sqrt(2))
+            const __m128 mask = _mm_cmplt_ps (x, _mm_set1_ps (0.707106781186547524f));
+            const __m128 tmp = _mm_and_ps (x, mask);
+            x = _mm_sub_ps (x, one);
+            e = _mm_sub_ps (e, _mm_and_ps (one, mask));
+            x = _mm_add_ps (x, tmp);
+
+            const __m128 z = _mm_mul_ps (x, x);
+
+            __m128 y = _mm_set1_ps (7.0376836292E-2f);
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (-1.1514610310E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (1.1676998740E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (-1.2420140846E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (1.4249322787E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (-1.6668057665E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (2.0000714765E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (-2.4999993993E-1f));
+            y = _mm_add_ps (_mm_mul_ps (y, x), _mm_set1_ps (3.3333331174E-1f));
+            y = _mm_mul_ps (_mm_mul_ps (y, x), z);
+
+            y = _mm_add_ps (y, _mm_mul_ps (e, _mm_set1_ps (-2.12194440E-4f)));
+            y = _mm_sub_ps (y, _mm_mul_ps (z, _mm_set1_ps (0.5f)));
+            x = _mm_add_ps (x, y);
+            return _mm_add_ps (x, _mm_mul_ps (e, _mm_set1_ps (0.693359375f)));
+        }
+#else
+        float operator() (float x) const
+        {
+            return std::log (x > std::numeric_limits<float>::min() ? x : std::numeric_limits<float>::min());
+        }
+#endif
+    };
+}
+
+
+void ElementwiseKernels::abs (float* dest, const float* source, int numSamples)
+{
+    FloatVectorOperations::abs (dest, source, numSamples);
+}
+
+
+void ElementwiseKernels::square (float* dest, const float* source, int numSamples)
+{
+    FloatVectorOperations::multiply (dest, source, source, numSamples);
+}
+
+
+void ElementwiseKernels::log (float* dest, const float* source, int numSamples)
+{
+    applyKernel (dest, source, numSamples, LogKernel());
+}
+
+
+void ElementwiseKernels::clip (float* dest, const float* source, float low, float high, int numSamples)
+{
+    FloatVectorOperations::clip (dest, source, jmin (low, high), jmax (low, high), numSamples);
+}
+
+
+void ElementwiseKernels::scaleOffset (float* dest, const float* source, float scale, float offset, int numSamples)
+{
+    ScaleOffsetKernel kernel = { scale, offset };
+    applyKernel (dest, source, numSamples, kernel);
+}
+
+
+void ElementwiseKernels::threshold (float* dest, const float* source, float level, int numSamples)
+{
+    ThresholdKernel kernel = { level };
+    applyKernel (dest, source, numSamples, kernel);
+}
@@ -0,0 +1,55 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ELEMENTWISEKERNELS_H_INCLUDED
+#define ELEMENTWISEKERNELS_H_INCLUDED
+
+#include <JuceHeader.h>
+
+/**
+
+    The operations of the ElementwiseMath processor, usable on any block of
+    samples. dest may be the same as source.
+
+    The kernels use SSE2 where it is available and share the arithmetic of
+    their vector path with the last few samples of a block, so every sample of
+    a channel gets the same result whatever its position in the block. They do
+    not depend on the processor, so ElementwiseMathBenchmark can time them
+    on their own.
+
+    @see ElementwiseMath
+*/
+class ElementwiseKernels
+{
+public:
+    static void abs (float* dest, const float* source, int numSamples);
+    static void square (float* dest, const float* source, int numSamples);
+    /** Inputs at or below zero, and NaNs, give the log of the smallest normal float */
+    static void log (float* dest, const float* source, int numSamples);
+    static void clip (float* dest, const float* source, float low, float high, int numSamples);
+    static void scaleOffset (float* dest, const float* source, float scale, float offset, int numSamples);
+    /** 1 where the sample is at or above the threshold, 0 elsewhere */
+    static void threshold (float* dest, const float* source, float level, int numSamples);
+};
+
+#endif  // ELEMENTWISEKERNELS_H_INCLUDED
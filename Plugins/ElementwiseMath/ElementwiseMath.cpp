@@ -0,0 +1,200 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ElementwiseMath.h"
+#include "ElementwiseMathEditor.h"
+
+ElementwiseMath::ElementwiseMath()
+    : GenericProcessor  ("Elementwise Math")
+    , operation         (OP_ABS)
+    , scale             (1.0f)
+    , offset            (0.0f)
+    , clipLow           (-100.0f)
+    , clipHigh          (100.0f)
+    , thresholdLevel    (0.0f)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+ElementwiseMath::~ElementwiseMath()
+{
+}
+
+
+AudioProcessorEditor* ElementwiseMath::createEditor()
+{
+    editor = new ElementwiseMathEditor (this, true);
+
+    return editor;
+}
+
+
+void ElementwiseMath::updateSettings()
+{
+    // channels keep their selection, new ones are transformed
+    while (channelActive.size() < dataChannelArray.size())
+        channelActive.add (true);
+
+    channelActive.resize (dataChannelArray.size());
+}
+
+
+void ElementwiseMath::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case OPERATION:
+            operation = (Operation) jlimit (0, NUM_OPERATIONS - 1, roundFloatToInt (newValue));
+            break;
+        case SCALE:
+            scale = newValue;
+            break;
+        case OFFSET:
+            offset = newValue;
+            break;
+        case CLIP_LOW:
+            clipLow = newValue;
+            break;
+        case CLIP_HIGH:
+            clipHigh = newValue;
+            break;
+        case THRESHOLD:
+            thresholdLevel = newValue;
+            break;
+        case CHANNEL_ACTIVE:
+            if (currentChannel >= 0 && currentChannel < channelActive.size())
+                channelActive.set (currentChannel, newValue > 0.5f);
+            break;
+        default:
+            break;
+    }
+}
+
+
+float ElementwiseMath::getParameterValue (int parameterIndex) const
+{
+    switch (parameterIndex)
+    {
+        case OPERATION: return (float) operation;
+        case SCALE: return scale;
+        case OFFSET: return offset;
+        case CLIP_LOW: return clipLow;
+        case CLIP_HIGH: return clipHigh;
+        case THRESHOLD: return thresholdLevel;
+        default: return 0.0f;
+    }
+}
+
+
+bool ElementwiseMath::isChannelActive (int chan) const
+{
+    return chan >= 0 && chan < channelActive.size() && channelActive[chan];
+}
+
+
+String ElementwiseMath::getOperationName (Operation op)
+{
+    switch (op)
+    {
+        case OP_ABS: return "abs(x)";
+        case OP_SQUARE: return "x^2";
+        case OP_LOG: return "ln(x)";
+        case OP_CLIP: return "clip(x)";
+        case OP_SCALE_OFFSET: return "a*x+b";
+        case OP_THRESHOLD: return "x >= T";
+        default: return String();
+    }
+}
+
+
+void ElementwiseMath::process (AudioSampleBuffer& buffer)
+{
+    const Operation op = operation;
+    const int nChannels = jmin (channelActive.size(), buffer.getNumChannels());
+
+    for (int n = 0; n < nChannels; ++n)
+    {
+        if (!channelActive[n])
+            continue;
+
+        const int nSamples = jmin ((int) getNumSamples (n), buffer.getNumSamples());
+        if (nSamples <= 0)
+            continue;
+
+        float* data = buffer.getWritePointer (n);
+
+        switch (op)
+        {
+            case OP_ABS:
+                ElementwiseKernels::abs (data, data, nSamples);
+                break;
+            case OP_SQUARE:
+                ElementwiseKernels::square (data, data, nSamples);
+                break;
+            case OP_LOG:
+                ElementwiseKernels::log (data, data, nSamples);
+                break;
+            case OP_CLIP:
+                ElementwiseKernels::clip (data, data, clipLow, clipHigh, nSamples);
+                break;
+            case OP_SCALE_OFFSET:
+                ElementwiseKernels::scaleOffset (data, data, scale, offset, nSamples);
+                break;
+            case OP_THRESHOLD:
+                ElementwiseKernels::threshold (data, data, thresholdLevel, nSamples);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+
+void ElementwiseMath::saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType)
+{
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNumber > -1
+        && channelNumber < channelActive.size())
+    {
+        XmlElement* channelParams = channelInfo->createNewChildElement ("PARAMETERS");
+        channelParams->setAttribute ("active", channelActive[channelNumber]);
+    }
+}
+
+
+void ElementwiseMath::loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType)
+{
+    int channelNum = channelInfo->getIntAttribute ("number");
+
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNum > -1
+        && channelNum < channelActive.size())
+    {
+        forEachXmlChildElement (*channelInfo, subNode)
+        {
+            if (subNode->hasTagName ("PARAMETERS"))
+                channelActive.set (channelNum, subNode->getBoolAttribute ("active", true));
+        }
+    }
+}
@@ -0,0 +1,98 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef ELEMENTWISEMATH_H_INCLUDED
+#define ELEMENTWISEMATH_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include "ElementwiseKernels.h"
+
+/**
+
+    Applies one elementwise operation, in place, to every selected channel:
+    absolute value, square, natural log, clipping, scale and offset, or a
+    threshold that turns the signal into 0/1.
+
+    Each operation is a single pass over the samples, see ElementwiseKernels.
+
+    @see GenericProcessor, ElementwiseMathEditor, ElementwiseKernels
+*/
+class ElementwiseMath : public GenericProcessor
+{
+public:
+    ElementwiseMath();
+    ~ElementwiseMath();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    void saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType) override;
+    void loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType) override;
+
+    enum Operation
+    {
+        OP_ABS = 0,
+        OP_SQUARE,
+        OP_LOG,
+        OP_CLIP,
+        OP_SCALE_OFFSET,
+        OP_THRESHOLD,
+        NUM_OPERATIONS
+    };
+
+    enum Parameters
+    {
+        OPERATION = 0,
+        SCALE,
+        OFFSET,
+        CLIP_LOW,
+        CLIP_HIGH,
+        THRESHOLD,
+        CHANNEL_ACTIVE
+    };
+
+    float getParameterValue (int parameterIndex) const;
+    bool isChannelActive (int chan) const;
+
+    static String getOperationName (Operation op);
+
+private:
+    Array<bool> channelActive;
+
+    Operation operation;
+    float scale;
+    float offset;
+    float clipLow;
+    float clipHigh;
+    float thresholdLevel;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ElementwiseMath);
+};
+
+#endif  // ELEMENTWISEMATH_H_INCLUDED
@@ -0,0 +1,217 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ElementwiseMathEditor.h"
+#include "ElementwiseMath.h"
+
+
+ElementwiseMathEditor::ElementwiseMathEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+{
+    desiredWidth = 250;
+
+    operationSelector = new ComboBox ("operation");
+    for (int op = 0; op < ElementwiseMath::NUM_OPERATIONS; ++op)
+        operationSelector->addItem (ElementwiseMath::getOperationName ((ElementwiseMath::Operation) op), op + 1);
+    operationSelector->setSelectedId (ElementwiseMath::OP_ABS + 1, dontSendNotification);
+    operationSelector->setBounds (15, 30, 100, 20);
+    operationSelector->setTooltip ("Operation applied to every sample of the selected channels");
+    operationSelector->addListener (this);
+    addAndMakeVisible (operationSelector);
+
+    addLabel ("Scale:", 10, 60, 60);
+    addValue (ElementwiseMath::SCALE, 70, 62, "Gain a of a*x+b");
+
+    addLabel ("Offset:", 10, 82, 60);
+    addValue (ElementwiseMath::OFFSET, 70, 84, "Offset b of a*x+b, in channel units");
+
+    addLabel ("Low:", 125, 25, 65);
+    addValue (ElementwiseMath::CLIP_LOW, 190, 27, "Lower limit of clip(x), in channel units");
+
+    addLabel ("High:", 125, 47, 65);
+    addValue (ElementwiseMath::CLIP_HIGH, 190, 49, "Upper limit of clip(x), in channel units");
+
+    addLabel ("Threshold:", 125, 69, 65);
+    addValue (ElementwiseMath::THRESHOLD, 190, 71, "Samples at or above this level become 1, the others 0");
+
+    channelButton = new UtilityButton ("+CH", Font ("Default", 10, Font::plain));
+    channelButton->addListener (this);
+    channelButton->setBounds (190, 97, 40, 18);
+    channelButton->setClickingTogglesState (true);
+    channelButton->setToggleState (true, dontSendNotification);
+    channelButton->setTooltip ("When this button is off, selected channels are passed through unchanged");
+    addAndMakeVisible (channelButton);
+}
+
+
+ElementwiseMathEditor::~ElementwiseMathEditor()
+{
+}
+
+
+Label* ElementwiseMathEditor::addLabel (const String& text, int x, int y, int width)
+{
+    Label* label = new Label (text, text);
+    label->setBounds (x, y, width, 20);
+    label->setFont (Font ("Small Text", 12, Font::plain));
+    label->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (label);
+    labels.add (label);
+
+    return label;
+}
+
+
+Label* ElementwiseMathEditor::addValue (int parameterIndex, int x, int y, const String& tooltip)
+{
+    Label* value = new Label (String (parameterIndex), String());
+    value->setBounds (x, y, 45, 18);
+    value->setFont (Font ("Default", 15, Font::plain));
+    value->setColour (Label::textColourId, Colours::white);
+    value->setColour (Label::backgroundColourId, Colours::grey);
+    value->setEditable (true);
+    value->addListener (this);
+    value->setTooltip (tooltip);
+    value->getProperties().set ("parameter", parameterIndex);
+    addAndMakeVisible (value);
+    values.add (value);
+
+    updateValue (value);
+
+    return value;
+}
+
+
+void ElementwiseMathEditor::updateValue (Label* label)
+{
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+    int parameterIndex = label->getProperties()["parameter"];
+
+    label->setText (String (processor->getParameterValue (parameterIndex)), dontSendNotification);
+}
+
+
+void ElementwiseMathEditor::labelTextChanged (Label* label)
+{
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+    int parameterIndex = label->getProperties()["parameter"];
+    float requestedValue = label->getText().getFloatValue();
+
+    bool isValid = true;
+
+    switch (parameterIndex)
+    {
+        case ElementwiseMath::CLIP_LOW:
+            isValid = requestedValue <= processor->getParameterValue (ElementwiseMath::CLIP_HIGH);
+            break;
+        case ElementwiseMath::CLIP_HIGH:
+            isValid = requestedValue >= processor->getParameterValue (ElementwiseMath::CLIP_LOW);
+            break;
+        default:
+            break;
+    }
+
+    if (!isValid)
+    {
+        CoreServices::sendStatusMessage ("Value out of range.");
+    }
+    else
+    {
+        processor->setParameter (parameterIndex, requestedValue);
+    }
+
+    updateValue (label);
+}
+
+
+void ElementwiseMathEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    if (comboBox == operationSelector)
+    {
+        getProcessor()->setParameter (ElementwiseMath::OPERATION, operationSelector->getSelectedId() - 1);
+    }
+}
+
+
+void ElementwiseMathEditor::channelChanged (int channel, bool /*newState*/)
+{
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+
+    channelButton->setToggleState (processor->isChannelActive (channel), dontSendNotification);
+}
+
+
+void ElementwiseMathEditor::buttonEvent (Button* button)
+{
+    if (button == channelButton)
+    {
+        ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+
+        Array<int> chans = getActiveChannels();
+
+        for (int n = 0; n < chans.size(); n++)
+        {
+            processor->setCurrentChannel (chans[n]);
+            processor->setParameter (ElementwiseMath::CHANNEL_ACTIVE, button->getToggleState() ? 1.0f : 0.0f);
+        }
+    }
+}
+
+
+void ElementwiseMathEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "ElementwiseMathEditor");
+
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("VALUES");
+    settings->setAttribute ("Operation", (int) processor->getParameterValue (ElementwiseMath::OPERATION));
+    settings->setAttribute ("Scale", processor->getParameterValue (ElementwiseMath::SCALE));
+    settings->setAttribute ("Offset", processor->getParameterValue (ElementwiseMath::OFFSET));
+    settings->setAttribute ("ClipLow", processor->getParameterValue (ElementwiseMath::CLIP_LOW));
+    settings->setAttribute ("ClipHigh", processor->getParameterValue (ElementwiseMath::CLIP_HIGH));
+    settings->setAttribute ("Threshold", processor->getParameterValue (ElementwiseMath::THRESHOLD));
+}
+
+
+void ElementwiseMathEditor::loadCustomParameters (XmlElement* xml)
+{
+    ElementwiseMath* processor = (ElementwiseMath*) getProcessor();
+
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("VALUES"))
+        {
+            processor->setParameter (ElementwiseMath::SCALE, xmlNode->getDoubleAttribute ("Scale", processor->getParameterValue (ElementwiseMath::SCALE)));
+            processor->setParameter (ElementwiseMath::OFFSET, xmlNode->getDoubleAttribute ("Offset", processor->getParameterValue (ElementwiseMath::OFFSET)));
+            processor->setParameter (ElementwiseMath::CLIP_LOW, xmlNode->getDoubleAttribute ("ClipLow", processor->getParameterValue (ElementwiseMath::CLIP_LOW)));
+            processor->setParameter (ElementwiseMath::CLIP_HIGH, xmlNode->getDoubleAttribute ("ClipHigh", processor->getParameterValue (ElementwiseMath::CLIP_HIGH)));
+            processor->setParameter (ElementwiseMath::THRESHOLD, xmlNode->getDoubleAttribute ("Threshold", processor->getParameterValue (ElementwiseMath::THRESHOLD)));
+
+            operationSelector->setSelectedId (xmlNode->getIntAttribute ("Operation", ElementwiseMath::OP_ABS) + 1, sendNotificationSync);
+        }
+    }
+
+    for (int i = 0; i < values.size(); ++i)
+        updateValue (values[i]);
+}
@@ -0,0 +1,395 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LfpDisplayBuffer.h"
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define LFP_USE_SSE2 1
+#else
+ #define LFP_USE_SSE2 0
+#endif
+
+using namespace LfpViewer;
+
+namespace
+{
+    union FloatBits
+    {
+        uint32 u;
+        float f;
+    };
+
+    /** Round to nearest even, saturating to the largest finite half */
+    inline uint16 encodeHalf (float value)
+    {
+        FloatBits in;
+        in.f = value;
+
+        const uint32 sign = in.u & 0x80000000u;
+        uint32 x = in.u ^ sign;
+        uint16 half;
+
+        if (x >= 0x477ff000u) // rounds to infinity, or is already infinite or NaN
+        {
+            half = x > 0x7f800000u ? 0x7e00 : 0x7bff;
+        }
+        else if (x < 0x38800000u) // subnormal half or zero: let the FPU align the mantissa
+        {
+            FloatBits magic;
+            magic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+
+            FloatBits f;
+            f.u = x;
+            f.f += magic.f;
+            half = (uint16) (f.u - magic.u);
+        }
+        else
+        {
+            const uint32 mantissaOdd = (x >> 13) & 1;
+            x += ((uint32) (15 - 127) << 23) + 0xfff;
+            x += mantissaOdd;
+            half = (uint16) (x >> 13);
+        }
+
+        return (uint16) (half | (sign >> 16));
+    }
+
+    inline float decodeHalf (uint16 half)
+    {
+        const uint32 shiftedExponent = 0x7c00u << 13;
+
+        FloatBits out;
+        out.u = (uint32) (half & 0x7fff) << 13;
+        const uint32 exponent = out.u & shiftedExponent;
+        out.u += (uint32) (127 - 15) << 23;
+
+        if (exponent == shiftedExponent) // infinity or NaN
+        {
+            out.u += (uint32) (128 - 16) << 23;
+        }
+        else if (exponent == 0) // zero or subnormal
+        {
+            FloatBits magic;
+            magic.u = 113 << 23;
+            out.u += 1 << 23;
+            out.f -= magic.f;
+        }
+
+        out.u |= (uint32) (half & 0x8000) << 16;
+        return out.f;
+    }
+
+#if LFP_USE_SSE2
+    /** Selects a where mask is set, b elsewhere */
+    inline __m128i select (__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128 (_mm_and_si128 (mask, a), _mm_andnot_si128 (mask, b));
+    }
+
+    /** encodeHalf on four values, with the same bit operations. Magnitudes fit in
+        31 bits, so the signed compares of SSE2 order them like the scalar code. */
+    inline __m128i encodeHalf4 (__m128 value)
+    {
+        const __m128i in = _mm_castps_si128 (value);
+        const __m128i sign = _mm_and_si128 (in, _mm_set1_epi32 ((int) 0x80000000u));
+        const __m128i x = _mm_xor_si128 (in, sign);
+
+        const __m128i overflow = _mm_cmpgt_epi32 (x, _mm_set1_epi32 (0x477fefff));
+        const __m128i nan = _mm_cmpgt_epi32 (x, _mm_set1_epi32 (0x7f800000));
+        const __m128i large = select (nan, _mm_set1_epi32 (0x7e00), _mm_set1_epi32 (0x7bff));
+
+        const __m128i subnormal = _mm_cmplt_epi32 (x, _mm_set1_epi32 (0x38800000));
+        const __m128i magic = _mm_set1_epi32 (((127 - 15) + (23 - 10) + 1) << 23);
+        const __m128i small = _mm_sub_epi32 (_mm_castps_si128 (_mm_add_ps (_mm_castsi128_ps (x), _mm_castsi128_ps (magic))), magic);
+
+        const __m128i mantissaOdd = _mm_and_si128 (_mm_srli_epi32 (x, 13), _mm_set1_epi32 (1));
+        __m128i normal = _mm_add_epi32 (x, _mm_set1_epi32 ((int) (((uint32) (15 - 127) << 23) + 0xfff)));
+        normal = _mm_srli_epi32 (_mm_add_epi32 (normal, mantissaOdd), 13);
+
+        const __m128i half = select (overflow, large, select (subnormal, small, normal));
+        return _mm_and_si128 (_mm_or_si128 (half, _mm_srli_epi32 (sign, 16)), _mm_set1_epi32 (0xffff));
+    }
+
+    /** decodeHalf on four values, given zero-extended to 32 bits */
+    inline __m128 decodeHalf4 (__m128i half)
+    {
+        const __m128i shiftedExponent = _mm_set1_epi32 (0x7c00 << 13);
+
+        __m128i out = _mm_slli_epi32 (_mm_and_si128 (half, _mm_set1_epi32 (0x7fff)), 13);
+        const __m128i exponent = _mm_and_si128 (out, shiftedExponent);
+        out = _mm_add_epi32 (out, _mm_set1_epi32 ((127 - 15) << 23));
+
+        const __m128i infNan = _mm_add_epi32 (out, _mm_set1_epi32 ((128 - 16) << 23));
+        const __m128 magic = _mm_castsi128_ps (_mm_set1_epi32 (113 << 23));
+        const __m128i subnormal = _mm_castps_si128 (_mm_sub_ps (_mm_castsi128_ps (_mm_add_epi32 (out, _mm_set1_epi32 (1 << 23))), magic));
+
+        out = select (_mm_cmpeq_epi32 (exponent, shiftedExponent), infNan, out);
+        out = select (_mm_cmpeq_epi32 (exponent, _mm_setzero_si128()), subnormal, out);
+
+        out = _mm_or_si128 (out, _mm_slli_epi32 (_mm_and_si128 (half, _mm_set1_epi32 (0x8000)), 16));
+        return _mm_castsi128_ps (out);
+    }
+#endif
+}
+
+
+LfpDisplayBuffer::LfpDisplayBuffer()
+    : numDataChannels   (0)
+    , size              (0)
+    , numBlocks         (0)
+{
+}
+
+
+LfpDisplayBuffer::~LfpDisplayBuffer()
+{
+}
+
+
+void LfpDisplayBuffer::floatToHalf (const float* source, uint16* dest, int numSamples)
+{
+    int i = 0;
+
+#if LFP_USE_SSE2
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        // the halves are below 0x10000, so the signed saturation of the pack keeps them
+        const __m128i lo = _mm_srai_epi32 (_mm_slli_epi32 (encodeHalf4 (_mm_loadu_ps (source + i)), 16), 16);
+        const __m128i hi = _mm_srai_epi32 (_mm_slli_epi32 (encodeHalf4 (_mm_loadu_ps (source + i + 4)), 16), 16);
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (dest + i), _mm_packs_epi32 (lo, hi));
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+        dest[i] = encodeHalf (source[i]);
+}
+
+
+void LfpDisplayBuffer::halfToFloat (const uint16* source, float* dest, int numSamples)
+{
+    int i = 0;
+
+#if LFP_USE_SSE2
+    for (; i + 8 <= numSamples; i += 8)
+    {
+        const __m128i v = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (source + i));
+        _mm_storeu_ps (dest + i, decodeHalf4 (_mm_unpacklo_epi16 (v, _mm_setzero_si128())));
+        _mm_storeu_ps (dest + i + 4, decodeHalf4 (_mm_unpackhi_epi16 (v, _mm_setzero_si128())));
+    }
+#endif
+
+    for (; i < numSamples; ++i)
+        dest[i] = decodeHalf (source[i]);
+}
+
+
+void LfpDisplayBuffer::setSize (int numDataChannels_, int numSamples)
+{
+    numDataChannels = jmax (0, numDataChannels_);
+    size = jmax (1, numSamples);
+    numBlocks = (size + LFP_SUMMARY_BLOCK - 1) / LFP_SUMMARY_BLOCK;
+
+    data.allocate ((size_t) numDataChannels * size, false);
+    events.allocate ((size_t) size, false);
+
+    blockMin.allocate ((size_t) numDataChannels * numBlocks, false);
+    blockMax.allocate ((size_t) numDataChannels * numBlocks, false);
+    blockSum.allocate ((size_t) numDataChannels * numBlocks, false);
+
+    clear();
+}
+
+
+void LfpDisplayBuffer::clear()
+{
+    // a half zero is all bits clear, like a float zero
+    data.clear ((size_t) numDataChannels * size);
+    events.clear ((size_t) size);
+
+    blockMin.clear ((size_t) numDataChannels * numBlocks);
+    blockMax.clear ((size_t) numDataChannels * numBlocks);
+    blockSum.clear ((size_t) numDataChannels * numBlocks);
+}
+
+
+void LfpDisplayBuffer::copyFrom (int channel, int startSample, const float* source, int numSamples)
+{
+    jassert (startSample >= 0 && startSample + numSamples <= size);
+
+    if (numSamples <= 0)
+        return;
+
+    if (channel == numDataChannels)
+    {
+        FloatVectorOperations::copy (events + startSample, source, numSamples);
+    }
+    else if (channel >= 0 && channel < numDataChannels)
+    {
+        floatToHalf (source, data + (size_t) channel * size + startSample, numSamples);
+        updateSummaries (channel, startSample, numSamples);
+    }
+}
+
+
+void LfpDisplayBuffer::fill (int channel, int startSample, int numSamples, float value)
+{
+    jassert (startSample >= 0 && startSample + numSamples <= size);
+
+    if (numSamples <= 0)
+        return;
+
+    if (channel == numDataChannels)
+    {
+        FloatVectorOperations::fill (events + startSample, value, numSamples);
+    }
+    else if (channel >= 0 && channel < numDataChannels)
+    {
+        const uint16 half = encodeHalf (value);
+        uint16* dest = data + (size_t) channel * size + startSample;
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = half;
+
+        updateSummaries (channel, startSample, numSamples);
+    }
+}
+
+
+float LfpDisplayBuffer::getSample (int channel, int sample) const
+{
+    if (sample < 0 || sample >= size)
+        return 0;
+
+    if (channel == numDataChannels)
+        return events[sample];
+
+    if (channel >= 0 && channel < numDataChannels)
+        return decodeHalf (data[(size_t) channel * size + sample]);
+
+    return 0;
+}
+
+
+void LfpDisplayBuffer::readSamples (int channel, int startSample, int numSamples, float* dest) const
+{
+    jassert (startSample >= 0 && startSample + numSamples <= size);
+
+    if (numSamples <= 0)
+        return;
+
+    if (channel == numDataChannels)
+        FloatVectorOperations::copy (dest, events + startSample, numSamples);
+    else if (channel >= 0 && channel < numDataChannels)
+        halfToFloat (data + (size_t) channel * size + startSample, dest, numSamples);
+    else
+        FloatVectorOperations::clear (dest, numSamples);
+}
+
+
+void LfpDisplayBuffer::updateSummaries (int channel, int startSample, int numSamples)
+{
+    const int firstBlock = startSample / LFP_SUMMARY_BLOCK;
+    const int lastBlock = (startSample + numSamples - 1) / LFP_SUMMARY_BLOCK;
+
+    const uint16* channelData = data + (size_t) channel * size;
+    const size_t summaryOffset = (size_t) channel * numBlocks;
+
+    float block[LFP_SUMMARY_BLOCK];
+
+    for (int b = firstBlock; b <= lastBlock; ++b)
+    {
+        const int start = b * LFP_SUMMARY_BLOCK;
+        const int n = jmin (LFP_SUMMARY_BLOCK, size - start);
+
+        halfToFloat (channelData + start, block, n);
+
+        const Range<float> range = FloatVectorOperations::findMinAndMax (block, n);
+
+        float sum = 0;
+        for (int i = 0; i < n; ++i)
+            sum += block[i];
+
+        blockMin[summaryOffset + b] = encodeHalf (range.getStart());
+        blockMax[summaryOffset + b] = encodeHalf (range.getEnd());
+        blockSum[summaryOffset + b] = sum;
+    }
+}
+
+
+void LfpDisplayBuffer::getRange (int channel, int startSample, int endSample, float& min, float& max, float& sum) const
+{
+    startSample = jmax (0, startSample);
+    endSample = jmin (size, endSample);
+
+    min = 0;
+    max = 0;
+    sum = 0;
+
+    if (endSample <= startSample)
+        return;
+
+    if (channel == numDataChannels)
+    {
+        const Range<float> range = FloatVectorOperations::findMinAndMax (events + startSample, endSample - startSample);
+        min = range.getStart();
+        max = range.getEnd();
+
+        for (int i = startSample; i < endSample; ++i)
+            sum += events[i];
+
+        return;
+    }
+
+    if (channel < 0 || channel >= numDataChannels)
+        return;
+
+    const uint16* channelData = data + (size_t) channel * size;
+    const size_t summaryOffset = (size_t) channel * numBlocks;
+
+    min = std::numeric_limits<float>::max();
+    max = -std::numeric_limits<float>::max();
+
+    int i = startSample;
+
+    while (i < endSample)
+    {
+        if (i % LFP_SUMMARY_BLOCK == 0 && i + LFP_SUMMARY_BLOCK <= endSample)
+        {
+            // whole block: use its summary
+            const int b = i / LFP_SUMMARY_BLOCK;
+            min = jmin (min, decodeHalf (blockMin[summaryOffset + b]));
+            max = jmax (max, decodeHalf (blockMax[summaryOffset + b]));
+            sum += blockSum[summaryOffset + b];
+            i += LFP_SUMMARY_BLOCK;
+        }
+        else
+        {
+            const float sample = decodeHalf (channelData[i]);
+            min = jmin (min, sample);
+            max = jmax (max, sample);
+            sum += sample;
+            ++i;
+        }
+    }
+}
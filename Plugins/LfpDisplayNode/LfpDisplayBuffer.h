@@ -0,0 +1,111 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __LFPDISPLAYBUFFER_H__
+#define __LFPDISPLAYBUFFER_H__
+
+#include <ProcessorHeaders.h>
+
+/** Samples summarised by one entry of the min/max/sum level */
+#define LFP_SUMMARY_BLOCK 32
+
+namespace LfpViewer
+{
+
+/**
+
+  Circular history of the LfpDisplayNode, stored at half the size of an
+  AudioSampleBuffer.
+
+  Data channels are kept as IEEE half-precision floats: 11 significant bits
+  are far more than a screen can show, and unlike a fixed-point format it
+  needs no per-channel scaling, whatever the units of the channel. Values
+  beyond the half range (65504) saturate. Samples are converted in bulk when
+  they are written, eight at a time with SSE2, giving the same bits as the
+  scalar conversion.
+
+  The last channel holds the TTL state of the displayed subprocessor as a
+  bit mask, which is kept in single precision.
+
+  Every LFP_SUMMARY_BLOCK samples of a data channel are also summarised by
+  their minimum, maximum and sum, so the range of a pixel that covers many
+  samples can be found without reading all of them.
+
+  @see LfpDisplayNode, LfpDisplayCanvas
+
+*/
+class LfpDisplayBuffer
+{
+public:
+    LfpDisplayBuffer();
+    ~LfpDisplayBuffer();
+
+    /** Reallocates the history for numDataChannels plus the event channel, and clears it */
+    void setSize (int numDataChannels, int numSamples);
+
+    void clear();
+
+    /** Returns the number of channels, including the event channel */
+    int getNumChannels() const { return numDataChannels + 1; }
+
+    int getNumSamples() const { return size; }
+
+    /** Writes numSamples values to a channel, without wrapping around */
+    void copyFrom (int channel, int startSample, const float* source, int numSamples);
+
+    /** Sets numSamples values of a channel to the same value, without wrapping around */
+    void fill (int channel, int startSample, int numSamples, float value);
+
+    float getSample (int channel, int sample) const;
+
+    /** Reads numSamples values of a channel, without wrapping around */
+    void readSamples (int channel, int startSample, int numSamples, float* dest) const;
+
+    /** Finds the minimum, maximum and sum of samples [startSample, endSample) of a channel */
+    void getRange (int channel, int startSample, int endSample, float& min, float& max, float& sum) const;
+
+    /** Converts between single and half precision */
+    static void floatToHalf (const float* source, uint16* dest, int numSamples);
+    static void halfToFloat (const uint16* source, float* dest, int numSamples);
+
+private:
+    /** Recomputes the summaries of the blocks that hold [startSample, startSample + numSamples) */
+    void updateSummaries (int channel, int startSample, int numSamples);
+
+    int numDataChannels;
+    int size;
+    int numBlocks;
+
+    HeapBlock<uint16> data;
+    HeapBlock<float> events;
+
+    HeapBlock<uint16> blockMin;
+    HeapBlock<uint16> blockMax;
+    HeapBlock<float> blockSum;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LfpDisplayBuffer);
+};
+
+};
+
+#endif  // __LFPDISPLAYBUFFER_H__
@@ -418,25 +418,20 @@ void LfpDisplayCanvas::updateScreenBuffer()
 						if (channel != nChans)
 						{
 							// interpolate between two samples with invAlpha and alpha
-							screenBuffer->addFrom(channel, // destChannel
-								sbi, // destStartSample
-								displayBuffer->getReadPointer(channel, dbi), // source
-								1, // numSamples
-								invAlpha*gain); // gain
-
-
-							screenBuffer->addFrom(channel, // destChannel
-								sbi, // destStartSample
-								displayBuffer->getReadPointer(channel, nextPos), // source
-								1, // numSamples
-								alpha*gain); // gain
+							screenBuffer->addSample(channel, // destChannel
+								sbi, // destSample
+								displayBuffer->getSample(channel, dbi) * invAlpha*gain); // value
+
+							screenBuffer->addSample(channel, // destChannel
+								sbi, // destSample
+								displayBuffer->getSample(channel, nextPos) * alpha*gain); // value
 						}
 						
 
 						// same thing again, but this time add the min,mean, and max of all samples in current pixel
-						float sample_min = 10000000;
-						float sample_max = -10000000;
-						float sample_mean = 0;
+						float sample_min;
+						float sample_max;
+						float sample_mean;
 
 						int nextpix = (dbi + (int)ratio + 1) % (displayBufferSize + 1); //  position to next pixels index
 
@@ -445,23 +440,8 @@ void LfpDisplayCanvas::updateScreenBuffer()
 							nextpix = dbi;
 						}
 
-						for (int j = dbi; j < nextpix; j++)
-						{
-
-							float sample_current = displayBuffer->getSample(channel, j);
-							sample_mean = sample_mean + sample_current;
-
-							if (sample_min > sample_current)
-							{
-								sample_min = sample_current;
-							}
-
-							if (sample_max < sample_current)
-							{
-								sample_max = sample_current;
-							}
-
-						}
+						// whole blocks of samples are covered by the display buffer's summaries
+						displayBuffer->getRange(channel, dbi, nextpix, sample_min, sample_max, sample_mean);
 
 						// update event channel
 						if (channel == nChans)
@@ -478,20 +458,16 @@ void LfpDisplayCanvas::updateScreenBuffer()
 						// with an additional array sampleCountPerPixel[px] that holds the N samples per pixel
 						if (channel < nChans) // we're looping over one 'extra' channel for events above, so make sure not to loop over that one here
 						{
-							int c = 0;
-							for (int j = dbi; j < nextpix && c < MAX_N_SAMP_PER_PIXEL; j++)
-							{
-								float sample_current = displayBuffer->getSample(channel, j);
-								samplesPerPixel[channel][sbi][c] = sample_current;
-								c++;
-							}
+							int c = jmin(nextpix - dbi, MAX_N_SAMP_PER_PIXEL);
+							displayBuffer->readSamples(channel, dbi, c, samplesPerPixel[channel][sbi].data());
+
 							if (c > 0){
 								sampleCountPerPixel[sbi] = c - 1; // save count of samples for this pixel
 							}
 							else{
 								sampleCountPerPixel[sbi] = 0;
 							}
-							sample_mean = sample_mean / c;
+							sample_mean = sample_mean / jmax(1, nextpix - dbi);
 							screenBufferMean->addSample(channel, sbi, sample_mean*gain);
 
 							screenBufferMin->addSample(channel, sbi, sample_min*gain);
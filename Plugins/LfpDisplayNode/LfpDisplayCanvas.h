@@ -25,6 +25,7 @@
 
 #include <VisualizerWindowHeaders.h>
 #include "LfpDisplayNode.h"
+#include "LfpDisplayBuffer.h"
 
 #include <vector>
 #include <array>
@@ -182,7 +183,7 @@ private:
     //float waves[MAX_N_CHAN][MAX_N_SAMP*2]; // we need an x and y point for each sample
 
     LfpDisplayNode* processor;
-    AudioSampleBuffer* displayBuffer; // sample wise data buffer for display
+    LfpDisplayBuffer* displayBuffer; // sample wise data buffer for display
     ScopedPointer<AudioSampleBuffer> screenBuffer; // subsampled buffer- one int per pixel
 
     //'define 3 buffers for min mean and max for better plotting of spikes
@@ -36,14 +36,8 @@ LfpDisplayNode::LfpDisplayNode()
 {
     setProcessorType (PROCESSOR_TYPE_SINK);
 
-    displayBuffer = new AudioSampleBuffer (8, 100);
-
-    const int heapSize = 5000;
-    arrayOfOnes = new float[heapSize];
-    for (int n = 0; n < heapSize; ++n)
-    {
-        arrayOfOnes[n] = 1;
-    }
+    displayBuffer = new LfpDisplayBuffer();
+    displayBuffer->setSize (7, 100);
 
 	subprocessorToDraw = 0;
 	numSubprocessors = -1;
@@ -52,7 +46,6 @@ LfpDisplayNode::LfpDisplayNode()
 
 LfpDisplayNode::~LfpDisplayNode()
 {
-    delete[] arrayOfOnes;
 }
 
 
@@ -196,8 +189,7 @@ bool LfpDisplayNode::resizeBuffer()
 	if (nSamples > 0 && nInputs > 0)
 	{
 		abstractFifo.setTotalSize(nSamples);
-		displayBuffer->setSize(nInputs + 1, nSamples); // add extra channel for TTLs
-		displayBuffer->clear();
+		displayBuffer->setSize(nInputs, nSamples); // adds an extra channel for TTLs, and clears
 
 		displayBufferIndex.clear();
 		displayBufferIndex.insertMultiple(0, 0, nInputs + 1);
@@ -294,27 +286,24 @@ void LfpDisplayNode::handleEvent(const EventChannel* eventInfo, const MidiMessag
 
             if (nSamples < samplesLeft)
             {
-                displayBuffer->copyFrom(chan,                                 // destChannel
-                                        index,                                // destStartSample
-                                        arrayOfOnes,                          // source
-                                        nSamples,                             // numSamples
-                                        float(ttlState[eventSourceNodeId]));  // gain
+                displayBuffer->fill(chan,                                 // destChannel
+                                    index,                                // destStartSample
+                                    nSamples,                             // numSamples
+                                    float(ttlState[eventSourceNodeId]));  // value
             }
             else
             {
                 int extraSamples = nSamples - samplesLeft;
 
-                displayBuffer->copyFrom(chan,                                 // destChannel
-                                        index,                                // destStartSample
-                                        arrayOfOnes,                          // source
-                                        samplesLeft,                          // numSamples
-                                        float(ttlState[eventSourceNodeId]));  // gain
-
-                displayBuffer->copyFrom(chan,                                 // destChannel
-                                        0,                                    // destStartSample
-                                        arrayOfOnes,                          // source
-                                        extraSamples,                         // numSamples
-                                        float(ttlState[eventSourceNodeId]));  // gain
+                displayBuffer->fill(chan,                                 // destChannel
+                                    index,                                // destStartSample
+                                    samplesLeft,                          // numSamples
+                                    float(ttlState[eventSourceNodeId]));  // value
+
+                displayBuffer->fill(chan,                                 // destChannel
+                                    0,                                    // destStartSample
+                                    extraSamples,                         // numSamples
+                                    float(ttlState[eventSourceNodeId]));  // value
             }
         }
 
@@ -341,27 +330,24 @@ void LfpDisplayNode::initializeEventChannels()
     if (nSamples < samplesLeft)
     {
 
-        displayBuffer->copyFrom (chan,                                      // destChannel
-                                 index,                                     // destStartSample
-                                 arrayOfOnes,                               // source
-                                 nSamples,                                  // numSamples
-                                 float (ttlState[subprocessorToDraw]));     // gain
+        displayBuffer->fill (chan,                                      // destChannel
+                             index,                                     // destStartSample
+                             nSamples,                                  // numSamples
+                             float (ttlState[subprocessorToDraw]));     // value
     }
     else
     {
         int extraSamples = nSamples - samplesLeft;
 
-        displayBuffer->copyFrom (chan,                                      // destChannel
-                                 index,                                     // destStartSample
-                                 arrayOfOnes,                               // source
-                                 samplesLeft,                               // numSamples
-                                 float (ttlState[subprocessorToDraw]));     // gain
-
-        displayBuffer->copyFrom (chan,                                      // destChannel
-                                 0,                                         // destStartSample
-                                 arrayOfOnes,                               // source
-                                 extraSamples,                              // numSamples
-                                 float (ttlState[subprocessorToDraw]));     // gain
+        displayBuffer->fill (chan,                                      // destChannel
+                             index,                                     // destStartSample
+                             samplesLeft,                               // numSamples
+                             float (ttlState[subprocessorToDraw]));     // value
+
+        displayBuffer->fill (chan,                                      // destChannel
+                             0,                                         // destStartSample
+                             extraSamples,                              // numSamples
+                             float (ttlState[subprocessorToDraw]));     // value
     }
 }
 
@@ -419,10 +405,8 @@ void LfpDisplayNode::process (AudioSampleBuffer& buffer)
 					{
 						displayBuffer->copyFrom(channelIndex,                      // destChannel
 							displayBufferIndex[channelIndex],  // destStartSample
-							buffer,                    // source
-							chan,                      // source channel
-							0,                         // source start sample
-							nSamples);                 // numSamples
+							buffer.getReadPointer(chan, 0),    // source
+							nSamples);                         // numSamples
 
 						displayBufferIndex.set(channelIndex, displayBufferIndex[channelIndex] + nSamples);
 					}
@@ -432,17 +416,13 @@ void LfpDisplayNode::process (AudioSampleBuffer& buffer)
 
 						displayBuffer->copyFrom(channelIndex,                      // destChannel
 							displayBufferIndex[channelIndex],  // destStartSample
-							buffer,                    // source
-							chan,                      // source channel
-							0,                         // source start sample
-							samplesLeft);              // numSamples
+							buffer.getReadPointer(chan, 0),    // source
+							samplesLeft);                      // numSamples
 
 						displayBuffer->copyFrom(channelIndex,                      // destChannel
-							0,                         // destStartSample
-							buffer,                    // source
-							chan,                      // source channel
-							samplesLeft,               // source start sample
-							extraSamples);             // numSamples
+							0,                                 // destStartSample
+							buffer.getReadPointer(chan, samplesLeft), // source
+							extraSamples);                     // numSamples
 
 						displayBufferIndex.set(channelIndex, extraSamples);
 					}
@@ -26,6 +26,7 @@
 
 #include <ProcessorHeaders.h>
 #include "LfpDisplayEditor.h"
+#include "LfpDisplayBuffer.h"
 
 #include <map>
 
@@ -62,7 +63,7 @@ public:
 
 	void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition = 0) override;
 
-    AudioSampleBuffer* getDisplayBufferAddress() const { return displayBuffer; }
+    LfpDisplayBuffer* getDisplayBufferAddress() const { return displayBuffer; }
 
     int getDisplayBufferIndex (int chan) const { return displayBufferIndex[chan]; }
 
@@ -81,7 +82,7 @@ private:
     void initializeEventChannels();
     void finalizeEventChannels();
 
-    ScopedPointer<AudioSampleBuffer> displayBuffer;
+    ScopedPointer<LfpDisplayBuffer> displayBuffer;
 
     Array<int> displayBufferIndex;
     Array<uint32> eventSourceNodes;
@@ -93,7 +94,6 @@ private:
 
     int64 bufferTimestamp;
     std::map<uint32, uint64> ttlState;
-    float* arrayOfOnes;
     int totalSamples;
 
     bool resizeBuffer();
@@ -0,0 +1,359 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stdio.h>
+#include "LineNoiseCanceller.h"
+#include "LineNoiseCancellerEditor.h"
+
+/** Frequencies further than this from the nominal one are not trusted */
+#define TRACKING_RANGE 0.1f
+
+/** Weight of each new period in the frequency estimate */
+#define TRACKING_WEIGHT 0.05f
+
+
+LineNoiseCanceller::LineNoiseCanceller()
+    : GenericProcessor      ("Line Noise Canceller")
+    , lineFrequency         (60.0f)
+    , numHarmonics          (4)
+    , adaptationMs          (500.0f)
+    , referenceChannel      (-1)
+    , sampleRate            (0)
+    , activeHarmonics       (0)
+    , weightStride          (0)
+    , phase                 (0)
+    , trackedFrequency      (60.0f)
+    , lastReferenceSample   (0)
+    , samplesSinceCrossing  (0)
+    , hasCrossing           (false)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+LineNoiseCanceller::~LineNoiseCanceller()
+{
+}
+
+
+AudioProcessorEditor* LineNoiseCanceller::createEditor()
+{
+    editor = new LineNoiseCancellerEditor (this, true);
+
+    return editor;
+}
+
+
+void LineNoiseCanceller::updateSettings()
+{
+    const int numChannels = dataChannelArray.size();
+
+    for (int n = shouldProcessChannel.size(); n < numChannels; ++n)
+        shouldProcessChannel.add (dataChannelArray[n]->getChannelType() == DataChannel::HEADSTAGE_CHANNEL);
+
+    shouldProcessChannel.resize (numChannels);
+
+    if (referenceChannel >= numChannels)
+        referenceChannel = -1;
+
+    activeChannels.ensureStorageAllocated (numChannels);
+    sineWeights.allocate ((size_t) jmax (1, MAX_HARMONICS * numChannels), true);
+    cosineWeights.allocate ((size_t) jmax (1, MAX_HARMONICS * numChannels), true);
+
+    referenceBuffer.setSize (1, MAX_BLOCK_SIZE);
+    sineTable.setSize (MAX_HARMONICS, MAX_BLOCK_SIZE);
+    cosineTable.setSize (MAX_HARMONICS, MAX_BLOCK_SIZE);
+    frames.setSize (1, MAX_BLOCK_SIZE * jmax (1, numChannels));
+
+    applySettings();
+}
+
+
+void LineNoiseCanceller::applySettings()
+{
+    activeChannels.clearQuick();
+
+    int source = referenceChannel;
+    for (int n = 0; source < 0 && n < shouldProcessChannel.size(); ++n)
+    {
+        if (shouldProcessChannel[n])
+            source = n;
+    }
+
+    if (source >= 0 && source < dataChannelArray.size())
+    {
+        const DataChannel* sourceChannel = dataChannelArray[source];
+        sampleRate = sourceChannel->getSampleRate();
+
+        for (int n = 0; n < shouldProcessChannel.size(); ++n)
+        {
+            const DataChannel* chan = dataChannelArray[n];
+
+            if (shouldProcessChannel[n]
+                && chan->getSourceNodeID() == sourceChannel->getSourceNodeID()
+                && chan->getSubProcessorIdx() == sourceChannel->getSubProcessorIdx())
+            {
+                activeChannels.add (n);
+            }
+        }
+    }
+
+    weightStride = activeChannels.size();
+    FloatVectorOperations::clear (sineWeights, MAX_HARMONICS * weightStride);
+    FloatVectorOperations::clear (cosineWeights, MAX_HARMONICS * weightStride);
+
+    if (sampleRate <= 0)
+        return;
+
+    // harmonics above Nyquist would only alias
+    activeHarmonics = jlimit (0, numHarmonics, (int) (sampleRate / 2.0f / (lineFrequency * (1.0f + TRACKING_RANGE))));
+
+    referenceFilter.setup (2, sampleRate, lineFrequency, lineFrequency * 2.0f * TRACKING_RANGE);
+    referenceFilter.reset();
+
+    trackedFrequency = lineFrequency;
+    lastReferenceSample = 0;
+    samplesSinceCrossing = 0;
+    hasCrossing = false;
+}
+
+
+bool LineNoiseCanceller::enable()
+{
+    applySettings();
+    settingsChanged = 0;
+    phase = 0;
+
+    return true;
+}
+
+
+void LineNoiseCanceller::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case LINE_FREQUENCY:
+            lineFrequency = newValue > 55.0f ? 60.0f : 50.0f;
+            break;
+        case NUM_HARMONICS:
+            numHarmonics = jlimit (1, MAX_HARMONICS, (int) newValue);
+            break;
+        case ADAPTATION_MS:
+            // read once per block, the model does not need to be reset
+            adaptationMs = jmax (1.0f, newValue);
+            return;
+        case REFERENCE_CHANNEL:
+            referenceChannel = (int) newValue < dataChannelArray.size() ? (int) newValue : -1;
+            break;
+        case CHANNEL_ACTIVE:
+            if (currentChannel >= 0 && currentChannel < shouldProcessChannel.size())
+                shouldProcessChannel.set (currentChannel, newValue > 0.5f);
+            break;
+        default:
+            return;
+    }
+
+    // the channel list and tables are rebuilt at the start of the next block
+    settingsChanged = 1;
+}
+
+
+float LineNoiseCanceller::getParameterValue (int parameterIndex) const
+{
+    switch (parameterIndex)
+    {
+        case LINE_FREQUENCY: return lineFrequency;
+        case NUM_HARMONICS: return (float) numHarmonics;
+        case ADAPTATION_MS: return adaptationMs;
+        case REFERENCE_CHANNEL: return (float) referenceChannel;
+        default: return 0.0f;
+    }
+}
+
+
+bool LineNoiseCanceller::isChannelActive (int chan) const
+{
+    return shouldProcessChannel[chan];
+}
+
+
+void LineNoiseCanceller::trackFrequency (const float* reference, int nSamples)
+{
+    for (int i = 0; i < nSamples; ++i)
+    {
+        const float sample = reference[i];
+        samplesSinceCrossing += 1.0;
+
+        if (lastReferenceSample < 0 && sample >= 0)
+        {
+            // interpolate the crossing between the two samples
+            const double fraction = lastReferenceSample / (lastReferenceSample - sample);
+            const double period = samplesSinceCrossing - (1.0 - fraction);
+            samplesSinceCrossing = 1.0 - fraction;
+
+            if (hasCrossing && period > 0)
+            {
+                const float frequency = float (sampleRate / period);
+
+                if (std::abs (frequency - lineFrequency) < lineFrequency * TRACKING_RANGE)
+                    trackedFrequency += TRACKING_WEIGHT * (frequency - trackedFrequency);
+            }
+
+            hasCrossing = true;
+        }
+
+        lastReferenceSample = sample;
+    }
+}
+
+
+void LineNoiseCanceller::generateReferences (int nSamples)
+{
+    const double frequency = referenceChannel >= 0 ? trackedFrequency : lineFrequency;
+    const double increment = 2.0 * double_Pi * frequency / sampleRate;
+
+    float* const* sines = sineTable.getArrayOfWritePointers();
+    float* const* cosines = cosineTable.getArrayOfWritePointers();
+
+    for (int i = 0; i < nSamples; ++i)
+    {
+        const float s1 = (float) std::sin (phase);
+        const float c1 = (float) std::cos (phase);
+
+        // higher harmonics by angle addition
+        float s = s1;
+        float c = c1;
+
+        for (int h = 0; h < activeHarmonics; ++h)
+        {
+            sines[h][i] = s;
+            cosines[h][i] = c;
+
+            const float next = s * c1 + c * s1;
+            c = c * c1 - s * s1;
+            s = next;
+        }
+
+        phase += increment;
+        if (phase >= 2.0 * double_Pi)
+            phase -= 2.0 * double_Pi;
+    }
+}
+
+
+void LineNoiseCanceller::process (AudioSampleBuffer& buffer)
+{
+    if (settingsChanged.compareAndSetBool (0, 1))
+        applySettings();
+
+    const int numActive = activeChannels.size();
+    if (numActive == 0 || activeHarmonics == 0)
+        return;
+
+    // the tables are preallocated in updateSettings(), never resized here
+    const int nSamples = jmin ((int) getNumSamples (activeChannels[0]), buffer.getNumSamples(), MAX_BLOCK_SIZE);
+    if (nSamples <= 0)
+        return;
+
+    if (referenceChannel >= 0 && referenceChannel < buffer.getNumChannels())
+    {
+        float* reference = referenceBuffer.getWritePointer (0);
+
+        FloatVectorOperations::copy (reference, buffer.getReadPointer (referenceChannel), nSamples);
+        referenceFilter.process (nSamples, &reference);
+        trackFrequency (reference, nSamples);
+    }
+
+    generateReferences (nSamples);
+
+    float* frame = frames.getWritePointer (0);
+
+    for (int c = 0; c < numActive; ++c)
+    {
+        const float* src = buffer.getReadPointer (activeChannels[c]);
+        for (int i = 0; i < nSamples; ++i)
+            frame[i * numActive + c] = src[i];
+    }
+
+    // normalised so the sine/cosine pair of each harmonic converges with the
+    // requested time constant, and capped to keep the update stable
+    const float mu = jmin (2000.0f / (adaptationMs * sampleRate), 1.0f / activeHarmonics);
+
+    const float* const* sines = sineTable.getArrayOfReadPointers();
+    const float* const* cosines = cosineTable.getArrayOfReadPointers();
+
+    for (int i = 0; i < nSamples; ++i)
+    {
+        float* residual = frame + i * numActive;
+
+        for (int h = 0; h < activeHarmonics; ++h)
+        {
+            FloatVectorOperations::addWithMultiply (residual, sineWeights + h * weightStride, -sines[h][i], numActive);
+            FloatVectorOperations::addWithMultiply (residual, cosineWeights + h * weightStride, -cosines[h][i], numActive);
+        }
+
+        for (int h = 0; h < activeHarmonics; ++h)
+        {
+            FloatVectorOperations::addWithMultiply (sineWeights + h * weightStride, residual, mu * sines[h][i], numActive);
+            FloatVectorOperations::addWithMultiply (cosineWeights + h * weightStride, residual, mu * cosines[h][i], numActive);
+        }
+    }
+
+    for (int c = 0; c < numActive; ++c)
+    {
+        float* dest = buffer.getWritePointer (activeChannels[c]);
+        for (int i = 0; i < nSamples; ++i)
+            dest[i] = frame[i * numActive + c];
+    }
+}
+
+
+void LineNoiseCanceller::saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType)
+{
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNumber > -1
+        && channelNumber < shouldProcessChannel.size())
+    {
+        XmlElement* channelParams = channelInfo->createNewChildElement ("PARAMETERS");
+        channelParams->setAttribute ("shouldProcess", shouldProcessChannel[channelNumber]);
+    }
+}
+
+
+void LineNoiseCanceller::loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType)
+{
+    int channelNum = channelInfo->getIntAttribute ("number");
+
+    if (channelType == InfoObjectCommon::DATA_CHANNEL
+        && channelNum > -1
+        && channelNum < shouldProcessChannel.size())
+    {
+        forEachXmlChildElement (*channelInfo, subNode)
+        {
+            if (subNode->hasTagName ("PARAMETERS"))
+                shouldProcessChannel.set (channelNum, subNode->getBoolAttribute ("shouldProcess", true));
+        }
+
+        settingsChanged = 1;
+    }
+}
@@ -0,0 +1,140 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef LINENOISECANCELLER_H_INCLUDED
+#define LINENOISECANCELLER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include <DspLib.h>
+
+#define MAX_HARMONICS 8
+
+/** Larger than any audio buffer the AudioComponent accepts, the tables are allocated for this many samples */
+#define MAX_BLOCK_SIZE 10000
+
+/**
+
+    Removes mains interference and its harmonics with an adaptive sinusoidal
+    model, instead of a cascade of notch filters per channel.
+
+    A sine and cosine reference is generated once per block for each harmonic
+    of the mains frequency. Every selected channel subtracts its own weighted
+    sum of the references, and the weights follow the residual with an LMS
+    update, so the model tracks changes in amplitude and phase without touching
+    the neighbouring frequencies.
+
+    The mains frequency is either the nominal one or tracked from a reference
+    channel (e.g. an ADC picking up line noise) by timing the zero crossings
+    of its band-passed signal.
+
+    The channels are processed sample by sample but in parallel: the block is
+    transposed so that each sample of every channel is contiguous, and the
+    model and weight updates are vector operations across channels. The
+    references are shared by all channels, so only channels from the same
+    source subprocessor as the reference (or as the first selected channel)
+    are processed.
+
+    @see GenericProcessor, LineNoiseCancellerEditor
+*/
+class LineNoiseCanceller : public GenericProcessor
+{
+public:
+    LineNoiseCanceller();
+    ~LineNoiseCanceller();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+
+    void saveCustomChannelParametersToXml (XmlElement* channelInfo, int channelNumber, InfoObjectCommon::InfoObjectType channelType) override;
+    void loadCustomChannelParametersFromXml (XmlElement* channelInfo, InfoObjectCommon::InfoObjectType channelType) override;
+
+    enum Parameters
+    {
+        LINE_FREQUENCY = 0,
+        NUM_HARMONICS,
+        ADAPTATION_MS,
+        REFERENCE_CHANNEL,
+        CHANNEL_ACTIVE
+    };
+
+    float getParameterValue (int parameterIndex) const;
+    bool isChannelActive (int chan) const;
+
+private:
+    /** Rebuilds the list of processed channels and resets the model. Does not allocate, all
+        buffers are sized for MAX_BLOCK_SIZE samples of every channel in updateSettings(). */
+    void applySettings();
+
+    /** Updates the frequency estimate from the zero crossings of the reference channel */
+    void trackFrequency (const float* reference, int nSamples);
+
+    /** Fills the sine and cosine tables of every harmonic for nSamples */
+    void generateReferences (int nSamples);
+
+    float lineFrequency;
+    int numHarmonics;
+    float adaptationMs;
+    int referenceChannel;
+
+    Array<bool> shouldProcessChannel;
+
+    /** Channels processed in the current configuration */
+    Array<int> activeChannels;
+    float sampleRate;
+    int activeHarmonics;
+
+    /** Model weights, one row of activeChannels.size() values per harmonic and quadrature */
+    HeapBlock<float> sineWeights;
+    HeapBlock<float> cosineWeights;
+    int weightStride;
+
+    /** Per block tables of sin(h * phase) and cos(h * phase), one row per harmonic */
+    AudioSampleBuffer sineTable;
+    AudioSampleBuffer cosineTable;
+
+    /** Block transposed to sample-major order */
+    AudioSampleBuffer frames;
+
+    AudioSampleBuffer referenceBuffer;
+    Dsp::SimpleFilter<Dsp::Butterworth::BandPass<2>, 1> referenceFilter;
+
+    double phase;
+    float trackedFrequency;
+    float lastReferenceSample;
+    double samplesSinceCrossing;
+    bool hasCrossing;
+
+    Atomic<int> settingsChanged;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LineNoiseCanceller);
+};
+
+#endif  // LINENOISECANCELLER_H_INCLUDED
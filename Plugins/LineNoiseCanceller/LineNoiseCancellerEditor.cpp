@@ -0,0 +1,197 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "LineNoiseCancellerEditor.h"
+#include "LineNoiseCanceller.h"
+
+
+LineNoiseCancellerEditor::LineNoiseCancellerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+{
+    desiredWidth = 220;
+
+    addLabel ("Mains:", 10, 25);
+    frequencySelector = new ComboBox ("line frequency");
+    frequencySelector->addItem ("50 Hz", 50);
+    frequencySelector->addItem ("60 Hz", 60);
+    frequencySelector->setSelectedId (60, dontSendNotification);
+    frequencySelector->setBounds (85, 27, 70, 18);
+    frequencySelector->addListener (this);
+    addAndMakeVisible (frequencySelector);
+
+    addLabel ("Harmonics:", 10, 47);
+    harmonicsSelector = new ComboBox ("harmonics");
+    for (int h = 1; h <= MAX_HARMONICS; ++h)
+        harmonicsSelector->addItem (String (h), h);
+    harmonicsSelector->setSelectedId (4, dontSendNotification);
+    harmonicsSelector->setBounds (85, 49, 70, 18);
+    harmonicsSelector->setTooltip ("Number of harmonics removed, including the fundamental");
+    harmonicsSelector->addListener (this);
+    addAndMakeVisible (harmonicsSelector);
+
+    addLabel ("Adapt (ms):", 10, 69);
+    adaptationValue = new Label ("adaptation", "500");
+    adaptationValue->setBounds (85, 71, 70, 18);
+    adaptationValue->setFont (Font ("Default", 15, Font::plain));
+    adaptationValue->setColour (Label::textColourId, Colours::white);
+    adaptationValue->setColour (Label::backgroundColourId, Colours::grey);
+    adaptationValue->setEditable (true);
+    adaptationValue->addListener (this);
+    adaptationValue->setTooltip ("Time constant of the adaptive model. Shorter follows faster changes, longer removes less signal");
+    addAndMakeVisible (adaptationValue);
+
+    addLabel ("Reference:", 10, 91);
+    referenceSelector = new ComboBox ("reference");
+    referenceSelector->setBounds (85, 93, 70, 18);
+    referenceSelector->setTooltip ("Channel used to track the mains frequency. Only channels from the same source are processed");
+    referenceSelector->addListener (this);
+    addAndMakeVisible (referenceSelector);
+
+    channelButton = new UtilityButton ("+CH", Font ("Default", 10, Font::plain));
+    channelButton->addListener (this);
+    channelButton->setBounds (165, 93, 40, 18);
+    channelButton->setClickingTogglesState (true);
+    channelButton->setToggleState (true, dontSendNotification);
+    channelButton->setTooltip ("When this button is off, selected channels are not processed");
+    addAndMakeVisible (channelButton);
+
+    updateSettings();
+}
+
+
+LineNoiseCancellerEditor::~LineNoiseCancellerEditor()
+{
+}
+
+
+Label* LineNoiseCancellerEditor::addLabel (const String& text, int x, int y)
+{
+    Label* label = new Label (text, text);
+    label->setBounds (x, y, 75, 20);
+    label->setFont (Font ("Small Text", 12, Font::plain));
+    label->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (label);
+    labels.add (label);
+
+    return label;
+}
+
+
+void LineNoiseCancellerEditor::updateSettings()
+{
+    LineNoiseCanceller* processor = (LineNoiseCanceller*) getProcessor();
+
+    referenceSelector->clear (dontSendNotification);
+    referenceSelector->addItem ("None", 1);
+
+    for (int n = 0; n < processor->getNumInputs(); ++n)
+        referenceSelector->addItem (String (n + 1), n + 2);
+
+    referenceSelector->setSelectedId ((int) processor->getParameterValue (LineNoiseCanceller::REFERENCE_CHANNEL) + 2, dontSendNotification);
+}
+
+
+void LineNoiseCancellerEditor::labelTextChanged (Label* label)
+{
+    LineNoiseCanceller* processor = (LineNoiseCanceller*) getProcessor();
+
+    if (label == adaptationValue)
+    {
+        float requestedValue = label->getText().getFloatValue();
+
+        if (requestedValue < 1.0f || requestedValue > 100000.0f)
+            CoreServices::sendStatusMessage ("Value out of range.");
+        else
+            processor->setParameter (LineNoiseCanceller::ADAPTATION_MS, requestedValue);
+
+        label->setText (String (processor->getParameterValue (LineNoiseCanceller::ADAPTATION_MS)), dontSendNotification);
+    }
+}
+
+
+void LineNoiseCancellerEditor::comboBoxChanged (ComboBox* comboBox)
+{
+    GenericProcessor* processor = getProcessor();
+
+    if (comboBox == frequencySelector)
+        processor->setParameter (LineNoiseCanceller::LINE_FREQUENCY, frequencySelector->getSelectedId());
+    else if (comboBox == harmonicsSelector)
+        processor->setParameter (LineNoiseCanceller::NUM_HARMONICS, harmonicsSelector->getSelectedId());
+    else if (comboBox == referenceSelector)
+        processor->setParameter (LineNoiseCanceller::REFERENCE_CHANNEL, referenceSelector->getSelectedId() - 2);
+}
+
+
+void LineNoiseCancellerEditor::channelChanged (int channel, bool /*newState*/)
+{
+    LineNoiseCanceller* processor = (LineNoiseCanceller*) getProcessor();
+
+    channelButton->setToggleState (processor->isChannelActive (channel), dontSendNotification);
+}
+
+
+void LineNoiseCancellerEditor::buttonEvent (Button* button)
+{
+    if (button == channelButton)
+    {
+        GenericProcessor* processor = getProcessor();
+
+        Array<int> chans = getActiveChannels();
+
+        for (int n = 0; n < chans.size(); n++)
+        {
+            processor->setCurrentChannel (chans[n]);
+            processor->setParameter (LineNoiseCanceller::CHANNEL_ACTIVE, button->getToggleState() ? 1.0f : 0.0f);
+        }
+    }
+}
+
+
+void LineNoiseCancellerEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "LineNoiseCancellerEditor");
+
+    LineNoiseCanceller* processor = (LineNoiseCanceller*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("VALUES");
+    settings->setAttribute ("Frequency", (int) processor->getParameterValue (LineNoiseCanceller::LINE_FREQUENCY));
+    settings->setAttribute ("Harmonics", (int) processor->getParameterValue (LineNoiseCanceller::NUM_HARMONICS));
+    settings->setAttribute ("Adaptation", processor->getParameterValue (LineNoiseCanceller::ADAPTATION_MS));
+    settings->setAttribute ("Reference", (int) processor->getParameterValue (LineNoiseCanceller::REFERENCE_CHANNEL));
+}
+
+
+void LineNoiseCancellerEditor::loadCustomParameters (XmlElement* xml)
+{
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("VALUES"))
+        {
+            frequencySelector->setSelectedId (xmlNode->getIntAttribute ("Frequency", 60), sendNotificationSync);
+            harmonicsSelector->setSelectedId (xmlNode->getIntAttribute ("Harmonics", 4), sendNotificationSync);
+            referenceSelector->setSelectedId (xmlNode->getIntAttribute ("Reference", -1) + 2, sendNotificationSync);
+
+            adaptationValue->setText (xmlNode->getStringAttribute ("Adaptation", "500"), sendNotificationSync);
+        }
+    }
+}
@@ -0,0 +1,533 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "DecoderModel.h"
+#include <vector>
+
+#if defined (__SSE__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 1)
+ #include <xmmintrin.h>
+ #define DECODER_USE_SSE 1
+#else
+ #define DECODER_USE_SSE 0
+#endif
+
+/** Floats per 64 byte cache line */
+#define DECODER_ALIGNMENT_FLOATS 16
+
+/** Riccati iterations allowed before giving up on a Kalman gain */
+#define MAX_RICCATI_ITERATIONS 2000
+
+/** Largest model whose gain is computed on load; larger ones must provide K */
+#define MAX_RICCATI_INPUTS 512
+
+typedef std::vector<double> Matrix;
+
+namespace
+{
+    bool hasEntry (const var& json, const char* name)
+    {
+        return !json.getProperty (name, var()).isVoid();
+    }
+
+    bool isNumber (const var& value)
+    {
+        return value.isDouble() || value.isInt() || value.isInt64();
+    }
+
+    /** Reads an array of rows into a row-major matrix. Returns false if it is not a rectangular array of numbers. */
+    bool readMatrix (const var& value, int& rows, int& columns, Array<double>& out)
+    {
+        out.clearQuick();
+
+        const Array<var>* rowArray = value.getArray();
+        if (rowArray == nullptr || rowArray->size() == 0)
+            return false;
+
+        rows = rowArray->size();
+        columns = -1;
+
+        for (int r = 0; r < rows; ++r)
+        {
+            const Array<var>* row = rowArray->getReference (r).getArray();
+            if (row == nullptr || (columns >= 0 && row->size() != columns))
+                return false;
+
+            columns = row->size();
+
+            for (int c = 0; c < columns; ++c)
+            {
+                if (!isNumber (row->getReference (c)))
+                    return false;
+
+                out.add ((double) row->getReference (c));
+            }
+        }
+
+        return columns > 0;
+    }
+
+    /** Reads an array of numbers. Returns false if it is not one. */
+    bool readVector (const var& value, int& size, Array<double>& out)
+    {
+        out.clearQuick();
+
+        const Array<var>* values = value.getArray();
+        if (values == nullptr)
+            return false;
+
+        size = values->size();
+
+        for (int i = 0; i < size; ++i)
+        {
+            if (!isNumber (values->getReference (i)))
+                return false;
+
+            out.add ((double) values->getReference (i));
+        }
+
+        return true;
+    }
+
+    Matrix toMatrix (const Array<double>& values)
+    {
+        return Matrix (values.begin(), values.end());
+    }
+
+    /** C = A * B, with A n x k and B k x m */
+    Matrix matrixProduct (const Matrix& a, const Matrix& b, int n, int k, int m)
+    {
+        Matrix c ((size_t) n * m, 0.0);
+
+        for (int i = 0; i < n; ++i)
+            for (int l = 0; l < k; ++l)
+            {
+                const double ail = a[(size_t) i * k + l];
+                for (int j = 0; j < m; ++j)
+                    c[(size_t) i * m + j] += ail * b[(size_t) l * m + j];
+            }
+
+        return c;
+    }
+
+    /** C = A * B', with A n x k and B m x k */
+    Matrix matrixProductTransposed (const Matrix& a, const Matrix& b, int n, int k, int m)
+    {
+        Matrix c ((size_t) n * m, 0.0);
+
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < m; ++j)
+            {
+                double sum = 0;
+                for (int l = 0; l < k; ++l)
+                    sum += a[(size_t) i * k + l] * b[(size_t) j * k + l];
+                c[(size_t) i * m + j] = sum;
+            }
+
+        return c;
+    }
+
+    /** Replaces the symmetric positive definite n x n matrix a by its lower Cholesky factor */
+    bool cholesky (Matrix& a, int n)
+    {
+        for (int j = 0; j < n; ++j)
+        {
+            double d = a[(size_t) j * n + j];
+            for (int k = 0; k < j; ++k)
+                d -= a[(size_t) j * n + k] * a[(size_t) j * n + k];
+
+            if (d <= 0)
+                return false;
+
+            d = std::sqrt (d);
+            a[(size_t) j * n + j] = d;
+
+            for (int i = j + 1; i < n; ++i)
+            {
+                double s = a[(size_t) i * n + j];
+                for (int k = 0; k < j; ++k)
+                    s -= a[(size_t) i * n + k] * a[(size_t) j * n + k];
+                a[(size_t) i * n + j] = s / d;
+            }
+        }
+
+        return true;
+    }
+
+    /** Solves L L' x = b in place for every column of the n x m matrix b */
+    void choleskySolve (const Matrix& l, int n, Matrix& b, int m)
+    {
+        for (int col = 0; col < m; ++col)
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                double s = b[(size_t) i * m + col];
+                for (int k = 0; k < i; ++k)
+                    s -= l[(size_t) i * n + k] * b[(size_t) k * m + col];
+                b[(size_t) i * m + col] = s / l[(size_t) i * n + i];
+            }
+
+            for (int i = n - 1; i >= 0; --i)
+            {
+                double s = b[(size_t) i * m + col];
+                for (int k = i + 1; k < n; ++k)
+                    s -= l[(size_t) k * n + i] * b[(size_t) k * m + col];
+                b[(size_t) i * m + col] = s / l[(size_t) i * n + i];
+            }
+        }
+    }
+
+    /** Iterates the Riccati equation of the filter until its gain K (m x n) stops changing */
+    String computeSteadyStateGain (const Matrix& A, const Matrix& W, const Matrix& H, const Matrix& Q,
+                                   int m, int n, Matrix& K)
+    {
+        Matrix P = W;
+        Matrix previous;
+
+        for (int iteration = 0; iteration < MAX_RICCATI_ITERATIONS; ++iteration)
+        {
+            // prediction: Pm = A P A' + W
+            Matrix Pm = matrixProductTransposed (matrixProduct (A, P, m, m, m), A, m, m, m);
+            for (size_t i = 0; i < Pm.size(); ++i)
+                Pm[i] += W[i];
+
+            // innovation covariance: S = H Pm H' + Q
+            Matrix HP = matrixProduct (H, Pm, n, m, m);
+            Matrix S = matrixProductTransposed (HP, H, n, m, n);
+            for (size_t i = 0; i < S.size(); ++i)
+                S[i] += Q[i];
+
+            if (!cholesky (S, n))
+                return "H Pm H' + Q is not positive definite, check W and Q";
+
+            // K' = S^-1 H Pm, as both S and Pm are symmetric
+            Matrix Kt = HP;
+            choleskySolve (S, n, Kt, m);
+
+            K.assign ((size_t) m * n, 0.0);
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < m; ++j)
+                    K[(size_t) j * n + i] = Kt[(size_t) i * m + j];
+
+            // update: P = Pm - K H Pm
+            P = matrixProduct (K, HP, m, n, m);
+            for (size_t i = 0; i < P.size(); ++i)
+                P[i] = Pm[i] - P[i];
+
+            for (int i = 0; i < m; ++i)
+                for (int j = 0; j < i; ++j)
+                {
+                    const double mean = 0.5 * (P[(size_t) i * m + j] + P[(size_t) j * m + i]);
+                    P[(size_t) i * m + j] = P[(size_t) j * m + i] = mean;
+                }
+
+            if (previous.size() == K.size())
+            {
+                double change = 0;
+                double largest = 0;
+                for (size_t i = 0; i < K.size(); ++i)
+                {
+                    change = jmax (change, std::abs (K[i] - previous[i]));
+                    largest = jmax (largest, std::abs (K[i]));
+                }
+
+                if (change <= 1e-9 * (1.0 + largest))
+                    return String();
+            }
+
+            previous = K;
+        }
+
+        return "the Kalman gain did not converge";
+    }
+}
+
+
+void DecoderModel::AlignedBlock::allocate (size_t numFloats)
+{
+    memory.calloc (numFloats + DECODER_ALIGNMENT_FLOATS);
+
+    const size_t misalignment = ((size_t) memory.getData() / sizeof (float)) % DECODER_ALIGNMENT_FLOATS;
+    data = memory.getData() + (misalignment == 0 ? 0 : DECODER_ALIGNMENT_FLOATS - misalignment);
+}
+
+
+DecoderModel::DecoderModel()
+    : type          (LINEAR)
+    , numInputs     (0)
+    , numOutputs    (0)
+    , inputStride   (0)
+    , outputStride  (0)
+{
+}
+
+
+DecoderModel::~DecoderModel()
+{
+}
+
+
+int DecoderModel::getStride (int numColumns)
+{
+    return (numColumns + DECODER_ALIGNMENT_FLOATS - 1) & ~(DECODER_ALIGNMENT_FLOATS - 1);
+}
+
+
+void DecoderModel::storeMatrix (AlignedBlock& dest, const Array<double>& source, int rows, int columns)
+{
+    const int stride = getStride (columns);
+    dest.allocate ((size_t) rows * stride);
+
+    for (int r = 0; r < rows; ++r)
+        for (int c = 0; c < columns; ++c)
+            dest.data[(size_t) r * stride + c] = (float) source[r * columns + c];
+}
+
+
+String DecoderModel::loadFromFile (const File& file)
+{
+    if (!file.existsAsFile())
+        return "File not found";
+
+    var json = JSON::parse (file);
+    if (!json.isObject())
+        return "Not a JSON object";
+
+    const String typeName = json.getProperty ("type", var()).toString().toLowerCase();
+    Array<double> F, S, c, mean, x0;
+    int m = 0;
+    int n = 0;
+    int rows, columns, size;
+
+    if (typeName == "linear")
+    {
+        if (!readMatrix (json.getProperty ("weights", var()), m, n, F))
+            return "\"weights\" must be an array of rows";
+
+        c.insertMultiple (0, 0.0, m);
+        if (hasEntry (json, "offset") && (!readVector (json.getProperty ("offset", var()), size, c) || size != m))
+            return "\"offset\" must have one value per output";
+    }
+    else if (typeName == "kalman")
+    {
+        Array<double> a, w, h, q, k;
+
+        if (!readMatrix (json.getProperty ("A", var()), m, columns, a) || columns != m)
+            return "\"A\" must be square";
+        if (!readMatrix (json.getProperty ("W", var()), rows, columns, w) || rows != m || columns != m)
+            return "\"W\" must be the same size as A";
+        if (!readMatrix (json.getProperty ("H", var()), n, columns, h) || columns != m)
+            return "\"H\" must have one column per state";
+        if (!readMatrix (json.getProperty ("Q", var()), rows, columns, q) || rows != n || columns != n)
+            return "\"Q\" must have one row and column per feature";
+
+        Matrix K;
+
+        if (hasEntry (json, "K"))
+        {
+            if (!readMatrix (json.getProperty ("K", var()), rows, columns, k) || rows != m || columns != n)
+                return "\"K\" must have one row per state and one column per feature";
+            K = toMatrix (k);
+        }
+        else if (n > MAX_RICCATI_INPUTS)
+        {
+            return "Models with more than " + String (MAX_RICCATI_INPUTS) + " features must provide \"K\"";
+        }
+        else
+        {
+            String error = computeSteadyStateGain (toMatrix (a), toMatrix (w), toMatrix (h), toMatrix (q), m, n, K);
+            if (error.isNotEmpty())
+                return "Cannot compute the gain: " + error;
+        }
+
+        // S = (I - K H) A
+        Matrix IKH = matrixProduct (K, toMatrix (h), m, n, m);
+        for (size_t i = 0; i < IKH.size(); ++i)
+            IKH[i] = -IKH[i];
+        for (int i = 0; i < m; ++i)
+            IKH[(size_t) i * m + i] += 1.0;
+
+        Matrix stateUpdate = matrixProduct (IKH, toMatrix (a), m, m, m);
+        for (size_t i = 0; i < stateUpdate.size(); ++i)
+            S.add (stateUpdate[i]);
+        for (size_t i = 0; i < K.size(); ++i)
+            F.add (K[i]);
+        c.insertMultiple (0, 0.0, m);
+    }
+    else
+    {
+        return "\"type\" must be \"linear\" or \"kalman\"";
+    }
+
+    if (m > MAX_DECODER_OUTPUTS)
+        return "At most " + String (MAX_DECODER_OUTPUTS) + " outputs are supported";
+    if (n > MAX_DECODER_INPUTS)
+        return "At most " + String (MAX_DECODER_INPUTS) + " features are supported";
+
+    mean.insertMultiple (0, 0.0, n);
+    if (hasEntry (json, "featureMean") && (!readVector (json.getProperty ("featureMean", var()), size, mean) || size != n))
+        return "\"featureMean\" must have one value per feature";
+
+    x0.insertMultiple (0, 0.0, m);
+    if (hasEntry (json, "x0") && (!readVector (json.getProperty ("x0", var()), size, x0) || size != m))
+        return "\"x0\" must have one value per state";
+
+    StringArray names;
+    if (const Array<var>* outputs = json.getProperty ("outputs", var()).getArray())
+        for (int i = 0; i < outputs->size(); ++i)
+            names.add (outputs->getReference (i).toString());
+
+    while (names.size() < m)
+        names.add ("Output " + String (names.size() + 1));
+    names.removeRange (m, names.size() - m);
+
+    // everything checked, the model can be replaced
+    type = typeName == "kalman" ? KALMAN : LINEAR;
+    numInputs = n;
+    numOutputs = m;
+    inputStride = getStride (n);
+    outputStride = getStride (m);
+    outputNames = names;
+
+    storeMatrix (featureMatrix, F, m, n);
+    storeMatrix (offset, c, 1, m);
+    storeMatrix (featureMean, mean, 1, n);
+    storeMatrix (initialState, x0, 1, m);
+
+    if (type == KALMAN)
+        storeMatrix (stateMatrix, S, m, m);
+    else
+        stateMatrix.allocate (0);
+
+    centred.allocate ((size_t) inputStride);
+    state.allocate ((size_t) outputStride);
+    next.allocate ((size_t) outputStride);
+
+    reset();
+
+    return String();
+}
+
+
+DecoderModel::Type DecoderModel::getType() const
+{
+    return type;
+}
+
+
+int DecoderModel::getNumInputs() const
+{
+    return numInputs;
+}
+
+
+int DecoderModel::getNumOutputs() const
+{
+    return numOutputs;
+}
+
+
+String DecoderModel::getOutputName (int index) const
+{
+    return outputNames[index];
+}
+
+
+String DecoderModel::getDescription() const
+{
+    if (numOutputs == 0)
+        return "No model";
+
+    return String (type == KALMAN ? "Kalman " : "Linear ") + String (numInputs) + ">" + String (numOutputs);
+}
+
+
+void DecoderModel::reset()
+{
+    if (numOutputs > 0)
+        FloatVectorOperations::copy (state.data, initialState.data, outputStride);
+}
+
+
+float DecoderModel::dotProduct (const float* a, const float* b, int numPadded)
+{
+#if DECODER_USE_SSE
+    __m128 s0 = _mm_setzero_ps();
+    __m128 s1 = _mm_setzero_ps();
+    __m128 s2 = _mm_setzero_ps();
+    __m128 s3 = _mm_setzero_ps();
+
+    // rows are padded to a whole number of cache lines
+    for (int i = 0; i < numPadded; i += DECODER_ALIGNMENT_FLOATS)
+    {
+        s0 = _mm_add_ps (s0, _mm_mul_ps (_mm_load_ps (a + i), _mm_load_ps (b + i)));
+        s1 = _mm_add_ps (s1, _mm_mul_ps (_mm_load_ps (a + i + 4), _mm_load_ps (b + i + 4)));
+        s2 = _mm_add_ps (s2, _mm_mul_ps (_mm_load_ps (a + i + 8), _mm_load_ps (b + i + 8)));
+        s3 = _mm_add_ps (s3, _mm_mul_ps (_mm_load_ps (a + i + 12), _mm_load_ps (b + i + 12)));
+    }
+
+    float sums[4];
+    _mm_storeu_ps (sums, _mm_add_ps (_mm_add_ps (s0, s1), _mm_add_ps (s2, s3)));
+
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+#else
+    float sum = 0;
+    for (int i = 0; i < numPadded; ++i)
+        sum += a[i] * b[i];
+
+    return sum;
+#endif
+}
+
+
+void DecoderModel::multiply (const float* matrix, int rows, int stride, const float* x, float* y)
+{
+    for (int r = 0; r < rows; ++r)
+        y[r] = dotProduct (matrix + (size_t) r * stride, x, stride);
+}
+
+
+void DecoderModel::step (const float* features)
+{
+    if (numOutputs == 0)
+        return;
+
+    // the padding of centred stays zero
+    FloatVectorOperations::subtract (centred.data, features, featureMean.data, numInputs);
+
+    multiply (featureMatrix.data, numOutputs, inputStride, centred.data, next.data);
+
+    if (type == KALMAN)
+    {
+        for (int r = 0; r < numOutputs; ++r)
+            next.data[r] += dotProduct (stateMatrix.data + (size_t) r * outputStride, state.data, outputStride);
+    }
+
+    FloatVectorOperations::add (state.data, next.data, offset.data, numOutputs);
+}
+
+
+const float* DecoderModel::getState() const
+{
+    return state.data;
+}
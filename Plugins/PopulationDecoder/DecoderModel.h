@@ -0,0 +1,141 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DECODERMODEL_H_INCLUDED
+#define DECODERMODEL_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/** Most features and outputs a model may have */
+#define MAX_DECODER_INPUTS 4096
+#define MAX_DECODER_OUTPUTS 64
+
+/**
+
+    A linear or steady-state Kalman decoder, loaded from a JSON file.
+
+    Both kinds are run as one update of the decoded state x from a feature
+    vector y:
+
+        x = S * x + F * (y - featureMean) + c
+
+    For a linear model, S is zero, F holds the "weights" and c the "offset".
+    For a Kalman model, x_t = A x_t-1 + w, w ~ N(0, W) and
+    y_t = H x_t + q, q ~ N(0, Q); the gain is assumed to have converged, so
+    S = (I - K H) A and F = K. K is read from the file if it is there, and
+    otherwise found by iterating the Riccati equation when the model is
+    loaded. Only the update runs per bin, as two matrix-vector products.
+
+    The matrices are kept in single precision with every row starting on a
+    64 byte boundary and padded with zeros, so the products run in SIMD
+    registers without a scalar tail.
+
+    File format (matrices are arrays of rows):
+
+        { "type": "kalman", "A": [[..]], "W": [[..]], "H": [[..]], "Q": [[..]],
+          "K": [[..]], "x0": [..], "featureMean": [..], "outputs": ["x", "y"] }
+
+        { "type": "linear", "weights": [[..]], "offset": [..],
+          "featureMean": [..], "outputs": ["x", "y"] }
+
+    K, x0, offset, featureMean and outputs are optional.
+
+    @see PopulationDecoder
+
+*/
+class DecoderModel
+{
+public:
+    DecoderModel();
+    ~DecoderModel();
+
+    enum Type
+    {
+        LINEAR = 0,
+        KALMAN
+    };
+
+    /** Reads a model file. Returns an empty string on success, otherwise what went wrong. */
+    String loadFromFile (const File& file);
+
+    Type getType() const;
+    int getNumInputs() const;
+    int getNumOutputs() const;
+    String getOutputName (int index) const;
+
+    /** Short description for the editor, e.g. "Kalman 96>4" */
+    String getDescription() const;
+
+    /** Sets the state back to x0 */
+    void reset();
+
+    /** Runs one update with numInputs features. Does not allocate. */
+    void step (const float* features);
+
+    /** The decoded state, numOutputs values */
+    const float* getState() const;
+
+private:
+    /** Float storage with a 64 byte aligned start */
+    struct AlignedBlock
+    {
+        AlignedBlock() : data (nullptr) {}
+        void allocate (size_t numFloats);
+        float* data;
+        HeapBlock<float> memory;
+    };
+
+    /** Floats per row of a matrix with numColumns columns */
+    static int getStride (int numColumns);
+
+    static float dotProduct (const float* a, const float* b, int numPadded);
+
+    /** y = M * x, M having rows rows of stride floats */
+    static void multiply (const float* matrix, int rows, int stride, const float* x, float* y);
+
+    /** Copies a row-major double matrix into padded float storage */
+    static void storeMatrix (AlignedBlock& dest, const Array<double>& source, int rows, int columns);
+
+    Type type;
+    int numInputs;
+    int numOutputs;
+    int inputStride;
+    int outputStride;
+
+    StringArray outputNames;
+
+    AlignedBlock stateMatrix;     // S, numOutputs x numOutputs
+    AlignedBlock featureMatrix;   // F, numOutputs x numInputs
+    AlignedBlock offset;          // c
+    AlignedBlock featureMean;
+    AlignedBlock initialState;    // x0
+
+    AlignedBlock centred;         // y - featureMean
+    AlignedBlock state;
+    AlignedBlock next;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecoderModel);
+};
+
+#endif  // DECODERMODEL_H_INCLUDED
@@ -0,0 +1,383 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include <stdio.h>
+#include "PopulationDecoder.h"
+#include "PopulationDecoderEditor.h"
+
+namespace
+{
+    template <typename T>
+    void convertFeatures (const void* source, float* dest, int numValues)
+    {
+        const T* values = static_cast<const T*> (source);
+
+        for (int i = 0; i < numValues; ++i)
+            dest[i] = (float) values[i];
+    }
+}
+
+
+PopulationDecoder::PopulationDecoder()
+    : GenericProcessor      ("Population Decoder")
+    , model                 (new DecoderModel())
+    , featureSource         (FEATURES_FROM_EVENTS)
+    , binMs                 (50.0f)
+    , isActive              (false)
+    , numFeatures           (0)
+    , featureChannel        (nullptr)
+    , outputChannel         (nullptr)
+    , sampleRate            (30000.0f)
+    , binSamples            (1)
+    , currentBin            (-1)
+    , binCount              (-1)
+    , nextTimestamp         (-1)
+    , microsecondsPerTick   (1.0e6 / (double) Time::getHighResolutionTicksPerSecond())
+    , numUpdates            (0)
+    , totalMicroseconds     (0)
+    , maxMicroseconds       (0)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+PopulationDecoder::~PopulationDecoder()
+{
+}
+
+
+AudioProcessorEditor* PopulationDecoder::createEditor()
+{
+    editor = new PopulationDecoderEditor (this, true);
+
+    return editor;
+}
+
+
+String PopulationDecoder::loadModel (const File& file)
+{
+    ScopedPointer<DecoderModel> newModel = new DecoderModel();
+    String error = newModel->loadFromFile (file);
+
+    if (error.isNotEmpty())
+    {
+        std::cout << "Population Decoder: cannot load " << file.getFullPathName() << ": " << error << std::endl;
+        return "Cannot load model: " + error;
+    }
+
+    model = newModel;
+    modelFile = file;
+
+    return "Loaded " + model->getDescription() + " model " + file.getFileName();
+}
+
+
+File PopulationDecoder::getModelFile() const
+{
+    return modelFile;
+}
+
+
+String PopulationDecoder::getModelDescription() const
+{
+    return model->getDescription();
+}
+
+
+bool PopulationDecoder::isDecoding() const
+{
+    return isActive;
+}
+
+
+void PopulationDecoder::updateSettings()
+{
+    featureChannel = nullptr;
+    outputChannel = nullptr;
+    isActive = false;
+    numFeatures = 0;
+
+    if (featureSource == FEATURES_FROM_EVENTS)
+    {
+        for (int i = 0; i < eventChannelArray.size(); ++i)
+        {
+            const EventChannel::EventChannelTypes type = eventChannelArray[i]->getChannelType();
+
+            if (type >= EventChannel::INT8_ARRAY && type <= EventChannel::DOUBLE_ARRAY)
+            {
+                featureChannel = eventChannelArray[i];
+                numFeatures = featureChannel->getLength();
+                break;
+            }
+        }
+    }
+    else
+    {
+        numFeatures = dataChannelArray.size();
+    }
+
+    features.calloc ((size_t) jmax (1, numFeatures));
+    binSums.calloc ((size_t) jmax (1, numFeatures));
+
+    const int numOutputs = model->getNumOutputs();
+
+    if (numOutputs == 0 || numFeatures == 0)
+        return;
+
+    if (numFeatures != model->getNumInputs())
+    {
+        std::cout << "Population Decoder: the model expects " << model->getNumInputs()
+                  << " features, the input has " << numFeatures << std::endl;
+        return;
+    }
+
+    EventChannel* ev;
+
+    if (dataChannelArray.size() > 0)
+    {
+        sampleRate = dataChannelArray[0]->getSampleRate();
+        ev = new EventChannel (EventChannel::FLOAT_ARRAY, 1, numOutputs, dataChannelArray[0], this);
+    }
+    else
+    {
+        sampleRate = featureChannel->getSampleRate();
+        ev = new EventChannel (EventChannel::FLOAT_ARRAY, 1, numOutputs, sampleRate, this);
+    }
+
+    StringArray names;
+    for (int i = 0; i < numOutputs; ++i)
+        names.add (model->getOutputName (i));
+
+    ev->setName ("Decoded state");
+    ev->setDescription ("State decoded by a " + model->getDescription() + " model: " + names.joinIntoString (", "));
+    ev->setIdentifier ("decoder.state");
+    ev->addEventMetaData (new MetaDataDescriptor (MetaDataDescriptor::FLOAT, 1, "Compute time",
+        "Time taken by the decoder update, in microseconds", "decoder.computeTime"));
+
+    eventChannelArray.add (ev);
+    outputChannel = ev;
+    isActive = true;
+
+    applySettings();
+}
+
+
+void PopulationDecoder::applySettings()
+{
+    binSamples = jmax (1, roundFloatToInt (binMs * sampleRate / 1000.0f));
+    currentBin = -1;
+    binCount = -1;
+}
+
+
+bool PopulationDecoder::enable()
+{
+    model->reset();
+
+    numUpdates = 0;
+    totalMicroseconds = 0;
+    maxMicroseconds = 0;
+    nextTimestamp = -1;
+
+    applySettings();
+    settingsChanged = 0;
+
+    return true;
+}
+
+
+bool PopulationDecoder::disable()
+{
+    if (numUpdates > 0)
+    {
+        std::cout << "Population Decoder: " << numUpdates << " updates, "
+                  << totalMicroseconds / numUpdates << " us mean, "
+                  << maxMicroseconds << " us max" << std::endl;
+    }
+
+    return true;
+}
+
+
+void PopulationDecoder::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case FEATURE_SOURCE:
+            // changes the number of features, takes effect on the next signal chain update
+            featureSource = newValue > 0.5f ? FEATURES_FROM_CHANNELS : FEATURES_FROM_EVENTS;
+            return;
+        case BIN_MS:
+            binMs = jmax ((float) MIN_DECODER_BIN_MS, newValue);
+            break;
+        default:
+            return;
+    }
+
+    // picked up at the start of the next block
+    settingsChanged = 1;
+}
+
+
+float PopulationDecoder::getParameterValue (int parameterIndex) const
+{
+    switch (parameterIndex)
+    {
+        case FEATURE_SOURCE: return (float) featureSource;
+        case BIN_MS: return binMs;
+        default: return 0.0f;
+    }
+}
+
+
+void PopulationDecoder::decode (juce::int64 timestamp, int sampleNum)
+{
+    const juce::int64 start = Time::getHighResolutionTicks();
+
+    model->step (features);
+
+    const double microseconds = (double) (Time::getHighResolutionTicks() - start) * microsecondsPerTick;
+    numUpdates++;
+    totalMicroseconds += microseconds;
+    maxMicroseconds = jmax (maxMicroseconds, microseconds);
+
+    MetaDataValueArray metaData;
+    MetaDataValuePtr computeTime = new MetaDataValue (*outputChannel->getEventMetaDataDescriptor (0));
+    computeTime->setValue ((float) microseconds);
+    metaData.add (computeTime);
+
+    BinaryEventPtr event = BinaryEvent::createBinaryEvent (outputChannel, timestamp, model->getState(),
+                                                           model->getNumOutputs() * sizeof (float), metaData);
+    addEvent (outputChannel, event, sampleNum);
+}
+
+
+void PopulationDecoder::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition)
+{
+    if (eventInfo != featureChannel || !isActive)
+        return;
+
+    BinaryEventPtr binary = BinaryEvent::deserializeFromMessage (event, eventInfo);
+    if (binary == nullptr)
+        return;
+
+    const void* data = binary->getBinaryDataPointer();
+
+    switch (eventInfo->getChannelType())
+    {
+        case EventChannel::INT8_ARRAY: convertFeatures<int8> (data, features, numFeatures); break;
+        case EventChannel::UINT8_ARRAY: convertFeatures<uint8> (data, features, numFeatures); break;
+        case EventChannel::INT16_ARRAY: convertFeatures<int16> (data, features, numFeatures); break;
+        case EventChannel::UINT16_ARRAY: convertFeatures<uint16> (data, features, numFeatures); break;
+        case EventChannel::INT32_ARRAY: convertFeatures<int32> (data, features, numFeatures); break;
+        case EventChannel::UINT32_ARRAY: convertFeatures<uint32> (data, features, numFeatures); break;
+        case EventChannel::INT64_ARRAY: convertFeatures<int64> (data, features, numFeatures); break;
+        case EventChannel::UINT64_ARRAY: convertFeatures<uint64> (data, features, numFeatures); break;
+        case EventChannel::FLOAT_ARRAY: convertFeatures<float> (data, features, numFeatures); break;
+        case EventChannel::DOUBLE_ARRAY: convertFeatures<double> (data, features, numFeatures); break;
+        default: return;
+    }
+
+    decode (binary->getTimestamp(), samplePosition);
+}
+
+
+void PopulationDecoder::accumulateChannels (const AudioSampleBuffer& buffer)
+{
+    const juce::int64 blockStart = getTimestamp (0);
+    const int nSamples = getNumSamples (0);
+
+    // a gap in the timestamps leaves the current bin incomplete
+    if (blockStart != nextTimestamp)
+        currentBin = -1;
+
+    nextTimestamp = blockStart + nSamples;
+
+    int i = 0;
+
+    while (i < nSamples)
+    {
+        const juce::int64 timestamp = blockStart + i;
+        if (timestamp < 0)
+        {
+            i++;
+            continue;
+        }
+
+        const juce::int64 bin = timestamp / binSamples;
+        const int binEnd = (int) jmin ((juce::int64) nSamples, (bin + 1) * binSamples - blockStart);
+
+        if (bin != currentBin)
+        {
+            // bins that start before the first sample are not complete and are skipped
+            currentBin = bin;
+            binCount = timestamp % binSamples == 0 ? 0 : -1;
+
+            for (int ch = 0; ch < numFeatures; ++ch)
+                binSums[ch] = 0;
+        }
+
+        if (binCount >= 0)
+        {
+            for (int ch = 0; ch < numFeatures; ++ch)
+            {
+                const float* samples = buffer.getReadPointer (ch);
+                double sum = 0;
+
+                for (int j = i; j < binEnd; ++j)
+                    sum += samples[j];
+
+                binSums[ch] += sum;
+            }
+
+            binCount += binEnd - i;
+
+            if (binCount == binSamples)
+            {
+                for (int ch = 0; ch < numFeatures; ++ch)
+                    features[ch] = (float) (binSums[ch] / binSamples);
+
+                decode ((bin + 1) * binSamples, binEnd - 1);
+                binCount = -1;
+            }
+        }
+
+        i = binEnd;
+    }
+}
+
+
+void PopulationDecoder::process (AudioSampleBuffer& buffer)
+{
+    if (settingsChanged.compareAndSetBool (0, 1))
+        applySettings();
+
+    if (!isActive)
+        return;
+
+    if (featureSource == FEATURES_FROM_EVENTS)
+        checkForEvents();
+    else
+        accumulateChannels (buffer);
+}
@@ -0,0 +1,144 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef POPULATIONDECODER_H_INCLUDED
+#define POPULATIONDECODER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+#include "DecoderModel.h"
+
+/** Narrowest bin when the features are averaged from the input channels */
+#define MIN_DECODER_BIN_MS 1
+
+/**
+
+    Runs a linear or Kalman-filter decoder on population features inside the
+    signal chain, so closed-loop experiments do not have to ship the features
+    to an external process and wait for the answer.
+
+    The features are either the numeric array events of an upstream
+    processor, such as the count vectors of the Spike Binner (the first such
+    event channel of the input is used), or the input channels averaged over
+    bins aligned to the timestamps of the first channel, such as the
+    envelopes of the Band Power processor. Each feature vector is decoded as
+    soon as it arrives, and the decoded state is sent as a float array event
+    at the same sample and with the same timestamp, in the same block.
+
+    Every event carries the time the update took, in microseconds, as
+    metadata; the mean and maximum are printed when acquisition stops.
+
+    The model is read from a JSON file (see DecoderModel) while acquisition
+    is stopped, and the decoder only runs if its number of features matches
+    the input.
+
+    @see GenericProcessor, PopulationDecoderEditor, DecoderModel
+*/
+class PopulationDecoder : public GenericProcessor
+{
+public:
+    PopulationDecoder();
+    ~PopulationDecoder();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int samplePosition) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+    bool disable() override;
+
+    enum FeatureSource
+    {
+        FEATURES_FROM_EVENTS = 0,
+        FEATURES_FROM_CHANNELS
+    };
+
+    enum Parameters
+    {
+        FEATURE_SOURCE = 0,
+        BIN_MS
+    };
+
+    float getParameterValue (int parameterIndex) const;
+
+    /** Reads a model file, to be called while acquisition is stopped.
+        Returns a status message. */
+    String loadModel (const File& file);
+
+    File getModelFile() const;
+    String getModelDescription() const;
+
+    /** Returns true if the model matches the features of the input */
+    bool isDecoding() const;
+
+private:
+    /** Recomputes the bin length and drops the current bin.
+        Does not allocate, so process() can call it between blocks. */
+    void applySettings();
+
+    /** Averages the input channels over bins, decoding every bin that completes */
+    void accumulateChannels (const AudioSampleBuffer& buffer);
+
+    /** Runs the model on the feature vector and sends the decoded state */
+    void decode (juce::int64 timestamp, int sampleNum);
+
+    ScopedPointer<DecoderModel> model;
+    File modelFile;
+
+    FeatureSource featureSource;
+    float binMs;
+
+    bool isActive;
+    int numFeatures;
+    HeapBlock<float> features;
+
+    const EventChannel* featureChannel;
+    const EventChannel* outputChannel;
+
+    // bins of the input channels
+    float sampleRate;
+    int binSamples;
+    juce::int64 currentBin;
+    int binCount;
+    juce::int64 nextTimestamp;
+    HeapBlock<double> binSums;
+
+    // compute time of the updates
+    double microsecondsPerTick;
+    juce::int64 numUpdates;
+    double totalMicroseconds;
+    double maxMicroseconds;
+
+    Atomic<int> settingsChanged;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PopulationDecoder);
+};
+
+#endif  // POPULATIONDECODER_H_INCLUDED
@@ -0,0 +1,209 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "PopulationDecoderEditor.h"
+#include "PopulationDecoder.h"
+
+
+PopulationDecoderEditor::PopulationDecoderEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+{
+    desiredWidth = 170;
+
+    addLabel ("Model:", 10, 25, 60);
+
+    modelLabel = new Label ("Model", "No model");
+    modelLabel->setBounds (10, 45, 150, 20);
+    modelLabel->setFont (Font ("Default", 15, Font::plain));
+    modelLabel->setColour (Label::textColourId, Colours::white);
+    modelLabel->setColour (Label::backgroundColourId, Colours::grey);
+    addAndMakeVisible (modelLabel);
+
+    loadButton = new UtilityButton ("LOAD", Font ("Default", 10, Font::plain));
+    loadButton->addListener (this);
+    loadButton->setBounds (110, 25, 50, 18);
+    loadButton->setTooltip ("Load a linear or Kalman model from a JSON file");
+    addAndMakeVisible (loadButton);
+
+    channelsButton = new UtilityButton ("CH", Font ("Default", 10, Font::plain));
+    channelsButton->addListener (this);
+    channelsButton->setBounds (10, 73, 40, 18);
+    channelsButton->setClickingTogglesState (true);
+    channelsButton->setTooltip ("When this button is on, the features are the input channels averaged over bins; "
+                                "otherwise they are the first array event channel of the input");
+    addAndMakeVisible (channelsButton);
+
+    addLabel ("Bin:", 60, 71, 40);
+
+    binValue = new Label ("Bin", String (PopulationDecoder::BIN_MS));
+    binValue->setBounds (100, 73, 45, 18);
+    binValue->setFont (Font ("Default", 15, Font::plain));
+    binValue->setColour (Label::textColourId, Colours::white);
+    binValue->setColour (Label::backgroundColourId, Colours::grey);
+    binValue->setEditable (true);
+    binValue->addListener (this);
+    binValue->setTooltip ("Width of the bins the input channels are averaged over, in ms");
+    binValue->setText (String (((PopulationDecoder*) getProcessor())->getParameterValue (PopulationDecoder::BIN_MS)), dontSendNotification);
+    addAndMakeVisible (binValue);
+}
+
+
+PopulationDecoderEditor::~PopulationDecoderEditor()
+{
+}
+
+
+Label* PopulationDecoderEditor::addLabel (const String& text, int x, int y, int width)
+{
+    Label* label = new Label (text, text);
+    label->setBounds (x, y, width, 20);
+    label->setFont (Font ("Small Text", 12, Font::plain));
+    label->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (label);
+    labels.add (label);
+
+    return label;
+}
+
+
+void PopulationDecoderEditor::updateModelLabel()
+{
+    PopulationDecoder* processor = (PopulationDecoder*) getProcessor();
+
+    modelLabel->setText (processor->getModelDescription(), dontSendNotification);
+    modelLabel->setColour (Label::backgroundColourId,
+                           processor->getModelFile() == File() || processor->isDecoding() ? Colours::grey : Colours::darkred);
+    modelLabel->setTooltip (processor->getModelFile().getFullPathName());
+}
+
+
+void PopulationDecoderEditor::updateSettings()
+{
+    updateModelLabel();
+}
+
+
+void PopulationDecoderEditor::loadModel (const File& file)
+{
+    PopulationDecoder* processor = (PopulationDecoder*) getProcessor();
+
+    CoreServices::sendStatusMessage (processor->loadModel (file));
+    CoreServices::updateSignalChain (this);
+
+    if (processor->getModelFile() != File() && !processor->isDecoding())
+        CoreServices::sendStatusMessage ("The model does not match the features of the input.");
+
+    updateModelLabel();
+}
+
+
+void PopulationDecoderEditor::labelTextChanged (Label* label)
+{
+    if (label != binValue)
+        return;
+
+    PopulationDecoder* processor = (PopulationDecoder*) getProcessor();
+    float requestedValue = label->getText().getFloatValue();
+
+    if (requestedValue < MIN_DECODER_BIN_MS)
+        CoreServices::sendStatusMessage ("Value out of range.");
+    else
+        processor->setParameter (PopulationDecoder::BIN_MS, requestedValue);
+
+    label->setText (String (processor->getParameterValue (PopulationDecoder::BIN_MS)), dontSendNotification);
+}
+
+
+void PopulationDecoderEditor::buttonEvent (Button* button)
+{
+    PopulationDecoder* processor = (PopulationDecoder*) getProcessor();
+
+    if (button == loadButton)
+    {
+        // the model sets the outputs of the processor, so it can only change between acquisitions
+        if (CoreServices::getAcquisitionStatus())
+        {
+            CoreServices::sendStatusMessage ("Stop acquisition before loading a model.");
+            return;
+        }
+
+        FileChooser fc ("Choose a decoder model...",
+                        CoreServices::getDefaultUserSaveDirectory(),
+                        "*.json",
+                        true);
+
+        if (fc.browseForFileToOpen())
+            loadModel (fc.getResult());
+    }
+    else if (button == channelsButton)
+    {
+        if (CoreServices::getAcquisitionStatus())
+        {
+            CoreServices::sendStatusMessage ("Cannot change the features during acquisition.");
+            channelsButton->setToggleState (processor->getParameterValue (PopulationDecoder::FEATURE_SOURCE) > 0.5f, dontSendNotification);
+            return;
+        }
+
+        processor->setParameter (PopulationDecoder::FEATURE_SOURCE, button->getToggleState() ? 1.0f : 0.0f);
+        CoreServices::updateSignalChain (this);
+    }
+}
+
+
+void PopulationDecoderEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "PopulationDecoderEditor");
+
+    PopulationDecoder* processor = (PopulationDecoder*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("VALUES");
+    settings->setAttribute ("ModelFile", processor->getModelFile().getFullPathName());
+    settings->setAttribute ("ChannelFeatures", channelsButton->getToggleState());
+    settings->setAttribute ("BinMs", processor->getParameterValue (PopulationDecoder::BIN_MS));
+}
+
+
+void PopulationDecoderEditor::loadCustomParameters (XmlElement* xml)
+{
+    PopulationDecoder* processor = (PopulationDecoder*) getProcessor();
+
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("VALUES"))
+        {
+            processor->setParameter (PopulationDecoder::BIN_MS, xmlNode->getDoubleAttribute ("BinMs", processor->getParameterValue (PopulationDecoder::BIN_MS)));
+
+            const bool channelFeatures = xmlNode->getBoolAttribute ("ChannelFeatures", false);
+            channelsButton->setToggleState (channelFeatures, dontSendNotification);
+            processor->setParameter (PopulationDecoder::FEATURE_SOURCE, channelFeatures ? 1.0f : 0.0f);
+
+            const String path = xmlNode->getStringAttribute ("ModelFile");
+            if (path.isNotEmpty())
+                CoreServices::sendStatusMessage (processor->loadModel (File (path)));
+        }
+    }
+
+    binValue->setText (String (processor->getParameterValue (PopulationDecoder::BIN_MS)), dontSendNotification);
+    updateModelLabel();
+}
@@ -0,0 +1,76 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef POPULATIONDECODEREDITOR_H_INCLUDED
+#define POPULATIONDECODEREDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the PopulationDecoder processor.
+
+  Loads the model file, and chooses between event and channel features and
+  the bin width of the latter.
+
+  @see PopulationDecoder
+
+*/
+
+class PopulationDecoderEditor : public GenericEditor,
+    public Label::Listener
+{
+public:
+    PopulationDecoderEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~PopulationDecoderEditor();
+
+    void buttonEvent (Button* button) override;
+    void labelTextChanged (Label* label) override;
+
+    void updateSettings() override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    Label* addLabel (const String& text, int x, int y, int width);
+
+    /** Loads a model and updates the signal chain for its outputs */
+    void loadModel (const File& file);
+
+    /** Shows the model and whether it matches the input */
+    void updateModelLabel();
+
+    OwnedArray<Label> labels;
+
+    ScopedPointer<Label> modelLabel;
+    ScopedPointer<Label> binValue;
+
+    ScopedPointer<UtilityButton> loadButton;
+    ScopedPointer<UtilityButton> channelsButton;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PopulationDecoderEditor);
+};
+
+#endif  // POPULATIONDECODEREDITOR_H_INCLUDED
@@ -0,0 +1,97 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ImpedanceDemodulator.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace RhythmNode;
+
+#define TWO_PI  6.28318530718
+
+void ImpedanceDemodulator::loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue, int numDataStreams,
+    int samplesPerBlock, int chipChannel, float* dest)
+{
+    int indexAmp = 0;
+
+    while (!dataQueue.empty())
+    {
+        const vector<vector<vector<int> > >& amplifierData = dataQueue.front().amplifierData;
+
+        for (int t = 0; t < samplesPerBlock; ++t)
+        {
+            for (int stream = 0; stream < numDataStreams; ++stream)
+            {
+                // Amplifier waveform units = microvolts
+                dest[indexAmp * numDataStreams + stream] = 0.195f * (amplifierData[stream][chipChannel][t] - 32768);
+            }
+            ++indexAmp;
+        }
+        // We are done with this Rhd2000DataBlock object; remove it from dataQueue
+        dataQueue.pop();
+    }
+}
+
+void ImpedanceDemodulator::amplitudeOfFreqComponent(double* realComponents, double* imagComponents,
+    const float* data, int numStreams, int startIndex,
+    int endIndex, double sampleRate, double frequency)
+{
+    int length = endIndex - startIndex + 1;
+    const double k = TWO_PI * frequency / sampleRate;  // precalculate for speed
+    const double coeff = 2.0 * cos(k);
+
+    // Goertzel recurrence s[n] = x[n] + 2 cos(k) s[n-1] - s[n-2], one state per
+    // stream so the inner loop runs over contiguous samples
+    vector<double> s1(numStreams, 0.0);
+    vector<double> s2(numStreams, 0.0);
+
+    for (int t = startIndex; t <= endIndex; ++t)
+    {
+        const float* x = data + t * numStreams;
+        for (int stream = 0; stream < numStreams; ++stream)
+        {
+            const double s0 = x[stream] + coeff * s1[stream] - s2[stream];
+            s2[stream] = s1[stream];
+            s1[stream] = s0;
+        }
+    }
+
+    // sum of x[t] exp(-jkt) = exp(-jk endIndex) (s[N-1] - exp(-jk) s[N-2])
+    const double cosK = cos(k);
+    const double sinK = sin(k);
+    const double cosEnd = cos(k * endIndex);
+    const double sinEnd = sin(k * endIndex);
+
+    for (int stream = 0; stream < numStreams; ++stream)
+    {
+        const double yRe = s1[stream] - cosK * s2[stream];
+        const double yIm = sinK * s2[stream];
+
+        const double meanI = (cosEnd * yRe + sinEnd * yIm) / (double)length;
+        const double meanQ = (cosEnd * yIm - sinEnd * yRe) / (double)length;
+
+        realComponents[stream] = 2.0 * meanI;
+        imagComponents[stream] = 2.0 * meanQ;
+    }
+}
@@ -0,0 +1,57 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef __IMPEDANCEDEMODULATOR_H__
+#define __IMPEDANCEDEMODULATOR_H__
+
+#include <fstream>
+#include <queue>
+
+#include "rhythm-api/rhd2000datablock.h"
+
+namespace RhythmNode
+{
+	/**
+		Signal processing of the impedance measurement, apart from the board
+		control so it can be run on simulated data blocks.
+
+		@see RHDImpedanceMeasure
+	*/
+	class ImpedanceDemodulator
+	{
+	public:
+		/** Converts one amplifier channel of every stream to microvolts, interleaved by stream,
+			so the demodulator can process all streams with each sample. Empties the queue. */
+		static void loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue, int numDataStreams,
+			int samplesPerBlock, int chipChannel, float* dest);
+
+		/** Returns the real and imaginary amplitudes of the test frequency for every stream,
+			between a start and an end index. data holds numStreams interleaved streams.
+			Phases are referenced to sample 0, as a correlation with cos(k t) and -sin(k t) would be. */
+		static void amplitudeOfFreqComponent(double* realComponents, double* imagComponents,
+			const float* data, int numStreams, int startIndex,
+			int endIndex, double sampleRate, double frequency);
+	};
+};
+
+#endif  // __IMPEDANCEDEMODULATOR_H__
@@ -49,24 +49,6 @@ using namespace RhythmNode;
 
 #define INIT_STEP ( evalBoard->isUSB3() ? 256 : 60)
 
-// Allocates memory for a 3-D array of doubles.
-void allocateDoubleArray3D(std::vector<std::vector<std::vector<double> > >& array3D,
-                           int xSize, int ySize, int zSize)
-{
-    int i, j;
-
-    if (xSize == 0) return;
-    array3D.resize(xSize);
-    for (i = 0; i < xSize; ++i)
-    {
-        array3D[i].resize(ySize);
-        for (j = 0; j < ySize; ++j)
-        {
-            array3D[i][j].resize(zSize);
-        }
-    }
-}
-
 DataThread* RHD2000Thread::createDataThread(SourceNode *sn)
 {
     return new RHD2000Thread(sn);
@@ -1455,6 +1437,14 @@ bool RHD2000Thread::startAcquisition()
     blockSize = dataBlock->calculateDataBlockSizeInWords(evalBoard->getNumEnabledDataStreams(), evalBoard->isUSB3());
     std::cout << "Expecting blocksize of " << blockSize << " for " << evalBoard->getNumEnabledDataStreams() << " streams" << std::endl;
     //evalBoard->printFIFOmetrics();
+
+    // headstage and aux channels stay as the words of the chip until the source node reads them
+    Array<float> rawBitVolts;
+    rawBitVolts.insertMultiple(-1, 0.195f, getNumDataOutputs(DataChannel::HEADSTAGE_CHANNEL, 0));
+    rawBitVolts.insertMultiple(-1, 0.0000374f, getNumDataOutputs(DataChannel::AUX_CHANNEL, 0));
+    rawBitVolts.insertMultiple(-1, 0.0f, getNumDataOutputs(DataChannel::ADC_CHANNEL, 0));
+    sourceBuffers[0]->setRawChannels(rawBitVolts);
+
     startThread();
 
 
@@ -1563,7 +1553,7 @@ bool RHD2000Thread::updateBuffer()
                 for (int chan = 0; chan < nChans; chan++)
                 {
                     channel++;
-                    thisSample[channel] = float(*(uint16*)(bufferPtr + chanIndex) - 32768)*0.195f;
+                    thisRawSample[channel] = int16(*(uint16*)(bufferPtr + chanIndex) - 32768);
                     chanIndex += 2*numStreams; // single chan width (2 bytes)
                 }
             }
@@ -1579,7 +1569,7 @@ bool RHD2000Thread::updateBuffer()
                         int auxNum = (samp+3) % 4;
                         if (auxNum < 3)
                         {
-                            auxSamples[dataStream][auxNum] = float(*(uint16*)(bufferPtr + auxIndex) - 32768)*0.0000374;
+                            auxSamples[dataStream][auxNum] = int16(*(uint16*)(bufferPtr + auxIndex) - 32768);
                         }
                         for (int chan = 0; chan < 3; chan++)
                         {
@@ -1588,7 +1578,7 @@ bool RHD2000Thread::updateBuffer()
                             {
                                 auxBuffer[channel] = auxSamples[dataStream][chan];
                             }
-                            thisSample[channel] = auxBuffer[channel];
+                            thisRawSample[channel] = auxBuffer[channel];
                         }
                     }
                     auxIndex += 2; // single chan width (2 bytes)
@@ -1616,7 +1606,7 @@ bool RHD2000Thread::updateBuffer()
             }
             ttlEventWords.set(0, *(uint16*)(bufferPtr + index));
             index += 4;
-            sourceBuffers[0]->addToBuffer(thisSample, &timestamps.getReference(0), &ttlEventWords.getReference(0), 1);
+            sourceBuffers[0]->addToBuffer(thisRawSample, thisSample, &timestamps.getReference(0), &ttlEventWords.getReference(0), 1);
         }
 
     }
@@ -1868,12 +1858,51 @@ bool RHDHeadstage::isPlugged() const
 /***********************************/
 /* Below is code for impedance measurements */
 
-RHDImpedanceMeasure::RHDImpedanceMeasure(RHD2000Thread* b) : Thread(""), data(nullptr), board(b)
+/** Demodulates the data of one channel on the worker pool */
+class RHDImpedanceMeasure::ChannelJob : public ThreadPoolJob
+{
+public:
+    ChannelJob(RHDImpedanceMeasure& m, queue<Rhd2000DataBlock>& blocks, int cap, int channel, bool rhd2164)
+        : ThreadPoolJob("Impedance channel"), measure(m), capIndex(cap), chipChannel(channel), rhd2164Pass(rhd2164)
+    {
+        dataQueue.swap(blocks);
+    }
+
+    JobStatus runJob() override
+    {
+        if (!shouldExit())
+        {
+            HeapBlock<float> samples(measure.numDataStreams * measure.samplesPerBlock * measure.numBlocks);
+            ImpedanceDemodulator::loadAmplifierData(dataQueue, measure.numDataStreams, measure.samplesPerBlock, chipChannel, samples);
+            measure.measureComplexAmplitude(samples, capIndex, chipChannel, rhd2164Pass);
+        }
+
+        --measure.pendingJobs;
+        measure.jobFinished.signal();
+        return jobHasFinished;
+    }
+
+private:
+    RHDImpedanceMeasure& measure;
+    queue<Rhd2000DataBlock> dataQueue;
+    int capIndex;
+    int chipChannel;
+    bool rhd2164Pass;
+};
+
+RHDImpedanceMeasure::RHDImpedanceMeasure(RHD2000Thread* b) : Thread(""),
+    numDataStreams(0),
+    numBlocks(0),
+    samplesPerBlock(0),
+    windowStart(0),
+    windowEnd(0),
+    measureFrequency(0),
+    workers(jlimit(1, 4, SystemStats::getNumCpus() - 1)),
+    pendingJobs(0),
+    jobFinished(false),
+    data(nullptr),
+    board(b)
 {
-    // to perform electrode impedance measurements at very low frequencies.
-    const int maxNumBlocks = 120;
-    int numStreams = 8;
-    allocateDoubleArray3D(amplifierPreFilter, numStreams, 32, MAX_SAMPLES_PER_DATA_BLOCK * maxNumBlocks);
 }
 
 RHDImpedanceMeasure::~RHDImpedanceMeasure()
@@ -1891,6 +1920,7 @@ void RHDImpedanceMeasure::stopThreadSafely()
             std::cerr << "ERROR: Impedance measurement thread did not exit. Force killed it. This might led to crashes." << std::endl;
         }
     }
+    workers.removeAllJobs(true, 3000);
 }
 
 void RHDImpedanceMeasure::waitSafely()
@@ -1957,117 +1987,42 @@ float RHDImpedanceMeasure::updateImpedanceFrequency(float desiredImpedanceFreq,
 }
 
 
-// Reads numBlocks blocks of raw USB data stored in a queue of Rhd2000DataBlock
-// objects, loads this data into this SignalProcessor object, scaling the raw
-// data to generate waveforms with units of volts or microvolts.
-int RHDImpedanceMeasure::loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
-    int numBlocks, int numDataStreams)
-{
-
-    int block, t, channel, stream;
-    int indexAmp = 0;
-    /*
-    int indexAux = 0;
-    int indexSupply = 0;
-    int indexAdc = 0;
-    int indexDig = 0;
-    int numWordsWritten = 0;
-
-    int bufferIndex;
-    int16 tempQint16;
-    uint16 tempQuint16;
-    int32 tempQint32;
-
-    bool triggerFound = false;
-    const double AnalogTriggerThreshold = 1.65;
-     */
-
-
-    for (block = 0; block < numBlocks; ++block)
-    {
-
-        // Load and scale RHD2000 amplifier waveforms
-        // (sampled at amplifier sampling rate)
-        for (t = 0; t < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()); ++t)
-        {
-            for (channel = 0; channel < 32; ++channel)
-            {
-                for (stream = 0; stream < numDataStreams; ++stream)
-                {
-                    // Amplifier waveform units = microvolts
-                    amplifierPreFilter[stream][channel][indexAmp] = 0.195 *
-                        (dataQueue.front().amplifierData[stream][channel][t] - 32768);
-                }
-            }
-            ++indexAmp;
-        }
-        // We are done with this Rhd2000DataBlock object; remove it from dataQueue
-        dataQueue.pop();
-    }
-
-    return 0;
-}
-
 #define PI  3.14159265359
 #define TWO_PI  6.28318530718
 #define DEGREES_TO_RADIANS  0.0174532925199
 #define RADIANS_TO_DEGREES  57.2957795132
 
-// Return the magnitude and phase (in degrees) of a selected frequency component (in Hz)
-// for a selected amplifier channel on the selected USB data stream.
-void RHDImpedanceMeasure::measureComplexAmplitude(std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
-    std::vector<std::vector<std::vector<double>>>& measuredPhase,
-    int capIndex, int stream, int chipChannel, int numBlocks,
-    double sampleRate, double frequency, int numPeriods)
+int RHDImpedanceMeasure::getMeasurementIndex(int stream, int channel, int capIndex) const
 {
-    int period = (sampleRate / frequency);
-    int startIndex = 0;
-    int endIndex = startIndex + numPeriods * period - 1;
-
-    // Move the measurement window to the end of the waveform to ignore start-up transient.
-    while (endIndex < SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3()) * numBlocks - period)
-    {
-        startIndex += period;
-        endIndex += period;
-    }
-
-    double iComponent, qComponent;
-
-    // Measure real (iComponent) and imaginary (qComponent) amplitude of frequency component.
-    amplitudeOfFreqComponent(iComponent, qComponent, amplifierPreFilter[stream][chipChannel],
-        startIndex, endIndex, sampleRate, frequency);
-    // Calculate magnitude and phase from real (I) and imaginary (Q) components.
-    measuredMagnitude[stream][chipChannel][capIndex] =
-        sqrt(iComponent * iComponent + qComponent * qComponent);
-    measuredPhase[stream][chipChannel][capIndex] =
-        RADIANS_TO_DEGREES *atan2(qComponent, iComponent);
+    return (stream * 32 + channel) * 3 + capIndex;
 }
 
-// Returns the real and imaginary amplitudes of a selected frequency component in the vector
-// data, between a start index and end index.
-void RHDImpedanceMeasure::amplitudeOfFreqComponent(double& realComponent, double& imagComponent,
-    const std::vector<double>& data, int startIndex,
-    int endIndex, double sampleRate, double frequency)
+// Stores the magnitude and phase (in degrees) of the test frequency component
+// for a selected amplifier channel on every matching data stream.
+void RHDImpedanceMeasure::measureComplexAmplitude(const float* samples, int capIndex, int chipChannel, bool rhd2164Pass)
 {
-    int length = endIndex - startIndex + 1;
-    const double k = TWO_PI * frequency / sampleRate;  // precalculate for speed
+    HeapBlock<double> iComponents(numDataStreams);
+    HeapBlock<double> qComponents(numDataStreams);
 
-    // Perform correlation with sine and cosine waveforms.
-    double meanI = 0.0;
-    double meanQ = 0.0;
-    for (int t = startIndex; t <= endIndex; ++t)
-    {
-        meanI += data.at(t) * cos(k * t);
-        meanQ += data.at(t) * -1.0 * sin(k * t);
-    }
-    meanI /= (double)length;
-    meanQ /= (double)length;
+    // Measure real (iComponent) and imaginary (qComponent) amplitude of frequency component.
+    ImpedanceDemodulator::amplitudeOfFreqComponent(iComponents, qComponents, samples, numDataStreams,
+        windowStart, windowEnd, board->boardSampleRate, measureFrequency);
 
-    realComponent = 2.0 * meanI;
-    imagComponent = 2.0 * meanQ;
-}
+    for (int stream = 0; stream < numDataStreams; ++stream)
+    {
+        // the second pass of an RHD2164 only addresses its upper 32 channels
+        if ((board->chipId[stream] == CHIP_ID_RHD2164_B) != rhd2164Pass)
+            continue;
 
+        const double iComponent = iComponents[stream];
+        const double qComponent = qComponents[stream];
+        const int index = getMeasurementIndex(stream, chipChannel, capIndex);
 
+        // Calculate magnitude and phase from real (I) and imaginary (Q) components.
+        measuredMagnitude[index] = sqrt(iComponent * iComponent + qComponent * qComponent);
+        measuredPhase[index] = RADIANS_TO_DEGREES * atan2(qComponent, iComponent);
+    }
+}
 
 // Given a measured complex impedance that is the result of an electrode impedance in parallel
 // with a parasitic capacitance (i.e., due to the amplifier input capacitance and other
@@ -2119,11 +2074,60 @@ void RHDImpedanceMeasure::run()
     if (data == nullptr)
         return;
     runImpedanceMeasurement();
+    // nothing may still be writing the results if the measurement was interrupted
+    workers.removeAllJobs(true, 3000);
     restoreFPGA();
     ed->triggerAsyncUpdate();
     data = nullptr;
 }
 
+bool RHDImpedanceMeasure::waitForBoard(int numSamples)
+{
+    // sleep for the time the board needs instead of polling the USB status
+    wait(int(1000.0 * numSamples / board->boardSampleRate));
+
+    while (board->evalBoard->isRunning())
+    {
+        if (threadShouldExit())
+            return false;
+        wait(1);
+    }
+    return true;
+}
+
+bool RHDImpedanceMeasure::waitForJobs()
+{
+    while (pendingJobs.get() > 0)
+    {
+        if (threadShouldExit())
+            return false;
+        jobFinished.wait(100);
+    }
+    return true;
+}
+
+bool RHDImpedanceMeasure::acquireChannel(int capIndex, int chipChannel, bool rhd2164Pass)
+{
+    vector<int> commandList;
+
+    board->chipRegisters.setZcheckChannel(rhd2164Pass ? chipChannel + 32 : chipChannel);
+    board->chipRegisters.createCommandListRegisterConfig(commandList, false);
+    // Upload version with no ADC calibration to AuxCmd3 RAM Bank 1.
+    board->evalBoard->uploadCommandList(commandList, Rhd2000EvalBoard::AuxCmd3, 3);
+
+    board->evalBoard->run();
+    if (!waitForBoard(samplesPerBlock * numBlocks))
+        return false;
+
+    queue<Rhd2000DataBlock> dataQueue;
+    board->evalBoard->readDataBlocks(numBlocks, dataQueue);
+
+    // demodulate in the background while the board acquires the next channel
+    ++pendingJobs;
+    workers.addJob(new ChannelJob(*this, dataQueue, capIndex, chipChannel, rhd2164Pass), true);
+    return true;
+}
+
 #define CHECK_EXIT if (threadShouldExit()) return
 
 void RHDImpedanceMeasure::runImpedanceMeasurement()
@@ -2131,9 +2135,9 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
     int commandSequenceLength, stream, channel, capRange;
     double cSeries;
     vector<int> commandList;
-    //int triggerIndex;                       // dummy reference variable; not used
-    queue<Rhd2000DataBlock> bufferQueue;    // dummy reference variable; not used
-    int numdataStreams = board->evalBoard->getNumEnabledDataStreams();
+    pendingJobs.set(0);
+    numDataStreams = board->evalBoard->getNumEnabledDataStreams();
+    samplesPerBlock = SAMPLES_PER_DATA_BLOCK(board->evalBoard->isUSB3());
 
     bool rhd2164ChipPresent = false;
     int chOffset;
@@ -2183,9 +2187,20 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
     int numPeriods = (0.020 * actualImpedanceFreq); // Test each channel for at least 20 msec...
     if (numPeriods < 5) numPeriods = 5; // ...but always measure across no fewer than 5 complete periods
     double period = board->boardSampleRate / actualImpedanceFreq;
-    int numBlocks = ceil((numPeriods + 2.0) * period / 60.0);  // + 2 periods to give time to settle initially
+    numBlocks = ceil((numPeriods + 2.0) * period / 60.0);  // + 2 periods to give time to settle initially
     if (numBlocks < 2) numBlocks = 2;   // need first block for command to switch channels to take effect.
 
+    // Move the measurement window to the end of the waveform to ignore start-up transient.
+    const int intPeriod = int(period);
+    windowStart = 0;
+    windowEnd = windowStart + numPeriods * intPeriod - 1;
+    while (windowEnd < samplesPerBlock * numBlocks - intPeriod)
+    {
+        windowStart += intPeriod;
+        windowEnd += intPeriod;
+    }
+    measureFrequency = actualImpedanceFreq;
+
     CHECK_EXIT;
     board->actualDspCutoffFreq = board->chipRegisters.setDspCutoffFreq(board->desiredDspCutoffFreq);
     board->actualLowerBandwidth = board->chipRegisters.setLowerBandwidth(board->desiredLowerBandwidth);
@@ -2208,23 +2223,8 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
 
     // Create matrices of doubles of size (numStreams x 32 x 3) to store complex amplitudes
     // of all amplifier channels (32 on each data stream) at three different Cseries values.
-    std::vector<std::vector<std::vector<double>>>  measuredMagnitude;
-    std::vector<std::vector<std::vector<double>>>  measuredPhase;
-
-    measuredMagnitude.resize(board->evalBoard->getNumEnabledDataStreams());
-    measuredPhase.resize(board->evalBoard->getNumEnabledDataStreams());
-    for (int i = 0; i < board->evalBoard->getNumEnabledDataStreams(); ++i)
-    {
-        measuredMagnitude[i].resize(32);
-        measuredPhase[i].resize(32);
-        for (int j = 0; j < 32; ++j)
-        {
-            measuredMagnitude[i][j].resize(3);
-            measuredPhase[i][j].resize(3);
-        }
-    }
-
-
+    measuredMagnitude.calloc(numDataStreams * 32 * 3);
+    measuredPhase.calloc(numDataStreams * 32 * 3);
 
     double distance, minDistance, current, Cseries;
     double impedanceMagnitude, impedancePhase;
@@ -2269,62 +2269,19 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
             CHECK_EXIT;
             cout << "running impedance on channel " << channel << endl;
 
-            board->chipRegisters.setZcheckChannel(channel);
-            commandSequenceLength =
-                board->chipRegisters.createCommandListRegisterConfig(commandList, false);
-            // Upload version with no ADC calibration to AuxCmd3 RAM Bank 1.
-            board->evalBoard->uploadCommandList(commandList, Rhd2000EvalBoard::AuxCmd3, 3);
-
-            board->evalBoard->run();
-            while (board->evalBoard->isRunning())
-            {
-
-            }
-            queue<Rhd2000DataBlock> dataQueue;
-            board->evalBoard->readDataBlocks(numBlocks, dataQueue);
-            loadAmplifierData(dataQueue, numBlocks, numdataStreams);
-            for (stream = 0; stream < numdataStreams; ++stream)
-            {
-                if (board->chipId[stream] != CHIP_ID_RHD2164_B)
-                {
-                    measureComplexAmplitude(measuredMagnitude, measuredPhase,
-                        capRange, stream, channel, numBlocks, board->boardSampleRate,
-                        actualImpedanceFreq, numPeriods);
-                }
-            }
+            if (!acquireChannel(capRange, channel, false))
+                return;
 
             // If an RHD2164 chip is plugged in, we have to set the Zcheck select register to channels 32-63
             // and repeat the previous steps.
-            if (rhd2164ChipPresent)
-            {
-                CHECK_EXIT;
-                board->chipRegisters.setZcheckChannel(channel + 32); // address channels 32-63
-                commandSequenceLength =
-                    board->chipRegisters.createCommandListRegisterConfig(commandList, false);
-                // Upload version with no ADC calibration to AuxCmd3 RAM Bank 1.
-                board->evalBoard->uploadCommandList(commandList, Rhd2000EvalBoard::AuxCmd3, 3);
-
-                board->evalBoard->run();
-                while (board->evalBoard->isRunning())
-                {
-
-                }
-                board->evalBoard->readDataBlocks(numBlocks, dataQueue);
-                loadAmplifierData(dataQueue, numBlocks, numdataStreams);
-
-                for (stream = 0; stream < board->evalBoard->getNumEnabledDataStreams(); ++stream)
-                {
-                    if (board->chipId[stream] == CHIP_ID_RHD2164_B)
-                    {
-                        measureComplexAmplitude(measuredMagnitude, measuredPhase,
-                            capRange, stream, channel, numBlocks, board->boardSampleRate,
-                            actualImpedanceFreq, numPeriods);
-                    }
-                }
-            }
+            if (rhd2164ChipPresent && !acquireChannel(capRange, channel, true))
+                return;
         }
     }
 
+    if (!waitForJobs())
+        return;
+
     data->streams.clear();
     data->channels.clear();
     data->magnitudes.clear();
@@ -2345,7 +2302,7 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
                 for (capRange = 0; capRange < 3; ++capRange)
                 {
                     // Find the measured amplitude that is closest to bestAmplitude on a logarithmic scale
-                    distance = abs(log(measuredMagnitude[stream][channel+chOffset][capRange] / bestAmplitude));
+                    distance = abs(log(measuredMagnitude[getMeasurementIndex(stream, channel + chOffset, capRange)] / bestAmplitude));
                     if (distance < minDistance)
                     {
                         bestAmplitudeIndex = capRange;
@@ -2369,12 +2326,12 @@ void RHDImpedanceMeasure::runImpedanceMeasurement()
                 current = TWO_PI * actualImpedanceFreq * dacVoltageAmplitude * Cseries;
 
                 // Calculate impedance magnitude from calculated current and measured voltage.
-                impedanceMagnitude = 1.0e-6 * (measuredMagnitude[stream][channel + chOffset][bestAmplitudeIndex] / current) *
+                impedanceMagnitude = 1.0e-6 * (measuredMagnitude[getMeasurementIndex(stream, channel + chOffset, bestAmplitudeIndex)] / current) *
                     (18.0 * relativeFreq * relativeFreq + 1.0);
 
                 // Calculate impedance phase, with small correction factor accounting for the
                 // 3-command SPI pipeline delay.
-                impedancePhase = measuredPhase[stream][channel + chOffset][bestAmplitudeIndex] + (360.0 * (3.0 / period));
+                impedancePhase = measuredPhase[getMeasurementIndex(stream, channel + chOffset, bestAmplitudeIndex)] + (360.0 * (3.0 / period));
 
                 // Factor out on-chip parasitic capacitance from impedance measurement.
                 factorOutParallelCapacitance(impedanceMagnitude, impedancePhase, actualImpedanceFreq,
@@ -35,6 +35,7 @@
 #include "rhythm-api/rhd2000registers.h"
 #include "rhythm-api/rhd2000datablock.h"
 #include "rhythm-api/okFrontPanelDLL.h"
+#include "ImpedanceDemodulator.h"
 
 #define MAX_NUM_DATA_STREAMS_USB2 8
 #define MAX_NUM_DATA_STREAMS_USB3 16
@@ -171,10 +172,12 @@ namespace RhythmNode
 		int numChannels;
 		bool deviceFound;
 
+		// headstage and aux channels are passed to the buffer as raw words, ADC channels in volts
+		int16 thisRawSample[MAX_NUM_CHANNELS];
 		float thisSample[MAX_NUM_CHANNELS];
 		// aux inputs are only sampled every 4th sample, so use this to buffer the samples so they can be handles just like the regular neural channels later
-		float auxBuffer[MAX_NUM_CHANNELS];
-		float auxSamples[MAX_NUM_DATA_STREAMS_USB3][3];
+		int16 auxBuffer[MAX_NUM_CHANNELS];
+		int16 auxSamples[MAX_NUM_DATA_STREAMS_USB3][3];
 
 		unsigned int blockSize;
 
@@ -269,6 +272,16 @@ namespace RhythmNode
 	};
 
 
+	/**
+		Measures electrode impedances by driving each channel with a test current
+		and demodulating the recorded voltage.
+
+		The board acquires one channel at a time. While it runs the next channel,
+		the data of the previous one is demodulated on a worker pool, with a
+		Goertzel recurrence evaluated for all data streams at once.
+
+		@see ImpedanceDemodulator
+	*/
 	class RHDImpedanceMeasure : public Thread
 	{
 	public:
@@ -283,17 +296,24 @@ namespace RhythmNode
 
 
 	private:
+		class ChannelJob;
+		friend class ChannelJob;
+
 		void runImpedanceMeasurement();
 		void restoreFPGA();
 
-		void measureComplexAmplitude(std::vector<std::vector<std::vector<double>>>& measuredMagnitude,
-			std::vector<std::vector<std::vector<double>>>& measuredPhase,
-			int capIndex, int stream, int chipChannel, int numBlocks,
-			double sampleRate, double frequency, int numPeriods);
+		/** Runs the board for the selected channel and queues the data for
+			demodulation. Returns false if the thread should exit. */
+		bool acquireChannel(int capIndex, int chipChannel, bool rhd2164Pass);
+
+		/** Blocks until the board has acquired numSamples samples. Returns false if the thread should exit. */
+		bool waitForBoard(int numSamples);
 
-		void amplitudeOfFreqComponent(double& realComponent, double& imagComponent,
-			const std::vector<double>& data, int startIndex,
-			int endIndex, double sampleRate, double frequency);
+		/** Blocks until all queued channels have been demodulated. Returns false if the thread should exit. */
+		bool waitForJobs();
+
+		/** Demodulates one channel of every stream and stores its complex amplitudes */
+		void measureComplexAmplitude(const float* samples, int capIndex, int chipChannel, bool rhd2164Pass);
 
 		void factorOutParallelCapacitance(double& impedanceMagnitude, double& impedancePhase,
 			double frequency, double parasiticCapacitance);
@@ -302,10 +322,24 @@ namespace RhythmNode
 			double boardSampleRate);
 
 		float updateImpedanceFrequency(float desiredImpedanceFreq, bool& impedanceFreqValid);
-		int loadAmplifierData(queue<Rhd2000DataBlock>& dataQueue,
-			int numBlocks, int numDataStreams);
 
-		std::vector<std::vector<std::vector<double>>> amplifierPreFilter;
+		int getMeasurementIndex(int stream, int channel, int capIndex) const;
+
+		// complex amplitudes of every stream, channel and capacitor range
+		HeapBlock<double> measuredMagnitude;
+		HeapBlock<double> measuredPhase;
+
+		// settings of the running measurement, read by the jobs
+		int numDataStreams;
+		int numBlocks;
+		int samplesPerBlock;
+		int windowStart;
+		int windowEnd;
+		double measureFrequency;
+
+		ThreadPool workers;
+		Atomic<int> pendingJobs;
+		WaitableEvent jobFinished;
 
 		ImpedanceData* data;
 		RHD2000Thread* board;
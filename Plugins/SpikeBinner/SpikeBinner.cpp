@@ -0,0 +1,349 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include <stdio.h>
+#include "SpikeBinner.h"
+#include "SpikeBinnerEditor.h"
+
+/** Longest unit announcement */
+#define MAX_UNIT_TEXT_LENGTH 256
+
+/** How often new units are announced */
+#define ANNOUNCE_INTERVAL_MS 50
+
+
+SpikeBinner::SpikeBinner()
+    : GenericProcessor  ("Spike Binner")
+    , binMs             (50.0f)
+    , closeDelayMs      (2.0f)
+    , numUnits          (64)
+    , countUnsorted     (true)
+    , vectorSize        (64)
+    , sampleRate        (30000.0f)
+    , binSamples        (1)
+    , closeDelaySamples (0)
+    , ringSize          (0)
+    , ringCapacity      (0)
+    , firstOpenBin      (-1)
+    , numElectrodes     (0)
+    , assignedUnits     (0)
+    , sentAnnouncements (0)
+    , countChannel      (nullptr)
+    , unitChannel       (nullptr)
+{
+    setProcessorType (PROCESSOR_TYPE_FILTER);
+}
+
+
+SpikeBinner::~SpikeBinner()
+{
+}
+
+
+AudioProcessorEditor* SpikeBinner::createEditor()
+{
+    editor = new SpikeBinnerEditor (this, true);
+
+    return editor;
+}
+
+
+void SpikeBinner::updateSettings()
+{
+    countChannel = nullptr;
+    unitChannel = nullptr;
+
+    numElectrodes = spikeChannelArray.size();
+    unitTable.allocate ((size_t) jmax (1, numElectrodes * (MAX_SORTED_ID + 1)), false);
+    assignedUnitInfo.allocate (MAX_BINNED_UNITS, true);
+    announcements.ensureStorageAllocated (MAX_BINNED_UNITS);
+    assignedUnits = 0;
+
+    ringSize = 0;
+    ringCapacity = 0;
+    vectorSize = numUnits;
+
+    if (dataChannelArray.size() == 0)
+        return;
+
+    // bins follow the clock of the first input channel
+    const DataChannel* in = dataChannelArray[0];
+    sampleRate = in->getSampleRate();
+
+    const int minBinSamples = jmax (1, roundFloatToInt (MIN_BIN_MS * sampleRate / 1000.0f));
+    const int maxDelaySamples = roundFloatToInt (MAX_CLOSE_DELAY_MS * sampleRate / 1000.0f);
+    ringCapacity = (MAX_BINNER_BLOCK_SAMPLES + maxDelaySamples) / minBinSamples + 2;
+    counts.allocate ((size_t) ringCapacity * vectorSize, true);
+
+    EventChannel* ev = new EventChannel (EventChannel::UINT16_ARRAY, 1, vectorSize, in, this);
+    ev->setName ("Binned spike counts");
+    ev->setDescription ("Spike count of every unit in a bin, sent when the bin closes with the timestamp of its end");
+    ev->setIdentifier ("spikederived.counts.binned");
+
+    MetaDataDescriptor md (MetaDataDescriptor::UINT16, 3, "Source Channel",
+        "Index at its source, Source processor ID and Sub Processor index of the channel that sets the bin clock", "source.channel.identifier.full");
+    MetaDataValue mv (md);
+    uint16 sourceInfo[3];
+    sourceInfo[0] = in->getSourceIndex();
+    sourceInfo[1] = in->getSourceNodeID();
+    sourceInfo[2] = in->getSubProcessorIdx();
+    mv.setValue (static_cast<const uint16*> (sourceInfo));
+    ev->addMetaData (md, mv);
+
+    eventChannelArray.add (ev);
+    countChannel = ev;
+
+    EventChannel* units = new EventChannel (EventChannel::TEXT, 1, MAX_UNIT_TEXT_LENGTH, in, this);
+    units->setName ("Binned units");
+    units->setDescription ("Sent when a unit gets a slot in the count vector: slot, electrode name and sorted ID");
+    units->setIdentifier ("spikederived.counts.units");
+    eventChannelArray.add (units);
+    unitChannel = units;
+
+    applySettings();
+}
+
+
+void SpikeBinner::applySettings()
+{
+    if (ringCapacity == 0)
+        return;
+
+    binSamples = jmax (1, roundFloatToInt (binMs * sampleRate / 1000.0f));
+    closeDelaySamples = roundFloatToInt (closeDelayMs * sampleRate / 1000.0f);
+    ringSize = jmin (ringCapacity, (MAX_BINNER_BLOCK_SAMPLES + closeDelaySamples) / binSamples + 2);
+
+    counts.clear ((size_t) ringCapacity * vectorSize);
+
+    // the next block starts a new set of bins
+    firstOpenBin = -1;
+}
+
+
+bool SpikeBinner::enable()
+{
+    // slots are assigned again, and announced, for every acquisition
+    for (int n = 0; n < numElectrodes * (MAX_SORTED_ID + 1); ++n)
+        unitTable[n] = -1;
+
+    assignedUnits = 0;
+    numAssigned = 0;
+    // keeps the storage reserved in updateSettings(), so the timer never reallocates it
+    announcements.clearQuick (true);
+    numAnnouncements = 0;
+    sentAnnouncements = 0;
+
+    applySettings();
+    settingsChanged = 0;
+
+    startTimer (ANNOUNCE_INTERVAL_MS);
+
+    return true;
+}
+
+
+bool SpikeBinner::disable()
+{
+    stopTimer();
+
+    return true;
+}
+
+
+void SpikeBinner::timerCallback()
+{
+    if (unitChannel == nullptr)
+        return;
+
+    const int assigned = numAssigned.get();
+
+    for (int unit = announcements.size(); unit < assigned; ++unit)
+    {
+        const AssignedUnit& info = assignedUnitInfo[unit];
+
+        String text = String (unit) + ": " + spikeChannelArray[info.electrode]->getName() + " unit " + String (info.sortedID);
+        TextEventPtr event = TextEvent::createTextEvent (unitChannel, info.timestamp, text.substring (0, MAX_UNIT_TEXT_LENGTH - 1));
+        announcements.add (event.release());
+    }
+
+    numAnnouncements = announcements.size();
+}
+
+
+void SpikeBinner::setParameter (int parameterIndex, float newValue)
+{
+    switch (parameterIndex)
+    {
+        case BIN_MS:
+            binMs = jmax ((float) MIN_BIN_MS, newValue);
+            break;
+        case CLOSE_DELAY_MS:
+            closeDelayMs = jlimit (0.0f, (float) MAX_CLOSE_DELAY_MS, newValue);
+            break;
+        case NUM_UNITS:
+            // changes the event size, takes effect on the next signal chain update
+            numUnits = jlimit (1, MAX_BINNED_UNITS, (int) newValue);
+            return;
+        case COUNT_UNSORTED:
+            countUnsorted = newValue > 0.5f;
+            return;
+        default:
+            return;
+    }
+
+    // bin changes are picked up at the start of the next block
+    settingsChanged = 1;
+}
+
+
+float SpikeBinner::getParameterValue (int parameterIndex) const
+{
+    switch (parameterIndex)
+    {
+        case BIN_MS: return binMs;
+        case CLOSE_DELAY_MS: return closeDelayMs;
+        case NUM_UNITS: return (float) numUnits;
+        case COUNT_UNSORTED: return countUnsorted ? 1.0f : 0.0f;
+        default: return 0.0f;
+    }
+}
+
+
+int SpikeBinner::getNumAssignedUnits() const
+{
+    return assignedUnits;
+}
+
+
+int SpikeBinner::getUnitIndex (int electrode, uint16 sortedID)
+{
+    if (sortedID > MAX_SORTED_ID)
+        return -1;
+
+    int16& slot = unitTable[electrode * (MAX_SORTED_ID + 1) + sortedID];
+
+    if (slot < 0 && assignedUnits < vectorSize)
+    {
+        // announced by timerCallback(), which only reads slots below numAssigned
+        AssignedUnit& info = assignedUnitInfo[assignedUnits];
+        info.electrode = electrode;
+        info.sortedID = sortedID;
+        info.timestamp = getTimestamp (0);
+
+        slot = (int16) assignedUnits++;
+        numAssigned = assignedUnits;
+    }
+
+    return slot;
+}
+
+
+void SpikeBinner::handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition)
+{
+    if (firstOpenBin < 0)
+        return;
+
+    const uint16 sortedID = SpikeEvent::getSortedID (event);
+    if (sortedID == 0 && !countUnsorted)
+        return;
+
+    const juce::int64 timestamp = EventBase::getTimestamp (event);
+    if (timestamp < 0)
+        return;
+
+    const juce::int64 bin = timestamp / binSamples;
+
+    // spikes of bins that were already sent, or too far ahead for the ring, are dropped
+    if (bin < firstOpenBin || bin >= firstOpenBin + ringSize)
+        return;
+
+    const int electrode = getSpikeChannelIndex (EventBase::getSourceIndex (event),
+                                                EventBase::getSourceID (event),
+                                                EventBase::getSubProcessorIdx (event));
+    if (electrode < 0 || electrode >= numElectrodes)
+        return;
+
+    const int unit = getUnitIndex (electrode, sortedID);
+    if (unit < 0)
+        return;
+
+    uint16& count = counts[(size_t) (bin % ringSize) * vectorSize + unit];
+    if (count < 0xffff)
+        ++count;
+}
+
+
+void SpikeBinner::sendBin (juce::int64 bin, int sampleNum)
+{
+    uint16* row = counts + (size_t) (bin % ringSize) * vectorSize;
+
+    BinaryEventPtr event = BinaryEvent::createBinaryEvent (countChannel, (bin + 1) * binSamples, row,
+                                                             vectorSize * sizeof (uint16));
+    addEvent (countChannel, event, sampleNum);
+
+    zeromem (row, sizeof (uint16) * vectorSize);
+}
+
+
+void SpikeBinner::process (AudioSampleBuffer& buffer)
+{
+    if (settingsChanged.compareAndSetBool (0, 1))
+        applySettings();
+
+    if (countChannel == nullptr || ringSize == 0)
+        return;
+
+    const juce::int64 blockStart = getTimestamp (0);
+    const int nSamples = getNumSamples (0);
+
+    if (firstOpenBin < 0)
+    {
+        // the first bin is the first one that starts inside this block
+        firstOpenBin = (blockStart + binSamples - 1) / binSamples;
+    }
+    else if ((firstOpenBin + ringSize) * binSamples + closeDelaySamples < blockStart)
+    {
+        // timestamps jumped ahead, the open bins can no longer be filled
+        counts.clear ((size_t) ringSize * vectorSize);
+        firstOpenBin = (blockStart + binSamples - 1) / binSamples;
+    }
+
+    checkForEvents (true);
+
+    // announcements built on the message thread since the last block
+    const int numReady = numAnnouncements.get();
+    while (sentAnnouncements < numReady)
+        addEvent (unitChannel, announcements.getUnchecked (sentAnnouncements++), 0);
+
+    const juce::int64 blockEnd = blockStart + nSamples;
+
+    for (;;)
+    {
+        const juce::int64 closeTime = (firstOpenBin + 1) * binSamples + closeDelaySamples;
+        if (closeTime >= blockEnd)
+            break;
+
+        sendBin (firstOpenBin, (int) jmax ((juce::int64) 0, closeTime - blockStart));
+        firstOpenBin++;
+    }
+}
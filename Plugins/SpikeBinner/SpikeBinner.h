@@ -0,0 +1,163 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SPIKEBINNER_H_INCLUDED
+#define SPIKEBINNER_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/** Largest number of units in a count vector */
+#define MAX_BINNED_UNITS 1024
+
+/** Narrowest bin and longest close delay, they set the size of the bin ring */
+#define MIN_BIN_MS 1
+#define MAX_CLOSE_DELAY_MS 50
+
+/** Longest block the bin ring is sized for, in samples */
+#define MAX_BINNER_BLOCK_SAMPLES 16384
+
+/** Largest sorted ID that can get a slot, sets the size of the unit tables */
+#define MAX_SORTED_ID 4095
+
+/**
+
+    Counts the spikes of every unit in fixed-width time bins and sends one
+    count vector per bin as a binary event, for online decoders.
+
+    Bins are aligned to the timestamps of the first input channel: bin k
+    holds the spikes with k * binSamples <= timestamp < (k + 1) * binSamples,
+    so bins line up across recordings and processors. A bin is closed a short
+    delay after its end, so spikes that are detected a few samples after their
+    peak still fall into it. Its vector is sent at the sample where it closes,
+    with the timestamp of the end of the bin.
+
+    Each (electrode, sorted ID) pair gets the next free slot of the vector the
+    first time one of its spikes arrives. A timer on the message thread builds
+    a text event announcing the new unit, which the next block sends. Unsorted
+    spikes (ID 0) can be counted as one multi-unit per electrode or ignored.
+    Counting reads the timestamp and sorted ID straight from the event and
+    increments a preallocated counter, so it does not allocate per spike.
+
+    @see GenericProcessor, SpikeBinnerEditor
+*/
+class SpikeBinner : public GenericProcessor
+                  , public Timer
+{
+public:
+    SpikeBinner();
+    ~SpikeBinner();
+
+    AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override { return true; }
+
+    void process (AudioSampleBuffer& buffer) override;
+
+    void handleSpike (const SpikeChannel* spikeInfo, const MidiMessage& event, int samplePosition) override;
+
+    void setParameter (int parameterIndex, float newValue) override;
+
+    void updateSettings() override;
+
+    bool enable() override;
+    bool disable() override;
+
+    /** Builds the announcements of the units assigned since the last call */
+    void timerCallback() override;
+
+    enum Parameters
+    {
+        BIN_MS = 0,
+        CLOSE_DELAY_MS,
+        NUM_UNITS,
+        COUNT_UNSORTED
+    };
+
+    float getParameterValue (int parameterIndex) const;
+
+    /** Returns the number of units that have a slot in the count vector */
+    int getNumAssignedUnits() const;
+
+private:
+    /** Recomputes the bin geometry and clears the counts.
+        Does not allocate, so process() can call it between blocks. */
+    void applySettings();
+
+    /** Returns the slot of a unit, assigning a new one if needed, or -1 if the vector is full
+        or the ID is above MAX_SORTED_ID. Does not allocate. */
+    int getUnitIndex (int electrode, uint16 sortedID);
+
+    /** Sends the count vector of a bin and clears its row */
+    void sendBin (juce::int64 bin, int sampleNum);
+
+    float binMs;
+    float closeDelayMs;
+    int numUnits;
+    bool countUnsorted;
+
+    /** Length of the count vector, numUnits at the last signal chain update */
+    int vectorSize;
+
+    float sampleRate;
+    int binSamples;
+    int closeDelaySamples;
+
+    /** Counts of the open bins, one row of vectorSize per bin, indexed by bin modulo ringSize */
+    HeapBlock<uint16> counts;
+    int ringSize;
+    int ringCapacity;
+
+    /** Oldest bin that has not been sent yet, or -1 before the first block */
+    juce::int64 firstOpenBin;
+
+    /** Dense unit slot of each sorted ID, MAX_SORTED_ID + 1 entries per electrode; -1 until assigned */
+    HeapBlock<int16> unitTable;
+    int numElectrodes;
+    int assignedUnits;
+
+    /** Electrode, sorted ID and block timestamp of each assigned slot, for its announcement */
+    struct AssignedUnit
+    {
+        int electrode;
+        uint16 sortedID;
+        juce::int64 timestamp;
+    };
+    HeapBlock<AssignedUnit> assignedUnitInfo;
+
+    /** Slots assigned by the audio thread, published for the timer */
+    Atomic<int> numAssigned;
+
+    /** Announcements built by the timer. Storage for MAX_BINNED_UNITS is reserved in updateSettings()
+        and kept by enable(), so adding one never moves the events the audio thread is reading. */
+    OwnedArray<TextEvent> announcements;
+    Atomic<int> numAnnouncements;
+    int sentAnnouncements;
+
+    const EventChannel* countChannel;
+    const EventChannel* unitChannel;
+
+    Atomic<int> settingsChanged;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpikeBinner);
+};
+
+#endif  // SPIKEBINNER_H_INCLUDED
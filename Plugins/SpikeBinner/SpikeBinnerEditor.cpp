@@ -0,0 +1,189 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "SpikeBinnerEditor.h"
+#include "SpikeBinner.h"
+
+
+SpikeBinnerEditor::SpikeBinnerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors = true)
+    : GenericEditor (parentNode, useDefaultParameterEditors)
+{
+    desiredWidth = 150;
+
+    addLabel ("Bin:", 10, 25, 60);
+    addValue (SpikeBinner::BIN_MS, 70, 27, "Width of a bin, in ms");
+
+    addLabel ("Delay:", 10, 47, 60);
+    addValue (SpikeBinner::CLOSE_DELAY_MS, 70, 49, "Time after the end of a bin before its counts are sent, for spikes detected late, in ms");
+
+    addLabel ("Units:", 10, 69, 60);
+    addValue (SpikeBinner::NUM_UNITS, 70, 71, "Length of the count vector; units beyond it are not counted");
+
+    unsortedButton = new UtilityButton ("UNS", Font ("Default", 10, Font::plain));
+    unsortedButton->addListener (this);
+    unsortedButton->setBounds (75, 97, 40, 18);
+    unsortedButton->setClickingTogglesState (true);
+    unsortedButton->setToggleState (true, dontSendNotification);
+    unsortedButton->setTooltip ("When this button is on, unsorted spikes are counted as one unit per electrode");
+    addAndMakeVisible (unsortedButton);
+}
+
+
+SpikeBinnerEditor::~SpikeBinnerEditor()
+{
+}
+
+
+Label* SpikeBinnerEditor::addLabel (const String& text, int x, int y, int width)
+{
+    Label* label = new Label (text, text);
+    label->setBounds (x, y, width, 20);
+    label->setFont (Font ("Small Text", 12, Font::plain));
+    label->setColour (Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible (label);
+    labels.add (label);
+
+    return label;
+}
+
+
+Label* SpikeBinnerEditor::addValue (int parameterIndex, int x, int y, const String& tooltip)
+{
+    Label* value = new Label (String (parameterIndex), String());
+    value->setBounds (x, y, 45, 18);
+    value->setFont (Font ("Default", 15, Font::plain));
+    value->setColour (Label::textColourId, Colours::white);
+    value->setColour (Label::backgroundColourId, Colours::grey);
+    value->setEditable (true);
+    value->addListener (this);
+    value->setTooltip (tooltip);
+    value->getProperties().set ("parameter", parameterIndex);
+    addAndMakeVisible (value);
+    values.add (value);
+
+    updateValue (value);
+
+    return value;
+}
+
+
+void SpikeBinnerEditor::updateValue (Label* label)
+{
+    SpikeBinner* processor = (SpikeBinner*) getProcessor();
+    int parameterIndex = label->getProperties()["parameter"];
+
+    label->setText (String (processor->getParameterValue (parameterIndex)), dontSendNotification);
+}
+
+
+void SpikeBinnerEditor::labelTextChanged (Label* label)
+{
+    SpikeBinner* processor = (SpikeBinner*) getProcessor();
+    int parameterIndex = label->getProperties()["parameter"];
+    float requestedValue = label->getText().getFloatValue();
+
+    bool isValid = true;
+
+    switch (parameterIndex)
+    {
+        case SpikeBinner::BIN_MS:
+            isValid = requestedValue >= MIN_BIN_MS;
+            break;
+        case SpikeBinner::CLOSE_DELAY_MS:
+            isValid = requestedValue >= 0 && requestedValue <= MAX_CLOSE_DELAY_MS;
+            break;
+        case SpikeBinner::NUM_UNITS:
+            isValid = requestedValue >= 1 && requestedValue <= MAX_BINNED_UNITS;
+            break;
+        default:
+            break;
+    }
+
+    if (!isValid)
+    {
+        CoreServices::sendStatusMessage ("Value out of range.");
+    }
+    else if (parameterIndex == SpikeBinner::NUM_UNITS)
+    {
+        // the vector length is part of the event channel, so it can only change between acquisitions
+        if (CoreServices::getAcquisitionStatus())
+        {
+            CoreServices::sendStatusMessage ("Cannot change the number of units during acquisition.");
+        }
+        else
+        {
+            processor->setParameter (parameterIndex, requestedValue);
+            CoreServices::updateSignalChain (this);
+        }
+    }
+    else
+    {
+        processor->setParameter (parameterIndex, requestedValue);
+    }
+
+    updateValue (label);
+}
+
+
+void SpikeBinnerEditor::buttonEvent (Button* button)
+{
+    if (button == unsortedButton)
+    {
+        getProcessor()->setParameter (SpikeBinner::COUNT_UNSORTED, button->getToggleState() ? 1.0f : 0.0f);
+    }
+}
+
+
+void SpikeBinnerEditor::saveCustomParameters (XmlElement* xml)
+{
+    xml->setAttribute ("Type", "SpikeBinnerEditor");
+
+    SpikeBinner* processor = (SpikeBinner*) getProcessor();
+
+    XmlElement* settings = xml->createNewChildElement ("VALUES");
+    settings->setAttribute ("BinMs", processor->getParameterValue (SpikeBinner::BIN_MS));
+    settings->setAttribute ("DelayMs", processor->getParameterValue (SpikeBinner::CLOSE_DELAY_MS));
+    settings->setAttribute ("Units", (int) processor->getParameterValue (SpikeBinner::NUM_UNITS));
+    settings->setAttribute ("CountUnsorted", unsortedButton->getToggleState());
+}
+
+
+void SpikeBinnerEditor::loadCustomParameters (XmlElement* xml)
+{
+    SpikeBinner* processor = (SpikeBinner*) getProcessor();
+
+    forEachXmlChildElement (*xml, xmlNode)
+    {
+        if (xmlNode->hasTagName ("VALUES"))
+        {
+            processor->setParameter (SpikeBinner::BIN_MS, xmlNode->getDoubleAttribute ("BinMs", processor->getParameterValue (SpikeBinner::BIN_MS)));
+            processor->setParameter (SpikeBinner::CLOSE_DELAY_MS, xmlNode->getDoubleAttribute ("DelayMs", processor->getParameterValue (SpikeBinner::CLOSE_DELAY_MS)));
+            processor->setParameter (SpikeBinner::NUM_UNITS, xmlNode->getIntAttribute ("Units", (int) processor->getParameterValue (SpikeBinner::NUM_UNITS)));
+
+            unsortedButton->setToggleState (xmlNode->getBoolAttribute ("CountUnsorted", true), sendNotification);
+        }
+    }
+
+    for (int i = 0; i < values.size(); ++i)
+        updateValue (values[i]);
+}
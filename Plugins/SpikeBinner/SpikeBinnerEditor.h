@@ -0,0 +1,68 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SPIKEBINNEREDITOR_H_INCLUDED
+#define SPIKEBINNEREDITOR_H_INCLUDED
+
+#include <EditorHeaders.h>
+
+/**
+
+  User interface for the SpikeBinner processor.
+
+  Sets the bin width, the delay before a bin is sent and the length of the
+  count vector, and whether unsorted spikes are counted.
+
+  @see SpikeBinner
+
+*/
+
+class SpikeBinnerEditor : public GenericEditor,
+    public Label::Listener
+{
+public:
+    SpikeBinnerEditor (GenericProcessor* parentNode, bool useDefaultParameterEditors);
+    virtual ~SpikeBinnerEditor();
+
+    void buttonEvent (Button* button) override;
+    void labelTextChanged (Label* label) override;
+
+    void saveCustomParameters (XmlElement* xml) override;
+    void loadCustomParameters (XmlElement* xml) override;
+
+private:
+    Label* addLabel (const String& text, int x, int y, int width);
+    Label* addValue (int parameterIndex, int x, int y, const String& tooltip);
+
+    /** Shows the processor's current value of a parameter */
+    void updateValue (Label* label);
+
+    OwnedArray<Label> labels;
+    OwnedArray<Label> values;
+
+    ScopedPointer<UtilityButton> unsortedButton;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpikeBinnerEditor);
+};
+
+#endif  // SPIKEBINNEREDITOR_H_INCLUDED
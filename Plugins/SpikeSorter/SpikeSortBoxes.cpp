@@ -764,6 +764,9 @@ void SpikeSortBoxes::loadCustomParametersFromXml(XmlElement* electrodeNode)
             }
         }
     }
+
+    const ScopedLock myScopedLock(mut);
+    unitIndex.rebuild(boxUnits, pcaUnits);
 }
 
 void SpikeSortBoxes::saveCustomParametersToXml(XmlElement* electrodeNode)
@@ -939,6 +942,7 @@ void SpikeSortBoxes::addPCAunit(PCAUnit unit)
     const ScopedLock myScopedLock(mut);
     //StartCriticalSection();
     pcaUnits.push_back(unit);
+    unitIndex.rebuild(boxUnits, pcaUnits);
     //EndCriticalSection();
 }
 
@@ -951,6 +955,7 @@ int SpikeSortBoxes::addBoxUnit(int channel)
     int unusedID = uniqueIDgenerator->generateUniqueID(); //generateUnitID();
     BoxUnit unit(unusedID, generateLocalID());
     boxUnits.push_back(unit);
+    unitIndex.rebuild(boxUnits, pcaUnits);
     setSelectedUnitAndBox(unusedID, 0);
     //EndCriticalSection();
     return unusedID;
@@ -973,6 +978,7 @@ int SpikeSortBoxes::addBoxUnit(int channel, Box B)
     int unusedID = uniqueIDgenerator->generateUniqueID(); //generateUnitID();
     BoxUnit unit(B, unusedID,generateLocalID());
     boxUnits.push_back(unit);
+    unitIndex.rebuild(boxUnits, pcaUnits);
     setSelectedUnitAndBox(unusedID, 0);
     //EndCriticalSection();
     return unusedID;
@@ -1062,6 +1068,7 @@ void SpikeSortBoxes::removeAllUnits()
     const ScopedLock myScopedLock(mut);
     boxUnits.clear();
     pcaUnits.clear();
+    unitIndex.rebuild(boxUnits, pcaUnits);
 }
 
 bool SpikeSortBoxes::removeUnit(int unitID)
@@ -1073,6 +1080,7 @@ bool SpikeSortBoxes::removeUnit(int unitID)
         if (boxUnits[k].getUnitID() == unitID)
         {
             boxUnits.erase(boxUnits.begin()+k);
+            unitIndex.rebuild(boxUnits, pcaUnits);
             //EndCriticalSection();
             return true;
         }
@@ -1083,6 +1091,7 @@ bool SpikeSortBoxes::removeUnit(int unitID)
         if (pcaUnits[k].getUnitID() == unitID)
         {
             pcaUnits.erase(pcaUnits.begin()+k);
+            unitIndex.rebuild(boxUnits, pcaUnits);
             //EndCriticalSection();
             return true;
         }
@@ -1108,6 +1117,7 @@ bool SpikeSortBoxes::addBoxToUnit(int channel, int unitID)
             B.y -= 30;
             B.channel = channel;
             boxUnits[k].addBox(B);
+            unitIndex.rebuild(boxUnits, pcaUnits);
             setSelectedUnitAndBox(unitID, (int) boxUnits[k].lstBoxes.size() - 1);
             // EndCriticalSection();
             return true;
@@ -1127,6 +1137,7 @@ bool SpikeSortBoxes::addBoxToUnit(int channel, int unitID, Box B)
         if (boxUnits[k].getUnitID() == unitID)
         {
             boxUnits[k].addBox(B);
+            unitIndex.rebuild(boxUnits, pcaUnits);
             // EndCriticalSection();
             return true;
         }
@@ -1159,6 +1170,7 @@ void SpikeSortBoxes::updatePCAUnits(std::vector<PCAUnit> _units)
     //StartCriticalSection();
     const ScopedLock myScopedLock(mut);
     pcaUnits = _units;
+    unitIndex.rebuild(boxUnits, pcaUnits);
     //EndCriticalSection();
 }
 
@@ -1167,6 +1179,7 @@ void SpikeSortBoxes::updateBoxUnits(std::vector<BoxUnit> _units)
     const ScopedLock myScopedLock(mut);
     //StartCriticalSection();
     boxUnits = _units;
+    unitIndex.rebuild(boxUnits, pcaUnits);
     //EndCriticalSection();
 }
 
@@ -1180,21 +1193,19 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
     if (PCAfirst)
     {
 
-        for (int k=0; k<pcaUnits.size(); k++)
+        int pcaUnit = unitIndex.findPCAUnit(so, pcaUnits);
+        if (pcaUnit >= 0)
         {
-            if (pcaUnits[k].isWaveFormInsidePolygon(so))
-            {
-                so->sortedId = pcaUnits[k].getUnitID();
-                so->color[0] = pcaUnits[k].ColorRGB[0];
-                so->color[1] = pcaUnits[k].ColorRGB[1];
-                so->color[2] = pcaUnits[k].ColorRGB[2];
-                return true;
-            }
+            so->sortedId = pcaUnits[pcaUnit].getUnitID();
+            so->color[0] = pcaUnits[pcaUnit].ColorRGB[0];
+            so->color[1] = pcaUnits[pcaUnit].ColorRGB[1];
+            so->color[2] = pcaUnits[pcaUnit].ColorRGB[2];
+            return true;
         }
 
         for (int k=0; k<boxUnits.size(); k++)
         {
-            if (boxUnits[k].isWaveFormInsideAllBoxes(so))
+            if (unitIndex.isWaveFormInsideAllBoxes(k, so, boxUnits))
             {
                 so->sortedId = boxUnits[k].getUnitID();
                 so->color[0] = boxUnits[k].ColorRGB[0];
@@ -1210,7 +1221,7 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
 
         for (int k=0; k<boxUnits.size(); k++)
         {
-            if (boxUnits[k].isWaveFormInsideAllBoxes(so))
+            if (unitIndex.isWaveFormInsideAllBoxes(k, so, boxUnits))
             {
                 so->sortedId = boxUnits[k].getUnitID();
                 so->color[0] = boxUnits[k].ColorRGB[0];
@@ -1220,17 +1231,15 @@ bool SpikeSortBoxes::sortSpike(SorterSpikePtr so, bool PCAfirst)
                 return true;
             }
         }
-        for (int k=0; k<pcaUnits.size(); k++)
+        int pcaUnit = unitIndex.findPCAUnit(so, pcaUnits);
+        if (pcaUnit >= 0)
         {
-            if (pcaUnits[k].isWaveFormInsidePolygon(so))
-            {
-                so->sortedId = pcaUnits[k].getUnitID();
-                so->color[0] = pcaUnits[k].ColorRGB[0];
-                so->color[1] = pcaUnits[k].ColorRGB[1];
-                so->color[2] = pcaUnits[k].ColorRGB[2];
-                pcaUnits[k].updateWaveform(so);
-                return true;
-            }
+            so->sortedId = pcaUnits[pcaUnit].getUnitID();
+            so->color[0] = pcaUnits[pcaUnit].ColorRGB[0];
+            so->color[1] = pcaUnits[pcaUnit].ColorRGB[1];
+            so->color[2] = pcaUnits[pcaUnit].ColorRGB[2];
+            pcaUnits[pcaUnit].updateWaveform(so);
+            return true;
         }
 
     }
@@ -1248,6 +1257,7 @@ bool  SpikeSortBoxes::removeBoxFromUnit(int unitID, int boxIndex)
         if (boxUnits[k].getUnitID() == unitID)
         {
             bool s= boxUnits[k].deleteBox(boxIndex);
+            unitIndex.rebuild(boxUnits, pcaUnits);
             setSelectedUnitAndBox(-1,-1);
             //EndCriticalSection();
             return s;
@@ -1697,6 +1707,198 @@ void PCAUnit::updateWaveform(SorterSpikePtr so)
     WaveformStat.update(so);
 }
 
+/*************************/
+
+// cells per side of the PCA grid
+#define INDEX_GRID_SIZE 64
+
+UnitBoundaryIndex::UnitBoundaryIndex() : gridSize(INDEX_GRID_SIZE), gridX0(0), gridY0(0), cellW(1), cellH(1), hasGrid(false)
+{
+}
+
+// conservative: false only if the segment certainly misses the rectangle
+bool UnitBoundaryIndex::mayCrossRectangle(double ax, double ay, double bx, double by, double x0, double y0, double x1, double y1)
+{
+    if (jmax(ax, bx) < x0 || jmin(ax, bx) > x1 || jmax(ay, by) < y0 || jmin(ay, by) > y1)
+        return false;
+
+    double dx = bx - ax;
+    double dy = by - ay;
+    double c00 = dx * (y0 - ay) - dy * (x0 - ax);
+    double c01 = dx * (y1 - ay) - dy * (x0 - ax);
+    double c10 = dx * (y0 - ay) - dy * (x1 - ax);
+    double c11 = dx * (y1 - ay) - dy * (x1 - ax);
+
+    if (c00 > 0 && c01 > 0 && c10 > 0 && c11 > 0)
+        return false;
+    if (c00 < 0 && c01 < 0 && c10 < 0 && c11 < 0)
+        return false;
+    return true;
+}
+
+void UnitBoundaryIndex::rebuild(std::vector<BoxUnit>& boxUnits, std::vector<PCAUnit>& pcaUnits)
+{
+    // boxes: voltage range of every box, with some room for rounding
+    boxRanges.resize(boxUnits.size());
+    for (int k = 0; k < boxUnits.size(); k++)
+    {
+        boxRanges[k].resize(boxUnits[k].lstBoxes.size());
+        for (int b = 0; b < boxUnits[k].lstBoxes.size(); b++)
+        {
+            const Box& box = boxUnits[k].lstBoxes[b];
+            BoxRange& r = boxRanges[k][b];
+            r.top = (float) jmax(box.y, box.y - box.h);
+            r.bottom = (float) jmin(box.y, box.y - box.h);
+            r.margin = 1e-3f * (fabs(r.top) + fabs(r.bottom)) + 1e-3f;
+        }
+    }
+
+    // polygons, with their offset applied as cPolygon::isPointInside does
+    std::vector<std::vector<PointD> > polygons(pcaUnits.size());
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    hasGrid = false;
+
+    for (int k = 0; k < pcaUnits.size(); k++)
+    {
+        const cPolygon& poly = pcaUnits[k].poly;
+        if (poly.pts.size() < 3)
+            continue;
+
+        for (int i = 0; i < poly.pts.size(); i++)
+        {
+            PointD p(poly.pts[i].X + poly.offset.X, poly.pts[i].Y + poly.offset.Y);
+            polygons[k].push_back(p);
+
+            if (!hasGrid)
+            {
+                minX = maxX = p.X;
+                minY = maxY = p.Y;
+                hasGrid = true;
+            }
+            minX = jmin(minX, (double) p.X);
+            maxX = jmax(maxX, (double) p.X);
+            minY = jmin(minY, (double) p.Y);
+            maxY = jmax(maxY, (double) p.Y);
+        }
+    }
+
+    cellStart.clear();
+    entries.clear();
+
+    if (!hasGrid)
+        return;
+
+    // outside the bounding box of all the polygons (and a margin), no polygon holds a point
+    double marginX = 1e-3 * (maxX - minX) + 1e-6 * (fabs(minX) + fabs(maxX)) + 1e-6;
+    double marginY = 1e-3 * (maxY - minY) + 1e-6 * (fabs(minY) + fabs(maxY)) + 1e-6;
+    gridX0 = minX - marginX;
+    gridY0 = minY - marginY;
+    cellW = (maxX - minX + 2 * marginX) / gridSize;
+    cellH = (maxY - minY + 2 * marginY) / gridSize;
+
+    cellStart.resize(gridSize * gridSize + 1);
+
+    for (int cy = 0; cy < gridSize; cy++)
+    {
+        for (int cx = 0; cx < gridSize; cx++)
+        {
+            cellStart[cy * gridSize + cx] = (int) entries.size();
+
+            // cells overlap a little, so a point rounded into a neighbouring cell is still covered
+            double x0 = gridX0 + cx * cellW - 0.01 * cellW;
+            double x1 = gridX0 + (cx + 1) * cellW + 0.01 * cellW;
+            double y0 = gridY0 + cy * cellH - 0.01 * cellH;
+            double y1 = gridY0 + (cy + 1) * cellH + 0.01 * cellH;
+
+            for (int k = 0; k < polygons.size(); k++)
+            {
+                const std::vector<PointD>& pts = polygons[k];
+                if (pts.size() < 3)
+                    continue;
+
+                bool crossed = false;
+                for (int i = 0; i < pts.size() && !crossed; i++)
+                {
+                    const PointD& a = pts[i == 0 ? pts.size() - 1 : i - 1];
+                    const PointD& b = pts[i];
+                    crossed = mayCrossRectangle(a.X, a.Y, b.X, b.Y, x0, y0, x1, y1);
+                }
+
+                CellEntry entry;
+                entry.unit = k;
+
+                if (crossed)
+                {
+                    entry.state = CELL_BOUNDARY;
+                    entries.push_back(entry);
+                }
+                else if (pcaUnits[k].isPointInsidePolygon(PointD(gridX0 + (cx + 0.5) * cellW, gridY0 + (cy + 0.5) * cellH)))
+                {
+                    // no edge in the cell: every point of it is on the same side
+                    entry.state = CELL_INSIDE;
+                    entries.push_back(entry);
+                }
+            }
+        }
+    }
+    cellStart[gridSize * gridSize] = (int) entries.size();
+}
+
+int UnitBoundaryIndex::findPCAUnit(SorterSpikePtr so, std::vector<PCAUnit>& pcaUnits)
+{
+    if (!hasGrid)
+        return -1;
+
+    double gx = (so->pcProj[0] - gridX0) / cellW;
+    double gy = (so->pcProj[1] - gridY0) / cellH;
+
+    // also rejects NaN projections, which no polygon holds either
+    if (!(gx >= 0 && gx < gridSize && gy >= 0 && gy < gridSize))
+        return -1;
+
+    int cell = jmin(gridSize - 1, (int) gy) * gridSize + jmin(gridSize - 1, (int) gx);
+
+    for (int e = cellStart[cell]; e < cellStart[cell + 1]; e++)
+    {
+        const CellEntry& entry = entries[e];
+        if (entry.state == CELL_INSIDE || pcaUnits[entry.unit].isWaveFormInsidePolygon(so))
+            return entry.unit;
+    }
+    return -1;
+}
+
+bool UnitBoundaryIndex::isWaveFormInsideAllBoxes(int unit, SorterSpikePtr so, std::vector<BoxUnit>& boxUnits)
+{
+    const std::vector<Box>& boxes = boxUnits[unit].lstBoxes;
+    const int nSamples = so->getChannel()->getTotalSamples();
+
+    // a waveform that stays above or below a box over its time span cannot cross it
+    for (int b = 0; b < boxes.size(); b++)
+    {
+        const Box& box = boxes[b];
+        const BoxRange& range = boxRanges[unit][b];
+
+        int binLeft = microSecondsToSpikeTimeBin(so, box.x);
+        int binRight = microSecondsToSpikeTimeBin(so, box.x + box.w);
+        if (binLeft >= binRight)
+            return false;
+
+        const float* data = so->getData() + box.channel * nSamples;
+        float minValue = data[binLeft];
+        float maxValue = data[binLeft];
+        for (int pt = binLeft + 1; pt <= binRight; pt++)
+        {
+            minValue = jmin(minValue, data[pt]);
+            maxValue = jmax(maxValue, data[pt]);
+        }
+
+        if (minValue > range.top + range.margin || maxValue < range.bottom - range.margin)
+            return false;
+    }
+
+    return boxUnits[unit].isWaveFormInsideAllBoxes(so);
+}
+
 /***************************/
 
 
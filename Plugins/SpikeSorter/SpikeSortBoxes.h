@@ -247,6 +247,48 @@ public:
     Time timer;
 };
 
+// Lookup structure over the unit boundaries of one electrode, so a spike is
+// only tested exactly against the units it could belong to.
+// The PCA plane is covered by a grid. Each cell lists, in unit order, the PCA
+// units whose polygon covers it entirely or crosses it; points in a cell that
+// no edge crosses are inside or outside a polygon all at once. Boxes keep
+// their voltage range, so a waveform that stays above or below a box over
+// its time span is rejected without the segment intersection tests.
+// Results are the same as testing every unit in order. The index must be
+// rebuilt whenever a unit or a boundary changes.
+class UnitBoundaryIndex
+{
+public:
+    UnitBoundaryIndex();
+    void rebuild(std::vector<BoxUnit>& boxUnits, std::vector<PCAUnit>& pcaUnits);
+    // returns the index of the first PCA unit whose polygon holds the spike projection, or -1
+    int findPCAUnit(SorterSpikePtr so, std::vector<PCAUnit>& pcaUnits);
+    bool isWaveFormInsideAllBoxes(int unit, SorterSpikePtr so, std::vector<BoxUnit>& boxUnits);
+private:
+    enum CellState
+    {
+        CELL_INSIDE = 0,
+        CELL_BOUNDARY
+    };
+    struct CellEntry
+    {
+        int unit;
+        CellState state;
+    };
+    struct BoxRange
+    {
+        float top, bottom, margin;
+    };
+    static bool mayCrossRectangle(double ax, double ay, double bx, double by, double x0, double y0, double x1, double y1);
+
+    int gridSize;
+    double gridX0, gridY0, cellW, cellH;
+    bool hasGrid;
+    std::vector<int> cellStart; // gridSize*gridSize+1 offsets into entries
+    std::vector<CellEntry> entries;
+    std::vector<std::vector<BoxRange> > boxRanges;
+};
+
 // Sort spikes from a single electrode (which could have any number of channels)
 // using the box method. Any electrode could have an arbitrary number of units specified.
 // Each unit is defined by a set of boxes, which can be placed on any of the given channels.
@@ -301,6 +343,7 @@ private:
     CriticalSection mut;
     std::vector<BoxUnit> boxUnits;
     std::vector<PCAUnit> pcaUnits;
+    UnitBoundaryIndex unitIndex;
     float* pc1, *pc2;
     std::atomic<float> pc1min, pc2min, pc1max, pc2max;
     SorterSpikeArray spikeBuffer;
@@ -1765,14 +1765,10 @@ Histogram::~Histogram()
 void ContinuousCircularBuffer::reallocate(int NumCh)
 {
     numCh =NumCh;
-    Buf.resize(numCh);
-    for (int k=0; k< numCh; k++)
-    {
-        Buf[k].resize(bufLen);
-    }
-    numSamplesInBuf = 0;
-    ptr = 0; // points to a valid position in the buffer.
-
+    samples.allocate((size_t) numCh * bufLen, true);
+    leftover_k = 0;
+    writeCount = 0;
+    writeTarget = 0;
 }
 
 
@@ -1782,157 +1778,187 @@ ContinuousCircularBuffer::ContinuousCircularBuffer(int NumCh, float SamplingRate
 
     numTicksPerSecond = (double) t.getHighResolutionTicksPerSecond();
 
-    int numSamplesToHoldPerChannel = (int)(SamplingRate * NumSecInBuffer / SubSampling);
+    int numSamplesToHoldPerChannel = jmax(1, (int)(SamplingRate * NumSecInBuffer / SubSampling));
     buffer_dx = 1.0 / (SamplingRate / SubSampling);
     subSampling = SubSampling;
     samplingRate = SamplingRate;
-    numCh =NumCh;
-    leftover_k = 0;
-    Buf.resize(numCh);
+    bufLen = numSamplesToHoldPerChannel;
 
+    hardwareTS.allocate(bufLen, true);
+    softwareTS.allocate(bufLen, true);
 
-    for (int k=0; k< numCh; k++)
-    {
-        Buf[k].resize(numSamplesToHoldPerChannel);
-    }
-
-    hardwareTS.resize(numSamplesToHoldPerChannel);
-    softwareTS.resize(numSamplesToHoldPerChannel);
-    valid.resize(numSamplesToHoldPerChannel);
-    bufLen = numSamplesToHoldPerChannel;
-    numSamplesInBuf = 0;
-    ptr = 0; // points to a valid position in the buffer.
+    reallocate(NumCh);
 }
 
-
-void ContinuousCircularBuffer::update(int channel, int64 hardware_ts, int64 software_ts, bool rise)
+namespace
 {
-    // used to record ttl pulses as continuous data...
-    mut.enter();
-    valid[ptr] = true;
-    hardwareTS[ptr] = hardware_ts;
-    softwareTS[ptr] = software_ts;
-
-    Buf[channel][ptr] = (rise) ? 1.0 : 0.0;
+    struct AudioBufferSource
+    {
+        AudioSampleBuffer& buffer;
+        float operator()(int ch, int k) const { return buffer.getReadPointer(ch)[k]; }
+    };
 
-    ptr++;
-    if (ptr == bufLen)
+    struct BoolVectorSource
     {
-        ptr = 0;
-    }
-    numSamplesInBuf++;
-    if (numSamplesInBuf >= bufLen)
+        const std::vector<std::vector<bool> >& data;
+        float operator()(int ch, int k) const { return data[ch][k] ? 1.0f : 0.0f; }
+    };
+
+    // copies ring positions [from, from + n) modulo length, in at most two runs
+    template <typename T>
+    void copyFromRing(const T* ring, int length, int64 from, int n, T* dest)
     {
-        numSamplesInBuf = bufLen;
+        int pos = (int) (from % length);
+        int firstRun = jmin(n, length - pos);
+        memcpy(dest, ring + pos, sizeof(T) * firstRun);
+        memcpy(dest + firstRun, ring, sizeof(T) * (n - firstRun));
     }
-    mut.exit();
 }
 
-void ContinuousCircularBuffer::update(AudioSampleBuffer& buffer, int64 hardware_ts, int64 software_ts, int numpts)
+// Readers check writeTarget after copying: the writer announces the samples it
+// is about to overwrite before touching them, and publishes them in writeCount
+// once they are complete.
+template <typename SampleSource>
+void ContinuousCircularBuffer::push(const SampleSource& source, int64 hardware_ts, int64 software_ts, int numpts)
 {
-    mut.enter();
-
     // we don't start from zero because of subsampling issues.
     // previous packet may not have ended exactly at the last given sample.
-    int k = leftover_k;
-    int lastUsedSample = 0;
-    for (; k < numpts; k+=subSampling)
+    int firstSample = leftover_k;
+    int n = firstSample < numpts ? (numpts - 1 - firstSample) / subSampling + 1 : 0;
+    leftover_k = firstSample + n * subSampling - numpts;
+
+    if (n == 0)
+        return;
+
+    const int64 start = writeCount.load(std::memory_order_relaxed);
+    writeTarget.store(start + n, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const int startPos = (int) (start % bufLen);
+
+    int pos = startPos;
+    for (int i = 0, k = firstSample; i < n; i++, k += subSampling)
     {
-        lastUsedSample = k;
-        valid[ptr] = true;
-        hardwareTS[ptr] = hardware_ts + k;
-        softwareTS[ptr] = software_ts + int64(float(k) / samplingRate * numTicksPerSecond);
+        hardwareTS[pos] = hardware_ts + k;
+        softwareTS[pos] = software_ts + int64(float(k) / samplingRate * numTicksPerSecond);
+        if (++pos == bufLen)
+            pos = 0;
+    }
 
-        for (int ch = 0; ch < numCh; ch++)
-        {
-            Buf[ch][ptr] = *(buffer.getReadPointer(ch,k));
-        }
-        ptr++;
-        if (ptr == bufLen)
-        {
-            ptr = 0;
-        }
-        numSamplesInBuf++;
-        if (numSamplesInBuf >= bufLen)
+    for (int ch = 0; ch < numCh; ch++)
+    {
+        float* row = samples + (size_t) ch * bufLen;
+        pos = startPos;
+        for (int i = 0, k = firstSample; i < n; i++, k += subSampling)
         {
-            numSamplesInBuf = bufLen;
+            row[pos] = source(ch, k);
+            if (++pos == bufLen)
+                pos = 0;
         }
     }
 
-    int numMissedSamples = (numpts-1)-lastUsedSample;
-    leftover_k = (subSampling-numMissedSamples-1) % subSampling;
-    mut.exit();
+    publish(start + n);
+}
 
+void ContinuousCircularBuffer::publish(int64 newCount)
+{
+    writeCount.store(newCount, std::memory_order_release);
 }
 
+void ContinuousCircularBuffer::update(int channel, int64 hardware_ts, int64 software_ts, bool rise)
+{
+    // used to record ttl pulses as continuous data...
+    const int64 start = writeCount.load(std::memory_order_relaxed);
+    writeTarget.store(start + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const int pos = (int) (start % bufLen);
+    hardwareTS[pos] = hardware_ts;
+    softwareTS[pos] = software_ts;
+    samples[(size_t) channel * bufLen + pos] = (rise) ? 1.0f : 0.0f;
 
-void ContinuousCircularBuffer::update(std::vector<std::vector<bool>> contdata, int64 hardware_ts, int64 software_ts, int numpts)
+    publish(start + 1);
+}
+
+void ContinuousCircularBuffer::update(AudioSampleBuffer& buffer, int64 hardware_ts, int64 software_ts, int numpts)
 {
-    mut.enter();
+    AudioBufferSource source = { buffer };
+    push(source, hardware_ts, software_ts, numpts);
+}
 
-    // we don't start from zero because of subsampling issues.
-    // previous packet may not have ended exactly at the last given sample.
-    int k = leftover_k;
-    int lastUsedSample = 0;
-    for (; k < numpts; k+=subSampling)
-    {
-        lastUsedSample = k;
-        valid[ptr] = true;
-        hardwareTS[ptr] = hardware_ts + k;
-        softwareTS[ptr] = software_ts + int64(float(k) / samplingRate * numTicksPerSecond);
 
-        for (int ch = 0; ch < numCh; ch++)
-        {
-            Buf[ch][ptr] = contdata[ch][k];
-        }
-        ptr++;
-        if (ptr == bufLen)
-        {
-            ptr = 0;
-        }
-        numSamplesInBuf++;
-        if (numSamplesInBuf >= bufLen)
-        {
-            numSamplesInBuf = bufLen;
-        }
+void ContinuousCircularBuffer::update(const std::vector<std::vector<bool> >& contdata, int64 hardware_ts, int64 software_ts, int numpts)
+{
+    BoolVectorSource source = { contdata };
+    push(source, hardware_ts, software_ts, numpts);
+}
+
+ContinuousCircularBuffer::Snapshot ContinuousCircularBuffer::read(int channel, int64 first, int numSamples, float* dest,
+                                                                  int64* hardwareTimestamps, int64* softwareTimestamps) const
+{
+    const int64 end = writeCount.load(std::memory_order_acquire);
+
+    Snapshot snapshot;
+    snapshot.first = jmax(first, end - bufLen, (int64) 0);
+    snapshot.numSamples = (int) jmax((int64) 0, jmin(first + numSamples, end) - snapshot.first);
+
+    if (snapshot.numSamples == 0 || channel < 0 || channel >= numCh)
+    {
+        snapshot.numSamples = 0;
+        return snapshot;
     }
 
-    int numMissedSamples = (numpts-1)-lastUsedSample;
-    leftover_k =subSampling-numMissedSamples-1;
-    mut.exit();
+    copyFromRing(samples + (size_t) channel * bufLen, bufLen, snapshot.first, snapshot.numSamples, dest);
+    if (hardwareTimestamps != nullptr)
+        copyFromRing(hardwareTS.getData(), bufLen, snapshot.first, snapshot.numSamples, hardwareTimestamps);
+    if (softwareTimestamps != nullptr)
+        copyFromRing(softwareTS.getData(), bufLen, snapshot.first, snapshot.numSamples, softwareTimestamps);
+
+    // drop the samples the writer may have overwritten in the meantime
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const int64 oldest = writeTarget.load(std::memory_order_relaxed) - bufLen;
 
+    if (oldest > snapshot.first)
+    {
+        const int torn = (int) jmin((int64) snapshot.numSamples, oldest - snapshot.first);
+        snapshot.first += torn;
+        snapshot.numSamples -= torn;
+
+        memmove(dest, dest + torn, sizeof(float) * snapshot.numSamples);
+        if (hardwareTimestamps != nullptr)
+            memmove(hardwareTimestamps, hardwareTimestamps + torn, sizeof(int64) * snapshot.numSamples);
+        if (softwareTimestamps != nullptr)
+            memmove(softwareTimestamps, softwareTimestamps + torn, sizeof(int64) * snapshot.numSamples);
+    }
+
+    return snapshot;
 }
-/*
-void ContinuousCircularBuffer::AddDataToBuffer(std::vector<std::vector<double>> lfp, double soft_ts)
+
+ContinuousCircularBuffer::Snapshot ContinuousCircularBuffer::readLatest(int channel, int numSamples, float* dest,
+                                                                        int64* hardwareTimestamps, int64* softwareTimestamps) const
 {
-	mut.enter();
-	int numpts = lfp[0].size();
-	for (int k = 0; k < numpts / subSampling; k++)
-	{
-		valid[ptr] = true;
-		for (int ch = 0; ch < numCh; ch++)
-		{
-			Buf[ch][ptr] = lfp[ch][k];
-			TS[ptr] = soft_ts + (double)(k * subSampling) / samplingRate;
-		}
-		ptr++;
-		if (ptr == bufLen)
-		{
-			ptr = 0;
-		}
-		numSamplesInBuf++;
-		if (numSamplesInBuf >= bufLen)
-		{
-			numSamplesInBuf = bufLen;
-		}
-	}
-	mut.exit();
+    const int64 end = writeCount.load(std::memory_order_acquire);
+    return read(channel, end - numSamples, numSamples, dest, hardwareTimestamps, softwareTimestamps);
 }
-*/
 
 int ContinuousCircularBuffer::GetPtr()
 {
-    return ptr;
+    return (int) (writeCount.load(std::memory_order_acquire) % bufLen);
+}
+
+int ContinuousCircularBuffer::getNumChannels() const
+{
+    return numCh;
+}
+
+int ContinuousCircularBuffer::getBufferLength() const
+{
+    return bufLen;
+}
+
+int64 ContinuousCircularBuffer::getNumSamplesWritten() const
+{
+    return writeCount.load(std::memory_order_acquire);
 }
 
 /************************************************************/
@@ -181,30 +181,59 @@ public:
     bool isMonitored;
 };
 
+// History of the continuous input, for a single writer (the audio thread) and
+// any number of readers. Samples are numbered in the order they are written;
+// the buffer keeps the last bufLen of them, in one preallocated block per
+// kind of data. Writers never lock or allocate. Readers copy the samples they
+// want and then check which of them the writer may have overwritten while they
+// were copying, so a snapshot only ever holds consistent samples.
 class ContinuousCircularBuffer
 {
 public:
     ContinuousCircularBuffer(int NumCh, float SamplingRate, int SubSampling, float NumSecInBuffer);
+    // not safe while the buffer is being written or read
     void reallocate(int N);
-    void update(std::vector<std::vector<bool>> contdata, int64 hardware_ts, int64 software_ts, int numpts);
+    void update(const std::vector<std::vector<bool> >& contdata, int64 hardware_ts, int64 software_ts, int numpts);
     void update(AudioSampleBuffer& buffer, int64 hardware_ts, int64 software_ts, int numpts);
     void update(int channel, int64 hardware_ts, int64 software_ts, bool rise);
     int GetPtr();
-    void addTrialStartToSmartBuffer(int trialID);
+    int getNumChannels() const;
+    int getBufferLength() const;
+    // sequence number of the next sample to be written
+    int64 getNumSamplesWritten() const;
+
+    struct Snapshot
+    {
+        int64 first; // sequence number of the sample in dest[0]
+        int numSamples;
+    };
+    // copies the samples with sequence numbers [first, first + numSamples) that are
+    // still in the buffer; the timestamp arrays are optional
+    Snapshot read(int channel, int64 first, int numSamples, float* dest,
+                  int64* hardwareTimestamps = nullptr, int64* softwareTimestamps = nullptr) const;
+    // copies the newest numSamples samples
+    Snapshot readLatest(int channel, int numSamples, float* dest,
+                        int64* hardwareTimestamps = nullptr, int64* softwareTimestamps = nullptr) const;
+
+private:
+    template <typename SampleSource>
+    void push(const SampleSource& source, int64 hardware_ts, int64 software_ts, int numpts);
+    void publish(int64 newCount);
+
     int numCh;
     int subSampling;
     float samplingRate;
-    CriticalSection mut;
-    int numSamplesInBuf;
     double numTicksPerSecond;
-    int ptr;
     int bufLen;
     int leftover_k;
     double buffer_dx;
 
-    std::vector<std::vector<float> > Buf;
-    std::vector<bool> valid;
-    std::vector<int64> hardwareTS,softwareTS;
+    HeapBlock<float> samples; // numCh rows of bufLen
+    HeapBlock<int64> hardwareTS, softwareTS;
+
+    // samples below writeCount are complete; the writer may be overwriting
+    // everything below writeTarget - bufLen
+    std::atomic<int64> writeCount, writeTarget;
 };
 
 
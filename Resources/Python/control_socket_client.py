@@ -0,0 +1,88 @@
+"""
+    Loopback test client for the Control Socket plugin.
+
+    Measures the round trip of the socket itself with Ping, then starts
+    acquisition and recording, sends annotations and stops again, printing
+    for every command how long the reply took and how many samples passed
+    between the command reaching the GUI and taking effect.
+
+    Usage: python control_socket_client.py [socket path] [number of annotations]
+"""
+
+from __future__ import print_function
+
+import socket
+import sys
+import time
+
+
+DEFAULT_PATH = '/tmp/open-ephys-control.sock'
+
+
+class ControlClient(object):
+
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.pending = b''
+
+    def send(self, command):
+        """ Returns the reply and the time it took, in milliseconds """
+        start = time.time()
+        self.sock.sendall(command.encode('utf-8') + b'\n')
+        while b'\n' not in self.pending:
+            data = self.sock.recv(4096)
+            if not data:
+                raise IOError('connection closed')
+            self.pending += data
+        line, self.pending = self.pending.split(b'\n', 1)
+        return line.decode('utf-8'), (time.time() - start) * 1000.0
+
+    def close(self):
+        self.sock.close()
+
+
+def report(client, command, sample_rate):
+    reply, elapsed = client.send(command)
+    fields = reply.split()
+    text = '%-20s %-40s reply after %7.2f ms' % (command[:20], reply, elapsed)
+
+    if len(fields) == 3 and fields[0] == 'OK' and int(fields[2]) >= 0 and sample_rate > 0:
+        latency = int(fields[1]) - int(fields[2])
+        text += ', effect %6d samples (%.2f ms) after arrival' % (latency, latency * 1000.0 / sample_rate)
+
+    print(text)
+    return reply
+
+
+def run(path=DEFAULT_PATH, num_annotations=10):
+    client = ControlClient(path)
+
+    times = sorted(client.send('Ping')[1] for _ in range(1000))
+    print('Ping round trip: median %.3f ms, 99th percentile %.3f ms, max %.3f ms'
+          % (times[len(times) // 2], times[len(times) * 99 // 100], times[-1]))
+
+    if client.send('IsAcquiring')[0] != 'OK 1':
+        report(client, 'StartAcquisition', 0)
+        time.sleep(1)
+
+    sample_rate = float(client.send('GetSampleRate')[0].split()[1])
+    print('Sample rate: %g Hz' % sample_rate)
+
+    report(client, 'StartRecord', sample_rate)
+
+    for i in range(num_annotations):
+        time.sleep(0.1)
+        report(client, 'Annotate trial %d' % i, sample_rate)
+
+    time.sleep(0.5)
+    report(client, 'StopRecord', sample_rate)
+    report(client, 'StopAcquisition', sample_rate)
+
+    client.close()
+
+
+if __name__ == '__main__':
+    path = sys.argv[1] if len(sys.argv) > 1 else DEFAULT_PATH
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 10
+    run(path, count)
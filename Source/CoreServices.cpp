@@ -155,6 +155,16 @@ namespace CoreServices
 			return getProcessorGraph()->getRecordNode()->getExperimentNumber();
 		}
 
+		juce::int64 getRecordingStartTimestamp()
+		{
+			return getProcessorGraph()->getRecordNode()->getRecordingStartTimestamp();
+		}
+
+		juce::int64 getRecordingEndTimestamp()
+		{
+			return getProcessorGraph()->getRecordNode()->getRecordingEndTimestamp();
+		}
+
 		void writeSpike(const SpikeEvent* spike, const SpikeChannel* chan)
 		{
 			getProcessorGraph()->getRecordNode()->writeSpike(spike, chan);
@@ -108,6 +108,13 @@ PLUGIN_API File getRecordingPath();
 PLUGIN_API int getRecordingNumber();
 PLUGIN_API int getExperimentNumber();
 
+/** Gets the timestamp of the first recorded sample of the current or last recording,
+or -1 until it has been written. See RecordNode::getRecordingStartTimestamp */
+PLUGIN_API juce::int64 getRecordingStartTimestamp();
+
+/** Gets the timestamp just past the last recorded sample, or -1 before the first */
+PLUGIN_API juce::int64 getRecordingEndTimestamp();
+
 /* Spike related methods. See record engine documentation */
 
 PLUGIN_API void writeSpike(const SpikeEvent* spike, const SpikeChannel* chan);
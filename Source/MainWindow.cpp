@@ -25,6 +25,9 @@
 #include "UI/UIComponent.h"
 #include "UI/EditorViewport.h"
 #include <stdio.h>
+
+/** Time between two autosaves of the signal chain */
+#define AUTOSAVE_INTERVAL_MS 60000
 //-----------------------------------------------------------------------
 
 static inline File getSavedStateDirectory() {
@@ -93,6 +96,9 @@ static inline File getSavedStateDirectory() {
 		ui->getEditorViewport()->loadState(file);
 	}
 
+	autosaver = new ConfigurationAutosaver(ui->getEditorViewport(),
+		getSavedStateDirectory().getChildFile(String("autosave") + BINARY_CONFIG_EXTENSION),
+		AUTOSAVE_INTERVAL_MS);
 
 
 }
@@ -100,6 +106,8 @@ static inline File getSavedStateDirectory() {
 MainWindow::~MainWindow()
 {
 
+	autosaver = nullptr;
+
 	if (audioComponent->callbacksAreActive())
 	{
 		audioComponent->endCallbacks();
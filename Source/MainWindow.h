@@ -28,6 +28,7 @@
 #include "UI/UIComponent.h"
 #include "Audio/AudioComponent.h"
 #include "Processors/ProcessorGraph/ProcessorGraph.h"
+#include "UI/ConfigurationAutosaver.h"
 
 /**
   The main window for the GUI application.
@@ -80,6 +81,9 @@ private:
     /** A pointer to the application's ProcessorGraph (owned by the MainWindow). */
     ScopedPointer<ProcessorGraph> processorGraph;
 
+    /** Saves the signal chain in the background, for recovery after a crash. */
+    ScopedPointer<ConfigurationAutosaver> autosaver;
+
 
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
@@ -127,6 +127,19 @@ AudioEditor::AudioEditor (AudioNode* owner)
     noiseGateSlider->setLookAndFeel (materialSliderLookAndFeel);
     noiseGateSlider->addListener (this);
     addAndMakeVisible (noiseGateSlider);
+
+    spreadSlider = new Slider ("Spread Slider");
+    spreadSlider->setSliderStyle (Slider::LinearHorizontal);
+    spreadSlider->setTextBoxStyle (Slider::NoTextBox,
+                                   false, 0, 0);
+    spreadSlider->setRange (0, 100, 1);
+    spreadSlider->setColour (Slider::backgroundColourId, COLOUR_SLIDER_TRACK);
+    spreadSlider->setColour (Slider::trackColourId,      COLOUR_SLIDER_TRACK_FILL);
+    spreadSlider->setColour (Slider::thumbColourId,      COLOUR_SLIDER_TRACK_FILL);
+    spreadSlider->setLookAndFeel (materialSliderLookAndFeel);
+    spreadSlider->setTooltip ("Spreads the monitored channels from left to right");
+    spreadSlider->addListener (this);
+    addAndMakeVisible (spreadSlider);
 }
 
 
@@ -144,9 +157,10 @@ void AudioEditor::resized()
     const bool isLatencyLabelVisible = width >= 450;
     const int audioWindowButtonWidth = isLatencyLabelVisible ? 110 : 60;
     const int gateLabelWidth         = 45;
+    const int spreadLabelWidth       = 60;
 
-    const int availableWidth = width - audioWindowButtonWidth - gateLabelWidth;
-    const int sliderWidth    = availableWidth * 0.4;
+    const int availableWidth = width - audioWindowButtonWidth - gateLabelWidth - spreadLabelWidth;
+    const int sliderWidth    = availableWidth * 0.27;
     const int sliderHeight   = height - 6;
     const int sliderY        = (height - sliderHeight) / 2;
     const int margin         = availableWidth * 0.03;
@@ -154,6 +168,7 @@ void AudioEditor::resized()
     muteButton->setBounds           (margin, 5, 20, 20);
     volumeSlider->setBounds         (margin + 30, sliderY, sliderWidth, sliderHeight);
     noiseGateSlider->setBounds      (volumeSlider->getRight() + margin + gateLabelWidth, sliderY, sliderWidth, sliderHeight);
+    spreadSlider->setBounds         (noiseGateSlider->getRight() + margin + spreadLabelWidth, sliderY, sliderWidth, sliderHeight);
     audioWindowButton->setBounds    (width - audioWindowButtonWidth + 2, 5, audioWindowButtonWidth, height);
 }
 
@@ -237,9 +252,11 @@ void AudioEditor::buttonClicked (Button* button)
 void AudioEditor::sliderValueChanged (Slider* slider)
 {
     if (slider == volumeSlider)
-        getAudioProcessor()->setParameter (1, slider->getValue());
+        getAudioProcessor()->setParameter (AudioNode::VOLUME, slider->getValue());
     else if (slider == noiseGateSlider)
-        getAudioProcessor()->setParameter (2, slider->getValue());
+        getAudioProcessor()->setParameter (AudioNode::NOISE_GATE, slider->getValue());
+    else if (slider == spreadSlider)
+        getAudioProcessor()->setParameter (AudioNode::SPREAD, slider->getValue());
 }
 
 void AudioEditor::componentVisibilityChanged(Component& component)
@@ -257,6 +274,7 @@ void AudioEditor::paint (Graphics& g)
     g.setColour (Colours::lightgrey);
     g.setFont (Font("Small Text", 12, Font::plain));
     g.drawSingleLineText ("GATE:", volumeSlider->getBounds().getRight() + margin, 20);
+    g.drawSingleLineText ("SPREAD:", noiseGateSlider->getBounds().getRight() + margin, 20);
 }
 
 
@@ -266,6 +284,7 @@ void AudioEditor::saveStateToXml (XmlElement* xml)
     audioEditorState->setAttribute ("isMuted",   muteButton->getToggleState());
     audioEditorState->setAttribute ("volume",    volumeSlider->getValue());
     audioEditorState->setAttribute ("noiseGate", noiseGateSlider->getValue());
+    audioEditorState->setAttribute ("spread",    spreadSlider->getValue());
 }
 
 
@@ -279,6 +298,7 @@ void AudioEditor::loadStateFromXml (XmlElement* xml)
 
             volumeSlider->setValue    (xmlNode->getDoubleAttribute ("volume",    0.0f), NotificationType::sendNotification);
             noiseGateSlider->setValue (xmlNode->getDoubleAttribute ("noiseGate", 0.0f), NotificationType::sendNotification);
+            spreadSlider->setValue    (xmlNode->getDoubleAttribute ("spread",    0.0f), NotificationType::sendNotification);
         }
     }
 
@@ -136,6 +136,7 @@ private:
 
     ScopedPointer<Slider> volumeSlider;
     ScopedPointer<Slider> noiseGateSlider;
+    ScopedPointer<Slider> spreadSlider;
 
     SharedResourcePointer<MaterialSliderLookAndFeel> materialSliderLookAndFeel;
 
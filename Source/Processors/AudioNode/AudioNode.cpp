@@ -26,7 +26,8 @@
 #include "AudioNode.h"
 
 AudioNode::AudioNode()
-    : GenericProcessor("Audio Node"), audioEditor(0), volume(0.00001f), noiseGateLevel(0.0f)
+    : GenericProcessor("Audio Node"), audioEditor(0), volume(0.00001f), noiseGateLevel(0.0f), spread(0.0f),
+      destBufferSampleRate(44100.0), estimatedSamples(1024)
 {
 
     // settings.numInputs = 4096;
@@ -37,7 +38,8 @@ AudioNode::AudioNode()
     //nextAvailableChannel = 2; // keep first two channels empty
     resetConnections();
 
-    tempBuffer = new AudioSampleBuffer(16, 1024);
+    tempBuffer = new AudioSampleBuffer(2, 4096);
+    resampleBuffer = new AudioSampleBuffer(2, 4096);
 
 }
 
@@ -141,18 +143,24 @@ void AudioNode::updatePlaybackBuffer()
 void AudioNode::setParameter(int parameterIndex, float newValue)
 {
     // change left channel, right channel, or volume
-    if (parameterIndex == 1)
+    if (parameterIndex == VOLUME)
     {
         // volume level
         volume = newValue*0.1f;
 
     }
-    else if (parameterIndex == 2)
+    else if (parameterIndex == NOISE_GATE)
     {
         // noiseGateLevel level
 
         expander.setThreshold(newValue); // in microVolts
 
+    }
+    else if (parameterIndex == SPREAD)
+    {
+        // stereo spread, in percent of the full width
+        spread = jlimit(0.0f, 1.0f, newValue * 0.01f);
+
     }
     else if (parameterIndex == 100)
     {
@@ -179,58 +187,100 @@ void AudioNode::prepareToPlay(double sampleRate_, int estimatedSamplesPerBlock)
 	{
 		destBufferSampleRate = sampleRate_;
 		estimatedSamples = estimatedSamplesPerBlock;
-		recreateBuffers();
+		recreateBuffers(false);
 	}
 
 }
 
-void AudioNode::recreateBuffers()
+void AudioNode::recreateBuffers(bool useScratchArena)
 {
-	numSamplesExpected.clear();
-    samplesInBackupBuffer.clear();
-    samplesInOverflowBuffer.clear();
-    ratio.clear();
-    filters.clear();
-    bufferA.clear();
-    bufferB.clear();
-    bufferSwap.clear();
+    groups.clear();
+    panLeft.clear();
+    panRight.clear();
+
+    int maxSamplesExpected = 4096;
 
     for (int i = 0; i < dataChannelArray.size(); i++)
     {
-        // processor sample rate divided by sound card sample rate
-        numSamplesExpected.add((int)(dataChannelArray[i]->getSampleRate()/destBufferSampleRate*float(estimatedSamples)) + 1);
-        samplesInBackupBuffer.add(0);
-        samplesInOverflowBuffer.add(0);
-        sourceBufferSampleRate.add(dataChannelArray[i]->getSampleRate());
+        const DataChannel* ch = dataChannelArray[i];
+        MonitorGroup* group = nullptr;
+
+        for (int g = 0; g < groups.size(); g++)
+        {
+            if (groups[g]->sourceNodeId == ch->getSourceNodeID()
+                && groups[g]->subProcessorIdx == ch->getSubProcessorIdx())
+            {
+                group = groups[g];
+                break;
+            }
+        }
+
+        if (group == nullptr)
+        {
+            group = new MonitorGroup();
+            group->sourceNodeId = ch->getSourceNodeID();
+            group->subProcessorIdx = ch->getSubProcessorIdx();
+            group->sourceSampleRate = ch->getSampleRate();
 
-        filters.add(new Dsp::SmoothedFilterDesign<Dsp::RBJ::Design::LowPass, 1> (1024));
+            // processor sample rate divided by sound card sample rate
+            group->numSamplesExpected = (int)(group->sourceSampleRate/destBufferSampleRate*float(estimatedSamples)) + 1;
+            group->ratio = float(group->numSamplesExpected)/float(estimatedSamples);
+            maxSamplesExpected = jmax(maxSamplesExpected, group->numSamplesExpected);
 
-        ratio.add(float(numSamplesExpected[i])/float(estimatedSamples));
-        updateFilter(i);
+            group->bufferSwap = false;
+            group->samplesInBackupBuffer = 0;
+            group->samplesInOverflowBuffer = 0;
 
-        bufferA.add(new AudioSampleBuffer(1,10000));
-        bufferB.add(new AudioSampleBuffer(1,10000));
-        bufferSwap.add(false);
+            group->filter = new Dsp::SmoothedFilterDesign<Dsp::RBJ::Design::LowPass, 2> (1024);
+            updateFilter(*group);
 
+            if (useScratchArena)
+            {
+                // the overflow buffers carry samples from one block to the next
+                requestScratchBuffer(group->bufferA, 2, 10000, true);
+                requestScratchBuffer(group->bufferB, 2, 10000, true);
+            }
+            else
+            {
+                group->bufferA.setSize(2, 10000);
+                group->bufferB.setSize(2, 10000);
+            }
+
+            groups.add(group);
+        }
+
+        group->channels.add(i);
+        panLeft.add(1.0f);
+        panRight.add(1.0f);
     }
 
-//    tempBuffer->setSize(getNumInputs(), 4096);
-    tempBuffer->setSize(1, 4096);
+    const int maxValuesNeeded = jmax(4096, estimatedSamples);
+
+    if (useScratchArena)
+    {
+        requestScratchBuffer(*tempBuffer, 2, maxSamplesExpected);
+        requestScratchBuffer(*resampleBuffer, 2, maxValuesNeeded);
+    }
+    else
+    {
+        tempBuffer->setSize(2, maxSamplesExpected);
+        resampleBuffer->setSize(2, maxValuesNeeded);
+    }
 }
 
 bool AudioNode::enable()
 {
-	recreateBuffers();
+	recreateBuffers(true);
 	return true;
 }
 
-void AudioNode::updateFilter(int i)
+void AudioNode::updateFilter(MonitorGroup& group)
 {
 
-    double cutoffFreq = (ratio[i] > 1.0) ? 2 * destBufferSampleRate  // downsample
+    double cutoffFreq = (group.ratio > 1.0) ? 2 * destBufferSampleRate  // downsample
                         : destBufferSampleRate / 2; // upsample
 
-    double sampleFreq = (ratio[i] > 1.0) ? sourceBufferSampleRate[i] // downsample
+    double sampleFreq = (group.ratio > 1.0) ? group.sourceSampleRate // downsample
                         : destBufferSampleRate;  // upsample
 
     Dsp::Params params;
@@ -238,255 +288,204 @@ void AudioNode::updateFilter(int i)
     params[1] = cutoffFreq; // cutoff frequency
     params[2] = 1.25; //Q //
 
-    filters[i]->setParams(params);
+    group.filter->setParams(params);
 
 }
 
-void AudioNode::process(AudioSampleBuffer& buffer)
+void AudioNode::updatePan()
 {
-    float gain;
-    int valuesNeeded = buffer.getNumSamples(); // samples needed to fill out the buffer
+    int numMonitored = 0;
+
+    for (int i = 0; i < dataChannelArray.size(); i++)
+        if (dataChannelArray[i]->isMonitored())
+            numMonitored++;
+
+    int position = 0;
+
+    for (int i = 0; i < dataChannelArray.size(); i++)
+    {
+        if (!dataChannelArray[i]->isMonitored())
+            continue;
+
+        // -1 is hard left and +1 hard right
+        const float x = (numMonitored > 1) ? spread * (2.0f * position / (numMonitored - 1) - 1.0f) : 0.0f;
+
+        // constant power pan, scaled so that a centred channel keeps unity gain on both sides
+        const float angle = (x + 1.0f) * float_Pi * 0.25f;
+        panLeft.setUnchecked(i, std::sqrt(2.0f) * std::cos(angle));
+        panRight.setUnchecked(i, std::sqrt(2.0f) * std::sin(angle));
 
-    //std::cout << "Buffer size: " << buffer.getNumChannels() << std::endl;
+        position++;
+    }
+}
+
+void AudioNode::process(AudioSampleBuffer& buffer)
+{
+    // samples needed to fill out the buffer
+    int valuesNeeded = jmin(buffer.getNumSamples(), resampleBuffer->getNumSamples());
 
     // clear the left and right channels
     buffer.clear(0,0,buffer.getNumSamples());
     buffer.clear(1,0,buffer.getNumSamples());
 
-    if (1)
-    {
+    // the channels changed since the buffers were made
+    if (panLeft.size() != dataChannelArray.size())
+        return;
 
-        AudioSampleBuffer* overflowBuffer;
-        AudioSampleBuffer* backupBuffer;
+    updatePan();
 
-        int nInputs = dataChannelArray.size();
-        if (nInputs > 0) // we have some channels
-        {
+    for (int g = 0; g < groups.size(); g++)
+        processGroup(*groups[g], buffer, valuesNeeded);
 
-//            tempBuffer->clear();
+    // Simple implementation of a "noise gate" on audio output
+    expander.process(buffer.getWritePointer(0),
+                     buffer.getWritePointer(1),
+                     valuesNeeded);
+}
 
-            for (int i = 0; i < nInputs; i++) // cycle through them all
-            {
+void AudioNode::processGroup(MonitorGroup& group, AudioSampleBuffer& buffer, int valuesNeeded)
+{
+    bool isMonitored = false;
 
-                if (dataChannelArray[i]->isMonitored())
-                {
-                    tempBuffer->clear();
-                    //std::cout << "Processing channel " << i << std::endl;
+    for (int c = 0; c < group.channels.size() && !isMonitored; c++)
+        isMonitored = dataChannelArray[group.channels.getUnchecked(c)]->isMonitored();
 
-                    if (!bufferSwap[i])
-                    {
-                        overflowBuffer = bufferA[i];
-                        backupBuffer = bufferB[i];
+    if (!isMonitored)
+    {
+        // don't play stale samples when the group is monitored again
+        group.samplesInBackupBuffer = 0;
+        return;
+    }
 
-                        bufferSwap.set(i,true);
-                    }
-                    else
-                    {
-                        overflowBuffer = bufferB[i];
-                        backupBuffer = bufferA[i];
+    AudioSampleBuffer* overflowBuffer;
+    AudioSampleBuffer* backupBuffer;
 
-                        bufferSwap.set(i,false);
-                    }
+    if (!group.bufferSwap)
+    {
+        overflowBuffer = &group.bufferA;
+        backupBuffer = &group.bufferB;
+    }
+    else
+    {
+        overflowBuffer = &group.bufferB;
+        backupBuffer = &group.bufferA;
+    }
 
-                    backupBuffer->clear();
+    group.bufferSwap = !group.bufferSwap;
 
-                    samplesInOverflowBuffer.set(i,samplesInBackupBuffer[i]); // size of buffer after last round
-                    samplesInBackupBuffer.set(i,0);
+    group.samplesInOverflowBuffer = group.samplesInBackupBuffer; // size of buffer after last round
 
-                    int orphanedSamples = 0;
+    // 1. copy overflow buffer, and move what is left of it to the backup buffer
 
-                    // 1. copy overflow buffer
+    const int samplesToCopyFromOverflowBuffer = jmin(group.samplesInOverflowBuffer, group.numSamplesExpected);
+    const int leftoverSamples = group.samplesInOverflowBuffer - samplesToCopyFromOverflowBuffer;
 
-                    int samplesToCopyFromOverflowBuffer =
-                        ((samplesInOverflowBuffer[i] <= numSamplesExpected[i]) ?
-                         samplesInOverflowBuffer[i] :
-                         numSamplesExpected[i]);
+    // 2. mix the incoming samples, and keep the ones that don't fit for the next round
 
-                    //std::cout << "Copying " << samplesToCopyFromOverflowBuffer << " samples from overflow buffer of " << samplesInOverflowBuffer[i] << " samples." << std::endl;
+    const int samplesAvailable = getNumSourceSamples(group.sourceNodeId, group.subProcessorIdx);
+    const int samplesToCopyFromIncomingBuffer = jmin(group.numSamplesExpected - samplesToCopyFromOverflowBuffer,
+                                                     samplesAvailable);
 
-                    if (samplesToCopyFromOverflowBuffer > 0) // need to re-add samples from backup buffer
-                    {
+    int orphanedSamples = samplesAvailable - samplesToCopyFromIncomingBuffer;
 
-                        tempBuffer->addFrom(0,    // destination channel
-                                            0,                // destination start sample
-                                            *overflowBuffer,  // source
-                                            0,                // source channel
-                                            0,                // source start sample
-                                            samplesToCopyFromOverflowBuffer,    // number of samples
-                                            1.0f              // gain to apply
-                                           );
+    if (leftoverSamples + orphanedSamples >= backupBuffer->getNumSamples())
+        orphanedSamples = 0;
 
-                        int leftoverSamples = samplesInOverflowBuffer[i] - samplesToCopyFromOverflowBuffer;
+    group.samplesInBackupBuffer = leftoverSamples + orphanedSamples;
 
-                        // std::cout << "Samples remaining in overflow buffer: " << leftoverSamples << std::endl;
+    for (int side = 0; side < 2; side++)
+    {
+        tempBuffer->copyFrom(side, 0, *overflowBuffer, side, 0, samplesToCopyFromOverflowBuffer);
+        tempBuffer->clear(side, samplesToCopyFromOverflowBuffer, group.numSamplesExpected - samplesToCopyFromOverflowBuffer);
 
-                        if (leftoverSamples > 0) // move remaining samples to the backup buffer
-                        {
+        if (leftoverSamples > 0)
+            backupBuffer->copyFrom(side, 0, *overflowBuffer, side, samplesToCopyFromOverflowBuffer, leftoverSamples);
 
-                            backupBuffer->addFrom(0, // destination channel
-                                                  0,                     // destination start sample
-                                                  *overflowBuffer,       // source
-                                                  0,                     // source channel
-                                                  samplesToCopyFromOverflowBuffer,         // source start sample
-                                                  leftoverSamples,       // number of samples
-                                                  1.0f                   // gain to apply
-                                                 );
-                        }
+        backupBuffer->clear(side, leftoverSamples, orphanedSamples);
+    }
 
-                        samplesInBackupBuffer.set(i,leftoverSamples);
-                    }
+    for (int c = 0; c < group.channels.size(); c++)
+    {
+        const int i = group.channels.getUnchecked(c);
 
-                    gain = volume/(float(0x7fff) * dataChannelArray[i]->getBitVolts());
-                    // Data are floats in units of microvolts, so dividing by bitVolts and 0x7fff (max value for 16b signed)
-                    // rescales to between -1 and +1. Audio output starts So, maximum gain applied to maximum data would be 10.
+        if (!dataChannelArray[i]->isMonitored())
+            continue;
 
-                    int remainingSamples = numSamplesExpected[i] - samplesToCopyFromOverflowBuffer;
+        const float gain = volume/(float(0x7fff) * dataChannelArray[i]->getBitVolts());
+        // Data are floats in units of microvolts, so dividing by bitVolts and 0x7fff (max value for 16b signed)
+        // rescales to between -1 and +1. Audio output starts So, maximum gain applied to maximum data would be 10.
 
-                    int samplesAvailable = getNumSourceSamples(dataChannelArray[i]->getSourceNodeID(), dataChannelArray[i]->getSubProcessorIdx());
+        const float sideGain[2] = { gain * panLeft.getUnchecked(i), gain * panRight.getUnchecked(i) };
 
-                    int samplesToCopyFromIncomingBuffer = ((remainingSamples <= samplesAvailable) ?
-                                                           remainingSamples :
-                                                           samplesAvailable);
+        for (int side = 0; side < 2; side++)
+        {
+            if (samplesToCopyFromIncomingBuffer > 0)
+                tempBuffer->addFrom(side,                            // destination channel
+                                    samplesToCopyFromOverflowBuffer, // destination start sample
+                                    buffer,                          // source
+                                    i+2,                             // source channel (add 2 to account for output channels)
+                                    0,                               // source start sample
+                                    samplesToCopyFromIncomingBuffer, // number of samples
+                                    sideGain[side]);                 // gain to apply
+
+            if (orphanedSamples > 0)
+                backupBuffer->addFrom(side,                            // destination channel
+                                      leftoverSamples,                 // destination start sample
+                                      buffer,                          // source
+                                      i+2,                             // source channel
+                                      samplesToCopyFromIncomingBuffer, // source start sample
+                                      orphanedSamples,                 // number of samples
+                                      sideGain[side]);                 // gain to apply
+        }
+    }
 
-                    //std::cout << "Copying " << samplesToCopyFromIncomingBuffer << " samples from incoming buffer of " << samplesAvailable << " samples." << std::endl;
+    // 3. now that our tempBuffer is ready, we can filter it and resample it into the output
 
+    const int sourceBufferSize = group.numSamplesExpected;
 
-                    if (samplesToCopyFromIncomingBuffer > 0)
-                    {
+    float* source[2] = { tempBuffer->getWritePointer(0), tempBuffer->getWritePointer(1) };
+    float* dest[2] = { resampleBuffer->getWritePointer(0), resampleBuffer->getWritePointer(1) };
 
-                        //tempBuffer->addFrom(i,       // destination channel
-                        tempBuffer->addFrom(0,       // destination channel
-                                            samplesToCopyFromOverflowBuffer,           // destination start sample
-                                            buffer,      // source
-                                            i+2,           // source channel (add 2 to account for output channels)
-                                            0,           // source start sample
-                                            samplesToCopyFromIncomingBuffer, //  number of samples
-                                            gain       // gain to apply
-                                           );
+    if (group.ratio > 1.00001)
+    {
+        // pre-apply filter before downsampling
+        group.filter->process(sourceBufferSize, source);
+    }
 
-                        //if (destBufferPos == 0)
-                        //  std::cout << "Temp buffer 0 value: " << *tempBuffer->getReadPointer(i,0) << std::endl;
+    // linear interpolation, code modified from "juce_ResamplingAudioSource.cpp":
 
-                    }
-
-                    orphanedSamples = samplesAvailable - samplesToCopyFromIncomingBuffer;
+    int sourceBufferPos = 0;
+    int nextPos = (sourceBufferPos + 1) % sourceBufferSize;
+    double subSampleOffset = 0.0;
 
-                    // std::cout << "Samples remaining in incoming buffer: " << orphanedSamples << std::endl;
+    for (int destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
+    {
+        const float alpha = (float) subSampleOffset;
+        const float invAlpha = 1.0f - alpha;
 
-                    if (orphanedSamples > 0 && (samplesInBackupBuffer[i] + orphanedSamples < backupBuffer->getNumSamples()))
-                    {
+        dest[0][destBufferPos] = invAlpha * source[0][sourceBufferPos] + alpha * source[0][nextPos];
+        dest[1][destBufferPos] = invAlpha * source[1][sourceBufferPos] + alpha * source[1][nextPos];
 
-                        backupBuffer->addFrom(0,                            // destination channel
-                                              samplesInBackupBuffer[i],     // destination start sample
-                                              buffer,                       // source
-                                              i+2,                          // source channel (add 2 to account for output channels)
-                                              remainingSamples,             // source start sample
-                                              orphanedSamples,              //  number of samples
-                                              gain                          // gain to apply
-                                             );
+        subSampleOffset += group.ratio;
 
-                        samplesInBackupBuffer.set(i, samplesInBackupBuffer[i] + orphanedSamples);
+        while (subSampleOffset >= 1.0)
+        {
+            if (++sourceBufferPos >= sourceBufferSize)
+                sourceBufferPos = 0;
 
-                    }
-
-                    // now that our tempBuffer is ready, we can filter it and copy it into the
-                    // original buffer
-
-                    //std::cout << "Ratio = " << ratio[i] << ", gain = " << gain << std::endl;
-                    //std::cout << "Values needed = " << valuesNeeded << ", channel = " << i << std::endl;
-
-                    if (ratio[i] > 1.00001)
-                    {
-                        // pre-apply filter before downsampling
-                        float* ptr = tempBuffer->getWritePointer(i);
-                        filters[i]->process(numSamplesExpected[i], &ptr);
-                    }
-
-                    // initialize variables
-                    int sourceBufferPos = 0;
-                    int sourceBufferSize = numSamplesExpected[i];
-                    float subSampleOffset = 0.0;
-                    int nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-
-                    int destBufferPos;
-
-                    // code modified from "juce_ResamplingAudioSource.cpp":
-
-                    for (destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
-                    {
-                        float gain = 1.0;
-                        float alpha = (float) subSampleOffset;
-                        float invAlpha = 1.0f - alpha;
-
-                        // std::cout << "Copying sample " << sourceBufferPos << std::endl;
-
-                        buffer.addFrom(0,    // destChannel
-                                       destBufferPos,  // destSampleOffset
-                                       *tempBuffer,     // source
-                                       //i,    // sourceChannel
-                                       0,       // sourceChannel
-                                       sourceBufferPos,// sourceSampleOffset
-                                       1,        // number of samples
-                                       invAlpha*gain);      // gain to apply to source
-
-                        buffer.addFrom(0,    // destChannel
-                                       destBufferPos,   // destSampleOffset
-                                       *tempBuffer,     // source
-                                       //i,      // sourceChannel
-                                       0,      // sourceChannel
-                                       nextPos,      // sourceSampleOffset
-                                       1,        // number of samples
-                                       alpha*gain);       // gain to apply to source
-
-                        // if (destBufferPos == 0)
-                        //std::cout << "Output buffer 0 value: " << *buffer.getReadPointer(i+2,destBufferPos) << std::endl;
-
-                        subSampleOffset += ratio[i];
-
-                        while (subSampleOffset >= 1.0)
-                        {
-                            if (++sourceBufferPos >= sourceBufferSize)
-                                sourceBufferPos = 0;
-
-                            nextPos = (sourceBufferPos + 1) % sourceBufferSize;
-                            subSampleOffset -= 1.0;
-                        }
-                    }
-
-                    if (ratio[i] < 0.99999)
-                    {
-                        // apply the filter after upsampling
-                        float* ptr = buffer.getWritePointer(0);
-                        filters[i]->process(destBufferPos, &ptr);
-                    }
-
-                    // now copy the channel into the output zone
-
-                    // buffer.addFrom(0,    // destChannel
-                    //                0,  // destSampleOffset
-                    //                buffer,     // source
-                    //                 i+2,    // sourceChannel
-                    //                 0,// sourceSampleOffset
-                    //                 valuesNeeded,        // number of samples
-                    //                 1.0);      // gain to apply to source
-
-                } // if channelPointers[i]->isMonitored
-            } // end cycling through channels
-
-            // Simple implementation of a "noise gate" on audio output
-            expander.process(buffer.getWritePointer(0), // expand the left channel
-                             buffer.getNumSamples());
-
-            // copy the signal into the right channel (no stereo audio yet!)
-            buffer.addFrom(1,    // destChannel
-                           0,  // destSampleOffset
-                           buffer,     // source
-                           0,    // sourceChannel
-                           0,// sourceSampleOffset
-                           valuesNeeded,        // number of samples
-                           1.0);      // gain to apply to source
+            nextPos = (sourceBufferPos + 1) % sourceBufferSize;
+            subSampleOffset -= 1.0;
         }
     }
+
+    if (group.ratio < 0.99999)
+    {
+        // apply the filter after upsampling
+        group.filter->process(valuesNeeded, dest);
+    }
+
+    buffer.addFrom(0, 0, *resampleBuffer, 0, 0, valuesNeeded);
+    buffer.addFrom(1, 0, *resampleBuffer, 1, 0, valuesNeeded);
 }
 
 
@@ -569,3 +568,26 @@ void Expander::process(float* sampleData, int numSamples)
         sampleData[i] = sampleData[i] * gain;
     }
 }
+
+
+void Expander::process(float* left, float* right, int numSamples)
+{
+    float det, transfer_gain;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        det = jmax(fabs(left[i]), fabs(right[i]));
+        det += 10e-30f; /* add tiny DC offset (-600dB) to prevent denormals */
+
+        env = det >= env ? det : det + envelope_decay*(env-det);
+
+        transfer_gain = env < threshold ? pow(env, transfer_A) * transfer_B : output;
+
+        gain = transfer_gain < gain ?
+               transfer_gain + attack * (gain - transfer_gain) :
+               transfer_gain + release * (gain - transfer_gain);
+
+        left[i] = left[i] * gain;
+        right[i] = right[i] * gain;
+    }
+}
@@ -53,6 +53,12 @@ class AudioEditor;
   control the channels going to the audio monitor; it all happens in a distributed
   way through the individual processors.
 
+  Monitored channels that come from the same source share its sample rate and block
+  size, so they are mixed into one stereo pair first, and only that pair is filtered
+  and resampled to the rate of the sound card. The cost of monitoring more channels of
+  a source is one multiply-add per sample and side. The spread parameter places the
+  monitored channels from left to right in channel order; at 0 all of them are centred.
+
   @see GenericProcessor, AudioEditor
 
 */
@@ -69,6 +75,9 @@ public:
 
   void process(float* sampleData, int numSamples);
 
+  /** Applies the same gain to both channels, following the louder of them */
+  void process(float* left, float* right, int numSamples);
+
 private:
     float   threshold;
     float   attack, release, envelope_decay;
@@ -122,7 +131,13 @@ public:
 
     void prepareToPlay(double sampleRate_, int estimatedSamplesPerBlock) override;
 
-    void updateFilter(int i);
+    /** Monitor parameters set through setParameter() */
+    enum Parameter
+    {
+        VOLUME = 1,
+        NOISE_GATE = 2,
+        SPREAD = 3
+    };
 
 	bool enable() override;
 
@@ -133,36 +148,62 @@ public:
     void registerProcessor(const GenericProcessor* sourceNode);
 
 private:
-	void recreateBuffers();
+    /** The monitored channels of one source, mixed and resampled together */
+    struct MonitorGroup
+    {
+        uint16 sourceNodeId;
+        uint16 subProcessorIdx;
+        double sourceSampleRate;
+
+        // source samples needed for one block of the sound card, and their ratio
+        int numSamplesExpected;
+        double ratio;
+
+        // stereo mix of the samples left over from previous blocks
+        AudioSampleBuffer bufferA;
+        AudioSampleBuffer bufferB;
+        bool bufferSwap;
+        int samplesInBackupBuffer;
+        int samplesInOverflowBuffer;
+
+        ScopedPointer<Dsp::Filter> filter;
+
+        /** Indexes in dataChannelArray */
+        Array<int> channels;
+    };
+
+	/** Rebuilds the per-source resampling state. With useScratchArena, the buffers are
+	    requested from the graph's ScratchArena instead of being allocated here. */
+	void recreateBuffers(bool useScratchArena);
+
+    void updateFilter(MonitorGroup& group);
+
+    /** Sets the left and right gain of every monitored channel from the spread */
+    void updatePan();
+
+    /** Mixes, filters and resamples one group, adding it to the output */
+    void processGroup(MonitorGroup& group, AudioSampleBuffer& buffer, int valuesNeeded);
 
     Array<int> leftChan;
     Array<int> rightChan;
     float volume;
     float noiseGateLevel; // in microvolts
+    float spread;
 
-    OwnedArray<AudioSampleBuffer> bufferA;
-    OwnedArray<AudioSampleBuffer> bufferB;
-
-    Array<int> numSamplesExpected;
-
-    Array<int> samplesInBackupBuffer;
-    Array<int> samplesInOverflowBuffer;
-    Array<double> sourceBufferSampleRate;
     double destBufferSampleRate;
 	int estimatedSamples;
 
-    Array<bool> bufferSwap;
-
     Expander expander;
 
-    // sample rate, timebase, and ratio info:
-    Array<double> ratio;
+    OwnedArray<MonitorGroup> groups;
 
-    // major objects:
-    OwnedArray<Dsp::Filter> filters;
+    // pan gains of each channel of dataChannelArray
+    Array<float> panLeft;
+    Array<float> panRight;
 
-    // Temporary buffer for data
+    // Temporary buffers for the stereo mix of a group, before and after resampling
     ScopedPointer<AudioSampleBuffer> tempBuffer;
+    ScopedPointer<AudioSampleBuffer> resampleBuffer;
 
 	//private map for datachannels with info relative to multiple processors
 	std::unordered_map<uint16, std::map<uint16, int>> audioDataChannelMap;
@@ -23,6 +23,89 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "InfoObjects.h"
 #include "../GenericProcessor/GenericProcessor.h"
+#include <unordered_map>
+
+/** Ancilliary objects **/
+//InfoStringTable
+namespace
+{
+	struct InfoStringTableData
+	{
+		InfoStringTableData()
+		{
+			strings.add(String::empty);
+			ids.set(String::empty, 0);
+			historyParent.add(0);
+			historyEntry.add(0);
+		}
+
+		CriticalSection lock;
+
+		StringArray strings;
+		HashMap<String, uint32> ids;
+
+		//Each history id is an entry appended to a parent history
+		Array<uint32> historyParent;
+		Array<uint32> historyEntry;
+		std::unordered_map<uint64, uint32> historyIds;
+	};
+
+	InfoStringTableData& getInfoStringTable()
+	{
+		static InfoStringTableData table;
+		return table;
+	}
+}
+
+uint32 InfoStringTable::intern(const String& text)
+{
+	InfoStringTableData& table = getInfoStringTable();
+	const ScopedLock sl(table.lock);
+
+	if (table.ids.contains(text))
+		return table.ids[text];
+
+	const uint32 id = table.strings.size();
+	table.strings.add(text);
+	table.ids.set(text, id);
+	return id;
+}
+
+String InfoStringTable::get(uint32 id)
+{
+	InfoStringTableData& table = getInfoStringTable();
+	const ScopedLock sl(table.lock);
+	return table.strings[id];
+}
+
+uint32 InfoStringTable::extendHistory(uint32 historyId, uint32 entryId)
+{
+	InfoStringTableData& table = getInfoStringTable();
+	const ScopedLock sl(table.lock);
+
+	const uint64 key = (uint64(historyId) << 32) | entryId;
+	auto it = table.historyIds.find(key);
+	if (it != table.historyIds.end())
+		return it->second;
+
+	const uint32 id = table.historyParent.size();
+	table.historyParent.add(historyId);
+	table.historyEntry.add(entryId);
+	table.historyIds[key] = id;
+	return id;
+}
+
+String InfoStringTable::getHistory(uint32 historyId)
+{
+	InfoStringTableData& table = getInfoStringTable();
+	const ScopedLock sl(table.lock);
+
+	StringArray entries;
+	for (uint32 id = historyId; id != 0; id = table.historyParent[id])
+		entries.insert(0, table.strings[table.historyEntry[id]]);
+
+	return entries.joinIntoString(" -> ");
+}
 
 /** Common classes **/
 //Empty protected constructors
@@ -30,8 +113,8 @@ HistoryObject::HistoryObject() {}
 NamedInfoObject::NamedInfoObject() {}
 
 //NodeInfoBase
-NodeInfoBase::NodeInfoBase(uint16 id, uint16 idx, String type, String name) :
-m_nodeID(id), m_nodeIdx(idx), m_currentNodeType(type), m_currentNodeName(name)
+NodeInfoBase::NodeInfoBase(uint16 id, uint16 idx, uint32 typeId, uint32 nameId) :
+m_nodeID(id), m_nodeIdx(idx), m_currentNodeTypeId(typeId), m_currentNodeNameId(nameId)
 {}
 
 NodeInfoBase::~NodeInfoBase()
@@ -49,12 +132,12 @@ uint16 NodeInfoBase::getCurrentNodeChannelIdx() const
 
 String NodeInfoBase::getCurrentNodeType() const
 {
-	return m_currentNodeType;
+	return InfoStringTable::get(m_currentNodeTypeId);
 }
 
 String NodeInfoBase::getCurrentNodeName() const
 {
-	return m_currentNodeName;
+	return InfoStringTable::get(m_currentNodeNameId);
 }
 
 //History Object
@@ -63,23 +146,25 @@ HistoryObject::~HistoryObject()
 
 String HistoryObject::getHistoricString() const
 {
-	return m_historicString;
+	return InfoStringTable::getHistory(m_historyId);
 }
 
 void HistoryObject::addToHistoricString(String entry)
 {
-	if (m_historicString.isEmpty())
-		m_historicString = entry;
-	else
-		m_historicString += (" -> " + entry);
+	addToHistory(InfoStringTable::intern(entry));
+}
+
+void HistoryObject::addToHistory(uint32 entryId)
+{
+	m_historyId = InfoStringTable::extendHistory(m_historyId, entryId);
 }
 
 //SourceProcessorInfo
 SourceProcessorInfo::SourceProcessorInfo(const GenericProcessor* source, uint16 subproc) 
 	:	m_sourceNodeID(source->getNodeId()),
 		m_sourceSubNodeIndex(subproc), 
-		m_sourceType(source->getName()),
-		m_sourceName(source->getName()), //TODO: fix those two when we have the ability to rename processors
+		m_sourceTypeId(source->getNameId()),
+		m_sourceNameId(source->getNameId()), //TODO: fix those two when we have the ability to rename processors
 		m_sourceSubProcessorCount(source->getNumSubProcessors())
 {
 }
@@ -99,12 +184,12 @@ uint16 SourceProcessorInfo::getSubProcessorIdx() const
 
 String SourceProcessorInfo::getSourceType() const
 {
-	return m_sourceType;
+	return InfoStringTable::get(m_sourceTypeId);
 }
 
 String SourceProcessorInfo::getSourceName() const
 {
-	return m_sourceName;
+	return InfoStringTable::get(m_sourceNameId);
 }
 
 uint16 SourceProcessorInfo::getSourceSubprocessorCount() const
@@ -128,27 +213,27 @@ String NamedInfoObject::getName() const
 
 void NamedInfoObject::setIdentifier(String identifier)
 {
-	m_identifier = identifier;
+	m_identifierId = InfoStringTable::intern(identifier);
 }
 
 String NamedInfoObject::getIdentifier() const
 {
-	return m_identifier;
+	return InfoStringTable::get(m_identifierId);
 }
 
 void NamedInfoObject::setDescription(String description)
 {
-	m_description = description;
+	m_descriptionId = InfoStringTable::intern(description);
 }
 
 String NamedInfoObject::getDescription() const
 {
-	return m_description;
+	return InfoStringTable::get(m_descriptionId);
 }
 
 //InfoObjectCommon
 InfoObjectCommon::InfoObjectCommon(uint16 idx, uint16 typeidx, float sampleRate, const GenericProcessor* source, uint16 subproc)
-	:	NodeInfoBase(source->getNodeId(), idx, source->getName(), source->getName()), //TODO: fix those two when we have the ability to rename processors
+	:	NodeInfoBase(source->getNodeId(), idx, source->getNameId(), source->getNameId()), //TODO: fix those two when we have the ability to rename processors
 		SourceProcessorInfo(source, subproc),
 		m_sourceIndex(idx),
 		m_sourceTypeIndex(typeidx),
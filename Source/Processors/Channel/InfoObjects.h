@@ -42,6 +42,38 @@ struct SourceChannelInfo
 	uint16 channelIDX;
 };
 
+/**
+Process-wide table of the descriptive strings shared by info objects.
+
+Processor names, descriptions and identifiers repeat on every channel of a processor, and
+every processor a channel goes through adds to its history. Info objects keep the index of
+each string in this table instead of a String of their own, so copying a channel or adding
+a processor to its history never copies or builds a string. A history is a chain of
+entries, each one a processor name appended to an earlier history, and identical chains are
+shared by all the channels that took the same path. The table only grows, with the number
+of distinct strings and paths rather than with the number of channels.
+
+All methods are thread safe. Id 0 is always the empty string, and the empty history.
+*/
+class PLUGIN_API InfoStringTable
+{
+public:
+	/** Returns the id of a string, adding it to the table the first time it is seen */
+	static uint32 intern(const String& text);
+
+	/** Returns the string with a given id */
+	static String get(uint32 id);
+
+	/** Returns the id of the history made of an existing history followed by one entry */
+	static uint32 extendHistory(uint32 historyId, uint32 entryId);
+
+	/** Returns a history as its entries separated by " -> " */
+	static String getHistory(uint32 historyId);
+
+private:
+	InfoStringTable() = delete;
+};
+
 class PLUGIN_API NodeInfoBase
 {
 	//This field should never be changed by anything except GenericProcessor base code
@@ -58,12 +90,13 @@ public:
 	String getCurrentNodeName() const;
 protected:
 	NodeInfoBase() = delete;
-	NodeInfoBase(uint16 id, uint16 idx, String type, String name);
+	NodeInfoBase(uint16 id, uint16 idx, uint32 typeId, uint32 nameId);
 private:
 	uint16 m_nodeID{ 0 };
 	uint16 m_nodeIdx{ 0 };
-	String m_currentNodeType;
-	String m_currentNodeName;
+	/** InfoStringTable ids */
+	uint32 m_currentNodeTypeId{ 0 };
+	uint32 m_currentNodeNameId{ 0 };
 };
 
 /** This class allows creating a string with an historic of all the data a node has gone through */
@@ -79,8 +112,12 @@ public:
 	/** Adds a new entry in the historic string*/
 	void addToHistoricString(String entry);
 
+	/** Adds a new entry already in the InfoStringTable, without looking up the string */
+	void addToHistory(uint32 entryId);
+
 private:
-	String m_historicString;
+	/** InfoStringTable history id */
+	uint32 m_historyId{ 0 };
 };
 
 class PLUGIN_API SourceProcessorInfo
@@ -110,8 +147,9 @@ private:
 	SourceProcessorInfo() = delete;
 	const uint16 m_sourceNodeID;
 	const uint16 m_sourceSubNodeIndex;
-	const String m_sourceType;
-	const String m_sourceName;
+	/** InfoStringTable ids */
+	const uint32 m_sourceTypeId;
+	const uint32 m_sourceNameId;
 	const uint16 m_sourceSubProcessorCount;
 };
 
@@ -140,8 +178,9 @@ protected:
 	virtual void setDefaultNameAndDescription() = 0;
 private:
 	String m_name;
-	String m_identifier;
-	String m_description;
+	/** InfoStringTable ids, as most channels of a processor share them */
+	uint32 m_identifierId{ 0 };
+	uint32 m_descriptionId{ 0 };
 
 };
 
@@ -26,11 +26,19 @@
 DataBuffer::DataBuffer (int chans, int size)
     : abstractFifo  (size)
     , buffer        (chans, size)
+    , numRawChans   (0)
+    , bufferSize    (size)
     , numChans      (chans)
 {
     timestampBuffer.malloc (size);
     eventCodeBuffer.malloc (size);
 
+    for (int chan = 0; chan < chans; ++chan)
+    {
+        channelBitVolts.add (0.0f);
+        storageIndex.add (chan);
+    }
+
 	lastTimestamp = 0;
 }
 
@@ -41,6 +49,7 @@ DataBuffer::~DataBuffer() {}
 void DataBuffer::clear()
 {
     buffer.clear();
+    rawBuffer.clear ((size_t) numRawChans * bufferSize);
     abstractFifo.reset();
 	lastTimestamp = 0;
 }
@@ -56,9 +65,92 @@ void DataBuffer::resize (int chans, int size)
 	lastTimestamp = 0;
 
     numChans = chans;
+    bufferSize = size;
+
+    channelBitVolts.clearQuick();
+    storageIndex.clearQuick();
+
+    for (int chan = 0; chan < chans; ++chan)
+    {
+        channelBitVolts.add (0.0f);
+        storageIndex.add (chan);
+    }
+
+    numRawChans = 0;
+    rawBuffer.free();
+}
+
+
+void DataBuffer::setRawChannels (const Array<float>& bitVolts)
+{
+    jassert (bitVolts.size() == numChans);
+
+    int numFloatChans = 0;
+    numRawChans = 0;
+
+    for (int chan = 0; chan < numChans; ++chan)
+    {
+        const float bv = jmax (0.0f, bitVolts[chan]);
+        channelBitVolts.set (chan, bv);
+        storageIndex.set (chan, bv > 0 ? numRawChans++ : numFloatChans++);
+    }
+
+    buffer.setSize (numFloatChans, bufferSize);
+    rawBuffer.calloc ((size_t) numRawChans * bufferSize);
+}
+
+
+void DataBuffer::writeChannel (int chan, int destStartSample, const int16* rawSource, const float* source, int numSamples)
+{
+    const float bitVolts = channelBitVolts.getUnchecked (chan);
+    const int index = storageIndex.getUnchecked (chan);
+
+    if (bitVolts == 0)
+    {
+        buffer.copyFrom (index, destStartSample, source, numSamples);
+    }
+    else if (rawSource != nullptr)
+    {
+        memcpy (rawBuffer + (size_t) index * bufferSize + destStartSample, rawSource, numSamples * sizeof (int16));
+    }
+    else
+    {
+        // a float source writing to a raw channel
+        int16* dest = rawBuffer + (size_t) index * bufferSize + destStartSample;
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = (int16) roundToInt (jlimit (-32768.0f, 32767.0f, source[i] / bitVolts));
+    }
 }
 
+
+void DataBuffer::readChannel (AudioSampleBuffer& data, int dstChannel, int dstStartSample, int chan, int srcStartSample, int numSamples)
+{
+    const float bitVolts = channelBitVolts.getUnchecked (chan);
+    const int index = storageIndex.getUnchecked (chan);
+
+    if (bitVolts == 0)
+    {
+        data.copyFrom (dstChannel, dstStartSample, buffer, index, srcStartSample, numSamples);
+    }
+    else
+    {
+        const int16* source = rawBuffer + (size_t) index * bufferSize + srcStartSample;
+        float* dest = data.getWritePointer (dstChannel, dstStartSample);
+
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = float (source[i]) * bitVolts;
+    }
+}
+
+
 int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize)
+{
+    return addToBuffer (nullptr, data, timestamps, eventCodes, numItems, chunkSize);
+}
+
+
+int DataBuffer::addToBuffer (const int16* rawData, const float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize)
 {
     int startIndex1, blockSize1, startIndex2, blockSize2;
 
@@ -81,10 +173,11 @@ int DataBuffer::addToBuffer (float* data, int64* timestamps, uint64* eventCodes,
             cSize = chunkSize <= bs[i] - j ? chunkSize : bs[i] - j;     // figure our how much you can write
             for (int chan = 0; chan < numChans; ++chan)         // write that much, per channel
             {
-                buffer.copyFrom (chan,                           // (int destChannel)
-                                 si[i] + j,                      // (int destStartSample)
-                                 data + (idx * numChans) + chan, // (const float* source)
-                                 cSize);                         // (int num samples)
+                writeChannel (chan,                                                          // (int chan)
+                              si[i] + j,                                                     // (int destStartSample)
+                              rawData != nullptr ? rawData + (idx * numChans) + chan : nullptr, // (const int16* rawSource)
+                              data != nullptr ? data + (idx * numChans) + chan : nullptr,    // (const float* source)
+                              cSize);                                                        // (int num samples)
             }
 
             for (int k = 0; k < cSize; ++k)
@@ -130,12 +223,12 @@ int DataBuffer::readAllFromBuffer (AudioSampleBuffer& data, uint64* timestamp, u
     {
         for (int chan = 0; chan < channelsToCopy; ++chan)
         {
-            data.copyFrom (dstStartChannel+chan,            // destChan
-                           0,               // destStartSample
-                           buffer,          // source
-                           chan,            // sourceChannel
-                           startIndex1,     // sourceStartSample
-                           blockSize1);     // numSamples
+            readChannel (data,
+                         dstStartChannel+chan,  // destChan
+                         0,               // destStartSample
+                         chan,            // sourceChannel
+                         startIndex1,     // sourceStartSample
+                         blockSize1);     // numSamples
         }
 
         memcpy (timestamp, timestampBuffer + startIndex1, 8);
@@ -150,12 +243,12 @@ int DataBuffer::readAllFromBuffer (AudioSampleBuffer& data, uint64* timestamp, u
     {
         for (int chan = 0; chan < channelsToCopy; ++chan)
         {
-            data.copyFrom (dstStartChannel+chan,            // destChan
-                           blockSize1,      // destStartSample
-                           buffer,          // source
-                           chan,            // sourceChannel
-                           startIndex2,     // sourceStartSample
-                           blockSize2);     // numSamples
+            readChannel (data,
+                         dstStartChannel+chan,  // destChan
+                         blockSize1,      // destStartSample
+                         chan,            // sourceChannel
+                         startIndex2,     // sourceStartSample
+                         blockSize2);     // numSamples
         }
         memcpy (eventCodes + blockSize1, eventCodeBuffer + startIndex2, blockSize2 * 8);
     }
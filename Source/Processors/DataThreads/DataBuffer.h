@@ -55,20 +55,55 @@ public:
     */
     int addToBuffer (float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize=1);
 
+    /** Add samples of which some channels are raw int16 words (see setRawChannels).
+
+        Both arrays are interleaved in the same way as for the float version, and each
+        channel is read from the one that matches the way it is stored. Entries of the
+        other array are ignored, and either array may be null if no channel uses it.
+    */
+    int addToBuffer (const int16* rawData, const float* data, int64* timestamps, uint64* eventCodes, int numItems, int chunkSize=1);
+
     /** Returns the number of samples currently available in the buffer.*/
     int getNumSamples() const;
 
     /** Copies as many samples as possible from the DataBuffer to an AudioSampleBuffer.*/
     int readAllFromBuffer (AudioSampleBuffer& data, uint64* ts, uint64* eventCodes, int maxSize, int dstStartChannel = 0, int numChannels = -1);
 
-    /** Resizes the data buffer */
+    /** Resizes the data buffer. All channels are stored as floats again. */
     void resize (int chans, int size);
 
+    /** Stores channels as raw int16 words instead of floats, which halves the memory
+        traffic between the data thread and the source node.
+
+        bitVolts holds the value of one word for each channel, 0 keeps a channel as float.
+        The samples are only scaled into floats when they are read by the source node.
+        Must be called after resize(), while the buffer is not in use.
+    */
+    void setRawChannels (const Array<float>& bitVolts);
+
 
 private:
+    /** Writes one chunk of one channel to the storage of that channel */
+    void writeChannel (int chan, int destStartSample, const int16* rawSource, const float* source, int numSamples);
+
+    /** Reads one segment of one channel, scaling raw words into floats */
+    void readChannel (AudioSampleBuffer& data, int dstChannel, int dstStartSample, int chan, int srcStartSample, int numSamples);
+
     AbstractFifo abstractFifo;
     AudioSampleBuffer buffer;
 
+    /** Raw channels, one after the other */
+    HeapBlock<int16> rawBuffer;
+
+    /** Per channel: the value of a raw word, or 0 for float channels */
+    Array<float> channelBitVolts;
+
+    /** Per channel: its index in buffer or rawBuffer */
+    Array<int> storageIndex;
+
+    int numRawChans;
+    int bufferSize;
+
     HeapBlock<int64> timestampBuffer;
     HeapBlock<uint64> eventCodeBuffer;
 
@@ -272,6 +272,12 @@ uint16 Event::getChannel() const
 	return m_channel;
 }
 
+uint16 Event::getChannel(const MidiMessage& msg)
+{
+	const uint8* data = msg.getRawData();
+	return *reinterpret_cast<const uint16*>(data + 16);
+}
+
 bool Event::serializeHeader(EventChannel::EventChannelTypes type, char* buffer, size_t dstSize) const
 {
 	size_t dataSize = m_channelInfo->getDataSize();
@@ -345,6 +351,14 @@ bool TTLEvent::getState() const
 	return ((1 << bitIndex) & data);
 }
 
+bool TTLEvent::getState(const MidiMessage& msg)
+{
+	const uint16 channel = getChannel(msg);
+	const uint8* data = msg.getRawData() + EVENT_BASE_SIZE;
+
+	return ((1 << (channel % 8)) & data[channel / 8]) != 0;
+}
+
 const void* TTLEvent::getTTLWordPointer() const
 {
 	return m_data.getData();
@@ -810,6 +824,12 @@ uint16 SpikeEvent::getSortedID() const
 	return m_sortedID;
 }
 
+uint16 SpikeEvent::getSortedID(const MidiMessage& msg)
+{
+	const uint8* data = msg.getRawData();
+	return *reinterpret_cast<const uint16*>(data + 16);
+}
+
 const float* SpikeEvent::getDataPointer(int channel) const
 {
 	if ((channel < 0) || (channel >= m_channelInfo->getNumChannels()))
@@ -147,6 +147,10 @@ public:
 	const void* getRawDataPointer() const;
 
 	static EventChannel::EventChannelTypes getEventType(const MidiMessage& msg);
+
+	/** Reads the channel of a serialized event without deserializing it */
+	static uint16 getChannel(const MidiMessage& msg);
+
 	static EventPtr deserializeFromMessage(const MidiMessage& msg, const EventChannel* channelInfo);
 
 protected:
@@ -177,6 +181,9 @@ public:
 
 	/** Gets the state true ='1' false = '0'*/
 	bool getState() const;
+
+	/** Reads the state of a serialized TTL event without deserializing it */
+	static bool getState(const MidiMessage& msg);
 	
 	const void* getTTLWordPointer() const;
 
@@ -296,6 +303,9 @@ public:
 
 	uint16 getSortedID() const;
 
+	/** Reads the sorted ID of a serialized spike without deserializing it */
+	static uint16 getSortedID(const MidiMessage& msg);
+
 	static SpikeEventPtr createSpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, SpikeBuffer& dataSource, uint16 sortedID);
 	static SpikeEventPtr createSpikeEvent(const SpikeChannel* channelInfo, juce::int64 timestamp, Array<float> thresholds, SpikeBuffer& dataSource, uint16 sortedID, const MetaDataValueArray& metaData);
 
@@ -25,7 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 using namespace BinarySource;
 
-BinaryFileSource::BinaryFileSource() : m_samplePos(0)
+BinaryFileSource::BinaryFileSource() : m_stream(nullptr), m_samplePos(0)
 {}
 
 BinaryFileSource::~BinaryFileSource()
@@ -33,82 +33,48 @@ BinaryFileSource::~BinaryFileSource()
 
 bool BinaryFileSource::Open(File file)
 {
-	m_jsonData = JSON::parse(file);
-	if (m_jsonData.isVoid())
-		return false;
-
-	if (m_jsonData["GUI version"].isVoid())
-		return false;
-	
-	var cont = m_jsonData["continuous"];
-	if (cont.isVoid() || cont.size() <= 0)
+	std::string error;
+	if (!m_recording.open(file.getFullPathName().toStdString(), error))
+	{
+		std::cerr << "Error opening " << file.getFullPathName() << ": " << error << std::endl;
 		return false;
-
-	m_rootPath = file.getParentDirectory();
+	}
 
 	return true;
 }
 
 void BinaryFileSource::fillRecordInfo()
 {
-	var continuousData = m_jsonData["continuous"];
-
-	//create identifiers to speed up stuff
-	Identifier idFolder("folder_name");
-	Identifier idSampleRate("sample_rate");
-	Identifier idNumChannels("num_channels");
-	Identifier idChannels("channels");
-	Identifier idChannelName("channel_name");
-	Identifier idBitVolts("bit_volts");
+	int numStreams = m_recording.getNumContinuousStreams();
 
-	int numProcessors = continuousData.size();
-
-	for (int i = 0; i < numProcessors; i++)
+	for (int i = 0; i < numStreams; i++)
 	{
-		var record = continuousData[i];
-		if (record.isVoid()) continue;
-
-		var channels = record[idChannels];
-		if (channels.isVoid() || channels.size() <= 0) continue;
+		const BinaryReader::ContinuousStream& stream = m_recording.getContinuousStream(i);
 
 		RecordInfo info;
+		info.name = stream.getFolderName();
+		info.sampleRate = stream.getSampleRate();
+		info.numSamples = stream.getNumSamples();
 
-		String folderName = record[idFolder];
-		folderName = folderName.trimCharactersAtEnd("/");
-
-		File dataFile = m_rootPath.getChildFile("continuous").getChildFile(folderName).getChildFile("continuous.dat");
-		if (!dataFile.existsAsFile()) continue;
-
-		int numChannels = record[idNumChannels];
-		int64 numSamples = (dataFile.getSize() / numChannels) / sizeof(int16);
-
-		info.name = folderName;
-		info.sampleRate = record[idSampleRate];
-		info.numSamples = numSamples;
-
-		for (int c = 0; c < numChannels; c++)
+		for (int c = 0; c < stream.getNumChannels(); c++)
 		{
-			var chan = channels[c];
 			RecordedChannelInfo cInfo;
 
-			cInfo.name = chan[idChannelName];
-			cInfo.bitVolts = chan[idBitVolts];
-			
+			cInfo.name = stream.getChannelInfo(c).name;
+			cInfo.bitVolts = stream.getChannelInfo(c).bitVolts;
+
 			info.channels.add(cInfo);
 		}
-		
-		infoArray.add(info);
-		numRecords++;	
 
-		m_dataFileArray.add(dataFile);
-		
+		infoArray.add(info);
+		numRecords++;
 	}
 
 }
 
 void BinaryFileSource::updateActiveRecord()
 {
-	m_dataFile = new MemoryMappedFile(m_dataFileArray[activeRecord.get()], MemoryMappedFile::readOnly);
+	m_stream = &m_recording.getContinuousStream(activeRecord.get());
 	m_samplePos = 0;
 }
 
@@ -119,29 +85,38 @@ void BinaryFileSource::seekTo(int64 sample)
 
 int BinaryFileSource::readData(int16* buffer, int nSamples)
 {
-	int nChans = getActiveNumChannels();
-	int64 samplesToRead;
+	int64 samplesRead = m_stream->readInterleaved(m_samplePos, nSamples, buffer);
 
-	if (m_samplePos + nSamples > getActiveNumSamples())
-	{
-		samplesToRead = getActiveNumSamples() - m_samplePos;
-	}
-	else
-	{
-		samplesToRead = nSamples;
-	}
+	m_samplePos += samplesRead;
+	return samplesRead;
+}
 
-	int16* data = static_cast<int16*>(m_dataFile->getData()) + (m_samplePos * nChans);
+int BinaryFileSource::readDataAt(int16* buffer, int64 startSample, int nSamples)
+{
+	// the data file is mapped, so any sample is a direct offset into it
+	return m_stream->readInterleaved(startSample, nSamples, buffer);
+}
 
-	memcpy(buffer, data, samplesToRead*nChans*sizeof(int16));
-    m_samplePos += samplesToRead;
-	return samplesToRead;
+bool BinaryFileSource::areRecordsSimultaneous() const
+{
+	// every continuous stream of a .oebin covers the same recording
+	return true;
+}
+
+int BinaryFileSource::readRecordDataAt(int record, int16* buffer, int64 startSample, int nSamples)
+{
+	return m_recording.getContinuousStream(record).readInterleaved(startSample, nSamples, buffer);
 }
 
 void BinaryFileSource::processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
 {
-	int n = getActiveNumChannels();
-	float bitVolts = getChannelInfo(channel).bitVolts;
+	processRecordChannelData(activeRecord.get(), inBuffer, outBuffer, channel, numSamples);
+}
+
+void BinaryFileSource::processRecordChannelData(int record, int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+	int n = getRecordNumChannels(record);
+	float bitVolts = getChannelInfo(record, channel).bitVolts;
 
 	for (int i = 0; i < numSamples; i++)
 	{
@@ -149,6 +124,12 @@ void BinaryFileSource::processChannelData(int16* inBuffer, float* outBuffer, int
 	}
 }
 
+void BinaryFileSource::getRecordMinMax(int record, int64 startSample, int64 numSamples, float* mins, float* maxs)
+{
+	// scanned straight from the mapped data file by the reader library
+	m_recording.getContinuousStream(record).getMinMax(startSample, numSamples, mins, maxs);
+}
+
 bool BinaryFileSource::isReady()
 {
 	return true;
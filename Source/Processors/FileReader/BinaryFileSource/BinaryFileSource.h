@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define BINARYFILESOURCE_H_INCLUDED
 
 #include "../FileSource.h"
+#include "../BinaryReader/BinaryReader.h"
 
 namespace BinarySource
 {
@@ -38,8 +39,18 @@ namespace BinarySource
 
 		void seekTo(int64 sample) override;
 
+		int readDataAt(int16* buffer, int64 startSample, int nSamples) override;
+
+		bool areRecordsSimultaneous() const override;
+
+		int readRecordDataAt(int record, int16* buffer, int64 startSample, int nSamples) override;
+
+		void processRecordChannelData(int record, int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+
 		void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
 
+		void getRecordMinMax(int record, int64 startSample, int64 numSamples, float* mins, float* maxs) override;
+
 		bool isReady() override;
 
 	private:
@@ -47,11 +58,9 @@ namespace BinarySource
 		void fillRecordInfo() override;
 		void updateActiveRecord() override;
 
-		ScopedPointer<MemoryMappedFile> m_dataFile;
-		var m_jsonData;
-		Array<File> m_dataFileArray;
+		BinaryReader::Recording m_recording;
+		const BinaryReader::ContinuousStream* m_stream;
 
-		File m_rootPath;
 		int64 m_samplePos;
 		
 	};
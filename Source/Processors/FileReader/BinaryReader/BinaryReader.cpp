@@ -0,0 +1,485 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "BinaryReader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace BinaryReader;
+
+static std::string joinPath(const std::string& base, const std::string& child)
+{
+    if (base.empty())
+        return child;
+    char last = base[base.size() - 1];
+    if (last == '/' || last == '\\')
+        return base + child;
+    return base + "/" + child;
+}
+
+static std::string trimTrailingSlashes(std::string path)
+{
+    while (!path.empty() && (path[path.size() - 1] == '/' || path[path.size() - 1] == '\\'))
+        path.erase(path.size() - 1);
+    return path;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+ContinuousStream::ContinuousStream()
+    : m_sampleRate(0), m_numSamples(0), m_firstTimestamp(0)
+{}
+
+bool ContinuousStream::open(const std::string& rootPath, const JsonValue& info, std::string& error)
+{
+    m_folderName = trimTrailingSlashes(info["folder_name"].asString());
+    m_sourceName = info["source_processor_name"].asString();
+    m_sampleRate = info["sample_rate"].asNumber();
+
+    const JsonValue& channels = info["channels"];
+    int numChannels = (int)info["num_channels"].asNumber(channels.size());
+
+    if (m_folderName.empty() || numChannels <= 0 || m_sampleRate <= 0)
+    {
+        error = "Invalid continuous stream description";
+        return false;
+    }
+
+    m_channels.resize(numChannels);
+    for (int c = 0; c < numChannels; c++)
+    {
+        const JsonValue& chan = channels[c];
+        m_channels[c].name = chan["channel_name"].asString("CH" + std::to_string(c + 1));
+        m_channels[c].units = chan["units"].asString("uV");
+        m_channels[c].bitVolts = (float)chan["bit_volts"].asNumber(1.0);
+    }
+
+    std::string folder = joinPath(joinPath(rootPath, "continuous"), m_folderName);
+    std::string dataPath = joinPath(folder, "continuous.dat");
+
+    if (!m_data.open(dataPath))
+    {
+        error = "Could not open " + dataPath;
+        return false;
+    }
+
+    m_numSamples = (int64_t)(m_data.getSize() / (numChannels * sizeof(int16_t)));
+
+    // timestamps are optional: without them the stream starts at zero
+    m_firstTimestamp = 0;
+    if (m_timestamps.open(joinPath(folder, "timestamps.npy"))
+        && m_timestamps.getItemSize() == sizeof(int64_t)
+        && m_timestamps.getNumRecords() > 0)
+    {
+        m_firstTimestamp = m_timestamps.getDataAs<int64_t>()[0];
+    }
+
+    return true;
+}
+
+const std::string& ContinuousStream::getFolderName() const
+{
+    return m_folderName;
+}
+
+const std::string& ContinuousStream::getSourceProcessorName() const
+{
+    return m_sourceName;
+}
+
+double ContinuousStream::getSampleRate() const
+{
+    return m_sampleRate;
+}
+
+int ContinuousStream::getNumChannels() const
+{
+    return (int)m_channels.size();
+}
+
+const ChannelInfo& ContinuousStream::getChannelInfo(int channel) const
+{
+    return m_channels[channel];
+}
+
+int64_t ContinuousStream::getNumSamples() const
+{
+    return m_numSamples;
+}
+
+int64_t ContinuousStream::getFirstTimestamp() const
+{
+    return m_firstTimestamp;
+}
+
+int64_t ContinuousStream::getSampleForTime(double seconds) const
+{
+    int64_t sample = (int64_t)std::floor(seconds * m_sampleRate + 0.5);
+    return std::max<int64_t>(0, std::min(sample, m_numSamples));
+}
+
+int64_t ContinuousStream::getSampleForTimestamp(int64_t timestamp) const
+{
+    size_t numTimestamps = std::min<size_t>(m_timestamps.getNumRecords(), (size_t)m_numSamples);
+
+    if (numTimestamps == 0 || m_timestamps.getItemSize() != sizeof(int64_t))
+        return std::max<int64_t>(0, std::min(timestamp - m_firstTimestamp, m_numSamples));
+
+    const int64_t* ts = m_timestamps.getDataAs<int64_t>();
+
+    // contiguous timestamps, the usual case, need no search
+    int64_t guess = timestamp - m_firstTimestamp;
+    if (guess >= 0 && guess < (int64_t)numTimestamps && ts[guess] == timestamp)
+        return guess;
+
+    return std::lower_bound(ts, ts + numTimestamps, timestamp) - ts;
+}
+
+int64_t ContinuousStream::getTimestamp(int64_t sample) const
+{
+    if (sample >= 0 && (size_t)sample < m_timestamps.getNumRecords() && m_timestamps.getItemSize() == sizeof(int64_t))
+        return m_timestamps.getDataAs<int64_t>()[sample];
+    return m_firstTimestamp + sample;
+}
+
+const int16_t* ContinuousStream::getFrame(int64_t sample) const
+{
+    if (sample < 0 || sample >= m_numSamples)
+        return nullptr;
+    return static_cast<const int16_t*>(m_data.getData()) + sample * m_channels.size();
+}
+
+int64_t ContinuousStream::readInterleaved(int64_t startSample, int64_t numSamples, int16_t* dest) const
+{
+    if (startSample < 0 || startSample >= m_numSamples || numSamples <= 0)
+        return 0;
+
+    int64_t count = std::min(numSamples, m_numSamples - startSample);
+    std::memcpy(dest, getFrame(startSample), (size_t)count * m_channels.size() * sizeof(int16_t));
+    return count;
+}
+
+int64_t ContinuousStream::readChannels(int64_t startSample, int64_t numSamples,
+                                       const int* channels, int numChannels, float* const* dest) const
+{
+    if (startSample < 0 || startSample >= m_numSamples || numSamples <= 0)
+        return 0;
+
+    const int64_t count = std::min(numSamples, m_numSamples - startSample);
+    const size_t stride = m_channels.size();
+    const int16_t* frame = getFrame(startSample);
+
+    std::vector<float> scale(numChannels);
+    for (int c = 0; c < numChannels; c++)
+        scale[c] = m_channels[channels[c]].bitVolts;
+
+    // walk the file sequentially, scattering into the destination channels
+    for (int64_t s = 0; s < count; s++)
+    {
+        for (int c = 0; c < numChannels; c++)
+            dest[c][s] = frame[channels[c]] * scale[c];
+        frame += stride;
+    }
+
+    return count;
+}
+
+void ContinuousStream::getMinMax(int channel, int64_t startSample, int64_t numSamples, int numBins,
+                                 float* mins, float* maxs) const
+{
+    const float bitVolts = m_channels[channel].bitVolts;
+    const size_t stride = m_channels.size();
+
+    for (int b = 0; b < numBins; b++)
+    {
+        int64_t binStart = startSample + (numSamples * b) / numBins;
+        int64_t binEnd = startSample + (numSamples * (b + 1)) / numBins;
+        binStart = std::max<int64_t>(0, binStart);
+        binEnd = std::min(binEnd, m_numSamples);
+
+        if (binEnd <= binStart)
+        {
+            mins[b] = maxs[b] = 0;
+            continue;
+        }
+
+        const int16_t* frame = getFrame(binStart) + channel;
+        int16_t lo = *frame;
+        int16_t hi = *frame;
+
+        for (int64_t s = binStart; s < binEnd; s++)
+        {
+            lo = std::min(lo, *frame);
+            hi = std::max(hi, *frame);
+            frame += stride;
+        }
+
+        mins[b] = lo * bitVolts;
+        maxs[b] = hi * bitVolts;
+    }
+}
+
+void ContinuousStream::getMinMax(int64_t startSample, int64_t numSamples, float* mins, float* maxs) const
+{
+    const size_t numChannels = m_channels.size();
+    const int64_t start = std::max<int64_t>(0, startSample);
+    const int64_t end = std::min(startSample + numSamples, m_numSamples);
+
+    if (end <= start)
+    {
+        std::fill(mins, mins + numChannels, 0.0f);
+        std::fill(maxs, maxs + numChannels, 0.0f);
+        return;
+    }
+
+    std::vector<int16_t> lo(getFrame(start), getFrame(start) + numChannels);
+    std::vector<int16_t> hi(lo);
+
+    for (int64_t s = start + 1; s < end; s++)
+    {
+        const int16_t* frame = getFrame(s);
+        for (size_t c = 0; c < numChannels; c++)
+        {
+            lo[c] = std::min(lo[c], frame[c]);
+            hi[c] = std::max(hi[c], frame[c]);
+        }
+    }
+
+    for (size_t c = 0; c < numChannels; c++)
+    {
+        mins[c] = lo[c] * m_channels[c].bitVolts;
+        maxs[c] = hi[c] * m_channels[c].bitVolts;
+    }
+}
+
+// ------------------------------------------------------------------------------------------------
+
+EventStream::EventStream()
+    : m_sampleRate(0), m_isTTL(false)
+{}
+
+bool EventStream::open(const std::string& rootPath, const JsonValue& info, std::string& error)
+{
+    m_folderName = trimTrailingSlashes(info["folder_name"].asString());
+    m_channelName = info["channel_name"].asString();
+    m_sampleRate = info["sample_rate"].asNumber();
+
+    std::string folder = joinPath(joinPath(rootPath, "events"), m_folderName);
+
+    if (!m_timestamps.open(joinPath(folder, "timestamps.npy")) || m_timestamps.getItemSize() != sizeof(int64_t))
+    {
+        error = "Could not open event timestamps in " + folder;
+        return false;
+    }
+
+    m_channels.open(joinPath(folder, "channels.npy"));
+
+    m_isTTL = m_data.open(joinPath(folder, "channel_states.npy"));
+    if (!m_isTTL && !m_data.open(joinPath(folder, "text.npy")))
+        m_data.open(joinPath(folder, "data_array.npy"));
+
+    return true;
+}
+
+const std::string& EventStream::getFolderName() const
+{
+    return m_folderName;
+}
+
+const std::string& EventStream::getChannelName() const
+{
+    return m_channelName;
+}
+
+double EventStream::getSampleRate() const
+{
+    return m_sampleRate;
+}
+
+bool EventStream::isTTL() const
+{
+    return m_isTTL;
+}
+
+size_t EventStream::getNumEvents() const
+{
+    return m_timestamps.getNumRecords();
+}
+
+int64_t EventStream::getTimestamp(size_t event) const
+{
+    return m_timestamps.getDataAs<int64_t>()[event];
+}
+
+int EventStream::getChannel(size_t event) const
+{
+    if (event >= m_channels.getNumRecords() || m_channels.getItemSize() != sizeof(uint16_t))
+        return 0;
+    return m_channels.getDataAs<uint16_t>()[event];
+}
+
+bool EventStream::getState(size_t event) const
+{
+    if (!m_isTTL || event >= m_data.getNumRecords())
+        return false;
+    return m_data.getDataAs<int16_t>()[event] > 0;
+}
+
+const void* EventStream::getData(size_t event) const
+{
+    return m_data.getRecord(event);
+}
+
+size_t EventStream::getDataSize() const
+{
+    return m_data.getRecordSize();
+}
+
+size_t EventStream::findEvents(int64_t startTimestamp, int64_t endTimestamp, size_t& count) const
+{
+    const int64_t* ts = m_timestamps.getDataAs<int64_t>();
+    const size_t n = getNumEvents();
+
+    const int64_t* first = std::lower_bound(ts, ts + n, startTimestamp);
+    const int64_t* last = std::lower_bound(first, ts + n, endTimestamp);
+
+    count = last - first;
+    return first - ts;
+}
+
+// ------------------------------------------------------------------------------------------------
+
+Recording::Recording()
+{}
+
+Recording::~Recording()
+{}
+
+bool Recording::open(const std::string& oebinPath, std::string& error)
+{
+    close();
+
+    std::ifstream file(oebinPath.c_str(), std::ios::in | std::ios::binary);
+    if (!file)
+    {
+        error = "Could not open " + oebinPath;
+        return false;
+    }
+
+    std::stringstream contents;
+    contents << file.rdbuf();
+
+    JsonValue json;
+    if (!JsonValue::parse(contents.str(), json, error))
+        return false;
+
+    if (json["GUI version"].isNull())
+    {
+        error = "Not an Open Ephys binary structure file";
+        return false;
+    }
+    m_guiVersion = json["GUI version"].asString();
+
+    std::string rootPath;
+    size_t separator = oebinPath.find_last_of("/\\");
+    if (separator != std::string::npos)
+        rootPath = oebinPath.substr(0, separator);
+    else
+        rootPath = ".";
+
+    const JsonValue& continuous = json["continuous"];
+    for (size_t i = 0; i < continuous.size(); i++)
+    {
+        std::unique_ptr<ContinuousStream> stream(new ContinuousStream());
+        std::string streamError;
+
+        // streams with missing files are skipped, like empty records were before
+        if (stream->open(rootPath, continuous[i], streamError))
+            m_continuous.push_back(std::move(stream));
+    }
+
+    const JsonValue& events = json["events"];
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        std::unique_ptr<EventStream> stream(new EventStream());
+        std::string streamError;
+
+        if (stream->open(rootPath, events[i], streamError))
+            m_events.push_back(std::move(stream));
+    }
+
+    if (m_continuous.empty())
+    {
+        error = "No continuous data found";
+        return false;
+    }
+
+    return true;
+}
+
+void Recording::close()
+{
+    m_continuous.clear();
+    m_events.clear();
+    m_guiVersion.clear();
+}
+
+const std::string& Recording::getGUIVersion() const
+{
+    return m_guiVersion;
+}
+
+int Recording::getNumContinuousStreams() const
+{
+    return (int)m_continuous.size();
+}
+
+const ContinuousStream& Recording::getContinuousStream(int index) const
+{
+    return *m_continuous[index];
+}
+
+int Recording::findContinuousStream(const std::string& folderName) const
+{
+    std::string name = trimTrailingSlashes(folderName);
+    for (size_t i = 0; i < m_continuous.size(); i++)
+    {
+        if (m_continuous[i]->getFolderName() == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+int Recording::getNumEventStreams() const
+{
+    return (int)m_events.size();
+}
+
+const EventStream& Recording::getEventStream(int index) const
+{
+    return *m_events[index];
+}
@@ -0,0 +1,210 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BINARYREADER_H_INCLUDED
+#define BINARYREADER_H_INCLUDED
+
+#include "JsonValue.h"
+#include "MappedFile.h"
+#include "NpyArray.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+    Random-access reader for recordings made with the binary record engine.
+
+    The library only depends on the C++ standard library, so it can be linked
+    into analysis tools outside of the GUI. Link against the oe-binary-reader
+    CMake target and open the structure.oebin file of a recording:
+
+    @code
+    BinaryReader::Recording rec;
+    std::string error;
+    if (rec.open("experiment1/recording1/structure.oebin", error))
+    {
+        const BinaryReader::ContinuousStream& stream = rec.getContinuousStream(0);
+        int64_t first = stream.getSampleForTime(12.5);
+        std::vector<float> ch0(3000);
+        float* dest[] = { ch0.data() };
+        int channels[] = { 0 };
+        stream.readChannels(first, 3000, channels, 1, dest);
+    }
+    @endcode
+
+    All data files are memory mapped: opening a recording is independent of
+    its size and any slice can be read without touching what precedes it.
+*/
+namespace BinaryReader
+{
+    struct ChannelInfo
+    {
+        std::string name;
+        std::string units;
+        float bitVolts;
+    };
+
+    /** One continuous.dat file: interleaved int16 samples of a single source subprocessor */
+    class ContinuousStream
+    {
+    public:
+        ContinuousStream();
+
+        bool open(const std::string& rootPath, const JsonValue& info, std::string& error);
+
+        const std::string& getFolderName() const;
+        const std::string& getSourceProcessorName() const;
+        double getSampleRate() const;
+        int getNumChannels() const;
+        const ChannelInfo& getChannelInfo(int channel) const;
+
+        /** Returns the number of samples per channel */
+        int64_t getNumSamples() const;
+
+        /** Returns the timestamp of the first sample */
+        int64_t getFirstTimestamp() const;
+
+        /** Returns the sample index for a time in seconds since the start of the file */
+        int64_t getSampleForTime(double seconds) const;
+
+        /** Returns the sample index of the first sample with a timestamp not less than ts */
+        int64_t getSampleForTimestamp(int64_t timestamp) const;
+
+        /** Returns the timestamp of a sample */
+        int64_t getTimestamp(int64_t sample) const;
+
+        /** Returns a pointer to the interleaved frame of a sample, or nullptr if out of range.
+            The pointer stays valid for as long as the stream is open. */
+        const int16_t* getFrame(int64_t sample) const;
+
+        /** Copies interleaved raw samples. Returns the number of samples copied,
+            which is less than numSamples at the end of the file. */
+        int64_t readInterleaved(int64_t startSample, int64_t numSamples, int16_t* dest) const;
+
+        /** De-interleaves a subset of channels, scaled to their units by bitVolts.
+            dest holds one pointer per requested channel. Returns the number of samples copied. */
+        int64_t readChannels(int64_t startSample, int64_t numSamples,
+                             const int* channels, int numChannels, float* const* dest) const;
+
+        /** Computes a decimated min/max overview of one channel, in its units.
+            The range is split into numBins equal bins; mins and maxs hold numBins values each. */
+        void getMinMax(int channel, int64_t startSample, int64_t numSamples, int numBins,
+                       float* mins, float* maxs) const;
+
+        /** Computes the range of every channel over a span of samples, in their units, with a
+            single pass over the interleaved frames. mins and maxs hold getNumChannels() values each. */
+        void getMinMax(int64_t startSample, int64_t numSamples, float* mins, float* maxs) const;
+
+    private:
+        std::string m_folderName;
+        std::string m_sourceName;
+        double m_sampleRate;
+        std::vector<ChannelInfo> m_channels;
+        int64_t m_numSamples;
+        int64_t m_firstTimestamp;
+
+        MappedFile m_data;
+        NpyArray m_timestamps;
+    };
+
+    /** One event folder: timestamps, channels and payload of an event channel */
+    class EventStream
+    {
+    public:
+        EventStream();
+
+        bool open(const std::string& rootPath, const JsonValue& info, std::string& error);
+
+        const std::string& getFolderName() const;
+        const std::string& getChannelName() const;
+        double getSampleRate() const;
+
+        /** Returns true for TTL events, false for text or binary events */
+        bool isTTL() const;
+
+        size_t getNumEvents() const;
+
+        int64_t getTimestamp(size_t event) const;
+
+        /** Returns the 1-based channel of an event */
+        int getChannel(size_t event) const;
+
+        /** For TTL events, returns true if the line went high */
+        bool getState(size_t event) const;
+
+        /** Returns the payload of an event: channel state for TTL, the string for
+            text events and the data array for binary events. */
+        const void* getData(size_t event) const;
+        size_t getDataSize() const;
+
+        /** Finds the events with startTimestamp <= timestamp < endTimestamp.
+            Returns the index of the first one and sets count. */
+        size_t findEvents(int64_t startTimestamp, int64_t endTimestamp, size_t& count) const;
+
+    private:
+        std::string m_folderName;
+        std::string m_channelName;
+        double m_sampleRate;
+        bool m_isTTL;
+
+        NpyArray m_timestamps;
+        NpyArray m_channels;
+        NpyArray m_data;
+    };
+
+    /** A single recording, described by its structure.oebin file */
+    class Recording
+    {
+    public:
+        Recording();
+        ~Recording();
+
+        /** Opens a recording. Returns false and sets error if the structure file is invalid. */
+        bool open(const std::string& oebinPath, std::string& error);
+
+        void close();
+
+        const std::string& getGUIVersion() const;
+
+        int getNumContinuousStreams() const;
+        const ContinuousStream& getContinuousStream(int index) const;
+
+        /** Returns the index of the continuous stream stored in a folder, or -1 */
+        int findContinuousStream(const std::string& folderName) const;
+
+        int getNumEventStreams() const;
+        const EventStream& getEventStream(int index) const;
+
+    private:
+        Recording(const Recording&) = delete;
+        Recording& operator=(const Recording&) = delete;
+
+        std::string m_guiVersion;
+        std::vector<std::unique_ptr<ContinuousStream>> m_continuous;
+        std::vector<std::unique_ptr<EventStream>> m_events;
+    };
+}
+
+#endif
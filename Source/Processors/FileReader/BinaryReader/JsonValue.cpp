@@ -0,0 +1,375 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "JsonValue.h"
+
+#include <cstdlib>
+
+namespace BinaryReader
+{
+    /** Recursive descent parser filling JsonValue trees */
+    class JsonParser
+    {
+    public:
+        JsonParser(const std::string& text) : m_text(text), m_pos(0) {}
+
+        bool parseDocument(JsonValue& result, std::string& error)
+        {
+            if (!parseValue(result, 0))
+            {
+                error = m_error + " at offset " + std::to_string(m_pos);
+                return false;
+            }
+            skipWhitespace();
+            if (m_pos != m_text.size())
+            {
+                error = "Unexpected trailing characters at offset " + std::to_string(m_pos);
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        static const int maxDepth = 256;
+
+        void skipWhitespace()
+        {
+            while (m_pos < m_text.size())
+            {
+                char c = m_text[m_pos];
+                if (c != ' ' && c != '\t' && c != '\n' && c != '\r')
+                    break;
+                ++m_pos;
+            }
+        }
+
+        bool fail(const std::string& message)
+        {
+            m_error = message;
+            return false;
+        }
+
+        bool matchLiteral(const char* literal)
+        {
+            size_t i = 0;
+            while (literal[i] != 0)
+            {
+                if (m_pos + i >= m_text.size() || m_text[m_pos + i] != literal[i])
+                    return false;
+                ++i;
+            }
+            m_pos += i;
+            return true;
+        }
+
+        bool parseValue(JsonValue& value, int depth)
+        {
+            if (depth > maxDepth)
+                return fail("Nesting too deep");
+
+            skipWhitespace();
+            if (m_pos >= m_text.size())
+                return fail("Unexpected end of document");
+
+            char c = m_text[m_pos];
+            switch (c)
+            {
+            case '{': return parseObject(value, depth);
+            case '[': return parseArray(value, depth);
+            case '"':
+                value.m_type = JsonValue::STRING;
+                return parseString(value.m_string);
+            case 't':
+                if (!matchLiteral("true")) return fail("Invalid literal");
+                value.m_type = JsonValue::BOOL;
+                value.m_bool = true;
+                return true;
+            case 'f':
+                if (!matchLiteral("false")) return fail("Invalid literal");
+                value.m_type = JsonValue::BOOL;
+                value.m_bool = false;
+                return true;
+            case 'n':
+                if (!matchLiteral("null")) return fail("Invalid literal");
+                value.m_type = JsonValue::NULL_VALUE;
+                return true;
+            default:
+                return parseNumber(value);
+            }
+        }
+
+        bool parseNumber(JsonValue& value)
+        {
+            const char* start = m_text.c_str() + m_pos;
+            char* end = nullptr;
+            double number = std::strtod(start, &end);
+            if (end == start)
+                return fail("Invalid value");
+            m_pos += end - start;
+            value.m_type = JsonValue::NUMBER;
+            value.m_number = number;
+            return true;
+        }
+
+        static void appendUtf8(std::string& out, unsigned int cp)
+        {
+            if (cp < 0x80)
+                out += (char)cp;
+            else if (cp < 0x800)
+            {
+                out += (char)(0xc0 | (cp >> 6));
+                out += (char)(0x80 | (cp & 0x3f));
+            }
+            else if (cp < 0x10000)
+            {
+                out += (char)(0xe0 | (cp >> 12));
+                out += (char)(0x80 | ((cp >> 6) & 0x3f));
+                out += (char)(0x80 | (cp & 0x3f));
+            }
+            else
+            {
+                out += (char)(0xf0 | (cp >> 18));
+                out += (char)(0x80 | ((cp >> 12) & 0x3f));
+                out += (char)(0x80 | ((cp >> 6) & 0x3f));
+                out += (char)(0x80 | (cp & 0x3f));
+            }
+        }
+
+        bool parseHex4(unsigned int& cp)
+        {
+            if (m_pos + 4 > m_text.size())
+                return fail("Truncated escape sequence");
+            cp = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                char h = m_text[m_pos++];
+                cp <<= 4;
+                if (h >= '0' && h <= '9') cp |= h - '0';
+                else if (h >= 'a' && h <= 'f') cp |= h - 'a' + 10;
+                else if (h >= 'A' && h <= 'F') cp |= h - 'A' + 10;
+                else return fail("Invalid escape sequence");
+            }
+            return true;
+        }
+
+        bool parseString(std::string& out)
+        {
+            ++m_pos; // opening quote
+            out.clear();
+            while (m_pos < m_text.size())
+            {
+                char c = m_text[m_pos++];
+                if (c == '"')
+                    return true;
+                if (c != '\\')
+                {
+                    out += c;
+                    continue;
+                }
+                if (m_pos >= m_text.size())
+                    break;
+                char e = m_text[m_pos++];
+                switch (e)
+                {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u':
+                {
+                    unsigned int cp;
+                    if (!parseHex4(cp)) return false;
+                    // surrogate pair
+                    if (cp >= 0xd800 && cp < 0xdc00 && m_pos + 1 < m_text.size()
+                        && m_text[m_pos] == '\\' && m_text[m_pos + 1] == 'u')
+                    {
+                        m_pos += 2;
+                        unsigned int low;
+                        if (!parseHex4(low)) return false;
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    appendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    return fail("Invalid escape sequence");
+                }
+            }
+            return fail("Unterminated string");
+        }
+
+        bool parseArray(JsonValue& value, int depth)
+        {
+            ++m_pos; // [
+            value.m_type = JsonValue::ARRAY;
+            skipWhitespace();
+            if (m_pos < m_text.size() && m_text[m_pos] == ']')
+            {
+                ++m_pos;
+                return true;
+            }
+            while (true)
+            {
+                value.m_elements.push_back(JsonValue());
+                if (!parseValue(value.m_elements.back(), depth + 1))
+                    return false;
+                skipWhitespace();
+                if (m_pos >= m_text.size())
+                    return fail("Unterminated array");
+                char c = m_text[m_pos++];
+                if (c == ']')
+                    return true;
+                if (c != ',')
+                    return fail("Expected ',' or ']'");
+            }
+        }
+
+        bool parseObject(JsonValue& value, int depth)
+        {
+            ++m_pos; // {
+            value.m_type = JsonValue::OBJECT;
+            skipWhitespace();
+            if (m_pos < m_text.size() && m_text[m_pos] == '}')
+            {
+                ++m_pos;
+                return true;
+            }
+            while (true)
+            {
+                skipWhitespace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != '"')
+                    return fail("Expected member name");
+                std::string key;
+                if (!parseString(key))
+                    return false;
+                skipWhitespace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != ':')
+                    return fail("Expected ':'");
+                ++m_pos;
+                value.m_members.push_back(std::make_pair(key, JsonValue()));
+                if (!parseValue(value.m_members.back().second, depth + 1))
+                    return false;
+                skipWhitespace();
+                if (m_pos >= m_text.size())
+                    return fail("Unterminated object");
+                char c = m_text[m_pos++];
+                if (c == '}')
+                    return true;
+                if (c != ',')
+                    return fail("Expected ',' or '}'");
+            }
+        }
+
+        const std::string& m_text;
+        size_t m_pos;
+        std::string m_error;
+    };
+}
+
+using namespace BinaryReader;
+
+static const JsonValue nullValue;
+
+JsonValue::JsonValue()
+    : m_type(NULL_VALUE), m_bool(false), m_number(0)
+{}
+
+bool JsonValue::parse(const std::string& text, JsonValue& result, std::string& error)
+{
+    result = JsonValue();
+    JsonParser parser(text);
+    return parser.parseDocument(result, error);
+}
+
+JsonValue::Type JsonValue::getType() const
+{
+    return m_type;
+}
+
+bool JsonValue::isNull() const
+{
+    return m_type == NULL_VALUE;
+}
+
+double JsonValue::asNumber(double defaultValue) const
+{
+    if (m_type == NUMBER) return m_number;
+    if (m_type == BOOL) return m_bool ? 1 : 0;
+    return defaultValue;
+}
+
+bool JsonValue::asBool(bool defaultValue) const
+{
+    if (m_type == BOOL) return m_bool;
+    if (m_type == NUMBER) return m_number != 0;
+    return defaultValue;
+}
+
+std::string JsonValue::asString(const std::string& defaultValue) const
+{
+    if (m_type == STRING) return m_string;
+    return defaultValue;
+}
+
+size_t JsonValue::size() const
+{
+    if (m_type == ARRAY) return m_elements.size();
+    if (m_type == OBJECT) return m_members.size();
+    return 0;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const
+{
+    if (m_type == ARRAY && index < m_elements.size())
+        return m_elements[index];
+    return nullValue;
+}
+
+const JsonValue& JsonValue::operator[](int index) const
+{
+    if (index < 0)
+        return nullValue;
+    return (*this)[(size_t)index];
+}
+
+const JsonValue& JsonValue::operator[](const std::string& key) const
+{
+    if (m_type == OBJECT)
+    {
+        for (size_t i = 0; i < m_members.size(); i++)
+        {
+            if (m_members[i].first == key)
+                return m_members[i].second;
+        }
+    }
+    return nullValue;
+}
+
+const JsonValue& JsonValue::operator[](const char* key) const
+{
+    return (*this)[std::string(key)];
+}
@@ -0,0 +1,85 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BINARYREADER_JSONVALUE_H_INCLUDED
+#define BINARYREADER_JSONVALUE_H_INCLUDED
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace BinaryReader
+{
+    /**
+        Minimal read-only JSON document, enough to parse structure.oebin
+        without pulling a GUI framework into external tools.
+
+        Missing members and out-of-range indices return a null value, so
+        lookups can be chained without checks, e.g. json["continuous"][0]["sample_rate"].
+    */
+    class JsonValue
+    {
+    public:
+        enum Type
+        {
+            NULL_VALUE,
+            BOOL,
+            NUMBER,
+            STRING,
+            ARRAY,
+            OBJECT
+        };
+
+        JsonValue();
+
+        /** Parses a JSON document. On failure returns false and describes the problem in error. */
+        static bool parse(const std::string& text, JsonValue& result, std::string& error);
+
+        Type getType() const;
+        bool isNull() const;
+
+        double asNumber(double defaultValue = 0) const;
+        bool asBool(bool defaultValue = false) const;
+        std::string asString(const std::string& defaultValue = std::string()) const;
+
+        /** Returns the number of elements of an array or members of an object */
+        size_t size() const;
+
+        const JsonValue& operator[](size_t index) const;
+        const JsonValue& operator[](int index) const;
+        const JsonValue& operator[](const std::string& key) const;
+        const JsonValue& operator[](const char* key) const;
+
+    private:
+        friend class JsonParser;
+
+        Type m_type;
+        bool m_bool;
+        double m_number;
+        std::string m_string;
+        std::vector<JsonValue> m_elements;
+        std::vector<std::pair<std::string, JsonValue>> m_members;
+    };
+}
+
+#endif
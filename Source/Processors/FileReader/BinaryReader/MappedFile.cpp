@@ -0,0 +1,173 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace BinaryReader;
+
+MappedFile::MappedFile()
+    : m_data(nullptr), m_size(0), m_open(false)
+#ifdef _WIN32
+    , m_fileHandle(nullptr), m_mappingHandle(nullptr)
+#endif
+{}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(len, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], len);
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    m_fileHandle = file;
+    m_size = (size_t)size.QuadPart;
+    m_open = true;
+
+    if (m_size == 0)
+        return true;
+
+    m_mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mappingHandle != nullptr)
+        m_data = MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+    if (m_data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mappingHandle != nullptr)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle != nullptr)
+        CloseHandle(m_fileHandle);
+
+    m_data = nullptr;
+    m_mappingHandle = nullptr;
+    m_fileHandle = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    m_size = (size_t)info.st_size;
+
+    if (m_size > 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            m_size = 0;
+            return false;
+        }
+        m_data = data;
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    m_open = true;
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != nullptr)
+        munmap(m_data, m_size);
+
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
+
+bool MappedFile::isOpen() const
+{
+    return m_open;
+}
+
+const void* MappedFile::getData() const
+{
+    return m_data;
+}
+
+size_t MappedFile::getSize() const
+{
+    return m_size;
+}
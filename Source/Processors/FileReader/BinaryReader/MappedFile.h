@@ -0,0 +1,74 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef BINARYREADER_MAPPEDFILE_H_INCLUDED
+#define BINARYREADER_MAPPEDFILE_H_INCLUDED
+
+#include <cstddef>
+#include <string>
+
+namespace BinaryReader
+{
+    /**
+        Read-only memory mapping of a whole file.
+
+        The operating system pages data in on demand, so opening a file is
+        constant time regardless of its size, and any byte range can be
+        accessed without reading what precedes it.
+    */
+    class MappedFile
+    {
+    public:
+        MappedFile();
+        ~MappedFile();
+
+        /** Maps a file. Any previously mapped file is released first. */
+        bool open(const std::string& path);
+
+        /** Releases the mapping. */
+        void close();
+
+        bool isOpen() const;
+
+        /** Returns the start of the mapped data, or nullptr for an empty file. */
+        const void* getData() const;
+
+        /** Returns the size of the file in bytes. */
+        size_t getSize() const;
+
+    private:
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        void* m_data;
+        size_t m_size;
+        bool m_open;
+
+#ifdef _WIN32
+        void* m_fileHandle;
+        void* m_mappingHandle;
+#endif
+    };
+}
+
+#endif
@@ -0,0 +1,187 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "NpyArray.h"
+
+#include <cstdlib>
+#include <cstring>
+
+using namespace BinaryReader;
+
+NpyArray::NpyArray()
+    : m_itemSize(0), m_recordSize(0), m_numRecords(0), m_data(nullptr)
+{}
+
+bool NpyArray::open(const std::string& path)
+{
+    m_numRecords = 0;
+    m_data = nullptr;
+
+    if (!m_file.open(path))
+        return false;
+
+    const unsigned char* bytes = static_cast<const unsigned char*>(m_file.getData());
+    size_t size = m_file.getSize();
+
+    // magic string, version, header length
+    if (size < 10 || bytes[0] != 0x93 || std::memcmp(bytes + 1, "NUMPY", 5) != 0)
+    {
+        m_file.close();
+        return false;
+    }
+
+    size_t headerStart;
+    size_t headerLen;
+    if (bytes[6] == 1)
+    {
+        headerStart = 10;
+        headerLen = bytes[8] | (bytes[9] << 8);
+    }
+    else if (size >= 12)
+    {
+        headerStart = 12;
+        headerLen = bytes[8] | (bytes[9] << 8) | (bytes[10] << 16) | ((size_t)bytes[11] << 24);
+    }
+    else
+    {
+        m_file.close();
+        return false;
+    }
+
+    if (headerStart + headerLen > size
+        || !parseHeader(std::string(reinterpret_cast<const char*>(bytes + headerStart), headerLen)))
+    {
+        m_file.close();
+        return false;
+    }
+
+    size_t dataOffset = headerStart + headerLen;
+    m_data = bytes + dataOffset;
+
+    // The writer only refreshes the shape in the header every few records, so
+    // a recording that was not closed cleanly has more data than its header
+    // reports. Trust the file size instead.
+    if (m_recordSize > 0)
+        m_numRecords = (size - dataOffset) / m_recordSize;
+
+    if (!m_shape.empty())
+        m_shape[0] = m_numRecords;
+
+    return true;
+}
+
+bool NpyArray::parseHeader(const std::string& header)
+{
+    // {'descr': '<i8', 'fortran_order': False, 'shape': (123, 4), }
+    size_t descrPos = header.find("'descr'");
+    size_t shapePos = header.find("'shape'");
+    if (descrPos == std::string::npos || shapePos == std::string::npos)
+        return false;
+
+    size_t quoteStart = header.find('\'', descrPos + 7);
+    if (quoteStart == std::string::npos)
+        return false;
+    size_t quoteEnd = header.find('\'', quoteStart + 1);
+    if (quoteEnd == std::string::npos)
+        return false;
+
+    // structured types start with a list and are not supported
+    size_t colon = header.find(':', descrPos);
+    size_t firstChar = header.find_first_not_of(' ', colon + 1);
+    if (firstChar == std::string::npos || header[firstChar] != '\'')
+        return false;
+
+    m_descriptor = header.substr(quoteStart + 1, quoteEnd - quoteStart - 1);
+    if (m_descriptor.size() < 3)
+        return false;
+    m_itemSize = (size_t)std::atoi(m_descriptor.c_str() + 2);
+    if (m_itemSize == 0)
+        return false;
+
+    size_t open = header.find('(', shapePos);
+    size_t close = header.find(')', shapePos);
+    if (open == std::string::npos || close == std::string::npos || close < open)
+        return false;
+
+    m_shape.clear();
+    std::string dims = header.substr(open + 1, close - open - 1);
+    size_t pos = 0;
+    while (pos < dims.size())
+    {
+        size_t next = dims.find(',', pos);
+        if (next == std::string::npos)
+            next = dims.size();
+        std::string token = dims.substr(pos, next - pos);
+        if (token.find_first_of("0123456789") != std::string::npos)
+            m_shape.push_back((size_t)std::strtoull(token.c_str(), nullptr, 10));
+        pos = next + 1;
+    }
+
+    m_recordSize = m_itemSize;
+    for (size_t i = 1; i < m_shape.size(); i++)
+        m_recordSize *= m_shape[i];
+
+    return true;
+}
+
+bool NpyArray::isOpen() const
+{
+    return m_file.isOpen();
+}
+
+const std::string& NpyArray::getDescriptor() const
+{
+    return m_descriptor;
+}
+
+char NpyArray::getTypeCode() const
+{
+    return m_descriptor.size() > 1 ? m_descriptor[1] : 0;
+}
+
+size_t NpyArray::getItemSize() const
+{
+    return m_itemSize;
+}
+
+const std::vector<size_t>& NpyArray::getShape() const
+{
+    return m_shape;
+}
+
+size_t NpyArray::getNumRecords() const
+{
+    return m_numRecords;
+}
+
+size_t NpyArray::getRecordSize() const
+{
+    return m_recordSize;
+}
+
+const void* NpyArray::getRecord(size_t index) const
+{
+    if (index >= m_numRecords)
+        return nullptr;
+    return static_cast<const char*>(m_data) + index * m_recordSize;
+}
@@ -0,0 +1,93 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+Specification of the .npy file format is at:
+
+http://www.numpy.org/neps/nep-0001-npy-format.html
+
+*/
+
+#ifndef BINARYREADER_NPYARRAY_H_INCLUDED
+#define BINARYREADER_NPYARRAY_H_INCLUDED
+
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace BinaryReader
+{
+    /**
+        Memory-mapped view of a .npy file with a simple (non-structured) dtype,
+        as written by the binary record engine.
+    */
+    class NpyArray
+    {
+    public:
+        NpyArray();
+
+        /** Maps a .npy file and parses its header */
+        bool open(const std::string& path);
+
+        bool isOpen() const;
+
+        /** Returns the numpy type descriptor, e.g. "<i8" */
+        const std::string& getDescriptor() const;
+
+        /** Returns the type character of the descriptor: 'i', 'u', 'f', 'S'... */
+        char getTypeCode() const;
+
+        /** Returns the size of a single element, in bytes */
+        size_t getItemSize() const;
+
+        const std::vector<size_t>& getShape() const;
+
+        /** Returns the length of the first dimension */
+        size_t getNumRecords() const;
+
+        /** Returns the size of one record (all dimensions but the first), in bytes */
+        size_t getRecordSize() const;
+
+        /** Returns a pointer to a record, or nullptr if out of range */
+        const void* getRecord(size_t index) const;
+
+        /** Returns the array data reinterpreted as a type. No conversion is made. */
+        template <typename T>
+        const T* getDataAs() const
+        {
+            return static_cast<const T*>(m_data);
+        }
+
+    private:
+        bool parseHeader(const std::string& header);
+
+        MappedFile m_file;
+        std::string m_descriptor;
+        std::vector<size_t> m_shape;
+        size_t m_itemSize;
+        size_t m_recordSize;
+        size_t m_numRecords;
+        const void* m_data;
+    };
+}
+
+#endif
@@ -28,21 +28,13 @@
 #include "../../Audio/AudioComponent.h"
 #include "../PluginManager/PluginManager.h"
 #include "BinaryFileSource/BinaryFileSource.h"
+#include "OpenEphysFileSource/OpenEphysFileSource.h"
 
 
 FileReader::FileReader()
     : GenericProcessor ("File Reader")
     , Thread ("filereader_Async_Reader")
-    , timestamp             (0)
-    , currentSampleRate     (0)
-    , currentNumChannels    (0)
-    , currentSample         (0)
-    , currentNumSamples     (0)
-    , startSample           (0)
-    , stopSample            (0)
     , counter               (0)
-    , bufferCacheWindow     (0)
-    , m_shouldFillBackBuffer(false)
 	, m_bufferSize(1024)
 	, m_sysSampleRate(44100)
 {
@@ -120,21 +112,32 @@ bool FileReader::isReady()
 
 float FileReader::getDefaultSampleRate() const
 {
-    if (input)
-        return currentSampleRate;
+    return getSampleRate (0);
+}
+
+
+float FileReader::getSampleRate (int subProcessorIdx) const
+{
+    if (input && subProcessorIdx < streams.size())
+        return streams[subProcessorIdx]->sampleRate;
     else
         return 44100.0;
 }
 
 
+int FileReader::getNumSubProcessors() const
+{
+    return jmax (1, streams.size());
+}
+
+
 int FileReader::getDefaultNumDataOutputs(DataChannel::DataChannelTypes type, int subproc) const
 {
-    if (subproc != 0) return 0;
     if (type != DataChannel::HEADSTAGE_CHANNEL) return 0;
     if (input)
-        return currentNumChannels;
+        return subproc < streams.size() ? streams[subproc]->numChannels : 0;
     else
-        return 16;
+        return subproc == 0 ? 16 : 0;
 }
 
 
@@ -154,8 +157,6 @@ void FileReader::setEnabledState (bool t)
 
 bool FileReader::enable()
 {
-	timestamp = 0;
-
 	AudioDeviceManager& adm = AccessClass::getAudioComponent()->deviceManager;
 	AudioDeviceManager::AudioDeviceSetup ads;
 	adm.getAudioDeviceSetup(ads);
@@ -163,27 +164,53 @@ bool FileReader::enable()
 	m_bufferSize = ads.bufferSize;
 	if (m_bufferSize == 0) m_bufferSize = 1024;
 
-	m_samplesPerBuffer.set(m_bufferSize * (getDefaultSampleRate() / m_sysSampleRate));
+	for (int s = 0; s < streams.size(); ++s)
+	{
+		PlaybackStream& stream = *streams[s];
+
+		const int samplesPerBuffer = int(m_bufferSize * (stream.sampleRate / m_sysSampleRate));
+
+		// windows are sized by the file sample rate, which can be higher than the system one
+		stream.maxSamplesPerBuffer = jmax(int(m_bufferSize), samplesPerBuffer + 1);
+
+		stream.bufferA.malloc(stream.numChannels * stream.maxSamplesPerBuffer * BUFFER_WINDOW_CACHE_SIZE);
+		stream.bufferB.malloc(stream.numChannels * stream.maxSamplesPerBuffer * BUFFER_WINDOW_CACHE_SIZE);
 
-	bufferA.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
-	bufferB.malloc(currentNumChannels * m_bufferSize * BUFFER_WINDOW_CACHE_SIZE);
+		const int64 firstSample = stream.wrapSample(stream.playbackSample.get());
+		stream.playbackSample.set(firstSample);
 
-	readAndFillBufferCache(bufferA); // pre-fill the front buffer with a blocking read
+		// start with the timestamp the first played sample was recorded at
+		stream.timestamp = input->getRecordTimestamp(stream.record, firstSample);
+		stream.timestampOffset = 0;
 
-	// set the backbuffer so that on the next call to process() we start with bufferA and buffer
-	// cache window id = 0
-	readBuffer = &bufferB;
-	bufferCacheWindow = 0;
-	m_shouldFillBackBuffer.set(false);
+		readAndFillBufferCache(stream, stream.bufferA, firstSample, samplesPerBuffer); // pre-fill the front buffer with a blocking read
+
+		stream.readBuffer = &stream.bufferA;
+		stream.bufferCacheWindow = 0;
+		stream.frontBufferWindows = BUFFER_WINDOW_CACHE_SIZE;
+		stream.backBufferState.set(BACK_BUFFER_IDLE);
+	}
 
 	startThread(); // start async file reader thread
 
+	for (int s = 0; s < streams.size(); ++s)
+	{
+		PlaybackStream& stream = *streams[s];
+		const int samplesPerBuffer = int(m_bufferSize * (stream.sampleRate / m_sysSampleRate));
+
+		requestBackBuffer(stream, stream.playbackSample.get() + samplesPerBuffer * BUFFER_WINDOW_CACHE_SIZE, samplesPerBuffer);
+	}
+
 	return isEnabled;
 }
 
 bool FileReader::disable()
 {
 	stopThread(100);
+
+	for (int s = 0; s < streams.size(); ++s)
+		streams[s]->backBufferState.set(BACK_BUFFER_IDLE);
+
 	return true;
 }
 
@@ -215,6 +242,10 @@ bool FileReader::setFile (String fullpath)
 
     if (isExtensionSupported)
     {
+        // nothing may read from the current source once it is replaced
+        overview.clear();
+        streams.clear();
+
         const int index = supportedExtensions[ext] -1 ;
 		const int numPluginFileSources = AccessClass::getPluginManager()->getNumFileSources();
 
@@ -268,26 +299,46 @@ void FileReader::setActiveRecording (int index)
 {
     if (!input) { return; }
 
-    input->setActiveRecord (index);
+    // the overview reads the active record, so it must stop before switching
+    overview.clear();
+
+    streams.clear();
+    channelInfo.clear();
 
-    currentNumChannels  = input->getActiveNumChannels();
-    currentNumSamples   = input->getActiveNumSamples();
-    currentSampleRate   = input->getActiveSampleRate();
+    const int numRecords = input->getNumRecords();
+
+    if (index >= numRecords && canPlayAllRecords())
+    {
+        for (int i = 0; i < numRecords; ++i)
+            streams.add (new PlaybackStream (i, input));
 
-    currentSample   = 0;
-    startSample     = 0;
-    stopSample      = currentNumSamples;
-    bufferCacheWindow = 0;
+        input->setActiveRecord (0);
+    }
+    else
+    {
+        index = jlimit (0, numRecords - 1, index);
+        input->setActiveRecord (index);
+        streams.add (new PlaybackStream (index, input));
+    }
 
-    for (int i = 0; i < currentNumChannels; ++i)
+    for (int s = 0; s < streams.size(); ++s)
     {
-        channelInfo.add (input->getChannelInfo (i));
+        for (int i = 0; i < streams[s]->numChannels; ++i)
+        {
+            channelInfo.add (input->getChannelInfo (streams[s]->record, i));
+        }
     }
 
-    static_cast<FileReaderEditor*> (getEditor())->setTotalTime (samplesToMilliseconds (currentNumSamples));
-	input->seekTo(startSample);
+    static_cast<FileReaderEditor*> (getEditor())->setTotalTime (samplesToMilliseconds (streams[0]->numSamples));
+	input->seekTo(0);
 
-   
+    overview.build (input, OVERVIEW_NUM_BINS);
+}
+
+
+bool FileReader::canPlayAllRecords() const
+{
+    return input != nullptr && input->getNumRecords() > 1 && input->areRecordsSimultaneous();
 }
 
 
@@ -304,7 +355,7 @@ void FileReader::updateSettings()
 {
      if (!input) return;
 
-     for (int i=0; i < currentNumChannels; i++)
+     for (int i=0; i < channelInfo.size() && i < dataChannelArray.size(); i++)
      {
          dataChannelArray[i]->setBitVolts(channelInfo[i].bitVolts);
          dataChannelArray[i]->setName(channelInfo[i].name);
@@ -313,33 +364,61 @@ void FileReader::updateSettings()
 
 void FileReader::process (AudioSampleBuffer& buffer)
 {
-    const int samplesNeededPerBuffer = int (float (buffer.getNumSamples()) * (getDefaultSampleRate() / m_sysSampleRate));
-    m_samplesPerBuffer.set(samplesNeededPerBuffer);
-    // FIXME: needs to account for the fact that the ratio might not be an exact
-    //        integer value
-    
-    // if cache window id == 0, we need to read and cache BUFFER_WINDOW_CACHE_SIZE more buffer windows
-    if (bufferCacheWindow == 0)
-    {
-        switchBuffer();
-    }
-    
-    for (int i = 0; i < currentNumChannels; ++i)
+    int channelOffset = 0;
+
+    for (int s = 0; s < streams.size(); ++s)
     {
-        // offset readBuffer index by current cache window count * buffer window size * num channels
-        input->processChannelData (*readBuffer + (samplesNeededPerBuffer * currentNumChannels * bufferCacheWindow),
-                                   buffer.getWritePointer (i, 0),
-                                   i,
-                                   samplesNeededPerBuffer);
-    }
-    
-    setTimestampAndSamples(timestamp, samplesNeededPerBuffer);
-	timestamp += samplesNeededPerBuffer;
+        PlaybackStream& stream = *streams[s];
 
-	static_cast<FileReaderEditor*> (getEditor())->setCurrentTime(samplesToMilliseconds(startSample + timestamp % (stopSample - startSample)));
-    
-    bufferCacheWindow += 1;
-    bufferCacheWindow %= BUFFER_WINDOW_CACHE_SIZE;
+        const int samplesNeededPerBuffer = jmin (stream.maxSamplesPerBuffer, buffer.getNumSamples(),
+                                                 int (float (buffer.getNumSamples()) * (stream.sampleRate / m_sysSampleRate)));
+        // FIXME: needs to account for the fact that the ratio might not be an exact
+        //        integer value
+
+        const int64 jump = stream.jumpRequest.exchange (-1);
+        if (jump >= 0)
+        {
+            // drop whatever is cached, the next window is read from the new position
+            stream.playbackSample.set (stream.wrapSample (jump));
+            stream.frontBufferWindows = 0;
+        }
+
+        bool hasData = true;
+        if (stream.bufferCacheWindow >= stream.frontBufferWindows)
+        {
+            hasData = switchBuffer (stream, samplesNeededPerBuffer);
+        }
+
+        for (int i = 0; i < stream.numChannels; ++i)
+        {
+            // offset readBuffer index by current cache window count * buffer window size * num channels
+            input->processRecordChannelData (stream.record,
+                                             *stream.readBuffer + (samplesNeededPerBuffer * stream.numChannels * stream.bufferCacheWindow),
+                                             buffer.getWritePointer (channelOffset + i, 0),
+                                             i,
+                                             samplesNeededPerBuffer);
+        }
+        channelOffset += stream.numChannels;
+
+        const int64 currentSample = stream.playbackSample.get();
+
+        // follow the recorded timestamps, so gaps between file records are kept, but never
+        // go back in time when playback loops, jumps back or waits for the reader thread
+        const int64 recordedTimestamp = input->getRecordTimestamp (stream.record, currentSample);
+        stream.timestamp = jmax (stream.timestamp, recordedTimestamp + stream.timestampOffset);
+        stream.timestampOffset = stream.timestamp - recordedTimestamp;
+
+        setTimestampAndSamples (stream.timestamp, samplesNeededPerBuffer, s);
+        stream.timestamp += samplesNeededPerBuffer;
+
+        if (s == 0)
+            static_cast<FileReaderEditor*> (getEditor())->setCurrentTime (samplesToMilliseconds (currentSample));
+
+        // while waiting for the reader thread the playback position holds, so no data is skipped
+        if (hasData)
+            stream.playbackSample.set (stream.wrapSample (currentSample + samplesNeededPerBuffer));
+        stream.bufferCacheWindow += 1;
+    }
 }
 
 
@@ -354,101 +433,208 @@ void FileReader::setParameter (int parameterIndex, float newValue)
 
         //set startTime
         case 1: 
-            startSample = millisecondsToSamples (newValue);
-            currentSample = startSample;
-
-            static_cast<FileReaderEditor*> (getEditor())->setCurrentTime (samplesToMilliseconds (currentSample));
+            for (int s = 0; s < streams.size(); ++s)
+                streams[s]->startSample = streams[s]->millisecondsToSamples (newValue);
+            jumpToTime (newValue);
             break;
 
         //set stop time
         case 2:
-            stopSample = millisecondsToSamples(newValue);
-            currentSample = startSample;
+            for (int s = 0; s < streams.size(); ++s)
+                streams[s]->stopSample = jmin (streams[s]->numSamples, streams[s]->millisecondsToSamples (newValue));
+            if (streams.size() > 0)
+                jumpToTime (samplesToMilliseconds (streams[0]->startSample));
+            break;
 
-            static_cast<FileReaderEditor*> (getEditor())->setCurrentTime (samplesToMilliseconds (currentSample));
+        //jump to a time within the playback range
+        case 3:
+            jumpToTime (newValue);
             break;
     }
 }
 
 
+void FileReader::jumpToTime (unsigned int ms)
+{
+    if (streams.size() == 0)
+        return;
+
+    for (int s = 0; s < streams.size(); ++s)
+    {
+        PlaybackStream& stream = *streams[s];
+        const int64 sample = stream.wrapSample (stream.millisecondsToSamples (ms));
+
+        if (isThreadRunning())
+            stream.jumpRequest.set (sample);
+        else
+            stream.playbackSample.set (sample);
+    }
+
+    if (! isThreadRunning())
+        static_cast<FileReaderEditor*> (getEditor())->setCurrentTime (samplesToMilliseconds (streams[0]->playbackSample.get()));
+}
+
+
+int64 FileReader::getPlaybackSample() const
+{
+    return streams.size() > 0 ? streams[0]->playbackSample.get() : 0;
+}
+
+
+const RecordOverview& FileReader::getOverview() const
+{
+    return overview;
+}
+
+
 unsigned int FileReader::samplesToMilliseconds (int64 samples) const
 {
-    return (unsigned int) (1000.f * float (samples) / currentSampleRate);
+    return (unsigned int) (1000.f * float (samples) / getDefaultSampleRate());
 }
 
 
 int64 FileReader::millisecondsToSamples (unsigned int ms) const
 {
-    return (int64) (currentSampleRate * float (ms) / 1000.f);
+    return (int64) (getDefaultSampleRate() * float (ms) / 1000.f);
 }
 
-void FileReader::switchBuffer()
+
+// PlaybackStream
+// ================================================================================
+FileReader::PlaybackStream::PlaybackStream (int r, FileSource* source)
+    : record                (r)
+    , sampleRate            (source->getRecordSampleRate (r))
+    , numChannels           (source->getRecordNumChannels (r))
+    , numSamples            (source->getRecordNumSamples (r))
+    , startSample           (0)
+    , stopSample            (numSamples)
+    , timestamp             (0)
+    , timestampOffset       (0)
+    , playbackSample        (0)
+    , jumpRequest           (-1)
+    , readBuffer            (nullptr)
+    , bufferCacheWindow     (0)
+    , frontBufferWindows    (0)
+    , maxSamplesPerBuffer   (0)
+    , backBufferState       (BACK_BUFFER_IDLE)
+    , backBufferStart       (0)
+    , backBufferWindowSize  (0)
 {
-    if (readBuffer == &bufferA)
-        readBuffer = &bufferB;
-    else
-        readBuffer = &bufferA;
-    
-    m_shouldFillBackBuffer.set(true);
-    notify();
 }
 
-HeapBlock<int16>* FileReader::getFrontBuffer()
+
+int64 FileReader::PlaybackStream::millisecondsToSamples (unsigned int ms) const
 {
-    return readBuffer;
+    return (int64) (double (sampleRate) * ms / 1000.0);
 }
 
-HeapBlock<int16>* FileReader::getBackBuffer()
+
+int64 FileReader::PlaybackStream::wrapSample (int64 sample) const
+{
+    const int64 length = stopSample - startSample;
+
+    if (length <= 0 || sample < startSample)
+        return startSample;
+
+    if (sample >= stopSample)
+        return startSample + (sample - stopSample) % length;
+
+    return sample;
+}
+
+
+HeapBlock<int16>* FileReader::PlaybackStream::getBackBuffer()
 {
     if (readBuffer == &bufferA) return &bufferB;
-    
+
     return &bufferA;
 }
 
+bool FileReader::switchBuffer (PlaybackStream& stream, int samplesPerWindow)
+{
+    const int64 firstSample = stream.playbackSample.get();
+    const int state = stream.backBufferState.get();
+
+    if (state == BACK_BUFFER_READY
+        && stream.backBufferStart == firstSample
+        && stream.backBufferWindowSize == samplesPerWindow)
+    {
+        stream.readBuffer = stream.getBackBuffer();
+        stream.bufferCacheWindow = 0;
+        stream.frontBufferWindows = BUFFER_WINDOW_CACHE_SIZE;
+
+        requestBackBuffer (stream, firstSample + samplesPerWindow * BUFFER_WINDOW_CACHE_SIZE, samplesPerWindow);
+
+        return true;
+    }
+
+    // The back buffer holds another part of the file (after a jump) or is
+    // still being filled. Play one window of silence, and once the reader
+    // thread is free ask it for the window at the playback sample.
+    zeromem (*stream.readBuffer, sizeof (int16) * stream.numChannels * samplesPerWindow);
+    stream.bufferCacheWindow = 0;
+    stream.frontBufferWindows = 1;
+
+    if (state != BACK_BUFFER_REQUESTED)
+        requestBackBuffer (stream, firstSample, samplesPerWindow);
+
+    return false;
+}
+
+void FileReader::requestBackBuffer (PlaybackStream& stream, int64 firstSample, int samplesPerWindow)
+{
+    // only called while the reader thread is not filling this stream, so its back buffer settings can be written
+    stream.backBufferStart = stream.wrapSample (firstSample);
+    stream.backBufferWindowSize = samplesPerWindow;
+    stream.backBufferState.set (BACK_BUFFER_REQUESTED);
+    notify();
+}
+
 void FileReader::run()
 {
     while (!threadShouldExit())
     {
-        if (m_shouldFillBackBuffer.compareAndSetBool(false, true))
+        // a single thread serves every stream, in order
+        for (int s = 0; s < streams.size(); ++s)
         {
-            readAndFillBufferCache(*getBackBuffer());
+            PlaybackStream& stream = *streams[s];
+
+            if (stream.backBufferState.get() == BACK_BUFFER_REQUESTED)
+            {
+                readAndFillBufferCache (stream, *stream.getBackBuffer(), stream.backBufferStart, stream.backBufferWindowSize);
+                stream.backBufferState.set (BACK_BUFFER_READY);
+            }
         }
         
         wait(30);
     }
 }
 
-void FileReader::readAndFillBufferCache(HeapBlock<int16> &cacheBuffer)
+void FileReader::readAndFillBufferCache (PlaybackStream& stream, HeapBlock<int16>& cacheBuffer, int64 firstSample, int samplesPerWindow)
 {
-    const int samplesNeededPerBuffer = m_samplesPerBuffer.get();
-    const int samplesNeeded = samplesNeededPerBuffer * BUFFER_WINDOW_CACHE_SIZE;
-    
+    readLooped (stream, cacheBuffer, firstSample, samplesPerWindow * BUFFER_WINDOW_CACHE_SIZE);
+}
+
+void FileReader::readLooped (const PlaybackStream& stream, int16* dest, int64 firstSample, int numSamples)
+{
+    int64 sample = stream.wrapSample (firstSample);
     int samplesRead = 0;
-    
-    // should only loop if reached end of file and resuming from start
-    while (samplesRead < samplesNeeded)
+
+    // should only loop if reached end of the playback range and resuming from start
+    while (samplesRead < numSamples)
     {
-        int samplesToRead = samplesNeeded - samplesRead;
-        
-        // if reached end of file stream
-        if ( (currentSample + samplesToRead) > stopSample)
-        {
-            samplesToRead = stopSample - currentSample;
-            if (samplesToRead > 0)
-                input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
-            
-            // reset stream to beginning
-            input->seekTo (startSample);
-            currentSample = startSample;
-        }
-        else // else read the block needed
+        const int samplesToRead = (int) jmin<int64> (numSamples - samplesRead, stream.stopSample - sample);
+        const int n = samplesToRead > 0 ? input->readRecordDataAt (stream.record, dest + samplesRead * stream.numChannels, sample, samplesToRead) : 0;
+
+        if (n <= 0)
         {
-            input->readData (cacheBuffer + samplesRead * currentNumChannels, samplesToRead);
-            
-            currentSample += samplesToRead;
+            // past the end of the data, play silence rather than stale samples
+            zeromem (dest + samplesRead * stream.numChannels, sizeof (int16) * stream.numChannels * (numSamples - samplesRead));
+            break;
         }
-        
-        samplesRead += samplesToRead;
+
+        samplesRead += n;
+        sample = stream.wrapSample (sample + n);
     }
 }
 
@@ -467,7 +653,7 @@ StringArray FileReader::getSupportedExtensions() const
 
 int FileReader::getNumBuiltInFileSources() const
 {
-	return 1;
+	return 2;
 }
 
 String FileReader::getBuiltInFileSourceExtensions(int index) const
@@ -476,6 +662,8 @@ String FileReader::getBuiltInFileSourceExtensions(int index) const
 	{
 	case 0: //Binary
 		return "oebin";
+	case 1: //Open Ephys
+		return "openephys;continuous";
 	default:
 		return "";
 	}
@@ -487,6 +675,8 @@ FileSource* FileReader::createBuiltInFileSource(int index) const
 	{
 	case 0:
 		return new BinarySource::BinaryFileSource();
+	case 1:
+		return new OpenEphysSource::OpenEphysFileSource();
 	default:
 		return nullptr;
 	}
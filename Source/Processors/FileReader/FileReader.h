@@ -30,13 +30,20 @@
 
 #include "../GenericProcessor/GenericProcessor.h"
 #include "FileSource.h"
+#include "RecordOverview.h"
 
 #define BUFFER_WINDOW_CACHE_SIZE 10
+#define OVERVIEW_NUM_BINS 1024
 
 
 /**
   Reads data from a file.
 
+  Either a single record is played back, or, for sources whose records were
+  acquired together, every record at once. In that case each record becomes
+  a subprocessor with its own sample rate and timestamps, and a single reader
+  thread prefetches all of them.
+
   @see GenericProcessor
 */
 class FileReader : public GenericProcessor,
@@ -57,6 +64,8 @@ public:
 
     int getDefaultNumDataOutputs(DataChannel::DataChannelTypes type, int)        const override;
 
+    int getNumSubProcessors()           const override;
+    float getSampleRate (int subProcessorIdx = 0) const override;
     float getDefaultSampleRate()        const override;
     float getBitVolts (const DataChannel* chan)   const override;
 
@@ -73,24 +82,73 @@ public:
     void createEventChannels();
 	StringArray getSupportedExtensions() const;
 
+    /** Returns true if the records of the current file can be played back together */
+    bool canPlayAllRecords() const;
+
+    /** Moves playback to a time within the active record. While acquiring, the
+        jump is taken at the next block, which plays silence while the reader
+        thread reads from the new position. */
+    void jumpToTime (unsigned int ms);
+
+    /** Returns the sample of the first played record that is currently being played */
+    int64 getPlaybackSample() const;
+
+    const RecordOverview& getOverview() const;
+
 private:
     Array<const EventChannel*> moduleEventChannels;
     unsigned int count = 0;
-    
+
+    /** Plays back a single record, or all of them if index is the number of records */
     void setActiveRecording (int index);
 
     unsigned int samplesToMilliseconds (int64 samples)  const;
     int64 millisecondsToSamples (unsigned int ms)       const;
 
-    int64 timestamp;
-
-    float currentSampleRate;
-    int currentNumChannels;
-    int64 currentSample;
-    int64 currentNumSamples;
-    int64 startSample;
-    int64 stopSample;
-    int64 bufferCacheWindow; // the current buffer window to read from readBuffer
+    enum BackBufferState
+    {
+        BACK_BUFFER_IDLE = 0,
+        BACK_BUFFER_REQUESTED,
+        BACK_BUFFER_READY
+    };
+
+    /** Playback state and double buffer of one record, output as one subprocessor */
+    struct PlaybackStream
+    {
+        PlaybackStream (int record, FileSource* source);
+
+        int record;
+        float sampleRate;
+        int numChannels;
+        int64 numSamples;
+        int64 startSample;
+        int64 stopSample;
+        int64 timestamp;                // next timestamp to output
+        int64 timestampOffset;          // output minus recorded timestamp, grows when playback loops or waits
+
+        Atomic<int64> playbackSample;
+        Atomic<int64> jumpRequest;      // -1 when no jump is pending
+
+        HeapBlock<int16>* readBuffer;   // Ptr to the current "front" buffer
+        HeapBlock<int16> bufferA;
+        HeapBlock<int16> bufferB;
+        int bufferCacheWindow;          // the current buffer window to read from readBuffer
+        int frontBufferWindows;         // number of valid windows in readBuffer
+        int maxSamplesPerBuffer;
+
+        Atomic<int> backBufferState;
+        int64 backBufferStart;          // first sample of the back buffer, set before requesting it
+        int backBufferWindowSize;       // samples per window of the back buffer
+
+        int64 millisecondsToSamples (unsigned int ms) const;
+
+        /** Maps a sample onto the playback range */
+        int64 wrapSample (int64 sample) const;
+
+        HeapBlock<int16>* getBackBuffer();
+    };
+
+    OwnedArray<PlaybackStream> streams;
     Array<RecordedChannelInfo> channelInfo;
 
     // for testing purposes only
@@ -98,33 +156,35 @@ private:
 
     ScopedPointer<FileSource> input;
 
-    HeapBlock<int16> * readBuffer;      // Ptr to the current "front" buffer
-    HeapBlock<int16> bufferA;
-    HeapBlock<int16> bufferB;
-
     HashMap<String, int> supportedExtensions;
-    
-    Atomic<int> m_shouldFillBackBuffer;
-    Atomic<int> m_samplesPerBuffer;
+
+    RecordOverview overview;
 
 	unsigned int m_bufferSize;
 	float m_sysSampleRate;
     
-    /** Swaps the backbuffer to the front and flags the background reader
-        thread to update the new backbuffer */
-    void switchBuffer();
-    
-    HeapBlock<int16>* getFrontBuffer();
-    HeapBlock<int16>* getBackBuffer();
-    
-    /** Executes the background thread task */
+    /** Makes the window starting at the playback sample of a stream available in
+        its front buffer by swapping in the back buffer. After a jump, or if the
+        reader thread fell behind, the front buffer gets a window of silence and
+        the reader thread is asked for the playback sample instead; the file is
+        never read here. Returns false if the window is silence. */
+    bool switchBuffer (PlaybackStream& stream, int samplesPerWindow);
+
+    /** Flags the background reader thread to fill the back buffer of a stream from a sample */
+    void requestBackBuffer (PlaybackStream& stream, int64 firstSample, int samplesPerWindow);
+
+    /** Executes the background thread task, serving the back buffers of all streams */
     void run() override;
     
     /** Reads a chunk of the file that fills an entire buffer cache.
      
         This method will read into the buffer that passed in by the param 
      */
-    void readAndFillBufferCache(HeapBlock<int16> &cacheBuffer);
+    void readAndFillBufferCache (PlaybackStream& stream, HeapBlock<int16>& cacheBuffer, int64 firstSample, int samplesPerWindow);
+
+    /** Reads samples from the playback range of a stream, continuing at its
+        start sample when the stop sample is reached */
+    void readLooped (const PlaybackStream& stream, int16* dest, int64 firstSample, int numSamples);
 
 	//Methods for built-in file sources
 	int getNumBuiltInFileSources() const;
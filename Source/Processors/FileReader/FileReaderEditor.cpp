@@ -57,7 +57,11 @@ FileReaderEditor::FileReaderEditor (GenericProcessor* parentNode, bool useDefaul
     timeLimits->setBounds (5, 105, 175, 20);
     addAndMakeVisible (timeLimits);
 
-    desiredWidth = 180;
+    minimap = new RecordMinimap (this, fileReader->getOverview());
+    minimap->setBounds (185, 30, 110, 95);
+    addAndMakeVisible (minimap);
+
+    desiredWidth = 300;
 
     setEnabledState (false);
 }
@@ -143,6 +147,7 @@ bool FileReaderEditor::setPlaybackStartTime (unsigned int ms)
         return false;
 
     fileReader->setParameter (1, ms);
+    minimap->setPlaybackRange (ms, timeLimits->getTimeMilliseconds (1));
     return true;
 }
 
@@ -154,6 +159,7 @@ bool FileReaderEditor::setPlaybackStopTime (unsigned int ms)
         return false;
 
     fileReader->setParameter (2, ms);
+    minimap->setPlaybackRange (timeLimits->getTimeMilliseconds (0), ms);
     return true;
 }
 
@@ -166,12 +172,21 @@ void FileReaderEditor::setTotalTime (unsigned int ms)
     currentTime->setTimeMilliseconds    (1, ms);
 
     recTotalTime = ms;
+
+    minimap->setTotalTime (ms);
 }
 
 
 void FileReaderEditor::setCurrentTime (unsigned int ms)
 {
     currentTime->setTimeMilliseconds (0, ms);
+    minimap->setCurrentTime (ms);
+}
+
+
+void FileReaderEditor::jumpToTime (unsigned int ms)
+{
+    fileReader->setParameter (3, ms);
 }
 
 
@@ -193,6 +208,10 @@ void FileReaderEditor::populateRecordings (FileSource* source)
         recordSelector->addItem (source->getRecordName (i), i + 1);
     }
 
+    // streams recorded together can be played back as one subprocessor each
+    if (fileReader->canPlayAllRecords())
+        recordSelector->addItem ("All streams", numRecords + 1);
+
     recordSelector->setSelectedId (1, dontSendNotification);
 }
 
@@ -206,6 +225,7 @@ void FileReaderEditor::clearEditor()
     timeLimits->setTimeMilliseconds     (1, 0);
     currentTime->setTimeMilliseconds    (0, 0);
     currentTime->setTimeMilliseconds    (1, 0);
+    minimap->setTotalTime (0);
 
     setEnabledState (false);
 }
@@ -445,3 +465,162 @@ void DualTimeComponent::labelTextChanged (Label* label)
     else
         setTimeMilliseconds (index, getTimeMilliseconds (index));
 }
+
+
+// RecordMinimap
+// ================================================================================
+RecordMinimap::RecordMinimap (FileReaderEditor* e, const RecordOverview& o)
+    : editor        (e)
+    , overview      (o)
+    , totalTime     (0)
+    , rangeStart    (0)
+    , rangeStop     (0)
+    , currentTime   (0)
+    , lastBinsDrawn (-1)
+    , lastTimeDrawn (-1)
+{
+    startTimer (50);
+}
+
+
+RecordMinimap::~RecordMinimap()
+{
+}
+
+
+void RecordMinimap::setTotalTime (unsigned int ms)
+{
+    totalTime   = ms;
+    rangeStart  = 0;
+    rangeStop   = ms;
+    currentTime.set (0);
+
+    repaint();
+}
+
+
+void RecordMinimap::setPlaybackRange (unsigned int startMs, unsigned int stopMs)
+{
+    rangeStart  = startMs;
+    rangeStop   = stopMs;
+
+    repaint();
+}
+
+
+void RecordMinimap::setCurrentTime (unsigned int ms)
+{
+    currentTime.set ((int) ms);
+}
+
+
+void RecordMinimap::timerCallback()
+{
+    // the overview fills in on a background thread and the position moves on
+    // the audio thread, so only repaint when either has changed
+    const int binsReady = overview.getNumBinsReady();
+    const int time = currentTime.get();
+
+    if (binsReady != lastBinsDrawn || time != lastTimeDrawn)
+        repaint();
+}
+
+
+unsigned int RecordMinimap::xToTime (int x) const
+{
+    if (getWidth() <= 0)
+        return 0;
+
+    const int clampedX = jlimit (0, getWidth(), x);
+    return (unsigned int) ((double) totalTime * clampedX / getWidth());
+}
+
+
+int RecordMinimap::timeToX (unsigned int ms) const
+{
+    if (totalTime == 0)
+        return 0;
+
+    return (int) ((double) getWidth() * ms / totalTime);
+}
+
+
+void RecordMinimap::paint (Graphics& g)
+{
+    const int w = getWidth();
+    const int h = getHeight();
+
+    g.setColour (Colours::darkgrey);
+    g.fillRect (0, 0, w, h);
+
+    const int numBins = overview.getNumBins();
+    const int binsReady = overview.getNumBinsReady();
+
+    lastBinsDrawn = binsReady;
+    lastTimeDrawn = currentTime.get();
+
+    if (totalTime == 0 || numBins == 0)
+        return;
+
+    float range = 0.0f;
+    for (int bin = 0; bin < binsReady; ++bin)
+        range = jmax (range, std::abs (overview.getMin (bin)), std::abs (overview.getMax (bin)));
+
+    if (range > 0.0f)
+    {
+        const float scale = (h / 2 - 1) / range;
+        const float mid = h / 2.0f;
+
+        g.setColour (Colours::lightgrey);
+
+        for (int x = 0; x < w; ++x)
+        {
+            const int firstBin = x * numBins / w;
+            const int lastBin = jmax (firstBin + 1, (x + 1) * numBins / w);
+
+            if (firstBin >= binsReady)
+                break;
+
+            float lo = overview.getMin (firstBin);
+            float hi = overview.getMax (firstBin);
+            for (int bin = firstBin + 1; bin < lastBin && bin < binsReady; ++bin)
+            {
+                lo = jmin (lo, overview.getMin (bin));
+                hi = jmax (hi, overview.getMax (bin));
+            }
+
+            g.drawVerticalLine (x, mid - hi * scale, mid - lo * scale + 1.0f);
+        }
+    }
+
+    // dim the parts outside the playback range
+    g.setColour (Colours::black.withAlpha (0.5f));
+    g.fillRect (0, 0, timeToX (rangeStart), h);
+    const int stopX = timeToX (rangeStop);
+    g.fillRect (stopX, 0, w - stopX, h);
+
+    g.setColour (Colours::yellow);
+    g.drawVerticalLine (timeToX ((unsigned int) lastTimeDrawn), 0.0f, (float) h);
+
+    g.setColour (Colours::black);
+    g.drawRect (0, 0, w, h, 1);
+}
+
+
+void RecordMinimap::mouseDown (const MouseEvent& event)
+{
+    if (totalTime == 0)
+        return;
+
+    const unsigned int ms = jlimit (rangeStart, rangeStop, xToTime (event.x));
+    editor->jumpToTime (ms);
+
+    currentTime.set ((int) ms);
+    repaint();
+}
+
+
+void RecordMinimap::mouseDrag (const MouseEvent& event)
+{
+    mouseDown (event);
+}
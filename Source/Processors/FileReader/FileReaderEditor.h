@@ -27,9 +27,11 @@
 
 #include "../../../JuceLibraryCode/JuceHeader.h"
 #include "../Editors/GenericEditor.h"
+#include "RecordOverview.h"
 
 class FileReader;
 class DualTimeComponent;
+class RecordMinimap;
 class FileSource;
 
 /**
@@ -67,6 +69,9 @@ public:
     void setTotalTime   (unsigned int ms);
     void setCurrentTime (unsigned int ms);
 
+    /** Moves playback to a time, as requested from the minimap */
+    void jumpToTime (unsigned int ms);
+
 	void startAcquisition() override;
 	void stopAcquisition()  override;
 
@@ -85,6 +90,7 @@ private:
     ScopedPointer<ComboBox>             recordSelector;
     ScopedPointer<DualTimeComponent>    currentTime;
     ScopedPointer<DualTimeComponent>    timeLimits;
+    ScopedPointer<RecordMinimap>        minimap;
 
     FileReader* fileReader;
     unsigned int recTotalTime;
@@ -128,4 +134,47 @@ private:
 
 
 
+/**
+  Draws the overview of the active record with the playback range and
+  position. Clicking or dragging on it jumps playback to that time.
+*/
+class RecordMinimap : public Component
+                    , private Timer
+{
+public:
+    RecordMinimap (FileReaderEditor* e, const RecordOverview& overview);
+    ~RecordMinimap();
+
+    void paint (Graphics& g) override;
+
+    void mouseDown (const MouseEvent& event) override;
+    void mouseDrag (const MouseEvent& event) override;
+
+    void setTotalTime (unsigned int ms);
+    void setPlaybackRange (unsigned int startMs, unsigned int stopMs);
+
+    /** Can be called from the audio thread */
+    void setCurrentTime (unsigned int ms);
+
+
+private:
+    void timerCallback() override;
+
+    unsigned int xToTime (int x) const;
+    int timeToX (unsigned int ms) const;
+
+    FileReaderEditor* editor;
+    const RecordOverview& overview;
+
+    unsigned int totalTime;
+    unsigned int rangeStart;
+    unsigned int rangeStop;
+    Atomic<int> currentTime;
+
+    int lastBinsDrawn;
+    int lastTimeDrawn;
+};
+
+
+
 #endif  // __FILEREADEREDITOR_H_D6EC8B48__
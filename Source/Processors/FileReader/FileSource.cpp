@@ -142,6 +142,79 @@ bool FileSource::OpenFile (File file)
     return fileOpened;
 }
 
+int FileSource::readDataAt (int16* buffer, int64 startSample, int nSamples)
+{
+    const ScopedLock sl (readLock);
+
+    seekTo (startSample);
+    return readData (buffer, nSamples);
+}
+
+bool FileSource::areRecordsSimultaneous() const
+{
+    return false;
+}
+
+int FileSource::readRecordDataAt (int record, int16* buffer, int64 startSample, int nSamples)
+{
+    jassert (record == getActiveRecord());
+    return readDataAt (buffer, startSample, nSamples);
+}
+
+void FileSource::processRecordChannelData (int record, int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+    jassert (record == getActiveRecord());
+    processChannelData (inBuffer, outBuffer, channel, numSamples);
+}
+
+int64 FileSource::getRecordTimestamp (int record, int64 sample) const
+{
+    return sample;
+}
+
+void FileSource::getRecordMinMax (int record, int64 startSample, int64 numSamples, float* mins, float* maxs)
+{
+    const int numChannels = getRecordNumChannels (record);
+    const int readSize = 4096;
+
+    HeapBlock<int16> data (readSize * numChannels);
+    HeapBlock<int16> lo (numChannels);
+    HeapBlock<int16> hi (numChannels);
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        lo[c] = std::numeric_limits<int16>::max();
+        hi[c] = std::numeric_limits<int16>::min();
+    }
+
+    for (int64 pos = startSample; pos < startSample + numSamples; )
+    {
+        const int samplesRead = readRecordDataAt (record, data, pos, (int) jmin<int64> (readSize, startSample + numSamples - pos));
+
+        if (samplesRead <= 0)
+            break;
+
+        const int16* frame = data;
+        for (int i = 0; i < samplesRead; ++i, frame += numChannels)
+        {
+            for (int c = 0; c < numChannels; ++c)
+            {
+                lo[c] = jmin (lo[c], frame[c]);
+                hi[c] = jmax (hi[c], frame[c]);
+            }
+        }
+
+        pos += samplesRead;
+    }
+
+    for (int c = 0; c < numChannels; ++c)
+    {
+        const float bitVolts = getChannelInfo (record, c).bitVolts;
+        mins[c] = lo[c] <= hi[c] ? lo[c] * bitVolts : 0.0f;
+        maxs[c] = lo[c] <= hi[c] ? hi[c] * bitVolts : 0.0f;
+    }
+}
+
 bool FileSource::isReady()
 {
     return true;
@@ -67,6 +67,35 @@ public:
     virtual void processChannelData (int16* inBuffer, float* outBuffer, int channel, int64 numSamples) = 0;
     virtual void seekTo (int64 sample) = 0;
 
+    /** Reads nSamples interleaved samples of the active record starting at startSample,
+        without moving the position used by readData. Returns the number of samples read.
+
+        The default implementation seeks and reads under a lock. Sources that can locate
+        any sample directly should override it so playback can jump without blocking.
+    */
+    virtual int readDataAt (int16* buffer, int64 startSample, int nSamples);
+
+    /** Returns true if the records of the file were acquired together, e.g. one
+        per source subprocessor, so they can be played back at the same time.
+        Sources that return true must implement the record-specific methods below. */
+    virtual bool areRecordsSimultaneous() const;
+
+    /** Like readDataAt, but from any record. The default implementation reads the active record. */
+    virtual int readRecordDataAt (int record, int16* buffer, int64 startSample, int nSamples);
+
+    /** Like processChannelData, but for any record. The default implementation uses the active record. */
+    virtual void processRecordChannelData (int record, int16* inBuffer, float* outBuffer, int channel, int64 numSamples);
+
+    /** Returns the timestamp a sample of a record was acquired at. Sources that store
+        timestamps should override it, so playback keeps the gaps of the recording.
+        The default implementation numbers the samples from 0. */
+    virtual int64 getRecordTimestamp (int record, int64 sample) const;
+
+    /** Computes the range of every channel of a record over a span of samples, in
+        their units. mins and maxs hold one value per channel, and a span without
+        data gives 0 for both. The default implementation scans readRecordDataAt. */
+    virtual void getRecordMinMax (int record, int64 startSample, int64 numSamples, float* mins, float* maxs);
+
     virtual bool isReady();
 
 protected:
@@ -86,6 +115,8 @@ protected:
 
 
 private:
+    CriticalSection readLock;
+
     virtual bool Open (File file) = 0;
     virtual void fillRecordInfo() = 0;
     virtual void updateActiveRecord() = 0;
@@ -0,0 +1,399 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "OpenEphysFileSource.h"
+
+using namespace OpenEphysSource;
+
+#define OE_HEADER_SIZE 1024
+#define OE_BLOCK_LENGTH 1024
+#define OE_BLOCK_HEADER_SIZE 12		// int64 timestamp, uint16 sample count, uint16 recording number
+#define OE_MARKER_SIZE 10
+#define OE_BLOCK_SIZE (OE_BLOCK_HEADER_SIZE + 2 * OE_BLOCK_LENGTH + OE_MARKER_SIZE)
+
+static const uint8 blockMarker[OE_MARKER_SIZE] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 255 };
+
+OpenEphysFileSource::OpenEphysFileSource() : m_simultaneous(true), m_samplePos(0)
+{}
+
+OpenEphysFileSource::~OpenEphysFileSource()
+{}
+
+bool OpenEphysFileSource::Open(File file)
+{
+	m_records.clear();
+	m_maps.clear();
+	m_mappedPaths.clear();
+	m_headers.clear();
+
+	bool opened;
+	if (file.hasFileExtension("openephys"))
+		opened = openIndex(file);
+	else
+		opened = openContinuousFolder(file);
+
+	if (!opened || m_records.size() == 0)
+	{
+		std::cerr << "No continuous data found in " << file.getFullPathName() << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+const MemoryMappedFile* OpenEphysFileSource::mapFile(const File& file, StringPairArray& header)
+{
+	const String path = file.getFullPathName();
+	const int index = m_mappedPaths.indexOf(path);
+
+	if (index >= 0)
+	{
+		header = m_headers[index];
+		return m_maps[index];
+	}
+
+	ScopedPointer<MemoryMappedFile> map = new MemoryMappedFile(file, MemoryMappedFile::readOnly);
+	if (map->getData() == nullptr || map->getSize() < OE_HEADER_SIZE)
+	{
+		std::cerr << "Could not map " << path << std::endl;
+		return nullptr;
+	}
+
+	// header.key = value; pairs, with quoted strings
+	const String text(static_cast<const char*>(map->getData()), OE_HEADER_SIZE);
+	StringArray fields;
+	fields.addTokens(text, ";", "'");
+
+	header.clear();
+	for (int i = 0; i < fields.size(); i++)
+	{
+		const String key = fields[i].upToFirstOccurrenceOf("=", false, false).trim().fromFirstOccurrenceOf("header.", false, false);
+		const String value = fields[i].fromFirstOccurrenceOf("=", false, false).trim().unquoted();
+
+		if (key.isNotEmpty())
+			header.set(key, value);
+	}
+
+	m_mappedPaths.add(path);
+	m_headers.add(header);
+	return m_maps.add(map.release());
+}
+
+bool OpenEphysFileSource::addChannel(RecordData& record, const File& file, int64 startPos, int64 endPos,
+									 const String& name, float bitVolts)
+{
+	StringPairArray header;
+	const MemoryMappedFile* map = mapFile(file, header);
+	if (map == nullptr)
+		return false;
+
+	const int64 fileSize = (int64)map->getSize();
+	if (endPos < 0 || endPos > fileSize)
+		endPos = fileSize;
+
+	// ftell right after opening in append mode can report 0 instead of the header end
+	if (startPos < OE_HEADER_SIZE)
+		startPos = OE_HEADER_SIZE;
+
+	int64 numBlocks = jmax<int64>(0, (endPos - startPos) / OE_BLOCK_SIZE);
+	const char* firstBlock = static_cast<const char*>(map->getData()) + startPos;
+
+	// a recording that was not closed cleanly can end with an incomplete block
+	while (numBlocks > 0
+		   && memcmp(firstBlock + (numBlocks - 1) * OE_BLOCK_SIZE + OE_BLOCK_SIZE - OE_MARKER_SIZE, blockMarker, OE_MARKER_SIZE) != 0)
+	{
+		numBlocks--;
+	}
+
+	if (record.channels.size() == 0)
+	{
+		record.sampleRate = header["sampleRate"].getFloatValue();
+		record.numBlocks = numBlocks;
+	}
+	else
+	{
+		if (header["sampleRate"].getFloatValue() != record.sampleRate)
+		{
+			std::cerr << file.getFullPathName() << " has a different sample rate than the other channels" << std::endl;
+			return false;
+		}
+
+		// channels stopped together, but only play what all of them hold
+		record.numBlocks = jmin(record.numBlocks, numBlocks);
+	}
+
+	ChannelData channel;
+	channel.name = name.isNotEmpty() ? name : header["channel"];
+	channel.bitVolts = bitVolts > 0 ? bitVolts : header["bitVolts"].getFloatValue();
+	channel.firstBlock = firstBlock;
+	record.channels.add(channel);
+
+	return true;
+}
+
+bool OpenEphysFileSource::openIndex(const File& file)
+{
+	ScopedPointer<XmlElement> xml = XmlDocument::parse(file);
+	if (xml == nullptr || !xml->hasTagName("EXPERIMENT"))
+	{
+		std::cerr << file.getFullPathName() << " is not a valid recording index" << std::endl;
+		return false;
+	}
+
+	const File folder = file.getParentDirectory();
+
+	// Recordings are appended to the same files unless they were saved separately,
+	// so each one ends where the next one written to that file starts.
+	HashMap<String, Array<int64>> filePositions;
+	forEachXmlChildElementWithTagName(*xml, rec, "RECORDING")
+	{
+		forEachXmlChildElementWithTagName(*rec, proc, "PROCESSOR")
+		{
+			forEachXmlChildElementWithTagName(*proc, chan, "CHANNEL")
+			{
+				const String filename = chan->getStringAttribute("filename");
+				Array<int64> positions = filePositions[filename];
+				positions.addUsingDefaultSort((int64)chan->getDoubleAttribute("position"));
+				filePositions.set(filename, positions);
+			}
+		}
+	}
+
+	forEachXmlChildElementWithTagName(*xml, rec, "RECORDING")
+	{
+		const int recordingNumber = rec->getIntAttribute("number");
+
+		forEachXmlChildElementWithTagName(*rec, proc, "PROCESSOR")
+		{
+			ScopedPointer<RecordData> record = new RecordData();
+			record->name = "Recording " + String(recordingNumber + 1) + " - " + proc->getStringAttribute("id");
+			record->recordingNumber = recordingNumber;
+			record->numBlocks = 0;
+
+			bool valid = true;
+			forEachXmlChildElementWithTagName(*proc, chan, "CHANNEL")
+			{
+				const String filename = chan->getStringAttribute("filename");
+				const int64 startPos = (int64)chan->getDoubleAttribute("position");
+
+				const Array<int64> positions = filePositions[filename];
+				const int next = positions.indexOf(startPos) + 1;
+				const int64 endPos = next < positions.size() ? positions[next] : -1;
+
+				if (!addChannel(*record, folder.getChildFile(filename), startPos, endPos,
+								chan->getStringAttribute("name"), (float)chan->getDoubleAttribute("bitVolts")))
+				{
+					valid = false;
+					break;
+				}
+			}
+
+			if (valid && record->channels.size() > 0 && record->numBlocks > 0)
+				m_records.add(record.release());
+		}
+	}
+
+	for (int i = 1; i < m_records.size(); i++)
+	{
+		if (m_records[i]->recordingNumber != m_records[0]->recordingNumber)
+			m_simultaneous = false;
+	}
+
+	return true;
+}
+
+/** Returns the [_<experiment>][_<recording>] part of a continuous file name, channel names have no underscores */
+static String getContinuousSuffix(const File& file)
+{
+	const String channelAndSuffix = file.getFileNameWithoutExtension().fromFirstOccurrenceOf("_", false, false);
+	return channelAndSuffix.fromFirstOccurrenceOf("_", true, false);
+}
+
+bool OpenEphysFileSource::openContinuousFolder(const File& file)
+{
+	// files are named <processor id>_<channel name>[_<experiment>][_<recording>].continuous
+	const String prefix = file.getFileName().upToFirstOccurrenceOf("_", true, false);
+	const String suffix = getContinuousSuffix(file);
+
+	Array<File> files;
+	file.getParentDirectory().findChildFiles(files, File::findFiles, false, prefix + "*.continuous");
+
+	StringArray names;
+	for (int i = 0; i < files.size(); i++)
+	{
+		// other experiments and recordings of the same processor are in the same folder
+		if (getContinuousSuffix(files[i]) == suffix)
+			names.add(files[i].getFileName());
+	}
+	names.sortNatural();
+
+	ScopedPointer<RecordData> record = new RecordData();
+	record->name = prefix.dropLastCharacters(1);
+	record->recordingNumber = 0;
+	record->numBlocks = 0;
+
+	StringPairArray header;
+	if (mapFile(file, header) == nullptr)
+		return false;
+	const float sampleRate = header["sampleRate"].getFloatValue();
+
+	for (int i = 0; i < names.size(); i++)
+	{
+		const File channelFile = file.getSiblingFile(names[i]);
+
+		StringPairArray channelHeader;
+		if (mapFile(channelFile, channelHeader) == nullptr
+			|| channelHeader["sampleRate"].getFloatValue() != sampleRate)
+			continue;
+
+		addChannel(*record, channelFile, OE_HEADER_SIZE, -1, String::empty, 0.0f);
+	}
+
+	if (record->channels.size() > 0 && record->numBlocks > 0)
+		m_records.add(record.release());
+
+	return true;
+}
+
+void OpenEphysFileSource::fillRecordInfo()
+{
+	for (int i = 0; i < m_records.size(); i++)
+	{
+		const RecordData& record = *m_records[i];
+
+		RecordInfo info;
+		info.name = record.name;
+		info.sampleRate = record.sampleRate;
+		info.numSamples = record.numBlocks * OE_BLOCK_LENGTH;
+
+		for (int c = 0; c < record.channels.size(); c++)
+		{
+			RecordedChannelInfo cInfo;
+
+			cInfo.name = record.channels[c].name;
+			cInfo.bitVolts = record.channels[c].bitVolts;
+
+			info.channels.add(cInfo);
+		}
+
+		infoArray.add(info);
+		numRecords++;
+	}
+}
+
+void OpenEphysFileSource::updateActiveRecord()
+{
+	m_samplePos = 0;
+}
+
+void OpenEphysFileSource::seekTo(int64 sample)
+{
+	m_samplePos = sample % getActiveNumSamples();
+}
+
+int OpenEphysFileSource::readData(int16* buffer, int nSamples)
+{
+	int samplesRead = readDataAt(buffer, m_samplePos, nSamples);
+
+	m_samplePos += samplesRead;
+	return samplesRead;
+}
+
+int OpenEphysFileSource::readDataAt(int16* buffer, int64 startSample, int nSamples)
+{
+	return readRecordDataAt(activeRecord.get(), buffer, startSample, nSamples);
+}
+
+bool OpenEphysFileSource::areRecordsSimultaneous() const
+{
+	// processors of the same recording were acquired together
+	return m_simultaneous;
+}
+
+int OpenEphysFileSource::readRecordDataAt(int record, int16* buffer, int64 startSample, int nSamples)
+{
+	const RecordData& rec = *m_records[record];
+	const int64 numSamples = rec.numBlocks * OE_BLOCK_LENGTH;
+
+	if (startSample < 0 || startSample >= numSamples)
+		return 0;
+
+	nSamples = (int)jmin<int64>(nSamples, numSamples - startSample);
+
+	const int numChannels = rec.channels.size();
+
+	for (int c = 0; c < numChannels; c++)
+	{
+		const char* firstBlock = rec.channels[c].firstBlock;
+		int16* dest = buffer + c;
+
+		int64 sample = startSample;
+		int samplesDone = 0;
+
+		while (samplesDone < nSamples)
+		{
+			const int64 block = sample / OE_BLOCK_LENGTH;
+			const int offset = int(sample % OE_BLOCK_LENGTH);
+			const int count = jmin(OE_BLOCK_LENGTH - offset, nSamples - samplesDone);
+
+			// samples are big-endian, interleave them in native order
+			const uint16* src = reinterpret_cast<const uint16*>(firstBlock + block * OE_BLOCK_SIZE + OE_BLOCK_HEADER_SIZE) + offset;
+			for (int i = 0; i < count; i++)
+			{
+				*dest = (int16)ByteOrder::swapIfLittleEndian(src[i]);
+				dest += numChannels;
+			}
+
+			sample += count;
+			samplesDone += count;
+		}
+	}
+
+	return nSamples;
+}
+
+void OpenEphysFileSource::processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+	processRecordChannelData(activeRecord.get(), inBuffer, outBuffer, channel, numSamples);
+}
+
+void OpenEphysFileSource::processRecordChannelData(int record, int16* inBuffer, float* outBuffer, int channel, int64 numSamples)
+{
+	const int n = getRecordNumChannels(record);
+	const float bitVolts = getChannelInfo(record, channel).bitVolts;
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		*(outBuffer + i) = *(inBuffer + (n*i) + channel) * bitVolts;
+	}
+}
+
+int64 OpenEphysFileSource::getRecordTimestamp(int record, int64 sample) const
+{
+	const RecordData& rec = *m_records[record];
+	const int64 block = jlimit<int64>(0, rec.numBlocks - 1, sample / OE_BLOCK_LENGTH);
+
+	// the record header starts with the timestamp of its first sample, written in native (little-endian) order
+	const int64 blockTimestamp = (int64)ByteOrder::littleEndianInt64(rec.channels[0].firstBlock + block * OE_BLOCK_SIZE);
+	return blockTimestamp + (sample - block * OE_BLOCK_LENGTH);
+}
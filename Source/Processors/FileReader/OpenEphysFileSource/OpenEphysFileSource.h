@@ -0,0 +1,109 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef OPENEPHYSFILESOURCE_H_INCLUDED
+#define OPENEPHYSFILESOURCE_H_INCLUDED
+
+#include "../FileSource.h"
+
+namespace OpenEphysSource
+{
+	/**
+		Reads recordings made with the Open Ephys record engine (OriginalRecording).
+
+		Either the Continuous_Data.openephys index of a recording folder is opened,
+		giving one record per recording and processor, or a single .continuous file,
+		in which case every file of the same processor in that folder is read.
+
+		Each channel file holds a 1024-byte text header followed by records of a
+		64-bit timestamp, a 16-bit sample count, a 16-bit recording number, 1024
+		big-endian int16 samples and a 10-byte marker. All channel files are memory
+		mapped, so a sample is found from its record index without reading the
+		data that precedes it. The record timestamps number the samples of each
+		channel, with a jump wherever acquisition paused between records.
+	*/
+	class OpenEphysFileSource : public FileSource
+	{
+	public:
+		OpenEphysFileSource();
+		~OpenEphysFileSource();
+
+		int readData(int16* buffer, int nSamples) override;
+
+		void seekTo(int64 sample) override;
+
+		int readDataAt(int16* buffer, int64 startSample, int nSamples) override;
+
+		bool areRecordsSimultaneous() const override;
+
+		int readRecordDataAt(int record, int16* buffer, int64 startSample, int nSamples) override;
+
+		void processChannelData(int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+
+		void processRecordChannelData(int record, int16* inBuffer, float* outBuffer, int channel, int64 numSamples) override;
+
+		int64 getRecordTimestamp(int record, int64 sample) const override;
+
+	private:
+		bool Open(File file) override;
+		void fillRecordInfo() override;
+		void updateActiveRecord() override;
+
+		struct ChannelData
+		{
+			String name;
+			float bitVolts;
+			const char* firstBlock;		// first record block of this recording within the mapped file
+		};
+
+		struct RecordData
+		{
+			String name;
+			int recordingNumber;
+			float sampleRate;
+			int64 numBlocks;
+			Array<ChannelData> channels;
+		};
+
+		bool openIndex(const File& file);
+		bool openContinuousFolder(const File& file);
+
+		/** Maps a channel file, once, and returns its header fields */
+		const MemoryMappedFile* mapFile(const File& file, StringPairArray& header);
+
+		/** Adds a channel to a record, with the blocks between startPos and endPos */
+		bool addChannel(RecordData& record, const File& file, int64 startPos, int64 endPos,
+						const String& name, float bitVolts);
+
+		OwnedArray<MemoryMappedFile> m_maps;
+		StringArray m_mappedPaths;
+		Array<StringPairArray> m_headers;
+
+		OwnedArray<RecordData> m_records;
+		bool m_simultaneous;
+
+		int64 m_samplePos;
+	};
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "RecordOverview.h"
+#include "FileSource.h"
+
+RecordOverview::RecordOverview()
+    : Thread        ("filereader_Overview")
+    , source        (nullptr)
+    , numBins       (0)
+    , numChannels   (0)
+    , numSamples    (0)
+    , binsReady     (0)
+{
+}
+
+
+RecordOverview::~RecordOverview()
+{
+    stopThread (1000);
+}
+
+
+void RecordOverview::build (FileSource* newSource, int bins)
+{
+    clear();
+
+    if (newSource == nullptr || bins <= 0)
+        return;
+
+    source      = newSource;
+    numChannels = source->getActiveNumChannels();
+    numSamples  = source->getActiveNumSamples();
+    numBins     = (int) jmin<int64> (bins, numSamples);
+
+    if (numChannels <= 0 || numBins <= 0)
+    {
+        numBins = 0;
+        return;
+    }
+
+    channelMins.malloc (numChannels * numBins);
+    channelMaxs.malloc (numChannels * numBins);
+    mins.malloc (numBins);
+    maxs.malloc (numBins);
+
+    startThread (2);
+}
+
+
+void RecordOverview::clear()
+{
+    stopThread (1000);
+
+    binsReady.set (0);
+    numBins = 0;
+    source  = nullptr;
+}
+
+
+int RecordOverview::getNumBins() const
+{
+    return numBins;
+}
+
+
+int RecordOverview::getNumBinsReady() const
+{
+    return binsReady.get();
+}
+
+
+float RecordOverview::getMin (int bin) const
+{
+    return (bin >= 0 && bin < binsReady.get()) ? mins[bin] : 0.0f;
+}
+
+
+float RecordOverview::getMax (int bin) const
+{
+    return (bin >= 0 && bin < binsReady.get()) ? maxs[bin] : 0.0f;
+}
+
+
+float RecordOverview::getChannelMin (int channel, int bin) const
+{
+    if (channel < 0 || channel >= numChannels || bin < 0 || bin >= binsReady.get())
+        return 0.0f;
+
+    return channelMins[channel * numBins + bin];
+}
+
+
+float RecordOverview::getChannelMax (int channel, int bin) const
+{
+    if (channel < 0 || channel >= numChannels || bin < 0 || bin >= binsReady.get())
+        return 0.0f;
+
+    return channelMaxs[channel * numBins + bin];
+}
+
+
+void RecordOverview::run()
+{
+    const int record = source->getActiveRecord();
+    HeapBlock<float> binMins (numChannels);
+    HeapBlock<float> binMaxs (numChannels);
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        if (threadShouldExit())
+            return;
+
+        const int64 binStart = numSamples * bin / numBins;
+        const int64 binEnd = numSamples * (bin + 1) / numBins;
+
+        source->getRecordMinMax (record, binStart, binEnd - binStart, binMins, binMaxs);
+
+        float lo = std::numeric_limits<float>::max();
+        float hi = -std::numeric_limits<float>::max();
+
+        for (int c = 0; c < numChannels; ++c)
+        {
+            // bitVolts can be negative, so order the scaled values again
+            const float a = jmin (binMins[c], binMaxs[c]);
+            const float b = jmax (binMins[c], binMaxs[c]);
+
+            channelMins[c * numBins + bin] = a;
+            channelMaxs[c * numBins + bin] = b;
+
+            lo = jmin (lo, a);
+            hi = jmax (hi, b);
+        }
+
+        mins[bin] = lo;
+        maxs[bin] = hi;
+
+        binsReady.set (bin + 1);
+    }
+}
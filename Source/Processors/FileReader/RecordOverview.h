@@ -0,0 +1,86 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2016 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef RECORDOVERVIEW_H_INCLUDED
+#define RECORDOVERVIEW_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+class FileSource;
+
+/**
+  Decimated min/max envelope of the active record of a FileSource.
+
+  The whole record is split into a fixed number of bins, whose ranges the
+  source computes one after another on a background thread, so the
+  FileReaderEditor can draw a minimap of the file and map a click on it back
+  to a playback position. Bins become readable as soon as they are computed.
+
+  @see FileReader, FileReaderEditor
+*/
+class RecordOverview : private Thread
+{
+public:
+    RecordOverview();
+    ~RecordOverview();
+
+    /** Starts scanning the active record of a source, replacing any previous overview */
+    void build (FileSource* source, int numBins);
+
+    /** Stops the scan and discards the overview */
+    void clear();
+
+    int getNumBins() const;
+
+    /** Returns the number of bins computed so far */
+    int getNumBinsReady() const;
+
+    /** Returns the range of all channels within a bin, in their units */
+    float getMin (int bin) const;
+    float getMax (int bin) const;
+
+    /** Returns the range of one channel within a bin, in its units */
+    float getChannelMin (int channel, int bin) const;
+    float getChannelMax (int channel, int bin) const;
+
+private:
+    void run() override;
+
+    FileSource* source;
+    int numBins;
+    int numChannels;
+    int64 numSamples;
+
+    HeapBlock<float> channelMins;   // numChannels x numBins
+    HeapBlock<float> channelMaxs;
+    HeapBlock<float> mins;
+    HeapBlock<float> maxs;
+
+    Atomic<int> binsReady;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RecordOverview);
+};
+
+
+#endif  // RECORDOVERVIEW_H_INCLUDED
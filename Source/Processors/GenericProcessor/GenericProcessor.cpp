@@ -23,6 +23,7 @@
 #include "GenericProcessor.h"
 #include "../../UI/UIComponent.h"
 #include "../../AccessClass.h"
+#include "../ProcessorGraph/ProcessorGraph.h"
 
 #include <exception>
 
@@ -43,6 +44,7 @@ GenericProcessor::GenericProcessor(const String& name)
 	, sendSampleCount(true)
 	, m_processorType(PROCESSOR_TYPE_UTILITY)
 	, m_name(name)
+	, m_nameId(InfoStringTable::intern(name))
 	, m_isParamsWereLoaded(false)
 {
 	settings.numInputs = settings.numOutputs = 0;
@@ -329,7 +331,7 @@ void GenericProcessor::update()
 				ch->setMonitored(m_monitorStatus[i]);
 			}
 
-			ch->addToHistoricString(getName());
+			ch->addToHistory(m_nameId);
 			dataChannelArray.add(ch);
 		}
 
@@ -400,7 +402,8 @@ void GenericProcessor::update()
 		44100.0,         // sampleRate
 		128);            // blockSize
 
-	editor->update(); // allow the editor to update its settings
+	if (editor != 0)
+		editor->update(); // allow the editor to update its settings
 }
 
 void GenericProcessor::updateChannelIndexes(bool updateNodeID)
@@ -419,8 +422,8 @@ void GenericProcessor::updateChannelIndexes(bool updateNodeID)
 		{
 			channel->m_nodeID = nodeId;
 			channel->m_nodeIdx = i;
-			channel->m_currentNodeName = getName();
-			channel->m_currentNodeType = getName(); //Fix when the ability to name individual processors is implemented
+			channel->m_currentNodeNameId = m_nameId;
+			channel->m_currentNodeTypeId = m_nameId; //Fix when the ability to name individual processors is implemented
 		}
 		uint32 sourceID = getProcessorFullId(channel->getSourceNodeID(), channel->getSubProcessorIdx());
 		dataChannelMap[sourceID][channel->getSourceIndex()] = i;
@@ -433,8 +436,8 @@ void GenericProcessor::updateChannelIndexes(bool updateNodeID)
 		{
 			channel->m_nodeID = nodeId;
 			channel->m_nodeIdx = i;
-			channel->m_currentNodeName = getName();
-			channel->m_currentNodeType = getName(); //Fix when the ability to name individual processors is implemented
+			channel->m_currentNodeNameId = m_nameId;
+			channel->m_currentNodeTypeId = m_nameId; //Fix when the ability to name individual processors is implemented
 		}
 		uint32 sourceID = getProcessorFullId(channel->getSourceNodeID(), channel->getSubProcessorIdx());
 		eventChannelMap[sourceID][channel->getSourceIndex()] = i;
@@ -447,8 +450,8 @@ void GenericProcessor::updateChannelIndexes(bool updateNodeID)
 		{
 			channel->m_nodeID = nodeId;
 			channel->m_nodeIdx = i;
-			channel->m_currentNodeName = getName();
-			channel->m_currentNodeType = getName(); //Fix when the ability to name individual processors is implemented
+			channel->m_currentNodeNameId = m_nameId;
+			channel->m_currentNodeTypeId = m_nameId; //Fix when the ability to name individual processors is implemented
 		}
 		uint32 sourceID = getProcessorFullId(channel->getSourceNodeID(), channel->getSubProcessorIdx());
 		spikeChannelMap[sourceID][channel->getSourceIndex()] = i;
@@ -472,7 +475,7 @@ void GenericProcessor::createDataChannelsByType(DataChannel::DataChannelTypes ty
 		{
 			DataChannel* chan = new DataChannel(type, getSampleRate(sub), this, sub);
 			chan->setBitVolts(getBitVolts(sub));
-			chan->addToHistoricString(getName());
+			chan->addToHistory(m_nameId);
 			chan->m_nodeID = nodeId;
 			dataChannelArray.add(chan);
 		}
@@ -793,7 +796,7 @@ int GenericProcessor::checkForEvents(bool checkForSpikes)
 			{
 				int spikeIndex = getSpikeChannelIndex(index, sourceId, subProc);
 				if (spikeIndex >= 0)
-					handleSpike(spikeChannelArray[index], message, samplePosition);
+					handleSpike(spikeChannelArray[spikeIndex], message, samplePosition);
 			}
 		}
 		//Restore the original buffer pointer and, if some new event has been added here, copy it to the original buffer
@@ -1123,6 +1126,20 @@ void GenericProcessor::setProcessorType(PluginProcessorType processorType)
 	m_processorType = processorType;
 }
 
+void GenericProcessor::requestScratchBuffer(AudioSampleBuffer& buffer, int numChannels, int numSamples, bool persistent)
+{
+	ProcessorGraph* graph = AccessClass::getProcessorGraph();
+
+	if (graph == nullptr)
+	{
+		buffer.setSize(numChannels, numSamples);
+		return;
+	}
+
+	graph->getScratchArena().request(this, buffer, numChannels, numSamples,
+		persistent ? ScratchArena::PERSISTENT : ScratchArena::TRANSIENT);
+}
+
 
 //<DEPRECATED>
 // ==================================================================
@@ -1135,6 +1152,8 @@ void GenericProcessor::getEventChannelNames(StringArray& Names) { }
 const String GenericProcessor::getProgramName(int index)   { return ""; }
 const String GenericProcessor::getName() const              { return m_name; }
 
+uint32 GenericProcessor::getNameId() const                  { return m_nameId; }
+
 int GenericProcessor::getCurrentChannel() const { return currentChannel; }
 
 PluginProcessorType GenericProcessor::getProcessorType() const { return m_processorType; }
@@ -108,6 +108,9 @@ public:
     /** Returns the name of the processor. */
     const String getName() const override;
 
+    /** Returns the id of the name of the processor in the InfoStringTable. */
+    uint32 getNameId() const;
+
     /** Called by JUCE as soon as a processor is created, as well as before the start of audio callbacks.
         To avoid starting data acquisition prematurely, use the enable() function instead. */
     virtual void prepareToPlay (double sampleRate, int estimatedSamplesPerBlock) override;
@@ -572,6 +575,12 @@ protected:
     /** Sets whether processor will have behaviour like Source, Sink, Splitter, Utility or Merge */
     void setProcessorType (PluginProcessorType processorType);
 
+	/** Gets scratch memory from the ScratchArena of the processor graph instead of allocating it.
+	Must be called from enable(); the buffer refers to the shared memory once all processors have
+	been enabled. Set persistent to true if the content has to survive from one process() call
+	to the next, otherwise the memory is shared with the scratch buffers of other processors. */
+	void requestScratchBuffer(AudioSampleBuffer& buffer, int numChannels, int numSamples, bool persistent = false);
+
 	OwnedArray<DataChannel> dataChannelArray;
 	OwnedArray<EventChannel> eventChannelArray;
 	OwnedArray<SpikeChannel> spikeChannelArray;
@@ -626,6 +635,7 @@ private:
 
     /** The name of the processor.*/
     const String m_name;
+    const uint32 m_nameId;
 
     /** Saves the record status of individual channels, even when other parameters are updated. */
     Array<bool> m_recordStatus;
@@ -645,6 +645,8 @@ bool ProcessorGraph::enableProcessors()
         }
     }
 
+    scratchArena.beginRequests();
+
     for (int i = 0; i < getNumNodes(); i++)
     {
 
@@ -658,6 +660,10 @@ bool ProcessorGraph::enableProcessors()
         }
     }
 
+    // processors ask for their scratch memory in enable(), it can be laid out now
+    scratchArena.allocate();
+    DBG (scratchArena.getReport());
+
     AccessClass::getEditorViewport()->signalChainCanBeEdited(false);
 
 	//Update special channels indexes, at the end
@@ -706,6 +712,11 @@ bool ProcessorGraph::disableProcessors()
     return true;
 }
 
+ScratchArena& ProcessorGraph::getScratchArena()
+{
+    return scratchArena;
+}
+
 void ProcessorGraph::setRecordState(bool isRecording)
 {
 
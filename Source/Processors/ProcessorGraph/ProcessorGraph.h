@@ -27,6 +27,7 @@
 #include "../../../JuceLibraryCode/JuceHeader.h"
 
 #include "../../AccessClass.h"
+#include "ScratchArena.h"
 
 class GenericProcessor;
 class RecordNode;
@@ -101,6 +102,9 @@ public:
 
 	void setTimestampWindow(TimestampSourceSelectionWindow* window);
 
+    /** Returns the scratch memory shared by the processors during acquisition. */
+    ScratchArena& getScratchArena();
+
 private:
     int currentNodeId;
 
@@ -123,6 +127,8 @@ private:
 	int m_timestampSourceSubIdx;
 	Array<const GenericProcessor*> m_validTimestampSources;
 	WeakReference<TimestampSourceSelectionWindow> m_timestampWindow;
+
+    ScratchArena scratchArena;
 };
 
 
@@ -0,0 +1,176 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ScratchArena.h"
+#include "../GenericProcessor/GenericProcessor.h"
+
+// 64 bytes, the cache line size and the widest SIMD register
+#define SCRATCH_ALIGNMENT_FLOATS 16
+
+ScratchArena::ScratchArena()
+    : allocatedFloats(0),
+      usedFloats(0),
+      requestedFloats(0)
+{
+}
+
+ScratchArena::~ScratchArena()
+{
+}
+
+size_t ScratchArena::getChannelStride(int numSamples)
+{
+    return ((size_t) numSamples + SCRATCH_ALIGNMENT_FLOATS - 1) & ~((size_t) SCRATCH_ALIGNMENT_FLOATS - 1);
+}
+
+void ScratchArena::beginRequests()
+{
+    requests.clearQuick();
+}
+
+void ScratchArena::request(GenericProcessor* owner, AudioSampleBuffer& buffer, int numChannels, int numSamples, Lifetime lifetime)
+{
+    Request r;
+    r.ownerName = owner->getName();
+    r.ownerId = owner->getNodeId();
+    r.buffer = &buffer;
+    r.numChannels = jmax(1, numChannels);
+    r.numSamples = jmax(1, numSamples);
+    r.lifetime = lifetime;
+    r.offset = 0;
+
+    requests.add(r);
+}
+
+void ScratchArena::allocate()
+{
+    // transient buffers of a processor are stacked, and every processor starts again from 0
+    size_t transientFloats = 0;
+    requestedFloats = 0;
+
+    for (int i = 0; i < requests.size(); i++)
+    {
+        Request& r = requests.getReference(i);
+        const size_t size = getChannelStride(r.numSamples) * r.numChannels;
+        requestedFloats += size;
+
+        if (r.lifetime != TRANSIENT)
+            continue;
+
+        size_t ownerOffset = 0;
+        for (int j = 0; j < i; j++)
+        {
+            const Request& previous = requests.getReference(j);
+            if (previous.lifetime == TRANSIENT && previous.ownerId == r.ownerId)
+                ownerOffset += getChannelStride(previous.numSamples) * previous.numChannels;
+        }
+
+        r.offset = ownerOffset;
+        transientFloats = jmax(transientFloats, ownerOffset + size);
+    }
+
+    // persistent buffers follow, each with memory of its own
+    usedFloats = transientFloats;
+
+    for (int i = 0; i < requests.size(); i++)
+    {
+        Request& r = requests.getReference(i);
+
+        if (r.lifetime == PERSISTENT)
+        {
+            r.offset = usedFloats;
+            usedFloats += getChannelStride(r.numSamples) * r.numChannels;
+        }
+    }
+
+    if (usedFloats + SCRATCH_ALIGNMENT_FLOATS > allocatedFloats)
+    {
+        allocatedFloats = usedFloats + SCRATCH_ALIGNMENT_FLOATS;
+        memory.allocate(allocatedFloats, false);
+    }
+
+    const size_t misalignment = ((size_t) memory.getData() / sizeof(float)) % SCRATCH_ALIGNMENT_FLOATS;
+    float* base = memory.getData() + (misalignment == 0 ? 0 : SCRATCH_ALIGNMENT_FLOATS - misalignment);
+
+    FloatVectorOperations::clear(base, (int) usedFloats);
+
+    int maxChannels = 0;
+    for (int i = 0; i < requests.size(); i++)
+        maxChannels = jmax(maxChannels, requests.getReference(i).numChannels);
+
+    HeapBlock<float*> channels((size_t) maxChannels);
+
+    for (int i = 0; i < requests.size(); i++)
+    {
+        const Request& r = requests.getReference(i);
+        const size_t stride = getChannelStride(r.numSamples);
+
+        for (int ch = 0; ch < r.numChannels; ch++)
+            channels[ch] = base + r.offset + stride * ch;
+
+        r.buffer->setDataToReferTo(channels, r.numChannels, r.numSamples);
+    }
+}
+
+String ScratchArena::getReport() const
+{
+    String report;
+    Array<int> listed;
+
+    for (int i = 0; i < requests.size(); i++)
+    {
+        const Request& r = requests.getReference(i);
+
+        if (listed.contains(r.ownerId))
+            continue;
+
+        listed.add(r.ownerId);
+
+        size_t transientBytes = 0;
+        size_t persistentBytes = 0;
+
+        for (int j = i; j < requests.size(); j++)
+        {
+            const Request& other = requests.getReference(j);
+
+            if (other.ownerId != r.ownerId)
+                continue;
+
+            const size_t bytes = getChannelStride(other.numSamples) * other.numChannels * sizeof(float);
+
+            if (other.lifetime == TRANSIENT)
+                transientBytes += bytes;
+            else
+                persistentBytes += bytes;
+        }
+
+        report << "  " << r.ownerName << " (" << r.ownerId << "): "
+               << File::descriptionOfSizeInBytes((int64) transientBytes) << " transient, "
+               << File::descriptionOfSizeInBytes((int64) persistentBytes) << " persistent" << newLine;
+    }
+
+    report << "Scratch arena: " << File::descriptionOfSizeInBytes((int64) (usedFloats * sizeof(float)))
+           << " for " << File::descriptionOfSizeInBytes((int64) (requestedFloats * sizeof(float))) << " requested";
+
+    return report;
+}
@@ -0,0 +1,107 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SCRATCHARENA_H_INCLUDED
+#define SCRATCHARENA_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+class GenericProcessor;
+
+/**
+
+  One block of scratch memory shared by all the processors of the graph.
+
+  Processors ask for their scratch buffers from enable(), through
+  GenericProcessor::requestScratchBuffer(). Once every processor has been
+  enabled, the ProcessorGraph lays out all the requests in a single
+  allocation and points each AudioSampleBuffer at its part of it.
+
+  A TRANSIENT buffer only lives for one process() call. The graph renders
+  its nodes one after the other on the audio thread, so the transient
+  buffers of different processors never hold data at the same time and all
+  start at the same address; only the buffers of one processor are kept
+  apart. A PERSISTENT buffer keeps its content from one block to the next
+  and gets memory of its own.
+
+  The content of a transient buffer is undefined at the start of every
+  process() call: it must be written before it is read, and must not be
+  resized, assigned to or relied on being clear from a previous block.
+
+  All methods must be called from the message thread, while acquisition
+  is stopped.
+
+  @see ProcessorGraph, GenericProcessor
+
+*/
+
+class ScratchArena
+{
+public:
+    ScratchArena();
+    ~ScratchArena();
+
+    enum Lifetime
+    {
+        TRANSIENT = 0,
+        PERSISTENT
+    };
+
+    /** Forgets the requests of the previous acquisition. */
+    void beginRequests();
+
+    /** Records a request. The buffer refers to arena memory once allocate() has been called. */
+    void request(GenericProcessor* owner, AudioSampleBuffer& buffer, int numChannels, int numSamples, Lifetime lifetime);
+
+    /** Lays out all the requests, allocates the memory and points the buffers at it. */
+    void allocate();
+
+    /** Returns the memory used by each processor and by the arena as a whole. */
+    String getReport() const;
+
+private:
+    struct Request
+    {
+        String ownerName;
+        int ownerId;
+        AudioSampleBuffer* buffer;
+        int numChannels;
+        int numSamples;
+        Lifetime lifetime;
+        size_t offset;
+    };
+
+    /** Floats per channel, rounded up so every channel starts on a cache line */
+    static size_t getChannelStride(int numSamples);
+
+    Array<Request> requests;
+
+    HeapBlock<float> memory;
+    size_t allocatedFloats;
+    size_t usedFloats;
+    size_t requestedFloats;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScratchArena);
+};
+
+#endif  // SCRATCHARENA_H_INCLUDED
@@ -159,15 +159,8 @@ void BinaryRecording::openFiles(File rootFolder, int experimentNumber, int recor
         jsonFile->setProperty("channels", jsonChannels.getReference(i));
     }
 
-    int nChans = getNumRecordedChannels();
-    //Timestamps
-    Array<uint32> procIDs;
-    for (int i = 0; i < nChans; i++)
-    {
-        if (i == 0)
-            std::cout << "Start timestamp: " << getTimestamp(i) << std::endl;
-        m_startTS.add(getTimestamp(i));
-    }
+    //Timestamps: the first write of each channel sets its start
+    m_startTS.insertMultiple(0, -1, getNumRecordedChannels());
 
     int nEvents = getNumRecordedEvents();
     String eventPath(basepath + "events" + File::separatorString);
@@ -472,8 +465,7 @@ void BinaryRecording::resetChannels()
     m_startTS.clear();
 }
 
-void BinaryRecording::writeData(int writeChannel, int realChannel, const float* buffer,
-                                int size)
+void BinaryRecording::checkBufferSize(int size)
 {
     if (size > m_bufferSize)
     // shouldn't happen, and if it does it'll be slow, but better this than crashing
@@ -484,15 +476,47 @@ void BinaryRecording::writeData(int writeChannel, int realChannel, const float*
         m_intBuffer.malloc(size);
         m_tsBuffer.malloc(size);
     }
+}
+
+void BinaryRecording::writeData(int writeChannel, int realChannel, const float* buffer,
+                                int size)
+{
+    checkBufferSize(size);
     double multFactor = 1 / (float(0x7fff) * getDataChannel(realChannel)->getBitVolts());
     FloatVectorOperations::copyWithMultiply(m_scaledBuffer.getData(), buffer, multFactor,
                                             size);
     AudioDataConverters::convertFloatToInt16LE(m_scaledBuffer.getData(), m_intBuffer.getData(),
                                                size);
+    writeRawData(writeChannel, realChannel, m_intBuffer.getData(), size);
+}
+
+bool BinaryRecording::opensFilesBeforeData() const
+{
+    // the start of each channel is taken from its first write instead
+    return true;
+}
+
+bool BinaryRecording::writesRawSamples() const
+{
+    return true;
+}
+
+void BinaryRecording::writeRawData(int writeChannel, int realChannel, const int16* buffer,
+                                   int size)
+{
+    // the files hold little endian words, which is what the record queue holds too
+    checkBufferSize(size);
+    if (m_startTS[writeChannel] < 0)
+    {
+        if (writeChannel == 0)
+            std::cout << "Start timestamp: " << getTimestamp(writeChannel) << std::endl;
+        m_startTS.set(writeChannel, getTimestamp(writeChannel));
+    }
+
     int fileIndex = m_fileIndexes[writeChannel];
     m_DataFiles[fileIndex]->writeChannel(getTimestamp(writeChannel) - m_startTS[writeChannel],
                                          m_channelIndexes[writeChannel],
-                                         m_intBuffer.getData(), size);
+                                         buffer, size);
 
     if (m_channelIndexes[writeChannel] == 0)
     {
@@ -40,6 +40,9 @@ namespace BinaryRecordingEngine
         void openFiles(File rootFolder, int experimentNumber, int recordingNumber) override;
         void closeFiles() override;
         void writeData(int writeChannel, int realChannel, const float* buffer, int size) override;
+        bool opensFilesBeforeData() const override;
+        bool writesRawSamples() const override;
+        void writeRawData(int writeChannel, int realChannel, const int16* buffer, int size) override;
         void writeEvent(int eventIndex, const MidiMessage& event) override;
         void resetChannels() override;
         void addSpikeElectrode(int index, const SpikeChannel* elec) override;
@@ -50,6 +53,7 @@ namespace BinaryRecordingEngine
         static RecordEngineManager* getEngineManager();
 
     private:
+        void checkBufferSize(int size);
 
         class EventRecording
         {
@@ -67,7 +67,7 @@ bool SequentialBlockFile::openFile(String filename)
     return true;
 }
 
-bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, int16* data, int nSamples)
+bool SequentialBlockFile::writeChannel(uint64 startPos, int channel, const int16* data, int nSamples)
 {
     if (!m_file)
         return false;
@@ -38,7 +38,7 @@ namespace BinaryRecordingEngine
         ~SequentialBlockFile();
 
         bool openFile(String filename);
-        bool writeChannel(uint64 startPos, int channel, int16* data, int nSamples);
+        bool writeChannel(uint64 startPos, int channel, const int16* data, int nSamples);
 
     private:
         ScopedPointer<FileOutputStream> m_file;
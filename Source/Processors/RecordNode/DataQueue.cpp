@@ -35,7 +35,7 @@ m_maxSize(blockSize*nBlocks)
 DataQueue::~DataQueue()
 {}
 
-void DataQueue::setChannels(int nChans)
+void DataQueue::setChannels(int nChans, const Array<float>& bitVolts)
 {
 	if (m_readInProgress)
 		return;
@@ -54,7 +54,24 @@ void DataQueue::setChannels(int nChans)
 		m_timestamps.getLast()->resize(m_numBlocks);
 		m_lastReadTimestamps.add(0);
 	}
-	m_buffer.setSize(nChans, m_maxSize);
+
+	m_rawScale.clear();
+	if (bitVolts.size() == nChans && nChans > 0)
+	{
+		for (int i = 0; i < nChans; ++i)
+			m_rawScale.add(1.0f / bitVolts[i]);
+	}
+
+	if (hasRawSamples())
+	{
+		m_buffer.setSize(0, 0);
+		m_rawBuffer.malloc((size_t) nChans * m_maxSize);
+	}
+	else
+	{
+		m_buffer.setSize(nChans, m_maxSize);
+		m_rawBuffer.free();
+	}
 }
 
 void DataQueue::resize(int nBlocks)
@@ -74,7 +91,11 @@ void DataQueue::resize(int nBlocks)
 		m_timestamps[i]->resize(nBlocks);
 		m_lastReadTimestamps.set(i, 0);
 	}
-	m_buffer.setSize(m_numChans, size);
+
+	if (hasRawSamples())
+		m_rawBuffer.malloc((size_t) m_numChans * size);
+	else
+		m_buffer.setSize(m_numChans, size);
 }
 
 void DataQueue::fillTimestamps(int channel, int index, int size, int64 timestamp)
@@ -117,29 +138,35 @@ void DataQueue::writeChannel(const AudioSampleBuffer& buffer, int channel, int s
 	{ //TODO: turn this into a proper notification. Probably returning a bool.
 		std::cerr << "Recording Data Queue Overflow" << std::endl;
 	}
-	m_buffer.copyFrom(channel,
-		index1,
-		buffer,
-		sourceChannel,
-		0,
-		size1);
+	copySamples(channel, index1, buffer.getReadPointer(sourceChannel, 0), size1);
 	
 	fillTimestamps(channel, index1, size1, timestamp);
 	
 	if (size2 > 0)
 	{
-		m_buffer.copyFrom(channel,
-			index2,
-			buffer,
-			sourceChannel,
-			size1,
-			size2);
+		copySamples(channel, index2, buffer.getReadPointer(sourceChannel, size1), size2);
 
 		fillTimestamps(channel, index2, size2, timestamp + size1);
 	}
 	m_fifos[channel]->finishedWrite(size1 + size2);
 }
 
+void DataQueue::copySamples(int channel, int index, const float* source, int size)
+{
+	if (!hasRawSamples())
+	{
+		m_buffer.copyFrom(channel, index, source, size);
+		return;
+	}
+
+	//Same scaling and rounding as the engines used to apply when writing
+	const float scale = m_rawScale.getUnchecked(channel);
+	int16* dest = m_rawBuffer + (size_t) channel * m_maxSize + index;
+
+	for (int i = 0; i < size; ++i)
+		dest[i] = (int16) roundToInt(jlimit(-32767.0f, 32767.0f, source[i] * scale));
+}
+
 /* 
 We could copy the internal circular buffer to an external one, as DataBuffer does. This class
 is, however, intended for disk writing, which is one of the most CPU-critical systems. Just
@@ -152,6 +179,16 @@ const AudioSampleBuffer& DataQueue::getAudioBufferReference() const
 	return m_buffer;
 }
 
+bool DataQueue::hasRawSamples() const
+{
+	return m_rawScale.size() > 0;
+}
+
+const int16* DataQueue::getRawReadPointer(int channel, int index) const
+{
+	return m_rawBuffer + (size_t) channel * m_maxSize + index;
+}
+
 bool DataQueue::startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax)
 {
 	//This should never happen, but it never hurts to be on the safe side.
@@ -39,7 +39,9 @@ class DataQueue
 public:
 	DataQueue(int blockSize, int nBlocks);
 	~DataQueue();
-	void setChannels(int nChans);
+	/** Sets the number of channels. If bitVolts holds a value for every channel, samples are
+	stored as int16 words of that value, the way they are written to disk, instead of floats */
+	void setChannels(int nChans, const Array<float>& bitVolts = Array<float>());
 	void resize(int nBlocks);
 	void getTimestampsForBlock(int idx, Array<int64>& timestamps) const;
 
@@ -48,14 +50,19 @@ public:
 	void writeChannel(const AudioSampleBuffer& buffer, int channel, int sourceChannel, int nSamples, int64 timestamp);
 	bool startRead(Array<CircularBufferIndexes>& indexes, Array<int64>& timestamps, int nMax);
 	const AudioSampleBuffer& getAudioBufferReference() const;
+	bool hasRawSamples() const;
+	const int16* getRawReadPointer(int channel, int index) const;
 	void stopRead();
 	
 
 private:
 	void fillTimestamps(int channel, int index, int size, int64 timestamp);
+	void copySamples(int channel, int index, const float* source, int size);
 
 	OwnedArray<AbstractFifo> m_fifos;
 	AudioSampleBuffer m_buffer;
+	HeapBlock<int16> m_rawBuffer;
+	Array<float> m_rawScale;
 	Array<int> m_readSamples;
 	OwnedArray<Array<int64>> m_timestamps;
 	Array<int64> m_lastReadTimestamps;
@@ -0,0 +1,172 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "DiskSpaceForecaster.h"
+
+/** Weight of the newest measurement in the smoothed write rate */
+#define DISK_RATE_SMOOTHING 0.2
+
+/** Largest amount of space kept free on a volume, for the files to be closed */
+#define DISK_MAX_RESERVE_BYTES (256 * 1024 * 1024)
+
+DiskSpaceForecaster::Forecast::Forecast() :
+bytesFree(0),
+totalBytes(0),
+bytesPerSecond(0),
+secondsToFull(-1)
+{
+}
+
+int64 DiskSpaceForecaster::VolumeInfo::getBytesFree(const File& directory) const
+{
+	return directory.getBytesFreeOnVolume();
+}
+
+int64 DiskSpaceForecaster::VolumeInfo::getTotalBytes(const File& directory) const
+{
+	return directory.getVolumeTotalSize();
+}
+
+DiskSpaceForecaster::DiskSpaceForecaster(const VolumeInfo* volumes_) :
+volumes(volumes_ != nullptr ? volumes_ : &fileSystem),
+lastBytesFree(-1),
+lastBytesWritten(-1),
+bytesPerSecond(0),
+warningLevel(0),
+rolloverRequested(false)
+{
+}
+
+const DiskSpaceForecaster::Forecast& DiskSpaceForecaster::getForecast() const
+{
+	return forecast;
+}
+
+const DiskSpaceForecaster::Forecast& DiskSpaceForecaster::getRolloverForecast() const
+{
+	return rolloverForecast;
+}
+
+String DiskSpaceForecaster::describe(const Forecast& forecast)
+{
+	if (forecast.totalBytes <= 0)
+		return "Disk space unknown";
+
+	String text = File::descriptionOfSizeInBytes(forecast.bytesFree) + " free of "
+		+ File::descriptionOfSizeInBytes(forecast.totalBytes);
+
+	if (forecast.bytesPerSecond > 0)
+		text << ", writing " << File::descriptionOfSizeInBytes((int64) forecast.bytesPerSecond) << "/s";
+
+	if (forecast.secondsToFull >= 0)
+		text << ", full in " << RelativeTime::seconds(forecast.secondsToFull).getDescription();
+
+	return text;
+}
+
+DiskSpaceForecaster::Forecast DiskSpaceForecaster::measure(const File& directory) const
+{
+	Forecast result;
+	result.directory = directory;
+
+	if (directory == File())
+		return result;
+
+	result.bytesFree = volumes->getBytesFree(directory);
+	result.totalBytes = volumes->getTotalBytes(directory);
+	result.bytesPerSecond = bytesPerSecond;
+
+	if (bytesPerSecond >= 1.0 && result.totalBytes > 0)
+	{
+		const int64 reserve = jmin((int64) DISK_MAX_RESERVE_BYTES, result.totalBytes / 100);
+		result.secondsToFull = jmax((int64) 0, result.bytesFree - reserve) / bytesPerSecond;
+	}
+
+	return result;
+}
+
+DiskSpaceForecaster::Action DiskSpaceForecaster::update(double elapsedSeconds, int64 bytesWritten, bool isRecording,
+	const File& directory, const File& rolloverDirectory)
+{
+	const double elapsed = jmax(0.001, elapsedSeconds);
+
+	// the first measurement only sets the baseline
+	const double engineRate = lastBytesWritten >= 0 ? (bytesWritten - lastBytesWritten) / elapsed : 0;
+	lastBytesWritten = bytesWritten;
+
+	const int64 bytesFree = directory == File() ? 0 : volumes->getBytesFree(directory);
+	double volumeRate = 0;
+	if (directory == lastDirectory && lastBytesFree >= 0)
+		volumeRate = (lastBytesFree - bytesFree) / elapsed;
+
+	if (directory != lastDirectory)
+	{
+		// a new directory gets its own warnings, and may roll over again
+		warningLevel = 0;
+		rolloverRequested = false;
+	}
+
+	lastDirectory = directory;
+	lastBytesFree = bytesFree;
+
+	if (isRecording)
+	{
+		bytesPerSecond += DISK_RATE_SMOOTHING * (jmax(engineRate, volumeRate) - bytesPerSecond);
+	}
+	else
+	{
+		bytesPerSecond = 0;
+		rolloverRequested = false;
+	}
+
+	forecast = measure(directory);
+	rolloverForecast = measure(rolloverDirectory);
+
+	if (forecast.secondsToFull < 0)
+	{
+		warningLevel = 0;
+		return NO_ACTION;
+	}
+
+	if (forecast.secondsToFull < DISK_ROLLOVER_SECONDS)
+	{
+		if (!rolloverRequested && rolloverForecast.secondsToFull > forecast.secondsToFull)
+		{
+			rolloverRequested = true;
+			return ROLLOVER;
+		}
+		else if (!rolloverRequested && warningLevel < 2)
+		{
+			warningLevel = 2;
+			return WARN_DISK_FULL;
+		}
+	}
+	else if (forecast.secondsToFull < DISK_WARNING_SECONDS && warningLevel < 1)
+	{
+		warningLevel = 1;
+		return WARN_SPACE_LOW;
+	}
+
+	return NO_ACTION;
+}
@@ -0,0 +1,116 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DISKSPACEFORECASTER_H_INCLUDED
+#define DISKSPACEFORECASTER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+/**
+
+  The arithmetic of the DiskSpaceMonitor: smooths the write rate, forecasts the time
+  left on the data and rollover volumes, and decides when to warn and when to roll over.
+
+  It has no thread and sends no messages. The monitor feeds it one measurement per
+  interval; the checks feed it made-up volumes through a VolumeInfo of their own.
+
+  @see DiskSpaceMonitor
+
+*/
+
+#define DISK_WARNING_SECONDS 600
+#define DISK_ROLLOVER_SECONDS 60
+
+class DiskSpaceForecaster
+{
+public:
+	struct Forecast
+	{
+		Forecast();
+
+		File directory;
+		int64 bytesFree;
+		int64 totalBytes;
+		/** Smoothed write rate while recording, 0 otherwise */
+		double bytesPerSecond;
+		/** Seconds until only the reserve is left, or -1 if the volume is not filling up */
+		double secondsToFull;
+	};
+
+	/** Sizes of the volume that holds a directory. The default reads the file system. */
+	class VolumeInfo
+	{
+	public:
+		virtual ~VolumeInfo() {}
+		virtual int64 getBytesFree(const File& directory) const;
+		virtual int64 getTotalBytes(const File& directory) const;
+	};
+
+	/** What the monitor should do after a measurement */
+	enum Action
+	{
+		NO_ACTION = 0,
+		/** Less than DISK_WARNING_SECONDS left */
+		WARN_SPACE_LOW,
+		/** Less than DISK_ROLLOVER_SECONDS left, and the rollover directory cannot take over */
+		WARN_DISK_FULL,
+		/** Less than DISK_ROLLOVER_SECONDS left, continue in the rollover directory */
+		ROLLOVER
+	};
+
+	/** Uses the file system if volumes is null, otherwise does not take ownership */
+	DiskSpaceForecaster(const VolumeInfo* volumes = nullptr);
+
+	/** Takes a measurement, elapsedSeconds after the previous one. Each action is
+	returned once, until the recording stops or the directory changes. */
+	Action update(double elapsedSeconds, int64 bytesWritten, bool isRecording,
+		const File& directory, const File& rolloverDirectory);
+
+	const Forecast& getForecast() const;
+	const Forecast& getRolloverForecast() const;
+
+	/** Describes a forecast in a line, e.g. for a tooltip */
+	static String describe(const Forecast& forecast);
+
+private:
+	Forecast measure(const File& directory) const;
+
+	VolumeInfo fileSystem;
+	const VolumeInfo* volumes;
+
+	Forecast forecast;
+	Forecast rolloverForecast;
+
+	File lastDirectory;
+	int64 lastBytesFree;
+	int64 lastBytesWritten;
+	double bytesPerSecond;
+
+	int warningLevel;
+	bool rolloverRequested;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DiskSpaceForecaster);
+};
+
+#endif  // DISKSPACEFORECASTER_H_INCLUDED
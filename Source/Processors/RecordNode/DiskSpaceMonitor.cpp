@@ -0,0 +1,140 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#include "DiskSpaceMonitor.h"
+#include "RecordNode.h"
+
+DiskSpaceMonitor::DiskSpaceMonitor(const RecordNode* node) :
+Thread("Disk Space Monitor"),
+recordNode(node),
+rolloverNeeded(false)
+{
+}
+
+DiskSpaceMonitor::~DiskSpaceMonitor()
+{
+	stopThread(2 * DISK_MONITOR_INTERVAL_MS);
+}
+
+void DiskSpaceMonitor::setDataDirectory(const File& directory)
+{
+	const ScopedLock sl(lock);
+	dataDirectory = directory;
+}
+
+void DiskSpaceMonitor::setRolloverDirectory(const File& directory)
+{
+	const ScopedLock sl(lock);
+	rolloverDirectory = directory;
+}
+
+File DiskSpaceMonitor::getRolloverDirectory() const
+{
+	const ScopedLock sl(lock);
+	return rolloverDirectory;
+}
+
+DiskSpaceMonitor::Forecast DiskSpaceMonitor::getForecast() const
+{
+	const ScopedLock sl(lock);
+	return lastForecast;
+}
+
+DiskSpaceMonitor::Forecast DiskSpaceMonitor::getRolloverForecast() const
+{
+	const ScopedLock sl(lock);
+	return lastRolloverForecast;
+}
+
+bool DiskSpaceMonitor::checkRolloverNeeded()
+{
+	return rolloverNeeded.exchange(false);
+}
+
+void DiskSpaceMonitor::filenameComponentChanged(FilenameComponent* fnc)
+{
+	setDataDirectory(fnc->getCurrentFile());
+}
+
+String DiskSpaceMonitor::describe(const Forecast& forecast)
+{
+	return DiskSpaceForecaster::describe(forecast);
+}
+
+void DiskSpaceMonitor::handleAction(DiskSpaceForecaster::Action action, const Forecast& current, const Forecast& rollover)
+{
+	const String timeLeft = RelativeTime::seconds(current.secondsToFull).getDescription();
+
+	switch (action)
+	{
+		case DiskSpaceForecaster::ROLLOVER:
+			rolloverNeeded = true;
+			CoreServices::sendStatusMessage("Disk almost full, recording continues in " + rollover.directory.getFullPathName());
+			break;
+		case DiskSpaceForecaster::WARN_DISK_FULL:
+			CoreServices::sendStatusMessage("Disk almost full: " + timeLeft + " of recording left in " + current.directory.getFullPathName());
+			break;
+		case DiskSpaceForecaster::WARN_SPACE_LOW:
+			CoreServices::sendStatusMessage("Disk space low: " + timeLeft + " of recording left in " + current.directory.getFullPathName());
+			break;
+		default:
+			break;
+	}
+}
+
+void DiskSpaceMonitor::run()
+{
+	double lastTime = Time::getMillisecondCounterHiRes();
+
+	while (!threadShouldExit())
+	{
+		File directory;
+		File rolloverTarget;
+		{
+			const ScopedLock sl(lock);
+			directory = dataDirectory;
+			rolloverTarget = rolloverDirectory;
+		}
+
+		const double now = Time::getMillisecondCounterHiRes();
+		const double elapsed = (now - lastTime) / 1000.0;
+		lastTime = now;
+
+		const DiskSpaceForecaster::Action action = forecaster.update(elapsed, recordNode->getBytesWritten(),
+			recordNode->isRecording, directory, rolloverTarget);
+
+		const Forecast current = forecaster.getForecast();
+		const Forecast rollover = forecaster.getRolloverForecast();
+
+		{
+			const ScopedLock sl(lock);
+			lastForecast = current;
+			lastRolloverForecast = rollover;
+		}
+
+		handleAction(action, current, rollover);
+
+		wait(DISK_MONITOR_INTERVAL_MS);
+	}
+}
@@ -0,0 +1,113 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+
+#ifndef DISKSPACEMONITOR_H_INCLUDED
+#define DISKSPACEMONITOR_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+#include "DiskSpaceForecaster.h"
+#include <atomic>
+
+class RecordNode;
+
+/**
+
+  Forecasts when the data directory will fill up, on a thread of its own.
+
+  Once a second, the monitor reads the bytes handed to the record engines by the
+  RecordThread and the free space of the volumes that hold the data directory and
+  the rollover directory. While recording, the write rate is the larger of the
+  engine rate and the drop of free space on the volume, which also counts file
+  headers and other programs writing to the same disk. It is smoothed over a few
+  seconds, and the time left is the free space above a small reserve divided by it.
+  The DiskSpaceForecaster does the arithmetic; the monitor runs it and acts on it.
+
+  When less than DISK_WARNING_SECONDS are left a status message is sent. When less
+  than DISK_ROLLOVER_SECONDS are left and the rollover directory has more room,
+  checkRolloverNeeded() tells the ControlPanel to continue the recording there.
+
+  The volume queries never run on the message thread; the ControlPanel only reads
+  the last forecast.
+
+  @see ControlPanel, RecordNode, RecordThread, DiskSpaceForecaster
+
+*/
+
+#define DISK_MONITOR_INTERVAL_MS 1000
+
+class DiskSpaceMonitor : public Thread,
+	public FilenameComponentListener
+{
+public:
+	typedef DiskSpaceForecaster::Forecast Forecast;
+
+	DiskSpaceMonitor(const RecordNode* recordNode);
+	~DiskSpaceMonitor();
+
+	void setDataDirectory(const File& directory);
+
+	/** Sets where recording continues when the data directory is nearly full.
+	A default File turns the rollover off. */
+	void setRolloverDirectory(const File& directory);
+	File getRolloverDirectory() const;
+
+	/** Returns the last forecast for the data directory */
+	Forecast getForecast() const;
+
+	/** Returns the last forecast for the rollover directory, at the same write rate */
+	Forecast getRolloverForecast() const;
+
+	/** Returns true once when recording should move to the rollover directory.
+	Called from the message thread, which does the switch. */
+	bool checkRolloverNeeded();
+
+	/** Describes a forecast in a line, e.g. for a tooltip */
+	static String describe(const Forecast& forecast);
+
+	/** Follows the data directory chosen in the ControlPanel */
+	void filenameComponentChanged(FilenameComponent* fnc) override;
+
+	void run() override;
+
+private:
+	/** Sends the warnings and requests the rollover for a new forecast */
+	void handleAction(DiskSpaceForecaster::Action action, const Forecast& current, const Forecast& rollover);
+
+	const RecordNode* recordNode;
+
+	CriticalSection lock;
+	File dataDirectory;
+	File rolloverDirectory;
+	Forecast lastForecast;
+	Forecast lastRolloverForecast;
+
+	std::atomic<bool> rolloverNeeded;
+
+	// monitor thread only
+	DiskSpaceForecaster forecaster;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DiskSpaceMonitor);
+};
+
+#endif  // DISKSPACEMONITOR_H_INCLUDED
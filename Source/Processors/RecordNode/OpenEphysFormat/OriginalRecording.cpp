@@ -445,7 +445,8 @@ void OriginalRecording::writeTTLEvent(int eventIndex, const MidiMessage& event)
     diskWriteLock.exit();
 }
 
-void OriginalRecording::writeData(int writeChannel, int realChannel, const float* buffer, int size)
+template <typename SampleType>
+void OriginalRecording::writeBlocks(int writeChannel, const SampleType* buffer, int size)
 {
 	int samplesWritten = 0;
 
@@ -492,6 +493,27 @@ void OriginalRecording::writeData(int writeChannel, int realChannel, const float
 
 }
 
+void OriginalRecording::writeData(int writeChannel, int realChannel, const float* buffer, int size)
+{
+	writeBlocks(writeChannel, buffer, size);
+}
+
+bool OriginalRecording::opensFilesBeforeData() const
+{
+	// headers only describe the channels, every record carries its own timestamp
+	return true;
+}
+
+bool OriginalRecording::writesRawSamples() const
+{
+	return true;
+}
+
+void OriginalRecording::writeRawData(int writeChannel, int realChannel, const int16* buffer, int size)
+{
+	writeBlocks(writeChannel, buffer, size);
+}
+
 void OriginalRecording::writeContinuousBuffer(const float* data, int nSamples, int writeChannel)
 {
     // check to see if the file exists
@@ -507,6 +529,25 @@ void OriginalRecording::writeContinuousBuffer(const float* data, int nSamples, i
     }
     AudioDataConverters::convertFloatToInt16BE(continuousDataFloatBuffer, continuousDataIntegerBuffer, nSamples);
 
+    writeContinuousWords(nSamples, writeChannel);
+}
+
+void OriginalRecording::writeContinuousBuffer(const int16* data, int nSamples, int writeChannel)
+{
+	if (fileArray[writeChannel] == nullptr)
+        return;
+
+    // the words are already scaled, they only need to be big endian
+    for (int n = 0; n < nSamples; n++)
+    {
+        *(continuousDataIntegerBuffer+n) = (int16) ByteOrder::swapIfLittleEndian((uint16) *(data+n));
+    }
+
+    writeContinuousWords(nSamples, writeChannel);
+}
+
+void OriginalRecording::writeContinuousWords(int nSamples, int writeChannel)
+{
 	if (blockIndex[writeChannel] == 0)
     {
 		writeTimestampAndSampleCount(fileArray[writeChannel], writeChannel);
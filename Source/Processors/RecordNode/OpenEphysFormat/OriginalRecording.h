@@ -49,6 +49,9 @@ public:
     void openFiles(File rootFolder, int experimentNumber, int recordingNumber) override;
 	void closeFiles() override;
 	void writeData(int writeChannel, int realChannel, const float* buffer, int size) override;
+	bool opensFilesBeforeData() const override;
+	bool writesRawSamples() const override;
+	void writeRawData(int writeChannel, int realChannel, const int16* buffer, int size) override;
 	void writeEvent(int eventIndex, const MidiMessage& event) override;
 	void resetChannels() override;
 	void addSpikeElectrode(int index, const SpikeChannel* elec) override;
@@ -61,7 +64,12 @@ private:
     String getFileName(int channelIndex);
     void openFile(File rootFolder, const InfoObjectCommon* ch, int channelIndex);
     String generateHeader(const InfoObjectCommon* ch);
+    template <typename SampleType>
+    void writeBlocks(int writeChannel, const SampleType* buffer, int size);
     void writeContinuousBuffer(const float* data, int nSamples, int channel);
+    void writeContinuousBuffer(const int16* data, int nSamples, int channel);
+    /** Writes the first nSamples words of continuousDataIntegerBuffer */
+    void writeContinuousWords(int nSamples, int channel);
     void writeTimestampAndSampleCount(FILE* file, int channel);
     void writeRecordMarker(FILE* file);
 
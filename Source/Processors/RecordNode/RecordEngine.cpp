@@ -53,6 +53,16 @@ void RecordEngine::startChannelBlock (bool lastBlock) {}
 
 void RecordEngine::endChannelBlock (bool lastBlock) {}
 
+bool RecordEngine::writesRawSamples() const { return false; }
+
+bool RecordEngine::opensFilesBeforeData() const { return false; }
+
+void RecordEngine::writeRawData (int writeChannel, int realChannel, const int16* buffer, int size)
+{
+    // engines that return true from writesRawSamples() must override this
+    jassertfalse;
+}
+
 const DataChannel* RecordEngine::getDataChannel (int index) const
 {
     return AccessClass::getProcessorGraph()->getRecordNode()->getDataChannel (index);
@@ -70,10 +70,12 @@ public:
         2-(setChannelMapping)
         3-(updateTimestamps*)
         4-openFiles*
+        (if opensFilesBeforeData() returns true, openFiles is called as soon as recording is
+        armed, before the first block and its timestamps have arrived)
       During recording: (RecordThread loop)
         1-(updateTimestamps*) (can be called in a per-channel basis when the circular buffer wraps)
         2-startChannelBlock*
-        3-writeData* (per channel. Can be called more than once to account for the circular buffer wrap)
+        3-writeData* or writeRawData* (per channel. Can be called more than once to account for the circular buffer wrap)
         4-endChannelBlock*
         4-writeEvent* (if needed)
         5-writeSpike* (if needed)
@@ -90,6 +92,11 @@ public:
     /** Called when recording starts to open all needed files */
     virtual void openFiles (File rootFolder, int experimentNumber, int recordingNumber) = 0;
 
+    /** Returns true if openFiles does not need the timestamps of the first block. The record
+        thread can then open the files while the first samples are still being queued, instead
+        of after they arrive. If any engine returns false, all of them wait. */
+    virtual bool opensFilesBeforeData() const;
+
     /** Called when recording stops to close all files
         and do all the necessary cleanups */
     virtual void closeFiles() = 0;
@@ -101,6 +108,15 @@ public:
         care must be taken to only read the specified number of bytes.  */
     virtual void writeData (int writeChannel, int realChannel, const float* buffer, int size) = 0;
 
+    /** Returns true if the engine stores continuous data as int16 words in units of the
+        bitVolts of each channel. The record node then converts the samples as it queues
+        them, and the record thread calls writeRawData instead of writeData. */
+    virtual bool writesRawSamples() const;
+
+    /** Write continuous data for a channel, already divided by the bitVolts of the channel
+        and rounded to int16. Only called if writesRawSamples() returns true. */
+    virtual void writeRawData (int writeChannel, int realChannel, const int16* buffer, int size);
+
     /** Called by the record thread after it has written a channel block */
     virtual void endChannelBlock (bool lastBlock);
 
@@ -42,6 +42,8 @@ RecordNode::RecordNode()
     isRecording = false;
 	shouldRecord = true;
 	setFirstBlock = false;
+	recordingStartTimestamp = -1;
+	recordingEndTimestamp = -1;
 
     settings.numInputs = 0;
     settings.numOutputs = 0;
@@ -275,17 +277,6 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 			recordingNumber++; // increment recording number within this directory
 		}
 
-		if (!rootFolder.exists())
-		{
-			rootFolder.createDirectory();
-		}
-		if (settingsNeeded)
-		{
-			String settingsFileName = rootFolder.getFullPathName() + File::separator + "settings" + ((experimentNumber > 1) ? "_" + String(experimentNumber) : String::empty) + ".xml";
-			AccessClass::getEditorViewport()->saveState(File(settingsFileName), m_lastSettingsText);
-			settingsNeeded = false;
-		}
-
 		m_recordThread->setFileComponents(rootFolder, experimentNumber, recordingNumber);
 
 		channelMap.clear();
@@ -328,17 +319,49 @@ void RecordNode::setParameter(int parameterIndex, float newValue)
 		//WARNING: If at some point we record at more that one recordEngine at once, we should change this, as using OwnedArrays only works for the first
 		EVERY_ENGINE->setChannelMapping(channelMap, chanProcessorMap, chanOrderinProc, procInfo);
 		m_recordThread->setChannelMap(channelMap);
-		m_dataQueue->setChannels(numRecordedChannels);
+
+		//If every engine writes int16 words, queue the samples that way, converted only once
+		bool rawSamples = engineArray.size() > 0;
+		for (int eng = 0; eng < engineArray.size(); ++eng)
+			rawSamples &= engineArray[eng]->writesRawSamples();
+
+		Array<float> bitVolts;
+		for (int ch = 0; ch < numRecordedChannels && rawSamples; ++ch)
+		{
+			float bv = dataChannelArray[channelMap[ch]]->getBitVolts();
+			rawSamples &= bv > 0;
+			bitVolts.add(bv);
+		}
+		if (!rawSamples)
+			bitVolts.clear();
+
+		m_dataQueue->setChannels(numRecordedChannels, bitVolts);
 		m_eventQueue->reset();
 		m_spikeQueue->reset();
 		m_recordThread->setFirstBlockFlag(false);
 
 		setFirstBlock = false;
-		m_recordThread->startThread();
+		recordingStartTimestamp = -1;
+		recordingEndTimestamp = -1;
 
+		// from the next block on, the samples are queued; nothing below can make us miss any
 		isRecording = true;
 		hasRecorded = true;
 
+		if (!rootFolder.exists())
+		{
+			rootFolder.createDirectory();
+		}
+		if (settingsNeeded)
+		{
+			String settingsFileName = rootFolder.getFullPathName() + File::separator + "settings" + ((experimentNumber > 1) ? "_" + String(experimentNumber) : String::empty) + ".xml";
+			AccessClass::getEditorViewport()->saveState(File(settingsFileName), m_lastSettingsText);
+			settingsNeeded = false;
+		}
+
+		// the record thread opens the files while the queue holds the first blocks
+		m_recordThread->startThread();
+
 	}
 	else if (parameterIndex == 0)
 	{
@@ -462,6 +485,21 @@ float RecordNode::getFreeSpace() const
     return 1.0f - float(dataDirectory.getBytesFreeOnVolume())/float(dataDirectory.getVolumeTotalSize());
 }
 
+int64 RecordNode::getBytesWritten() const
+{
+    return m_recordThread->getBytesWritten();
+}
+
+int64 RecordNode::getRecordingStartTimestamp() const
+{
+	return recordingStartTimestamp;
+}
+
+int64 RecordNode::getRecordingEndTimestamp() const
+{
+	return recordingEndTimestamp;
+}
+
 
 void RecordNode::handleEvent(const EventChannel* eventInfo, const MidiMessage& event, int samplePosition)
 {
@@ -513,6 +551,17 @@ void RecordNode::process(AudioSampleBuffer& buffer)
 				m_dataQueue->writeChannel(buffer, chan, realChan, nSamples, timestamp);
 		}
 
+		// lets other threads know which samples this recording covers
+		if (recordChans > 0 && m_validBlocks[0])
+		{
+			const int64 firstTimestamp = getTimestamp(channelMap[0]);
+
+			if (recordingStartTimestamp < 0)
+				recordingStartTimestamp = firstTimestamp;
+
+			recordingEndTimestamp = firstTimestamp + getNumSamples(channelMap[0]);
+		}
+
         //  std::cout << nSamples << " " << samplesWritten << " " << blockIndex << std::endl;
 		if (!setFirstBlock)
 		{
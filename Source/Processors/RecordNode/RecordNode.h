@@ -99,6 +99,22 @@ public:
     */
     float getFreeSpace() const;
 
+    /** Returns the number of bytes handed to the record engines since the GUI started.
+        Can be called from any thread; see DiskSpaceMonitor.
+    */
+    int64 getBytesWritten() const;
+
+    /** Returns the timestamp of the first sample of the current (or last) recording, on the
+        first recorded channel, or -1 until that sample has been queued for writing.
+        Can be called from any thread.
+    */
+    int64 getRecordingStartTimestamp() const;
+
+    /** Returns the timestamp just past the last sample queued for writing, on the first
+        recorded channel, or -1 before the first one. Can be called from any thread.
+    */
+    int64 getRecordingEndTimestamp() const;
+
     /** Selects a channel relative to a particular processor with ID = id
     */
     void setChannel(const DataChannel* ch);
@@ -193,6 +209,9 @@ private:
     bool hasRecorded;
     bool settingsNeeded;
 	std::atomic<bool> setFirstBlock;
+
+	std::atomic<int64> recordingStartTimestamp;
+	std::atomic<int64> recordingEndTimestamp;
     /** Generates a default directory name, based on the current date and time */
     String generateDirectoryName();
 
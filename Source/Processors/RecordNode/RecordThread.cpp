@@ -34,7 +34,8 @@ RecordThread::RecordThread(const OwnedArray<RecordEngine>& engines) :
 Thread("Record Thread"),
 m_engineArray(engines),
 m_receivedFirstBlock(false),
-m_cleanExit(true)
+m_cleanExit(true),
+m_bytesWritten(0)
 {
 }
 
@@ -77,14 +78,27 @@ void RecordThread::run()
 {
 	const AudioSampleBuffer& dataBuffer = m_dataQueue->getAudioBufferReference();
 	bool closeEarly = true;
-	//1-Wait until the first block has arrived, so we can align the timestamps
+
+	bool openEarly = m_engineArray.size() > 0;
+	for (int eng = 0; eng < m_engineArray.size(); ++eng)
+		openEarly &= m_engineArray[eng]->opensFilesBeforeData();
+
+	//1-Open files right away if no engine needs the first timestamps; the samples queue up meanwhile
+	if (openEarly && !threadShouldExit())
+	{
+		m_cleanExit = false;
+		closeEarly = false;
+		EVERY_ENGINE->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
+	}
+
+	//2-Wait until the first block has arrived, so we can align the timestamps
 	while (!m_receivedFirstBlock && !threadShouldExit())
 	{
 		wait(1);
 	}
 
-	//2-Open Files 
-	if (!threadShouldExit())
+	//3-Open files, if they are not open yet
+	if (!threadShouldExit() && !openEarly)
 	{
 		m_cleanExit = false;
 		closeEarly = false;
@@ -94,25 +108,30 @@ void RecordThread::run()
 		EVERY_ENGINE->updateTimestamps(timestamps);
 		EVERY_ENGINE->openFiles(m_rootFolder, m_experimentNumber, m_recordingNumber);
 	}
-	//3-Normal loop
+	//4-Normal loop
 	while (!threadShouldExit())
 	{
 		writeData(dataBuffer, BLOCK_MAX_WRITE_SAMPLES, BLOCK_MAX_WRITE_EVENTS, BLOCK_MAX_WRITE_SPIKES);
 	}
 	std::cout << "Exiting record thread" << std::endl;
-	//4-Before closing the thread, try to write the remaining samples
+	//5-Before closing the thread, try to write the remaining samples
 	if (!closeEarly)
 	{
 		writeData(dataBuffer, -1, -1, -1, true);
 
 		std::cout << "Closing files" << std::endl;
-		//5-Close files
+		//6-Close files
 		EVERY_ENGINE->closeFiles();
 	}
 	m_cleanExit = true;
 	m_receivedFirstBlock = false;
 }
 
+int64 RecordThread::getBytesWritten() const
+{
+	return m_bytesWritten;
+}
+
 void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock)
 {
 	Array<int64> timestamps;
@@ -120,16 +139,25 @@ void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples
 	m_dataQueue->startRead(idx, timestamps, maxSamples);
 	EVERY_ENGINE->updateTimestamps(timestamps);
 	EVERY_ENGINE->startChannelBlock(lastBlock);
+	const bool rawSamples = m_dataQueue->hasRawSamples();
+	int64 bytes = 0;
 	for (int chan = 0; chan < m_numChannels; ++chan)
 	{
+		bytes += (idx[chan].size1 + idx[chan].size2) * sizeof(int16);
 		if (idx[chan].size1 > 0)
 		{
-			EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index1), idx[chan].size1);
+			if (rawSamples)
+				EVERY_ENGINE->writeRawData(chan, m_channelArray[chan], m_dataQueue->getRawReadPointer(chan, idx[chan].index1), idx[chan].size1);
+			else
+				EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index1), idx[chan].size1);
 			if (idx[chan].size2 > 0)
 			{
 				timestamps.set(chan, timestamps[chan] + idx[chan].size1);
 				EVERY_ENGINE->updateTimestamps(timestamps, chan);
-				EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index2), idx[chan].size2);
+				if (rawSamples)
+					EVERY_ENGINE->writeRawData(chan, m_channelArray[chan], m_dataQueue->getRawReadPointer(chan, idx[chan].index2), idx[chan].size2);
+				else
+					EVERY_ENGINE->writeData(chan, m_channelArray[chan], dataBuffer.getReadPointer(chan, idx[chan].index2), idx[chan].size2);
 			}
 		}
 	}
@@ -152,6 +180,7 @@ void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples
 		}
 		else
 			EVERY_ENGINE->writeEvent(events[ev]->getExtra(), events[ev]->getData());
+		bytes += event.getRawDataSize();
 	}
 
 	std::vector<SpikeMessagePtr> spikes;
@@ -159,7 +188,11 @@ void RecordThread::writeData(const AudioSampleBuffer& dataBuffer, int maxSamples
 	for (int sp = 0; sp < nSpikes; ++sp)
 	{
 		EVERY_ENGINE->writeSpike(spikes[sp]->getExtra(), &spikes[sp]->getData());
+		const SpikeChannel* spikeInfo = spikes[sp]->getData().getChannelInfo();
+		bytes += spikeInfo->getNumChannels() * spikeInfo->getTotalSamples() * sizeof(int16);
 	}
+
+	m_bytesWritten += bytes * m_engineArray.size();
 }
 
 void RecordThread::forceCloseFiles()
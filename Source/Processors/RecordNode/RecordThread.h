@@ -50,6 +50,10 @@ public:
 	void setFirstBlockFlag(bool state);
 	void forceCloseFiles();
 
+	/** Returns the number of bytes of samples, events and spikes handed to the engines since the
+	thread was created, counting samples as int16 words. Can be called from any thread. */
+	int64 getBytesWritten() const;
+
 private:
 	void writeData(const AudioSampleBuffer& buffer, int maxSamples, int maxEvents, int maxSpikes, bool lastBlock = false);
 
@@ -62,6 +66,7 @@ private:
 
 	std::atomic<bool> m_receivedFirstBlock;
 	std::atomic<bool> m_cleanExit;
+	std::atomic<int64> m_bytesWritten;
 
 	File m_rootFolder;
 	int m_experimentNumber;
@@ -22,22 +22,29 @@
 */
 
 #include "Visualizer.h"
+#include "VisualizerScheduler.h"
 
 Visualizer::Visualizer()
 {
 	refreshRate = 50;    // 50 Hz default refresh rate
 }
 
-Visualizer::~Visualizer() {}
+Visualizer::~Visualizer()
+{
+	stopCallbacks();
+}
 
 void Visualizer::startCallbacks()
 {
-	startTimer(1/float(refreshRate)*1000.0f);
+	VisualizerScheduler::getInstance()->addVisualizer(this);
 }
 
 void Visualizer::stopCallbacks()
 {
 	stopTimer();
+
+	if (VisualizerScheduler* scheduler = VisualizerScheduler::getInstanceWithoutCreating())
+		scheduler->removeVisualizer(this);
 }
 
 void Visualizer::timerCallback()
@@ -45,6 +52,12 @@ void Visualizer::timerCallback()
 	refresh();
 }
 
+void Visualizer::paintOverChildren(Graphics& g)
+{
+	if (VisualizerScheduler* scheduler = VisualizerScheduler::getInstanceWithoutCreating())
+		scheduler->drawOverlay(this, g);
+}
+
 void Visualizer::saveVisualizerParameters(XmlElement* xml) { }
 
 void Visualizer::loadVisualizerParameters(XmlElement* xml) { }
\ No newline at end of file
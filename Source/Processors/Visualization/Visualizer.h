@@ -64,16 +64,20 @@ public:
     /** Called by an editor to initiate a parameter change.*/
     virtual void setParameter(int, int, int, float) = 0;
 
-    /** Starts the timer callbacks. */
+    /** Registers with the VisualizerScheduler, which calls refresh() at up to refreshRate
+        while the visualizer is on screen. */
 	void startCallbacks();
 
-    /** Stops the timer callbacks. */
+    /** Stops the refresh callbacks. */
 	void stopCallbacks();
 
-    /** Called whenever the timer is triggered. */
+    /** Calls refresh(). Kept for visualizers that start the timer themselves. */
 	void timerCallback();
 
-    /** Refresh rate in Hz. */
+    /** Draws the frame-time overlay when it is enabled. */
+    void paintOverChildren(Graphics& g) override;
+
+    /** Target refresh rate in Hz. The scheduler lowers it temporarily under load. */
     float refreshRate;
 
 
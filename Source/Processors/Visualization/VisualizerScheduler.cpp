@@ -0,0 +1,273 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "VisualizerScheduler.h"
+#include "Visualizer.h"
+
+#define TICK_INTERVAL_MS 10
+#define FRAME_BUDGET_MS 8.0
+#define LATE_TICK_MS (3.0 * TICK_INTERVAL_MS)
+#define MAX_LOAD_FACTOR 4.0
+#define LOAD_INCREASE 1.25
+#define LOAD_RECOVERY 0.98
+#define AVERAGE_WEIGHT 0.1
+
+juce_ImplementSingleton_SingleThreaded(VisualizerScheduler)
+
+VisualizerScheduler::VisualizerScheduler()
+    : nextEntry(0),
+      lastTickTime(0),
+      averageTickInterval(TICK_INTERVAL_MS),
+      averageTickCost(0),
+      deferredLastTick(0),
+      showOverlay(false)
+{
+}
+
+VisualizerScheduler::~VisualizerScheduler()
+{
+    stopTimer();
+    clearSingletonInstance();
+}
+
+int VisualizerScheduler::indexOf(const Visualizer* v) const
+{
+    for (int i = 0; i < entries.size(); i++)
+    {
+        if (entries.getReference(i).visualizer == v)
+            return i;
+    }
+    return -1;
+}
+
+void VisualizerScheduler::addVisualizer(Visualizer* v)
+{
+    if (indexOf(v) >= 0)
+        return;
+
+    Entry e;
+    e.visualizer = v;
+    e.nextRefreshTime = 0;
+    e.averageCost = 0;
+    e.lastCost = 0;
+    e.loadFactor = 1.0;
+    e.averageInterval = 1000.0 / jmax(1.0f, v->refreshRate);
+    e.lastRefreshTime = 0;
+    entries.add(e);
+
+    if (!isTimerRunning())
+    {
+        lastTickTime = Time::getMillisecondCounterHiRes();
+        startTimer(TICK_INTERVAL_MS);
+    }
+}
+
+void VisualizerScheduler::removeVisualizer(Visualizer* v)
+{
+    int index = indexOf(v);
+    if (index < 0)
+        return;
+
+    entries.remove(index);
+
+    if (entries.size() == 0)
+        stopTimer();
+
+    if (showOverlay)
+        repaintOverlay(v);
+}
+
+void VisualizerScheduler::setOverlayVisible(bool visible)
+{
+    showOverlay = visible;
+
+    for (int i = 0; i < entries.size(); i++)
+        repaintOverlay(entries.getReference(i).visualizer);
+}
+
+bool VisualizerScheduler::isOverlayVisible() const
+{
+    return showOverlay;
+}
+
+bool VisualizerScheduler::isOnScreen(Component* c) const
+{
+    // isShowing() already covers hidden tabs and minimised windows
+    if (!c->isShowing())
+        return false;
+
+    // a canvas scrolled or resized out of view by its parents is not drawn either
+    Rectangle<int> area = c->getLocalBounds();
+    Component* child = c;
+
+    for (Component* parent = c->getParentComponent(); parent != nullptr; parent = parent->getParentComponent())
+    {
+        area = parent->getLocalArea(child, area).getIntersection(parent->getLocalBounds());
+
+        if (area.isEmpty())
+            return false;
+
+        child = parent;
+    }
+
+    return !area.isEmpty();
+}
+
+void VisualizerScheduler::timerCallback()
+{
+    const double tickStart = Time::getMillisecondCounterHiRes();
+    const double tickInterval = tickStart - lastTickTime;
+    lastTickTime = tickStart;
+
+    averageTickInterval += AVERAGE_WEIGHT * (tickInterval - averageTickInterval);
+
+    // ticks arriving well after they were due mean the message thread is
+    // saturated, whatever the cost of the refreshes themselves
+    const bool lateTick = tickInterval > LATE_TICK_MS;
+
+    // refresh() may start or stop other visualizers, so work on a snapshot
+    Array<Visualizer*> order;
+    int numVisible = 0;
+
+    for (int k = 0; k < entries.size(); k++)
+    {
+        Entry& e = entries.getReference((nextEntry + k) % entries.size());
+        order.add(e.visualizer);
+
+        if (isOnScreen(e.visualizer))
+            numVisible++;
+    }
+
+    const double share = FRAME_BUDGET_MS / jmax(1, numVisible);
+    double spent = 0;
+    int deferred = 0;
+    int firstDeferred = -1;
+
+    for (int k = 0; k < order.size(); k++)
+    {
+        int index = indexOf(order[k]);
+        if (index < 0)
+            continue;
+
+        Entry& e = entries.getReference(index);
+        Visualizer* v = e.visualizer;
+
+        if (!isOnScreen(v))
+        {
+            // refresh as soon as it comes back into view
+            e.nextRefreshTime = 0;
+            continue;
+        }
+
+        if (tickStart < e.nextRefreshTime)
+            continue;
+
+        if (spent >= FRAME_BUDGET_MS)
+        {
+            if (firstDeferred < 0)
+                firstDeferred = index;
+            deferred++;
+            continue;
+        }
+
+        const double start = Time::getMillisecondCounterHiRes();
+        v->refresh();
+        const double end = Time::getMillisecondCounterHiRes();
+
+        index = indexOf(v);
+        if (index < 0)
+            continue;
+
+        Entry& r = entries.getReference(index);
+        const double cost = end - start;
+        spent += cost;
+
+        r.lastCost = cost;
+        r.averageCost += AVERAGE_WEIGHT * (cost - r.averageCost);
+
+        if (r.lastRefreshTime > 0)
+            r.averageInterval += AVERAGE_WEIGHT * ((start - r.lastRefreshTime) - r.averageInterval);
+        r.lastRefreshTime = start;
+
+        if (cost > share || lateTick)
+            r.loadFactor = jmin(MAX_LOAD_FACTOR, r.loadFactor * LOAD_INCREASE);
+        else if (r.averageCost < 0.5 * share)
+            r.loadFactor = jmax(1.0, r.loadFactor * LOAD_RECOVERY);
+
+        const double interval = 1000.0 / jmax(1.0f, v->refreshRate) * r.loadFactor;
+        r.nextRefreshTime += interval;
+        if (r.nextRefreshTime < end)
+            r.nextRefreshTime = end + interval - TICK_INTERVAL_MS / 2;
+
+        if (showOverlay)
+            repaintOverlay(v);
+    }
+
+    // whoever missed this tick goes first on the next one
+    if (firstDeferred >= 0)
+        nextEntry = firstDeferred;
+
+    deferredLastTick = deferred;
+    averageTickCost += AVERAGE_WEIGHT * (spent - averageTickCost);
+}
+
+Rectangle<int> VisualizerScheduler::getOverlayBounds(const Visualizer* v) const
+{
+    return Rectangle<int>(v->getWidth() - 190, 5, 185, 52);
+}
+
+void VisualizerScheduler::repaintOverlay(Visualizer* v) const
+{
+    v->repaint(getOverlayBounds(v));
+}
+
+void VisualizerScheduler::drawOverlay(const Visualizer* v, Graphics& g) const
+{
+    if (!showOverlay)
+        return;
+
+    int index = indexOf(v);
+    if (index < 0)
+        return;
+
+    const Entry& e = entries.getReference(index);
+    Rectangle<int> bounds = getOverlayBounds(v);
+
+    g.setColour(Colours::black.withAlpha(0.7f));
+    g.fillRoundedRectangle(bounds.toFloat(), 4.0f);
+
+    g.setColour(e.loadFactor > 1.0 ? Colours::orange : Colours::lightgreen);
+    g.setFont(Font("Small Text", 11, Font::plain));
+
+    bounds.reduce(6, 3);
+    const int lineHeight = bounds.getHeight() / 3;
+
+    g.drawText("refresh " + String(e.lastCost, 2) + " ms (avg " + String(e.averageCost, 2) + ")",
+               bounds.removeFromTop(lineHeight), Justification::left, false);
+    g.drawText("rate " + String(1000.0 / jmax(1.0, e.averageInterval), 1) + " / "
+               + String(v->refreshRate, 0) + " Hz",
+               bounds.removeFromTop(lineHeight), Justification::left, false);
+    g.drawText("tick " + String(averageTickInterval, 1) + " ms, " + String(averageTickCost, 1)
+               + " ms used, " + String(deferredLastTick) + " deferred",
+               bounds, Justification::left, false);
+}
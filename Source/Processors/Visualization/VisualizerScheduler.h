@@ -0,0 +1,104 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef VISUALIZERSCHEDULER_H_INCLUDED
+#define VISUALIZERSCHEDULER_H_INCLUDED
+
+#include "../../../JuceLibraryCode/JuceHeader.h"
+
+class Visualizer;
+
+/**
+
+  Drives the refresh() calls of every animating Visualizer from a single timer.
+
+  Each tick refreshes the canvases whose refresh interval has elapsed, skipping
+  the ones that are not on screen (hidden tabs, minimised or clipped windows).
+  A tick spends at most FRAME_BUDGET_MS on refreshes, shared equally between
+  the visible canvases; whatever does not fit is deferred to the next tick,
+  starting from where the previous one stopped. Canvases whose refresh takes
+  longer than their share, or a message thread that delivers ticks late, lower
+  the effective refresh rate step by step (down to a quarter of the requested
+  one), and it recovers once there is time to spare.
+
+  All methods must be called from the message thread.
+
+  @see Visualizer
+
+*/
+
+class VisualizerScheduler : private Timer,
+    public DeletedAtShutdown
+{
+public:
+    VisualizerScheduler();
+    ~VisualizerScheduler();
+
+    /** Starts refreshing a visualizer at its refreshRate. */
+    void addVisualizer(Visualizer* v);
+
+    /** Stops refreshing a visualizer. */
+    void removeVisualizer(Visualizer* v);
+
+    /** Shows or hides the frame-time overlay on every visualizer. */
+    void setOverlayVisible(bool visible);
+    bool isOverlayVisible() const;
+
+    /** Draws the frame-time overlay of a visualizer, if enabled. */
+    void drawOverlay(const Visualizer* v, Graphics& g) const;
+
+    juce_DeclareSingleton_SingleThreaded_Minimal(VisualizerScheduler)
+
+private:
+    struct Entry
+    {
+        Visualizer* visualizer;
+        double nextRefreshTime;
+        double averageCost;     // ms, exponential average of refresh() durations
+        double lastCost;
+        double loadFactor;      // multiplies the requested refresh interval
+        double averageInterval; // ms between actual refreshes
+        double lastRefreshTime;
+    };
+
+    void timerCallback() override;
+
+    bool isOnScreen(Component* c) const;
+    void repaintOverlay(Visualizer* v) const;
+    Rectangle<int> getOverlayBounds(const Visualizer* v) const;
+    int indexOf(const Visualizer* v) const;
+
+    Array<Entry> entries;
+    int nextEntry;
+
+    double lastTickTime;
+    double averageTickInterval;
+    double averageTickCost;
+    int deferredLastTick;
+
+    bool showOverlay;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualizerScheduler);
+};
+
+#endif  // VISUALIZERSCHEDULER_H_INCLUDED
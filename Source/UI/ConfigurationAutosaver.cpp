@@ -0,0 +1,128 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ConfigurationAutosaver.h"
+#include "EditorViewport.h"
+
+ConfigurationAutosaver::ConfigurationAutosaver(EditorViewport* viewport_, const File& file_, int intervalMs)
+    : Thread("Configuration autosave"),
+      viewport(viewport_),
+      file(file_)
+{
+    startThread(2);
+    startTimer(intervalMs);
+}
+
+ConfigurationAutosaver::~ConfigurationAutosaver()
+{
+    stopTimer();
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+}
+
+const File& ConfigurationAutosaver::getFile() const
+{
+    return file;
+}
+
+void ConfigurationAutosaver::timerCallback()
+{
+    if (viewport->isSignalChainEmpty())
+        return;
+
+    // the only part that needs the message thread: processors and editors save their own state
+    XmlElement* snapshot = viewport->createSettingsXml();
+
+    {
+        const ScopedLock sl(pendingLock);
+        pending = snapshot;
+    }
+
+    notify();
+}
+
+void ConfigurationAutosaver::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(-1);
+
+        ScopedPointer<XmlElement> xml;
+
+        {
+            const ScopedLock sl(pendingLock);
+            xml = pending.release();
+        }
+
+        if (xml == nullptr)
+            continue;
+
+        // the date changes with every snapshot, and would make each one look new
+        XmlElement* info = xml->getChildByName("INFO");
+        XmlElement* date = info != nullptr ? info->getChildByName("DATE") : nullptr;
+        XmlElement* dateText = date != nullptr ? date->getFirstChildElement() : nullptr;
+        String dateString;
+
+        if (dateText != nullptr && dateText->isTextElement())
+        {
+            dateString = dateText->getText();
+            dateText->setText(String::empty);
+        }
+        else
+        {
+            dateText = nullptr;
+        }
+
+        MemoryOutputStream output;
+        if (! ConfigurationFile::write(*xml, output))
+            continue;
+
+        if (output.getDataSize() == lastSaved.getSize()
+            && memcmp(output.getData(), lastSaved.getData(), lastSaved.getSize()) == 0)
+            continue;
+
+        if (dateText != nullptr)
+            dateText->setText(dateString);
+
+        MemoryOutputStream withDate;
+        if (! ConfigurationFile::write(*xml, withDate))
+            continue;
+
+       #if JUCE_DEBUG
+        {
+            MemoryInputStream input(withDate.getData(), withDate.getDataSize(), false);
+            ScopedPointer<XmlElement> decoded = ConfigurationFile::read(input);
+            jassert(decoded != nullptr && decoded->isEquivalentTo(xml, false));
+        }
+       #endif
+
+        TemporaryFile temp(file);
+
+        if (temp.getFile().replaceWithData(withDate.getData(), withDate.getDataSize())
+            && temp.overwriteTargetFileWithTemporary())
+        {
+            lastSaved = output.getMemoryBlock();
+        }
+    }
+}
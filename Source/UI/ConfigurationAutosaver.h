@@ -0,0 +1,68 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONFIGURATIONAUTOSAVER_H_INCLUDED
+#define CONFIGURATIONAUTOSAVER_H_INCLUDED
+
+#include "ConfigurationFile.h"
+
+class EditorViewport;
+
+/**
+
+  Saves the configuration every few minutes, for recovery after a crash.
+
+  Only the snapshot of the signal chain is taken on the message thread, as
+  it reads the state of the processors and editors. Encoding and writing the
+  file happen on a background thread, and the file is left untouched when
+  nothing changed since the last save.
+
+*/
+
+class ConfigurationAutosaver : public Thread,
+    private Timer
+{
+public:
+    ConfigurationAutosaver(EditorViewport* viewport, const File& file, int intervalMs);
+    ~ConfigurationAutosaver();
+
+    const File& getFile() const;
+
+    void run() override;
+
+private:
+    void timerCallback() override;
+
+    EditorViewport* viewport;
+    File file;
+
+    CriticalSection pendingLock;
+    ScopedPointer<XmlElement> pending;
+
+    MemoryBlock lastSaved;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConfigurationAutosaver);
+};
+
+
+#endif  // CONFIGURATIONAUTOSAVER_H_INCLUDED
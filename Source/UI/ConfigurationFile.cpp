@@ -0,0 +1,359 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "ConfigurationFile.h"
+
+// "OECB", then the format version
+#define BINARY_CONFIG_MAGIC 0x4243454f
+#define BINARY_CONFIG_VERSION 1
+
+// deeper documents are rejected as corrupt
+#define BINARY_CONFIG_MAX_DEPTH 256
+
+namespace
+{
+    class StringTable
+    {
+    public:
+        int add(const String& s)
+        {
+            if (indices.contains(s))
+                return indices[s];
+
+            const int index = strings.size();
+            indices.set(s, index);
+            strings.add(s);
+            return index;
+        }
+
+        void collect(const XmlElement& xml)
+        {
+            if (xml.isTextElement())
+            {
+                add(xml.getText());
+                return;
+            }
+
+            add(xml.getTagName());
+
+            for (int i = 0; i < xml.getNumAttributes(); i++)
+            {
+                add(xml.getAttributeName(i));
+                add(xml.getAttributeValue(i));
+            }
+
+            forEachXmlChildElement(xml, child)
+                collect(*child);
+        }
+
+        StringArray strings;
+        HashMap<String, int> indices;
+    };
+
+    // text elements are marked by a tag index of 0, element tags are stored as index + 1
+    void writeElement(const XmlElement& xml, StringTable& table, OutputStream& output)
+    {
+        if (xml.isTextElement())
+        {
+            output.writeCompressedInt(0);
+            output.writeCompressedInt(table.add(xml.getText()));
+            return;
+        }
+
+        output.writeCompressedInt(table.add(xml.getTagName()) + 1);
+
+        const int numAttributes = xml.getNumAttributes();
+        output.writeCompressedInt(numAttributes);
+
+        for (int i = 0; i < numAttributes; i++)
+        {
+            output.writeCompressedInt(table.add(xml.getAttributeName(i)));
+            output.writeCompressedInt(table.add(xml.getAttributeValue(i)));
+        }
+
+        int numChildren = 0;
+        forEachXmlChildElement(xml, child)
+            numChildren++;
+
+        output.writeCompressedInt(numChildren);
+
+        forEachXmlChildElement(xml, child)
+            writeElement(*child, table, output);
+    }
+
+    /** Decodes the data written by an OutputStream straight from memory, failing on anything out of range */
+    class BinaryReader
+    {
+    public:
+        BinaryReader(const MemoryBlock& data)
+            : pos(static_cast<const uint8*>(data.getData())),
+              end(pos + data.getSize()),
+              failed(false)
+        {
+        }
+
+        bool hasFailed() const { return failed; }
+
+        int readInt()
+        {
+            if (end - pos < 4)
+                return fail();
+
+            const int value = (int) ByteOrder::littleEndianInt(pos);
+            pos += 4;
+            return value;
+        }
+
+        // the format of OutputStream::writeCompressedInt(): a byte count, with the sign in its top bit
+        int readCompressedInt()
+        {
+            if (pos >= end)
+                return fail();
+
+            const uint8 sizeByte = *pos++;
+            const int numBytes = sizeByte & 0x7f;
+
+            if (numBytes > 4 || end - pos < numBytes)
+                return fail();
+
+            uint32 value = 0;
+            for (int i = 0; i < numBytes; i++)
+                value |= (uint32) pos[i] << (8 * i);
+
+            pos += numBytes;
+            return (sizeByte & 0x80) != 0 ? -(int) value : (int) value;
+        }
+
+        // the format of OutputStream::writeString(): UTF-8 with a null terminator
+        String readString()
+        {
+            const uint8* terminator = static_cast<const uint8*>(memchr(pos, 0, (size_t) (end - pos)));
+
+            if (terminator == nullptr)
+            {
+                fail();
+                return String::empty;
+            }
+
+            const String s(String::fromUTF8(reinterpret_cast<const char*>(pos), (int) (terminator - pos)));
+            pos = terminator + 1;
+            return s;
+        }
+
+        bool readIndex(const StringArray& strings, int& index)
+        {
+            index = readCompressedInt();
+            return ! failed && index >= 0 && index < strings.size();
+        }
+
+    private:
+        int fail()
+        {
+            failed = true;
+            pos = end;
+            return 0;
+        }
+
+        const uint8* pos;
+        const uint8* const end;
+        bool failed;
+    };
+
+    // attribute names are pooled identifiers: each is interned once per file, not once per use
+    bool readName(BinaryReader& reader, const StringArray& strings, Array<Identifier>& names, int& index)
+    {
+        if (! reader.readIndex(strings, index) || strings[index].isEmpty())
+            return false;
+
+        if (names.getReference(index).isNull())
+            names.set(index, Identifier(strings[index]));
+
+        return true;
+    }
+
+    XmlElement* readElement(BinaryReader& reader, const StringArray& strings, Array<Identifier>& names, int depth)
+    {
+        if (depth > BINARY_CONFIG_MAX_DEPTH)
+            return nullptr;
+
+        const int tag = reader.readCompressedInt();
+        int index;
+
+        if (reader.hasFailed())
+            return nullptr;
+
+        if (tag == 0)
+        {
+            if (! reader.readIndex(strings, index))
+                return nullptr;
+
+            return XmlElement::createTextElement(strings[index]);
+        }
+
+        if (tag < 0 || tag > strings.size() || strings[tag - 1].isEmpty())
+            return nullptr;
+
+        ScopedPointer<XmlElement> xml = new XmlElement(strings[tag - 1]);
+
+        const int numAttributes = reader.readCompressedInt();
+        if (reader.hasFailed() || numAttributes < 0)
+            return nullptr;
+
+        for (int i = 0; i < numAttributes; i++)
+        {
+            int name, value;
+            if (! readName(reader, strings, names, name) || ! reader.readIndex(strings, value))
+                return nullptr;
+
+            xml->setAttribute(names.getReference(name), strings[value]);
+        }
+
+        const int numChildren = reader.readCompressedInt();
+        if (reader.hasFailed() || numChildren < 0)
+            return nullptr;
+
+        // appending walks the whole child list, so children are prepended last to first
+        OwnedArray<XmlElement> children;
+
+        for (int i = 0; i < numChildren; i++)
+        {
+            XmlElement* child = readElement(reader, strings, names, depth + 1);
+            if (child == nullptr)
+                return nullptr;
+
+            children.add(child);
+        }
+
+        for (int i = children.size(); --i >= 0;)
+            xml->prependChildElement(children.removeAndReturn(i));
+
+        return xml.release();
+    }
+}
+
+bool ConfigurationFile::write(const XmlElement& xml, OutputStream& output)
+{
+    StringTable table;
+    table.collect(xml);
+
+    // encoded in memory first, so the destination gets a single write that reports any failure
+    MemoryOutputStream encoded;
+
+    encoded.writeInt(BINARY_CONFIG_MAGIC);
+    encoded.writeInt(BINARY_CONFIG_VERSION);
+
+    encoded.writeCompressedInt(table.strings.size());
+    for (int i = 0; i < table.strings.size(); i++)
+        encoded.writeString(table.strings[i]);
+
+    writeElement(xml, table, encoded);
+
+    // lets read() tell a complete file from a truncated one
+    encoded.writeInt(BINARY_CONFIG_MAGIC);
+
+    return output.write(encoded.getData(), encoded.getDataSize());
+}
+
+XmlElement* ConfigurationFile::read(InputStream& input)
+{
+    // configurations are small: decoding from memory avoids a virtual call for every byte
+    MemoryBlock data;
+    input.readIntoMemoryBlock(data);
+
+    BinaryReader reader(data);
+
+    if (reader.readInt() != BINARY_CONFIG_MAGIC || reader.readInt() != BINARY_CONFIG_VERSION)
+        return nullptr;
+
+    const int numStrings = reader.readCompressedInt();
+    if (reader.hasFailed() || numStrings < 0)
+        return nullptr;
+
+    StringArray strings;
+
+    for (int i = 0; i < numStrings && ! reader.hasFailed(); i++)
+        strings.add(reader.readString());
+
+    if (reader.hasFailed())
+        return nullptr;
+
+    Array<Identifier> names;
+    names.insertMultiple(0, Identifier(), numStrings);
+
+    ScopedPointer<XmlElement> xml = readElement(reader, strings, names, 0);
+
+    if (xml == nullptr || reader.readInt() != BINARY_CONFIG_MAGIC || reader.hasFailed())
+        return nullptr;
+
+    return xml.release();
+}
+
+bool ConfigurationFile::isBinaryFile(const File& file)
+{
+    ScopedPointer<FileInputStream> input = file.createInputStream();
+
+    return input != nullptr && input->readInt() == BINARY_CONFIG_MAGIC;
+}
+
+bool ConfigurationFile::shouldWriteBinary(const File& file)
+{
+    return file.hasFileExtension(BINARY_CONFIG_EXTENSION);
+}
+
+XmlElement* ConfigurationFile::loadFile(const File& file)
+{
+    if (isBinaryFile(file))
+    {
+        ScopedPointer<FileInputStream> input = file.createInputStream();
+
+        if (input == nullptr)
+            return nullptr;
+
+        return read(*input);
+    }
+
+    XmlDocument doc(file);
+    return doc.getDocumentElement();
+}
+
+bool ConfigurationFile::saveFile(const XmlElement& xml, const File& file)
+{
+    if (! shouldWriteBinary(file))
+        return xml.writeToFile(file, String::empty);
+
+    TemporaryFile temp(file);
+
+    {
+        ScopedPointer<FileOutputStream> output = temp.getFile().createOutputStream();
+
+        if (output == nullptr || ! write(xml, *output))
+            return false;
+
+        output->flush();
+
+        if (output->getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
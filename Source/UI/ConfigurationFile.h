@@ -0,0 +1,73 @@
+/*
+------------------------------------------------------------------
+
+This file is part of the Open Ephys GUI
+Copyright (C) 2018 Open Ephys
+
+------------------------------------------------------------------
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef CONFIGURATIONFILE_H_INCLUDED
+#define CONFIGURATIONFILE_H_INCLUDED
+
+#include "../../JuceLibraryCode/JuceHeader.h"
+
+/**
+
+  Compact binary form of the signal chain configuration.
+
+  The binary file holds exactly the XML document the EditorViewport builds,
+  so everything that can be saved as XML can be saved this way, and loading
+  goes through the same code. Every distinct string (tag and attribute
+  names, attribute values, text) is stored once in a table at the start of
+  the file; elements refer to it by index. Reading needs no text parsing or
+  unescaping, and the many repeated names and values of per-channel
+  parameters cost a few bytes each.
+
+  Files are recognised by their first bytes, whatever their name. Configurations
+  are written in binary when the file has the BINARY_CONFIG_EXTENSION.
+
+  @see EditorViewport::saveState, EditorViewport::loadState
+
+*/
+
+#define BINARY_CONFIG_EXTENSION ".oecfg"
+
+class ConfigurationFile
+{
+public:
+    /** Writes the document to a stream. */
+    static bool write(const XmlElement& xml, OutputStream& output);
+
+    /** Reads a document written by write(). Returns nullptr if the data is not a valid configuration. */
+    static XmlElement* read(InputStream& input);
+
+    /** True if the file starts like a binary configuration. */
+    static bool isBinaryFile(const File& file);
+
+    /** True if configurations saved under this name should be written in binary. */
+    static bool shouldWriteBinary(const File& file);
+
+    /** Reads a binary or XML configuration file. */
+    static XmlElement* loadFile(const File& file);
+
+    /** Writes the document, in binary or as XML depending on the file name, through a temporary file. */
+    static bool saveFile(const XmlElement& xml, const File& file);
+};
+
+
+#endif  // CONFIGURATIONFILE_H_INCLUDED
@@ -136,7 +136,7 @@ void CPUMeter::paint(Graphics& g)
 
 
 DiskSpaceMeter::DiskSpaceMeter()
-
+    : diskFree(0.0f), monitor(nullptr)
 {
 
     font = Font("Small Text", 12, Font::plain);
@@ -159,6 +159,38 @@ void DiskSpaceMeter::updateDiskSpace(float percent)
     diskFree = percent;
 }
 
+void DiskSpaceMeter::setMonitor(DiskSpaceMonitor* monitor_)
+{
+    monitor = monitor_;
+}
+
+void DiskSpaceMeter::mouseDown(const MouseEvent& e)
+{
+    if (monitor == nullptr)
+        return;
+
+    const File rollover = monitor->getRolloverDirectory();
+
+    PopupMenu m;
+    m.addItem(1, "Roll over to another directory when the disk is full...");
+    m.addItem(2, "Stop rolling over to " + rollover.getFullPathName(), rollover != File());
+
+    const int result = m.show();
+
+    if (result == 1)
+    {
+        FileChooser chooser("Directory to continue recording in when the disk is full",
+                            rollover.exists() ? rollover : File::getSpecialLocation(File::userHomeDirectory));
+
+        if (chooser.browseForDirectory())
+            monitor->setRolloverDirectory(chooser.getResult());
+    }
+    else if (result == 2)
+    {
+        monitor->setRolloverDirectory(File());
+    }
+}
+
 void DiskSpaceMeter::paint(Graphics& g)
 {
 
@@ -519,6 +551,15 @@ void ControlPanel::updateChildComponents()
 
     filenameComponent->addListener(AccessClass::getProcessorGraph()->getRecordNode());
     AccessClass::getProcessorGraph()->getRecordNode()->filenameComponentChanged(filenameComponent);
+
+    if (diskMonitor == nullptr)
+    {
+        diskMonitor = new DiskSpaceMonitor(AccessClass::getProcessorGraph()->getRecordNode());
+        diskMonitor->setDataDirectory(filenameComponent->getCurrentFile());
+        filenameComponent->addListener(diskMonitor);
+        diskMeter->setMonitor(diskMonitor);
+        diskMonitor->startThread();
+    }
 	updateRecordEngineList();
 
 }
@@ -863,7 +904,7 @@ void ControlPanel::buttonClicked(Button* button)
             refreshMeters();
             masterClock->stop();
             stopTimer();
-            startTimer(60000); // back to refresh every minute
+            startTimer(1000); // back to refresh every second
             audioEditor->enable();
             recordSelector->setEnabled(true);
             recordOptionsButton->setEnabled(true);
@@ -966,7 +1007,7 @@ void ControlPanel::disableCallbacks()
         std::cout << "Updating control panel." << std::endl;
         refreshMeters();
         stopTimer();
-        startTimer(60000); // back to refresh every 10 seconds
+        startTimer(1000); // back to refresh every second
 
     }
 
@@ -1015,17 +1056,49 @@ void ControlPanel::refreshMeters()
 
     masterClock->repaint();
 
-    diskMeter->updateDiskSpace(graph->getRecordNode()->getFreeSpace());
+    if (diskMonitor != nullptr)
+    {
+        // the volume is queried by the monitor thread, this only reads its last forecast
+        const DiskSpaceMonitor::Forecast forecast = diskMonitor->getForecast();
+
+        if (forecast.totalBytes > 0)
+            diskMeter->updateDiskSpace(1.0f - float(forecast.bytesFree)/float(forecast.totalBytes));
+
+        diskMeter->setTooltip(DiskSpaceMonitor::describe(forecast));
+
+        if (diskMonitor->checkRolloverNeeded() && recordButton->getToggleState())
+            rolloverRecording();
+    }
+
     diskMeter->repaint();
 
     if (initialize)
     {
         stopTimer();
-        startTimer(60000); // check for disk updates every minute
+        startTimer(1000); // refresh every second
         initialize = false;
     }
 }
 
+void ControlPanel::rolloverRecording()
+{
+    const File rolloverDirectory = diskMonitor->getRolloverDirectory();
+
+    if (rolloverDirectory == File())
+        return;
+
+    std::cout << "Disk almost full, recording continues in " << rolloverDirectory.getFullPathName() << std::endl;
+
+    stopRecording();
+
+    // used once: going back would only find the full disk
+    diskMonitor->setRolloverDirectory(File());
+    setRecordingDirectory(rolloverDirectory.getFullPathName());
+
+    recordButton->setToggleState(true, dontSendNotification);
+    startRecording();
+}
+
 bool ControlPanel::keyPressed(const KeyPress& key)
 {
     std::cout << "Control panel received" << key.getKeyCode() << std::endl;
@@ -1092,6 +1165,8 @@ void ControlPanel::saveStateToXml(XmlElement* xml)
     XmlElement* controlPanelState = xml->createNewChildElement("CONTROLPANEL");
     controlPanelState->setAttribute("isOpen",open);
 	controlPanelState->setAttribute("recordPath", filenameComponent->getCurrentFile().getFullPathName());
+	if (diskMonitor != nullptr)
+		controlPanelState->setAttribute("rolloverPath", diskMonitor->getRolloverDirectory().getFullPathName());
     controlPanelState->setAttribute("prependText",prependText->getText());
     controlPanelState->setAttribute("appendText",appendText->getText());
     controlPanelState->setAttribute("recordEngine",recordEngines[recordSelector->getSelectedId()-1]->getID());
@@ -1121,6 +1196,9 @@ void ControlPanel::loadStateFromXml(XmlElement* xml)
 			{
 				filenameComponent->setCurrentFile(File(recordPath), true, sendNotificationAsync);
 			}
+			String rolloverPath = xmlNode->getStringAttribute("rolloverPath", String::empty);
+			if (diskMonitor != nullptr)
+				diskMonitor->setRolloverDirectory(rolloverPath.isEmpty() ? File() : File(rolloverPath));
             appendText->setText(xmlNode->getStringAttribute("appendText", ""), dontSendNotification);
             prependText->setText(xmlNode->getStringAttribute("prependText", ""), dontSendNotification);
 			String selectedEngine = xmlNode->getStringAttribute("recordEngine");
@@ -30,6 +30,7 @@
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
 #include "../Processors/RecordNode/RecordNode.h"
 #include "../Processors/RecordNode/RecordEngine.h"
+#include "../Processors/RecordNode/DiskSpaceMonitor.h"
 #include "LookAndFeel/CustomLookAndFeel.h"
 #include "../AccessClass.h"
 #include "../Processors/Editors/GenericEditor.h" // for UtilityButton
@@ -122,10 +123,9 @@ private:
 
   Displays the amount of disk space left in the current data directory.
 
-  The DiskSpaceMeter is located in the ControlPanel. When the GUI is launched (or the data directory
-  is changed), a built-in JUCE method is used to find the amount of free space.
-
-  Note that the DiskSpaceMeter currently displays only relative, not absolute disk space.
+  The DiskSpaceMeter is located in the ControlPanel. The free space is measured by the
+  DiskSpaceMonitor, whose forecast of the time left while recording is shown in the tooltip.
+  Clicking on the meter chooses the directory that recording rolls over to when the disk fills up.
 
   @see ControlPanel
 
@@ -141,15 +141,23 @@ public:
     	the ControlPanel. */
     void updateDiskSpace(float percent);
 
+    /** Sets the monitor whose rollover directory is chosen from the meter. */
+    void setMonitor(DiskSpaceMonitor* monitor);
+
     /** Draws the DiskSpaceMeter. */
     void paint(Graphics& g);
 
+    /** Shows the rollover menu. */
+    void mouseDown(const MouseEvent& e);
+
 private:
 
     Font font;
 
     float diskFree;
 
+    DiskSpaceMonitor* monitor;
+
 };
 
 /**
@@ -376,6 +384,7 @@ private:
     ScopedPointer<Clock> masterClock;
     ScopedPointer<CPUMeter> cpuMeter;
     ScopedPointer<DiskSpaceMeter> diskMeter;
+    ScopedPointer<DiskSpaceMonitor> diskMonitor;
     ScopedPointer<FilenameComponent> filenameComponent;
     ScopedPointer<UtilityButton> newDirectoryButton;
     ScopedPointer<ControlPanelButton> cpb;
@@ -405,6 +414,9 @@ private:
     /** Updates the values displayed by the CPUMeter and DiskSpaceMeter.*/
     void refreshMeters();
 
+    /** Continues the current recording in the rollover directory of the DiskSpaceMonitor.*/
+    void rolloverRecording();
+
     bool keyPressed(const KeyPress& key);
 
 
@@ -1198,6 +1198,30 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
 
     currentFile = fileToUse;
 
+    XmlElement* xml = createSettingsXml();
+
+    if (! ConfigurationFile::saveFile(*xml, currentFile))
+        error = "Couldn't write to file ";
+    else
+        error = "Saved configuration as ";
+
+    error += currentFile.getFileName();
+
+	if (xmlText != nullptr)
+	{
+		(*xmlText) = xml->createDocument(String::empty);
+		if ((*xmlText).isEmpty())
+			(*xmlText) = "Couldn't create configuration xml";
+	}
+
+    delete xml;
+
+    return error;
+}
+
+XmlElement* EditorViewport::createSettingsXml()
+{
+
     // FileChooser fc("Choose the file to save...",
     //                CoreServices::getDefaultUserSaveDirectory(),
     //                "*",
@@ -1324,23 +1348,7 @@ const String EditorViewport::saveState(File fileToUse, String* xmlText)
     AccessClass::getProcessorList()->saveStateToXml(xml);
     AccessClass::getUIComponent()->saveStateToXml(xml);  // save the UI settings
 
-    if (! xml->writeToFile(currentFile, String::empty))
-        error = "Couldn't write to file ";
-    else
-        error = "Saved configuration as ";
-
-    error += currentFile.getFileName();
-
-	if (xmlText != nullptr)
-	{
-		(*xmlText) = xml->createDocument(String::empty);
-		if ((*xmlText).isEmpty())
-			(*xmlText) = "Couldn't create configuration xml";
-	}
-
-    delete xml;
-
-    return error;
+    return xml;
 }
 
 const String EditorViewport::loadState(File fileToLoad)
@@ -1366,8 +1374,7 @@ const String EditorViewport::loadState(File fileToLoad)
 
     Array<GenericProcessor*> splitPoints;
 
-    XmlDocument doc(currentFile);
-    XmlElement* xml = doc.getDocumentElement();
+    XmlElement* xml = ConfigurationFile::loadFile(currentFile);
 
     if (xml == 0 || ! xml->hasTagName("SETTINGS"))
     {
@@ -33,6 +33,7 @@
 #include "ControlPanel.h"
 #include "UIComponent.h"
 #include "DataViewport.h"
+#include "ConfigurationFile.h"
 
 class GenericEditor;
 class SignalChainTabButton;
@@ -146,15 +147,18 @@ public:
         return signalChainArray;
     }
 
-    /** Save the current configuration as an XML file. */
+    /** Save the current configuration, as XML or in binary if the file has the BINARY_CONFIG_EXTENSION. */
     const String saveState(File filename, String* xmlText = nullptr);
 
 	/** Save the current configuration as an XML file. Reference wrapper*/
 	const String saveState(File filename, String& xmlText);
 
-    /** Load a saved configuration from an XML file. */
+    /** Load a saved configuration from an XML or binary file. */
     const String loadState(File filename);
 
+    /** Builds the XML document of the current configuration, owned by the caller. */
+    XmlElement* createSettingsXml();
+
     /** Converts information about a given editor to XML. */
     XmlElement* createNodeXml(GenericProcessor*);
 
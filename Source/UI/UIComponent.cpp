@@ -33,6 +33,7 @@
 #include "../Processors/MessageCenter/MessageCenterEditor.h"
 #include "GraphViewer.h"
 #include "../Processors/ProcessorGraph/ProcessorGraph.h"
+#include "../Processors/Visualization/VisualizerScheduler.h"
 #include "../Audio/AudioComponent.h"
 #include "../MainWindow.h"
 
@@ -398,6 +399,7 @@ PopupMenu UIComponent::getMenuForIndex(int menuIndex, const String& menuName)
 		menu.addCommandItem(commandManager, toggleFileInfo);
 		menu.addSeparator();
 		menu.addCommandItem(commandManager, resizeWindow);
+		menu.addCommandItem(commandManager, showFrameTimes);
 
 	}
 	else if (menuIndex == 3)
@@ -440,7 +442,8 @@ void UIComponent::getAllCommands(Array <CommandID>& commands)
 		toggleFileInfo,
 		showHelp,
 		resizeWindow,
-		openTimestampSelectionWindow
+		openTimestampSelectionWindow,
+		showFrameTimes
 	};
 
 	commands.addArray(ids, numElementsInArray(ids));
@@ -537,6 +540,11 @@ void UIComponent::getCommandInfo(CommandID commandID, ApplicationCommandInfo& re
 			result.setInfo("Reset window bounds", "Reset window bounds", "General", 0);
 			break;
 
+		case showFrameTimes:
+			result.setInfo("Show frame times", "Show refresh timing of the visualizers.", "General", 0);
+			result.setTicked(VisualizerScheduler::getInstance()->isOverlayVisible());
+			break;
+
 		default:
 			break;
 	};
@@ -654,6 +662,13 @@ bool UIComponent::perform(const InvocationInfo& info)
 			mainWindow->centreWithSize(800, 600);
 			break;
 
+		case showFrameTimes:
+			{
+				VisualizerScheduler* scheduler = VisualizerScheduler::getInstance();
+				scheduler->setOverlayVisible(!scheduler->isOverlayVisible());
+				break;
+			}
+
 		case openTimestampSelectionWindow:
 			if (timestampWindow == nullptr)
 			{
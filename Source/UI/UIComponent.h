@@ -189,7 +189,8 @@ private:
         resizeWindow            = 0x2012,
         reloadOnStartup         = 0x2013,
         saveConfigurationAs     = 0x2014,
-		openTimestampSelectionWindow = 0x2015
+		openTimestampSelectionWindow = 0x2015,
+        showFrameTimes          = 0x2016
     };
 
     File currentConfigFile;
@@ -0,0 +1,225 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Times the audio monitor mix of the AudioNode on synthetic input, against
+    the path it replaced.
+
+    The old path resampled and filtered every monitored channel on its own,
+    one addFrom() per output sample. The new path (AudioNode::processGroup)
+    pans every channel of a source into one stereo pair, then resamples and
+    filters that pair once. Both are reproduced here on the same random
+    microvolt data, so only the mixing cost is measured.
+
+    Usage: AudioMonitorBenchmark [source rate] [sound card rate] [block size]
+*/
+
+#include "../Source/Processors/Dsp/Dsp.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    const float bitVolts = 0.195f;
+    const float volume = 1.0f;
+
+    /** Linear interpolation of one channel, sample by sample, as the old AudioNode did */
+    void oldPath(AudioSampleBuffer& buffer, AudioSampleBuffer& tempBuffer, OwnedArray<Dsp::Filter>& filters,
+                 int numChannels, int samplesExpected, int samplesAvailable, int valuesNeeded, double ratio)
+    {
+        buffer.clear(0, 0, valuesNeeded);
+        buffer.clear(1, 0, valuesNeeded);
+
+        const float gain = volume / (float(0x7fff) * bitVolts);
+
+        for (int i = 0; i < numChannels; i++)
+        {
+            tempBuffer.clear();
+            tempBuffer.addFrom(0, 0, buffer, i + 2, 0, jmin(samplesExpected, samplesAvailable), gain);
+
+            int sourceBufferPos = 0;
+            int nextPos = 1;
+            double subSampleOffset = 0.0;
+            int destBufferPos;
+
+            for (destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
+            {
+                const float alpha = (float) subSampleOffset;
+                const float invAlpha = 1.0f - alpha;
+
+                buffer.addFrom(0, destBufferPos, tempBuffer, 0, sourceBufferPos, 1, invAlpha);
+                buffer.addFrom(0, destBufferPos, tempBuffer, 0, nextPos, 1, alpha);
+
+                subSampleOffset += ratio;
+
+                while (subSampleOffset >= 1.0)
+                {
+                    if (++sourceBufferPos >= samplesExpected)
+                        sourceBufferPos = 0;
+
+                    nextPos = (sourceBufferPos + 1) % samplesExpected;
+                    subSampleOffset -= 1.0;
+                }
+            }
+
+            float* out = buffer.getWritePointer(0);
+            filters[i]->process(destBufferPos, &out);
+        }
+
+        buffer.addFrom(1, 0, buffer, 0, 0, valuesNeeded, 1.0f);
+    }
+
+    /** Stereo mix of every channel, then one resample and filter, as AudioNode::processGroup does */
+    void newPath(AudioSampleBuffer& buffer, AudioSampleBuffer& tempBuffer, AudioSampleBuffer& resampleBuffer,
+                 Dsp::Filter& filter, int numChannels, int samplesExpected, int samplesAvailable, int valuesNeeded, double ratio)
+    {
+        buffer.clear(0, 0, valuesNeeded);
+        buffer.clear(1, 0, valuesNeeded);
+
+        for (int side = 0; side < 2; side++)
+            tempBuffer.clear(side, 0, samplesExpected);
+
+        const float gain = volume / (float(0x7fff) * bitVolts);
+
+        for (int i = 0; i < numChannels; i++)
+        {
+            // constant power pan over the full width, as AudioNode::updatePan
+            const float x = (numChannels > 1) ? 2.0f * i / (numChannels - 1) - 1.0f : 0.0f;
+            const float angle = (x + 1.0f) * float_Pi * 0.25f;
+            const float sideGain[2] = { gain * std::sqrt(2.0f) * std::cos(angle), gain * std::sqrt(2.0f) * std::sin(angle) };
+
+            for (int side = 0; side < 2; side++)
+                tempBuffer.addFrom(side, 0, buffer, i + 2, 0, jmin(samplesExpected, samplesAvailable), sideGain[side]);
+        }
+
+        float* source[2] = { tempBuffer.getWritePointer(0), tempBuffer.getWritePointer(1) };
+        float* dest[2] = { resampleBuffer.getWritePointer(0), resampleBuffer.getWritePointer(1) };
+
+        if (ratio > 1.00001)
+            filter.process(samplesExpected, source);
+
+        int sourceBufferPos = 0;
+        int nextPos = 1 % samplesExpected;
+        double subSampleOffset = 0.0;
+
+        for (int destBufferPos = 0; destBufferPos < valuesNeeded; destBufferPos++)
+        {
+            const float alpha = (float) subSampleOffset;
+            const float invAlpha = 1.0f - alpha;
+
+            dest[0][destBufferPos] = invAlpha * source[0][sourceBufferPos] + alpha * source[0][nextPos];
+            dest[1][destBufferPos] = invAlpha * source[1][sourceBufferPos] + alpha * source[1][nextPos];
+
+            subSampleOffset += ratio;
+
+            while (subSampleOffset >= 1.0)
+            {
+                if (++sourceBufferPos >= samplesExpected)
+                    sourceBufferPos = 0;
+
+                nextPos = (sourceBufferPos + 1) % samplesExpected;
+                subSampleOffset -= 1.0;
+            }
+        }
+
+        if (ratio < 0.99999)
+            filter.process(valuesNeeded, dest);
+
+        buffer.addFrom(0, 0, resampleBuffer, 0, 0, valuesNeeded);
+        buffer.addFrom(1, 0, resampleBuffer, 1, 0, valuesNeeded);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double sourceRate = argc > 1 ? atof(argv[1]) : 30000.0;
+    const double destRate = argc > 2 ? atof(argv[2]) : 44100.0;
+    const int blockSize = argc > 3 ? atoi(argv[3]) : 1024;
+
+    if (sourceRate <= 0 || destRate <= 0 || blockSize <= 0)
+    {
+        printf("Usage: AudioMonitorBenchmark [source rate] [sound card rate] [block size]\n");
+        return 1;
+    }
+
+    // the same block geometry as AudioNode::recreateBuffers
+    const int samplesExpected = int(sourceRate / destRate * blockSize) + 1;
+    const int samplesAvailable = samplesExpected - 1;
+    const double ratio = double(samplesExpected) / blockSize;
+
+    // and the same filter as AudioNode::updateFilter
+    Dsp::Params params;
+    params[0] = ratio > 1.0 ? sourceRate : destRate;
+    params[1] = ratio > 1.0 ? 2 * destRate : destRate / 2;
+    params[2] = 1.25;
+
+    const int repetitions = 2000;
+    Random random(1);
+
+    printf("%.0f Hz source, %.0f Hz sound card, %d samples per block, %d blocks\n",
+           sourceRate, destRate, blockSize, repetitions);
+    printf("channels  old us/block  new us/block  speedup\n");
+
+    for (int numChannels : { 1, 4, 8, 16, 32, 64, 128 })
+    {
+        const int bufferSize = jmax(blockSize, samplesExpected);
+        AudioSampleBuffer buffer(numChannels + 2, bufferSize);
+        AudioSampleBuffer tempBuffer(2, jmax(4096, samplesExpected));
+        AudioSampleBuffer resampleBuffer(2, jmax(4096, blockSize));
+
+        OwnedArray<Dsp::Filter> filters;
+        for (int i = 0; i < numChannels; i++)
+        {
+            filters.add(new Dsp::SmoothedFilterDesign<Dsp::RBJ::Design::LowPass, 1>(1024));
+            filters.getLast()->setParams(params);
+        }
+
+        Dsp::SmoothedFilterDesign<Dsp::RBJ::Design::LowPass, 2> stereoFilter(1024);
+        stereoFilter.setParams(params);
+
+        // both paths overwrite the output channels only, the inputs are reused
+        for (int c = 2; c < numChannels + 2; c++)
+            for (int n = 0; n < bufferSize; n++)
+                buffer.setSample(c, n, random.nextFloat() * 200.0f - 100.0f);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int k = 0; k < repetitions; k++)
+            oldPath(buffer, tempBuffer, filters, numChannels, samplesExpected, samplesAvailable, blockSize, ratio);
+
+        const auto middle = std::chrono::steady_clock::now();
+
+        for (int k = 0; k < repetitions; k++)
+            newPath(buffer, tempBuffer, resampleBuffer, stereoFilter, numChannels, samplesExpected, samplesAvailable, blockSize, ratio);
+
+        const auto end = std::chrono::steady_clock::now();
+
+        const double oldTime = std::chrono::duration<double, std::micro>(middle - start).count() / repetitions;
+        const double newTime = std::chrono::duration<double, std::micro>(end - middle).count() / repetitions;
+
+        printf("%8d  %12.1f  %12.1f  %6.1fx\n", numChannels, oldTime, newTime, oldTime / newTime);
+    }
+
+    return 0;
+}
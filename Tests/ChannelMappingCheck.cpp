@@ -0,0 +1,135 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks how the Channel Map reads .prb files. A file as writePrbFile
+    saves it is read back in full, a minimal file gets the defaults, and
+    files with a single problem each must be rejected before anything is
+    applied.
+*/
+
+#include "../Plugins/ChannelMappingNode/ChannelMappingEditor.h"
+
+#include <iostream>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    // eight channels of a probe, saved after reordering and referencing them
+    const char* const sampleFile = R"({
+  "0": {
+    "mapping": [3, 1, 2, 4, 8, 7, 6, 5],
+    "reference": [0, 0, 0, 0, 1, 1, -1, -1],
+    "enabled": [true, true, false, true, true, true, true, false]
+  },
+  "refs": {
+    "channels": [2, 7, -1, -1]
+  },
+  "recording": {
+    "channels": [true, true, true, true, false, false, false, false]
+  }
+})";
+
+    String parse(const String& text, ChannelMappingEditor::PrbMap& map)
+    {
+        return ChannelMappingEditor::parsePrbFile(JSON::parse(text), map);
+    }
+
+    /** The sample file with one piece of text replaced */
+    String sampleWith(const String& original, const String& replacement)
+    {
+        const String text(sampleFile);
+        jassert(text.contains(original));
+        return text.replace(original, replacement);
+    }
+}
+
+int main()
+{
+    {
+        ChannelMappingEditor::PrbMap map;
+        const String error = parse(sampleFile, map);
+        expect(error.isEmpty(), "the sample file is valid, got \"" + error + "\"");
+
+        const int mapping[] = { 3, 1, 2, 4, 8, 7, 6, 5 };
+        const int reference[] = { 0, 0, 0, 0, 1, 1, -1, -1 };
+        const bool enabled[] = { true, true, false, true, true, true, true, false };
+
+        bool matches = map.mapping.size() == 8 && map.reference.size() == 8 && map.enabled.size() == 8;
+        for (int i = 0; matches && i < 8; i++)
+            matches = map.mapping[i] == mapping[i] && map.reference[i] == reference[i] && map.enabled[i] == enabled[i];
+        expect(matches, "mapping, references and enabled states are read per position");
+
+        expect(map.referenceChannels.size() == NUM_REFERENCES && map.referenceChannels[0] == 2 && map.referenceChannels[1] == 7
+            && map.referenceChannels[2] == -1 && map.referenceChannels[3] == -1, "reference channels are read");
+        expect(map.recording.size() == 8 && map.recording[0] && !map.recording[4], "record states are read");
+    }
+
+    // only the mapping is required
+    {
+        ChannelMappingEditor::PrbMap map;
+        const String error = parse("{ \"0\": { \"mapping\": [2, 1] } }", map);
+        expect(error.isEmpty(), "a file with only a mapping is valid, got \"" + error + "\"");
+        expect(map.reference.size() == 2 && map.reference[0] == -1 && map.reference[1] == -1, "channels default to no reference");
+        expect(map.enabled.size() == 2 && map.enabled[0] && map.enabled[1], "channels default to enabled");
+        expect(map.referenceChannels.size() == NUM_REFERENCES && map.referenceChannels[0] == -1, "reference groups default to no channel");
+        expect(map.recording.size() == 0, "record states are left alone");
+    }
+
+    struct Invalid
+    {
+        String text;
+        String description;
+    };
+
+    const Invalid invalidFiles[] = {
+        { "[1, 2]", "not an object" },
+        { "{ \"0\": { \"mapping\": [] } }", "an empty mapping" },
+        { sampleWith("[3, 1, 2, 4, 8, 7, 6, 5]", "[3, 1, 2, 4, 8, 7, 6, 3]"), "a channel mapped twice" },
+        { sampleWith("[3, 1, 2, 4, 8, 7, 6, 5]", "[3, 1, 2, 4, 8, 7, 6, 9]"), "a channel beyond the mapping" },
+        { sampleWith("[3, 1, 2, 4, 8, 7, 6, 5]", "[3, 1, 2, 4, 8, 7, 6, \"5\"]"), "a channel that is not a number" },
+        { sampleWith("[0, 0, 0, 0, 1, 1, -1, -1]", "[0, 0, 0, 0, 1, 1, -1]"), "a reference list shorter than the mapping" },
+        { sampleWith("[0, 0, 0, 0, 1, 1, -1, -1]", "[0, 0, 0, 0, 1, 4, -1, -1]"), "a reference group that does not exist" },
+        { sampleWith("[2, 7, -1, -1]", "[2, 8, -1, -1]"), "a reference channel beyond the mapping" },
+    };
+
+    for (const Invalid& file : invalidFiles)
+    {
+        ChannelMappingEditor::PrbMap map;
+        expect(parse(file.text, map).isNotEmpty(), "a file with " + file.description + " is rejected");
+    }
+
+    std::cout << (failures == 0 ? "all channel map checks passed" : "channel map checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks that binary configuration files hold exactly the XML they were
+    written from: every bundled configuration and a set of random documents
+    are written as binary, read back and compared. Truncated files must be
+    rejected rather than decoded.
+
+    Usage: ConfigurationFileCheck [configuration folder]
+*/
+
+#include "../Source/UI/ConfigurationFile.h"
+
+namespace
+{
+    String randomText(Random& random)
+    {
+        const char* pool[] = { "a", "<&>\"'", "\xc3\xbcn\xc3\xaf", "", "x y", "1.5", "\n\ttab" };
+
+        String text;
+        const int n = random.nextInt(4);
+
+        for (int i = 0; i < n; i++)
+            text << String::fromUTF8(pool[random.nextInt(7)]) << random.nextInt(5);
+
+        return text;
+    }
+
+    XmlElement* randomDocument(Random& random, int depth)
+    {
+        XmlElement* element = new XmlElement("T" + String(random.nextInt(20)));
+
+        const int numAttributes = random.nextInt(6);
+        for (int i = 0; i < numAttributes; i++)
+            element->setAttribute("a" + String(i), randomText(random));
+
+        if (depth < 6)
+        {
+            const int numChildren = random.nextInt(depth < 2 ? 40 : 6);
+
+            for (int i = 0; i < numChildren; i++)
+            {
+                if (random.nextInt(8) == 0)
+                    element->addChildElement(XmlElement::createTextElement(randomText(random) + "x"));
+                else
+                    element->addChildElement(randomDocument(random, depth + 1));
+            }
+        }
+
+        return element;
+    }
+
+    /** Returns the encoded size, or -1 if the document does not come back unchanged */
+    int64 roundTrip(const XmlElement& xml, MemoryOutputStream& output)
+    {
+        if (! ConfigurationFile::write(xml, output))
+            return -1;
+
+        MemoryInputStream input(output.getData(), output.getDataSize(), false);
+        ScopedPointer<XmlElement> decoded = ConfigurationFile::read(input);
+
+        if (decoded == nullptr || ! decoded->isEquivalentTo(&xml, false))
+            return -1;
+
+        return (int64) output.getDataSize();
+    }
+
+    int checkConfiguration(const File& file)
+    {
+        ScopedPointer<XmlElement> xml = XmlDocument::parse(file);
+
+        if (xml == nullptr)
+        {
+            std::cout << "FAIL " << file.getFileName() << ": not a valid XML file" << std::endl;
+            return 1;
+        }
+
+        MemoryOutputStream output;
+        const int64 size = roundTrip(*xml, output);
+
+        if (size < 0)
+        {
+            std::cout << "FAIL " << file.getFileName() << ": binary form differs from the XML" << std::endl;
+            return 1;
+        }
+
+        // through the same files the GUI saves and loads
+        TemporaryFile temp(BINARY_CONFIG_EXTENSION);
+        ScopedPointer<XmlElement> loaded;
+
+        if (ConfigurationFile::saveFile(*xml, temp.getFile()))
+            loaded = ConfigurationFile::loadFile(temp.getFile());
+
+        if (loaded == nullptr || ! ConfigurationFile::isBinaryFile(temp.getFile()) || ! loaded->isEquivalentTo(xml, false))
+        {
+            std::cout << "FAIL " << file.getFileName() << ": saved file does not load back" << std::endl;
+            return 1;
+        }
+
+        std::cout << "ok   " << file.getFileName() << ": " << file.getSize() << " bytes of XML, "
+                  << size << " bytes of binary" << std::endl;
+        return 0;
+    }
+
+    int checkRandomDocuments()
+    {
+        Random random(42);
+        int failures = 0;
+
+        for (int i = 0; i < 500; i++)
+        {
+            ScopedPointer<XmlElement> xml = randomDocument(random, i % 4);
+            MemoryOutputStream output;
+
+            if (roundTrip(*xml, output) < 0)
+            {
+                failures++;
+                continue;
+            }
+
+            for (int t = 0; t < 8; t++)
+            {
+                MemoryInputStream truncated(output.getData(), (size_t) random.nextInt((int) output.getDataSize()), false);
+                ScopedPointer<XmlElement> decoded = ConfigurationFile::read(truncated);
+
+                if (decoded != nullptr)
+                    failures++;
+            }
+        }
+
+        std::cout << (failures == 0 ? "ok   " : "FAIL ") << "500 random documents and their truncations: "
+                  << failures << " failures" << std::endl;
+        return failures;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const File folder = File::getCurrentWorkingDirectory().getChildFile(argc > 1 ? argv[1] : "Resources/Configs");
+
+    Array<File> configurations;
+    folder.findChildFiles(configurations, File::findFiles, false, "*.xml");
+
+    if (configurations.size() == 0)
+    {
+        std::cout << "FAIL no configurations in " << folder.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    int failures = 0;
+
+    for (int i = 0; i < configurations.size(); i++)
+        failures += checkConfiguration(configurations[i]);
+
+    failures += checkRandomDocuments();
+
+    return failures == 0 ? 0 : 1;
+}
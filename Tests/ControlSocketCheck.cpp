@@ -0,0 +1,126 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks where the Control Socket listens and who can connect to it. With
+    a runtime directory the socket is created there, only its owner may
+    connect, and commands sent through it are answered. Without one, it goes
+    to a folder of the temporary directory named after the user. Only built
+    on Linux and macOS, where the socket exists.
+*/
+
+#include "../Plugins/ControlSocket/ControlSocket.h"
+#include "../Plugins/ControlSocket/ControlServer.h"
+
+#include <iostream>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    /** Sends a command and returns the line it is answered with */
+    String sendCommand(int socket, const String& command)
+    {
+        const String line = command + "\n";
+        if (write(socket, line.toRawUTF8(), line.getNumBytesAsUTF8()) < 0)
+            return String();
+
+        String reply;
+        char c;
+        while (read(socket, &c, 1) == 1 && c != '\n')
+            reply += c;
+
+        return reply;
+    }
+}
+
+int main()
+{
+    const File runtimeDir = File::createTempFile("runtime");
+    runtimeDir.createDirectory();
+    chmod(runtimeDir.getFullPathName().toRawUTF8(), S_IRWXU);
+
+    setenv("XDG_RUNTIME_DIR", runtimeDir.getFullPathName().toRawUTF8(), 1);
+    const String path = ControlServer::getDefaultPath();
+    expect(path == runtimeDir.getChildFile(CONTROL_SOCKET_NAME).getFullPathName(), "the socket goes to the runtime directory, got " + path);
+
+    {
+        // the processor starts listening on the default path
+        ControlSocket processor;
+
+        for (int i = 0; i < 100 && processor.getServerStatus() != "Listening"; i++)
+            Thread::sleep(20);
+
+        expect(processor.getSocketPath() == path, "the processor listens on the default path");
+        expect(processor.getServerStatus() == "Listening", "the server listens, got \"" + processor.getServerStatus() + "\"");
+
+        struct stat info;
+        expect(stat(path.toRawUTF8(), &info) == 0 && S_ISSOCK(info.st_mode), "the socket file exists");
+        expect((info.st_mode & 0777) == (S_IRUSR | S_IWUSR), "only the owner can use the socket, mode " + String::formatted("%o", (unsigned int) (info.st_mode & 0777)));
+
+        sockaddr_un address;
+        zerostruct(address);
+        address.sun_family = AF_UNIX;
+        path.copyToUTF8(address.sun_path, sizeof(address.sun_path));
+
+        const int client = socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool connected = connect(client, (const sockaddr*) &address, sizeof(address)) == 0;
+        expect(connected, "the owner can connect");
+
+        if (connected)
+        {
+            expect(sendCommand(client, "Ping") == "OK", "Ping is answered");
+            expect(sendCommand(client, "IsAcquiring") == "OK 0", "the state is reported");
+            expect(sendCommand(client, "Bogus").startsWith("ERROR"), "unknown commands are refused");
+        }
+
+        close(client);
+    }
+
+    expect(! File(path).exists(), "the socket is removed when the processor goes away");
+
+    // without a runtime directory, a folder of the temporary directory that only the user can enter
+    unsetenv("XDG_RUNTIME_DIR");
+    const String fallback = ControlServer::getDefaultPath();
+    expect(fallback == "/tmp/open-ephys-" + String((int) getuid()) + "/" CONTROL_SOCKET_NAME,
+        "the socket goes to a folder of the user, got " + fallback);
+
+    runtimeDir.deleteRecursively();
+
+    std::cout << (failures == 0 ? "all control socket checks passed" : "control socket checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
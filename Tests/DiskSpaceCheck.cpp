@@ -0,0 +1,273 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the warning and rollover thresholds of the disk space monitor. The
+    DiskSpaceForecaster is stepped once per simulated second through recordings
+    onto made-up volumes, which shrink by what the record engines write, and
+    every action it returns is compared with the time that was really left.
+*/
+
+#include "../Source/Processors/RecordNode/DiskSpaceForecaster.h"
+
+#include <iostream>
+
+namespace
+{
+    const int64 megabyte = 1024 * 1024;
+    const int64 gigabyte = 1024 * megabyte;
+
+    /** Volumes that only change when the check writes to them */
+    class SimulatedVolumes : public DiskSpaceForecaster::VolumeInfo
+    {
+    public:
+        void addVolume(const File& directory, int64 totalBytes, int64 bytesFree)
+        {
+            volumes.set(directory.getFullPathName(), Volume(totalBytes, bytesFree));
+        }
+
+        void write(const File& directory, int64 bytes)
+        {
+            Volume volume = volumes[directory.getFullPathName()];
+            volume.bytesFree = jmax((int64) 0, volume.bytesFree - bytes);
+            volumes.set(directory.getFullPathName(), volume);
+        }
+
+        int64 getBytesFree(const File& directory) const override
+        {
+            return volumes[directory.getFullPathName()].bytesFree;
+        }
+
+        int64 getTotalBytes(const File& directory) const override
+        {
+            return volumes[directory.getFullPathName()].totalBytes;
+        }
+
+    private:
+        struct Volume
+        {
+            Volume(int64 total = 0, int64 free = 0) : totalBytes(total), bytesFree(free) {}
+            int64 totalBytes;
+            int64 bytesFree;
+        };
+
+        HashMap<String, Volume> volumes;
+    };
+
+    /** Seconds of recording left above the reserve the forecaster keeps */
+    double secondsLeft(const SimulatedVolumes& volumes, const File& directory, int64 bytesPerSecond)
+    {
+        const int64 reserve = jmin((int64) 256 * megabyte, volumes.getTotalBytes(directory) / 100);
+        return double(volumes.getBytesFree(directory) - reserve) / bytesPerSecond;
+    }
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    struct Recording
+    {
+        int warnings = 0;
+        int fullWarnings = 0;
+        int rollovers = 0;
+        double leftAtWarning = -1;
+        double leftAtFullWarning = -1;
+        double leftAtRollover = -1;
+        int seconds = 0;
+    };
+
+    /** Records at a constant rate until the data volume is full, or the rollover happens */
+    Recording record(DiskSpaceForecaster& forecaster, SimulatedVolumes& volumes, int64& bytesWritten,
+        const File& directory, const File& rolloverDirectory, int64 bytesPerSecond)
+    {
+        Recording recording;
+
+        while (volumes.getBytesFree(directory) > 0 && recording.rollovers == 0)
+        {
+            volumes.write(directory, bytesPerSecond);
+            bytesWritten += bytesPerSecond;
+            recording.seconds++;
+
+            const double left = secondsLeft(volumes, directory, bytesPerSecond);
+
+            switch (forecaster.update(1.0, bytesWritten, true, directory, rolloverDirectory))
+            {
+                case DiskSpaceForecaster::WARN_SPACE_LOW:
+                    recording.warnings++;
+                    recording.leftAtWarning = left;
+                    break;
+                case DiskSpaceForecaster::WARN_DISK_FULL:
+                    recording.fullWarnings++;
+                    recording.leftAtFullWarning = left;
+                    break;
+                case DiskSpaceForecaster::ROLLOVER:
+                    recording.rollovers++;
+                    recording.leftAtRollover = left;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        return recording;
+    }
+
+    /** True if an action came at the first second below its threshold */
+    bool isAtThreshold(double secondsLeftThen, double threshold)
+    {
+        return secondsLeftThen < threshold && secondsLeftThen >= threshold - 1.0;
+    }
+}
+
+int main()
+{
+    const File data("/simulated/data");
+    const File spare("/simulated/spare");
+    const File small("/simulated/small");
+    const int64 rate = 20 * megabyte;
+
+    // idle: no rate, no forecast and no action
+    {
+        SimulatedVolumes volumes;
+        volumes.addVolume(data, 100 * gigabyte, 10 * gigabyte);
+        DiskSpaceForecaster forecaster(&volumes);
+
+        bool quiet = true;
+        for (int t = 0; t < 100; t++)
+            quiet = quiet && forecaster.update(1.0, 0, false, data, File()) == DiskSpaceForecaster::NO_ACTION;
+
+        expect(quiet, "idle monitor returns no action");
+        expect(forecaster.getForecast().secondsToFull < 0, "idle forecast has no time to full");
+        expect(forecaster.getForecast().bytesFree == 10 * gigabyte, "idle forecast reads the free space");
+    }
+
+    // no rollover directory: a low space warning at 600 s, then a full warning at 60 s
+    {
+        SimulatedVolumes volumes;
+        volumes.addVolume(data, 100 * gigabyte, 30 * gigabyte);
+        DiskSpaceForecaster forecaster(&volumes);
+        int64 bytesWritten = 0;
+        forecaster.update(1.0, bytesWritten, false, data, File());
+
+        const Recording recording = record(forecaster, volumes, bytesWritten, data, File(), rate);
+
+        expect(recording.warnings == 1, "one low space warning, got " + String(recording.warnings));
+        expect(isAtThreshold(recording.leftAtWarning, DISK_WARNING_SECONDS),
+            "low space warning at " + String(DISK_WARNING_SECONDS) + " s, got " + String(recording.leftAtWarning));
+        expect(recording.fullWarnings == 1, "one full warning, got " + String(recording.fullWarnings));
+        expect(isAtThreshold(recording.leftAtFullWarning, DISK_ROLLOVER_SECONDS),
+            "full warning at " + String(DISK_ROLLOVER_SECONDS) + " s, got " + String(recording.leftAtFullWarning));
+        expect(recording.rollovers == 0, "no rollover without a rollover directory");
+    }
+
+    // a larger rollover volume: the recording moves at 60 s instead of the full warning
+    {
+        SimulatedVolumes volumes;
+        volumes.addVolume(data, 100 * gigabyte, 30 * gigabyte);
+        volumes.addVolume(spare, 100 * gigabyte, 80 * gigabyte);
+        DiskSpaceForecaster forecaster(&volumes);
+        int64 bytesWritten = 0;
+
+        const Recording recording = record(forecaster, volumes, bytesWritten, data, spare, rate);
+
+        expect(recording.warnings == 1, "one low space warning before the rollover, got " + String(recording.warnings));
+        expect(recording.rollovers == 1, "one rollover, got " + String(recording.rollovers));
+        expect(isAtThreshold(recording.leftAtRollover, DISK_ROLLOVER_SECONDS),
+            "rollover at " + String(DISK_ROLLOVER_SECONDS) + " s, got " + String(recording.leftAtRollover));
+        expect(recording.fullWarnings == 0, "no full warning when the rollover happens");
+        expect(forecaster.getRolloverForecast().secondsToFull > DISK_WARNING_SECONDS,
+            "the rollover forecast uses the same rate: " + DiskSpaceForecaster::describe(forecaster.getRolloverForecast()));
+
+        // the recording continues on the spare volume, which starts without warnings
+        const Recording continued = record(forecaster, volumes, bytesWritten, spare, File(), rate);
+        expect(continued.warnings == 1 && continued.fullWarnings == 1,
+            "the rollover directory warns again, got " + String(continued.warnings) + " and " + String(continued.fullWarnings));
+    }
+
+    // a rollover volume that is already down to its reserve does not take over
+    {
+        SimulatedVolumes volumes;
+        volumes.addVolume(data, 100 * gigabyte, 30 * gigabyte);
+        volumes.addVolume(small, 1 * gigabyte, 10 * megabyte);
+        DiskSpaceForecaster forecaster(&volumes);
+        int64 bytesWritten = 0;
+
+        const Recording recording = record(forecaster, volumes, bytesWritten, data, small, rate);
+
+        expect(recording.rollovers == 0, "no rollover to a full volume");
+        expect(recording.fullWarnings == 1, "full warning when the rollover volume is full");
+    }
+
+    // stopping resets the warnings, so the next recording is warned again
+    {
+        SimulatedVolumes volumes;
+        volumes.addVolume(data, 100 * gigabyte, 12 * gigabyte + 300 * megabyte);
+        DiskSpaceForecaster forecaster(&volumes);
+        int64 bytesWritten = 0;
+        int warnings = 0;
+
+        for (int take = 0; take < 2; take++)
+        {
+            for (int t = 0; t < 60; t++)
+            {
+                volumes.write(data, rate);
+                bytesWritten += rate;
+                if (forecaster.update(1.0, bytesWritten, true, data, File()) == DiskSpaceForecaster::WARN_SPACE_LOW)
+                    warnings++;
+            }
+
+            forecaster.update(1.0, bytesWritten, false, data, File());
+            expect(forecaster.getForecast().secondsToFull < 0, "a stopped recording has no forecast");
+        }
+
+        expect(warnings == 2, "each recording is warned once, got " + String(warnings));
+    }
+
+    // other programs writing to the volume count as well
+    {
+        SimulatedVolumes volumes;
+        volumes.addVolume(data, 100 * gigabyte, 30 * gigabyte);
+        DiskSpaceForecaster forecaster(&volumes);
+
+        for (int t = 0; t < 100; t++)
+        {
+            volumes.write(data, rate);
+            forecaster.update(1.0, 0, true, data, File());
+        }
+
+        const double estimate = forecaster.getForecast().bytesPerSecond;
+        expect(std::abs(estimate - rate) < 0.001 * rate,
+            "the drop of free space sets the rate, got " + File::descriptionOfSizeInBytes((int64) estimate) + "/s");
+    }
+
+    std::cout << (failures == 0 ? "all disk space checks passed" : "disk space checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
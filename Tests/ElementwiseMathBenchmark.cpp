@@ -0,0 +1,145 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Throughput of the ElementwiseMath kernels against the Rectifier, on
+    random microvolt data.
+
+    Every pass reads one buffer and writes another, so the data stays the
+    same from pass to pass and no kernel slows down on denormals or NaNs.
+    The best of several trials is reported, in samples per second.
+
+    Usage: ElementwiseMathBenchmark [channels] [samples per block]
+*/
+
+#include "../Plugins/ElementwiseMath/ElementwiseKernels.h"
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+
+namespace
+{
+    typedef std::function<void (float*, const float*, int)> Kernel;
+
+    /** The loop of Rectifier::process, for one channel */
+    void rectify (float* dest, const float* source, int numSamples)
+    {
+        for (int n = 0; n < numSamples; ++n)
+            *(dest + n) = fabsf (*(source + n));
+    }
+
+    double measure (const AudioSampleBuffer& input, AudioSampleBuffer& output, const Kernel& kernel)
+    {
+        const int numChannels = input.getNumChannels();
+        const int numSamples = input.getNumSamples();
+        const int blocks = jmax (1, 100000000 / (numChannels * numSamples) / 20);
+
+        double best = 0;
+
+        for (int trial = 0; trial < 20; ++trial)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            for (int block = 0; block < blocks; ++block)
+                for (int ch = 0; ch < numChannels; ++ch)
+                    kernel (output.getWritePointer (ch), input.getReadPointer (ch), numSamples);
+
+            const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+            best = jmax (best, double (numChannels) * numSamples * blocks / seconds);
+        }
+
+        return best;
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    const int numChannels = argc > 1 ? atoi (argv[1]) : 64;
+    const int numSamples = argc > 2 ? atoi (argv[2]) : 1024;
+
+    if (numChannels <= 0 || numSamples <= 0)
+    {
+        printf ("Usage: ElementwiseMathBenchmark [channels] [samples per block]\n");
+        return 1;
+    }
+
+    AudioSampleBuffer input (numChannels, numSamples);
+    AudioSampleBuffer output (numChannels, numSamples);
+    Random random (1);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int n = 0; n < numSamples; ++n)
+            input.setSample (ch, n, random.nextFloat() * 200.0f - 100.0f);
+
+    const double rectifier = measure (input, output, rectify);
+
+    struct Operation { const char* name; Kernel kernel; };
+    const Operation operations[] =
+    {
+        { "abs(x)",  ElementwiseKernels::abs },
+        { "x^2",     ElementwiseKernels::square },
+        { "ln(x)",   ElementwiseKernels::log },
+        { "clip(x)", [] (float* d, const float* s, int n) { ElementwiseKernels::clip (d, s, -50.0f, 50.0f, n); } },
+        { "a*x+b",   [] (float* d, const float* s, int n) { ElementwiseKernels::scaleOffset (d, s, 2.0f, 1.0f, n); } },
+        { "x >= T",  [] (float* d, const float* s, int n) { ElementwiseKernels::threshold (d, s, 0.5f, n); } },
+        { "std::log", [] (float* d, const float* s, int n)
+            {
+                for (int i = 0; i < n; ++i)
+                    d[i] = std::log (jmax (s[i], std::numeric_limits<float>::min()));
+            } }
+    };
+
+    printf ("%d channels of %d samples\n", numChannels, numSamples);
+    printf ("operation   Gsamples/s   vs Rectifier\n");
+    printf ("%-10s  %10.2f   %10.2fx\n", "Rectifier", rectifier / 1e9, 1.0);
+
+    for (const Operation& op : operations)
+    {
+        const double rate = measure (input, output, op.kernel);
+        printf ("%-10s  %10.2f   %10.2fx\n", op.name, rate / 1e9, rate / rectifier);
+    }
+
+    // accuracy of the polynomial log over the range of normal floats
+    float largestError = 0;
+
+    for (int i = 0; i < 1000003; ++i)
+    {
+        float x[7], y[7];
+
+        for (int j = 0; j < 7; ++j)
+            x[j] = std::exp (random.nextFloat() * 170.0f - 85.0f);
+
+        ElementwiseKernels::log (y, x, 7);
+
+        for (int j = 0; j < 7; ++j)
+        {
+            const float reference = std::log (x[j]);
+            largestError = jmax (largestError, std::abs (y[j] - reference) / jmax (1e-3f, std::abs (reference)));
+        }
+    }
+
+    printf ("ln(x) largest relative error against std::log: %.3g\n", largestError);
+
+    return 0;
+}
@@ -0,0 +1,177 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the string table shared by the channel info objects. Strings and
+    histories are interned from several threads at once, and every thread
+    must get the same ids and read back the same text. A simulated source
+    then goes through two processors, and the names and histories of the
+    channels must read as they did when every channel kept its own strings.
+*/
+
+#include "SimulatedSource.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    const int numThreads = 8;
+    const int numNames = 50;
+    const int historyLength = 6;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    /** A processor that passes its input through */
+    class Relay : public GenericProcessor
+    {
+    public:
+        Relay(const String& name) : GenericProcessor(name)
+        {
+            setProcessorType(PROCESSOR_TYPE_FILTER);
+        }
+
+        void process(AudioSampleBuffer&) override {}
+    };
+
+    /** The ids one thread got for every name and for the history of names i, i+1, ... */
+    struct Interned
+    {
+        std::vector<uint32> names;
+        std::vector<uint32> histories;
+    };
+
+    void internAll(int seed, Interned& result)
+    {
+        Random random(seed);
+        result.names.assign(numNames, 0);
+        result.histories.assign(numNames, 0);
+
+        // every thread visits the names in its own order
+        for (int n = 0; n < numNames * 4; n++)
+        {
+            const int i = random.nextInt(numNames);
+            result.names[i] = InfoStringTable::intern("processor " + String(i));
+
+            uint32 history = 0;
+            for (int k = 0; k < historyLength; k++)
+                history = InfoStringTable::extendHistory(history, InfoStringTable::intern("processor " + String((i + k) % numNames)));
+
+            result.histories[i] = history;
+        }
+
+        for (int i = 0; i < numNames; i++)
+            result.names[i] = InfoStringTable::intern("processor " + String(i));
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    expect(InfoStringTable::intern(String::empty) == 0, "the empty string has id 0");
+    expect(InfoStringTable::getHistory(0).isEmpty(), "history 0 is empty");
+
+    std::vector<Interned> interned(numThreads);
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < numThreads; t++)
+        threads.push_back(std::thread(internAll, t + 1, std::ref(interned[t])));
+
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    for (int i = 0; i < numNames; i++)
+    {
+        const String name = "processor " + String(i);
+        const uint32 id = interned[0].names[i];
+
+        expect(id != 0 && InfoStringTable::get(id) == name, name + " reads back");
+
+        StringArray entries;
+        for (int k = 0; k < historyLength; k++)
+            entries.add("processor " + String((i + k) % numNames));
+
+        for (int t = 0; t < numThreads; t++)
+        {
+            expect(interned[t].names[i] == id, "thread " + String(t) + " got the same id for " + name);
+
+            if (interned[t].histories[i] != 0)
+                expect(InfoStringTable::getHistory(interned[t].histories[i]) == entries.joinIntoString(" -> "),
+                       "thread " + String(t) + " history from " + name);
+        }
+
+        for (int j = 0; j < i; j++)
+            expect(interned[0].names[j] != id, name + " and processor " + String(j) + " have different ids");
+    }
+
+    SimulatedSource source;
+    Relay first("First Relay");
+    Relay second("Second Relay");
+
+    Array<GenericProcessor*> chain;
+    chain.add(&first);
+    chain.add(&second);
+    source.connect(chain);
+
+    expect(second.getTotalDataChannels() == 1, "the continuous channel reaches the end of the chain");
+
+    if (second.getTotalDataChannels() == 1)
+    {
+        const DataChannel* channel = second.getDataChannel(0);
+        const DataChannel* original = source.getDataChannel(0);
+
+        expect(channel->getCurrentNodeName() == "Second Relay", "current node name, got " + channel->getCurrentNodeName());
+        expect(channel->getCurrentNodeType() == "Second Relay", "current node type, got " + channel->getCurrentNodeType());
+        expect(channel->getSourceName() == "Simulated Source", "source name, got " + channel->getSourceName());
+
+        // each processor appends its name, as addToHistoricString did
+        DataChannel expected(*original);
+        expected.addToHistoricString("First Relay");
+        expected.addToHistoricString("Second Relay");
+
+        String text = original->getHistoricString();
+        text = text.isEmpty() ? "First Relay" : text + " -> First Relay";
+        text += " -> Second Relay";
+
+        expect(channel->getHistoricString() == text, "history, got " + channel->getHistoricString());
+        expect(expected.getHistoricString() == text, "addToHistoricString history, got " + expected.getHistoricString());
+    }
+
+    if (failures == 0)
+        std::cout << "all info string table checks passed" << std::endl;
+    else
+        std::cout << failures << " info string table checks failed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
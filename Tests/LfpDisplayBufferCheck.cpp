@@ -0,0 +1,179 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the half-precision conversions of the LFP display history. Bulk
+    conversions, which take the vector path where the build has one, must
+    give the same bits as converting one sample at a time, which always takes
+    the scalar path. Every half value is decoded, and floats at, next to and
+    halfway between every pair of halves are encoded, along with values
+    beyond the half range and random bit patterns.
+*/
+
+#include "../Plugins/LfpDisplayNode/LfpDisplayBuffer.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace LfpViewer;
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    uint32 floatBits(float value)
+    {
+        uint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float floatFromBits(uint32 bits)
+    {
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    float decodeOne(uint16 half)
+    {
+        float value;
+        LfpDisplayBuffer::halfToFloat(&half, &value, 1);
+        return value;
+    }
+
+    uint16 encodeOne(float value)
+    {
+        uint16 half;
+        LfpDisplayBuffer::floatToHalf(&value, &half, 1);
+        return half;
+    }
+
+    String hex(uint32 bits)
+    {
+        return "0x" + String::toHexString((int) bits);
+    }
+}
+
+int main()
+{
+    const int numHalves = 0x10000;
+
+    // decoding: every half, in bulk and one by one
+    HeapBlock<uint16> halves(numHalves);
+    for (int h = 0; h < numHalves; h++)
+        halves[h] = (uint16) h;
+
+    HeapBlock<float> decoded(numHalves);
+    LfpDisplayBuffer::halfToFloat(halves, decoded, numHalves);
+
+    int decodeMismatches = 0;
+    for (int h = 0; h < numHalves; h++)
+    {
+        if (floatBits(decoded[h]) != floatBits(decodeOne((uint16) h)) && decodeMismatches++ == 0)
+            expect(false, "half " + hex(h) + " decodes to " + hex(floatBits(decoded[h])) + " in bulk, "
+                + hex(floatBits(decodeOne((uint16) h))) + " alone");
+    }
+    expect(decodeMismatches == 0, String(decodeMismatches) + " halves decode differently in bulk");
+
+    expect(decoded[0x3c00] == 1.0f, "0x3c00 is 1");
+    expect(decoded[0x0001] == std::ldexp(1.0f, -24), "0x0001 is the smallest subnormal");
+    expect(decoded[0x7bff] == 65504.0f, "0x7bff is the largest finite half");
+    expect(std::isinf(decoded[0xfc00]) && decoded[0xfc00] < 0, "0xfc00 is minus infinity");
+    expect(std::isnan(decoded[0x7e00]), "0x7e00 is NaN");
+
+    // encoding: each finite half, its neighbouring floats, and the floats around the
+    // rounding midpoint to the next half, where round to nearest even decides
+    Array<float> inputs;
+    for (int h = 0; h < numHalves; h++)
+    {
+        const float value = decoded[h];
+        if (! std::isfinite(value))
+            continue;
+
+        const uint32 bits = floatBits(value);
+        inputs.add(value);
+        inputs.add(floatFromBits(bits + 1));
+        if ((bits & 0x7fffffff) != 0)
+            inputs.add(floatFromBits(bits - 1));
+
+        const float next = decoded[(h + 1) & 0xffff];
+        if (std::isfinite(next) && (h & 0x7fff) != 0x7fff)
+        {
+            const float midpoint = (float) (((double) value + (double) next) / 2.0);
+            inputs.add(midpoint);
+            inputs.add(floatFromBits(floatBits(midpoint) + 1));
+            inputs.add(floatFromBits(floatBits(midpoint) - 1));
+        }
+    }
+
+    const float specials[] = { 65504.0f, 65519.0f, 65520.0f, 1.0e6f, -1.0e6f, 3.0e38f,
+                               std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+                               std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min(),
+                               std::ldexp(1.0f, -25), std::ldexp(3.0f, -25), 1.0e-8f, 0.0f, -0.0f };
+    for (float value : specials)
+        inputs.add(value);
+
+    Random random(42);
+    for (int i = 0; i < 1000000; i++)
+        inputs.add(floatFromBits((uint32) random.nextInt()));
+
+    HeapBlock<uint16> encoded(inputs.size());
+    LfpDisplayBuffer::floatToHalf(inputs.getRawDataPointer(), encoded, inputs.size());
+
+    int encodeMismatches = 0;
+    for (int i = 0; i < inputs.size(); i++)
+    {
+        const uint16 alone = encodeOne(inputs[i]);
+        if (encoded[i] != alone && encodeMismatches++ == 0)
+            expect(false, "float " + hex(floatBits(inputs[i])) + " encodes to " + hex(encoded[i]) + " in bulk, "
+                + hex(alone) + " alone");
+    }
+    expect(encodeMismatches == 0, String(encodeMismatches) + " of " + String(inputs.size()) + " floats encode differently in bulk");
+
+    int roundTripFailures = 0;
+    for (int h = 0; h < numHalves; h++)
+    {
+        if (! std::isnan(decoded[h]) && ! std::isinf(decoded[h]) && encodeOne(decoded[h]) != h)
+            roundTripFailures++;
+    }
+    expect(roundTripFailures == 0, String(roundTripFailures) + " finite halves do not survive a round trip");
+
+    expect(encodeOne(65520.0f) == 0x7bff && encodeOne(-1.0e6f) == 0xfbff, "values beyond the half range saturate");
+    expect(encodeOne(std::ldexp(1.0f, -25)) == 0x0000, "half the smallest subnormal rounds to even, to zero");
+    expect(encodeOne(std::ldexp(3.0f, -25)) == 0x0002, "one and a half subnormals round to even, to two");
+    expect(encodeOne(std::numeric_limits<float>::quiet_NaN()) == 0x7e00, "NaN stays NaN");
+
+    std::cout << (failures == 0 ? "all LFP display buffer checks passed" : "LFP display buffer checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
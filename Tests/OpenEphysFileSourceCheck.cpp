@@ -0,0 +1,171 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the Open Ephys format file source. Two .continuous files are
+    written the way OriginalRecording writes them, with a pause in
+    acquisition between two records and an incomplete record at the end,
+    and the samples, ranges and timestamps read back are compared with what
+    was written.
+*/
+
+#include "../Source/Processors/FileReader/OpenEphysFileSource/OpenEphysFileSource.h"
+
+#include <iostream>
+
+namespace
+{
+    const int blockLength = 1024;
+    const int numChannels = 2;
+    const float sampleRate = 30000.0f;
+    const float bitVolts = 0.195f;
+
+    // acquisition paused after the second record
+    const juce::int64 blockTimestamps[] = { 5000, 6024, 9000 };
+    const int numBlocks = 3;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    int16 sampleValue(int channel, juce::int64 sample)
+    {
+        return int16((channel + 1) * 1000 - int(sample % 2000));
+    }
+
+    void writeChannel(const File& file, int channel)
+    {
+        String header;
+        header << "header.format = 'Open Ephys Data Format';\n"
+               << "header.version = 0.4;\n"
+               << "header.header_bytes = 1024;\n"
+               << "header.channel = 'CH" << (channel + 1) << "';\n"
+               << "header.channelType = 'Continuous';\n"
+               << "header.sampleRate = " << int(sampleRate) << ";\n"
+               << "header.blockLength = 1024;\n"
+               << "header.bufferSize = 1024;\n"
+               << "header.bitVolts = 0.195;\n";
+
+        MemoryOutputStream data;
+        data.write(header.toRawUTF8(), header.getNumBytesAsUTF8());
+        data.writeRepeatedByte(' ', 1024 - header.getNumBytesAsUTF8());
+
+        for (int b = 0; b <= numBlocks; b++)
+        {
+            data.writeInt64(b < numBlocks ? blockTimestamps[b] : blockTimestamps[numBlocks - 1] + blockLength);
+            data.writeShort(blockLength);
+            data.writeShort(0);
+
+            // the last record was cut off before its samples were written
+            if (b == numBlocks)
+            {
+                data.writeShortBigEndian(1);
+                break;
+            }
+
+            for (int i = 0; i < blockLength; i++)
+                data.writeShortBigEndian(sampleValue(channel, b * blockLength + i));
+
+            const uint8 marker[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 255 };
+            data.write(marker, sizeof(marker));
+        }
+
+        file.replaceWithData(data.getData(), data.getDataSize());
+    }
+}
+
+int main()
+{
+    const File folder = File::createTempFile("openephys");
+    folder.createDirectory();
+
+    for (int c = 0; c < numChannels; c++)
+        writeChannel(folder.getChildFile("100_CH" + String(c + 1) + ".continuous"), c);
+
+    {
+        OpenEphysSource::OpenEphysFileSource source;
+        expect(source.OpenFile(folder.getChildFile("100_CH1.continuous")), "the continuous file opens");
+        expect(source.getNumRecords() == 1, "one record, got " + String(source.getNumRecords()));
+
+        if (source.getNumRecords() == 1)
+        {
+            source.setActiveRecord(0);
+
+            expect(source.getRecordNumChannels(0) == numChannels, "both channels of the processor are read");
+            expect(source.getRecordSampleRate(0) == sampleRate, "the sample rate comes from the header");
+            expect(source.getRecordNumSamples(0) == numBlocks * blockLength,
+                "the incomplete record is dropped, got " + String(source.getRecordNumSamples(0)) + " samples");
+
+            // across the boundary of two records
+            const int start = blockLength - 5;
+            const int count = 10;
+            HeapBlock<int16> buffer(count * numChannels);
+            expect(source.readRecordDataAt(0, buffer, start, count) == count, "a window across two records is read");
+
+            bool samplesMatch = true;
+            for (int i = 0; i < count; i++)
+                for (int c = 0; c < numChannels; c++)
+                    samplesMatch &= buffer[i * numChannels + c] == sampleValue(c, start + i);
+            expect(samplesMatch, "samples are byte swapped and interleaved");
+
+            expect(source.readRecordDataAt(0, buffer, numBlocks * blockLength - 4, count) == 4,
+                "reads stop at the last complete record");
+
+            // the overview range of the first record, in microvolts
+            float mins[numChannels];
+            float maxs[numChannels];
+            source.getRecordMinMax(0, 0, blockLength, mins, maxs);
+
+            for (int c = 0; c < numChannels; c++)
+            {
+                expect(mins[c] == sampleValue(c, blockLength - 1) * bitVolts && maxs[c] == sampleValue(c, 0) * bitVolts,
+                    "channel " + String(c + 1) + " ranges over the samples of the record");
+            }
+
+            for (int b = 0; b < numBlocks; b++)
+            {
+                for (int offset : { 0, 1, blockLength - 1 })
+                {
+                    const juce::int64 sample = b * blockLength + offset;
+                    const juce::int64 timestamp = source.getRecordTimestamp(0, sample);
+                    expect(timestamp == blockTimestamps[b] + offset,
+                        "sample " + String(sample) + " has timestamp " + String(blockTimestamps[b] + offset)
+                        + ", got " + String(timestamp));
+                }
+            }
+        }
+    }
+
+    folder.deleteRecursively();
+
+    std::cout << (failures == 0 ? "all Open Ephys file source checks passed" : "Open Ephys file source checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
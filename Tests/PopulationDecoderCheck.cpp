@@ -0,0 +1,371 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the Population Decoder. Linear and Kalman models are loaded from
+    JSON and stepped against a double precision reference: the Kalman gain
+    found by iterating the Riccati equation must give the same states as a
+    full Kalman filter once its covariance has converged. Malformed models
+    must be rejected. Then feature vectors are sent through the processor as
+    events, and every decoded state it sends is deserialized and compared.
+*/
+
+#include "SimulatedSource.h"
+#include "../Plugins/PopulationDecoder/PopulationDecoder.h"
+
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    typedef std::vector<double> Matrix;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    File writeModel(const String& json)
+    {
+        File file = File::getSpecialLocation(File::tempDirectory).getNonexistentChildFile("decoder", ".json");
+        file.replaceWithText(json);
+        return file;
+    }
+
+    String loadModel(DecoderModel& model, const String& json)
+    {
+        File file = writeModel(json);
+        String error = model.loadFromFile(file);
+        file.deleteFile();
+        return error;
+    }
+
+    /** C = A * B, with A n x k and B k x m */
+    Matrix product(const Matrix& a, const Matrix& b, int n, int k, int m)
+    {
+        Matrix c((size_t) n * m, 0.0);
+
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < m; j++)
+                for (int l = 0; l < k; l++)
+                    c[i * m + j] += a[i * k + l] * b[l * m + j];
+
+        return c;
+    }
+
+    Matrix transpose(const Matrix& a, int rows, int columns)
+    {
+        Matrix t((size_t) rows * columns);
+
+        for (int i = 0; i < rows; i++)
+            for (int j = 0; j < columns; j++)
+                t[j * rows + i] = a[i * columns + j];
+
+        return t;
+    }
+
+    /** Inverse of an n x n matrix by Gauss-Jordan elimination with partial pivoting */
+    Matrix inverse(Matrix a, int n)
+    {
+        Matrix inv((size_t) n * n, 0.0);
+        for (int i = 0; i < n; i++)
+            inv[i * n + i] = 1.0;
+
+        for (int col = 0; col < n; col++)
+        {
+            int pivot = col;
+            for (int r = col + 1; r < n; r++)
+                if (std::abs(a[r * n + col]) > std::abs(a[pivot * n + col]))
+                    pivot = r;
+
+            for (int j = 0; j < n; j++)
+            {
+                std::swap(a[col * n + j], a[pivot * n + j]);
+                std::swap(inv[col * n + j], inv[pivot * n + j]);
+            }
+
+            const double d = a[col * n + col];
+            for (int j = 0; j < n; j++)
+            {
+                a[col * n + j] /= d;
+                inv[col * n + j] /= d;
+            }
+
+            for (int r = 0; r < n; r++)
+            {
+                if (r == col)
+                    continue;
+
+                const double f = a[r * n + col];
+                for (int j = 0; j < n; j++)
+                {
+                    a[r * n + j] -= f * a[col * n + j];
+                    inv[r * n + j] -= f * inv[col * n + j];
+                }
+            }
+        }
+
+        return inv;
+    }
+
+    /** A full Kalman filter, whose gain is recomputed at every step */
+    struct KalmanFilter
+    {
+        KalmanFilter(const Matrix& A_, const Matrix& W_, const Matrix& H_, const Matrix& Q_, int m_, int n_)
+            : A(A_), W(W_), H(H_), Q(Q_), m(m_), n(n_), x((size_t) m_, 0.0), P(W_)
+        {
+        }
+
+        void step(const Matrix& y)
+        {
+            const Matrix xp = product(A, x, m, m, 1);
+
+            Matrix Pp = product(product(A, P, m, m, m), transpose(A, m, m), m, m, m);
+            for (size_t i = 0; i < Pp.size(); i++)
+                Pp[i] += W[i];
+
+            const Matrix Ht = transpose(H, n, m);
+            Matrix S = product(product(H, Pp, n, m, m), Ht, n, m, n);
+            for (size_t i = 0; i < S.size(); i++)
+                S[i] += Q[i];
+
+            const Matrix K = product(product(Pp, Ht, m, m, n), inverse(S, n), m, n, n);
+
+            const Matrix Hx = product(H, xp, n, m, 1);
+            Matrix innovation(y);
+            for (int i = 0; i < n; i++)
+                innovation[i] -= Hx[i];
+
+            const Matrix correction = product(K, innovation, m, n, 1);
+            for (int i = 0; i < m; i++)
+                x[i] = xp[i] + correction[i];
+
+            const Matrix KHP = product(product(K, H, m, n, m), Pp, m, m, m);
+            for (size_t i = 0; i < P.size(); i++)
+                P[i] = Pp[i] - KHP[i];
+        }
+
+        Matrix A, W, H, Q;
+        int m, n;
+        Matrix x, P;
+    };
+
+    String toJson(const Matrix& a, int rows, int columns)
+    {
+        StringArray rowText;
+
+        for (int i = 0; i < rows; i++)
+        {
+            StringArray values;
+            for (int j = 0; j < columns; j++)
+                values.add(String(a[i * columns + j], 17));
+            rowText.add("[" + values.joinIntoString(", ") + "]");
+        }
+
+        return "[" + rowText.joinIntoString(", ") + "]";
+    }
+
+    const String linearModel =
+        "{ \"type\": \"linear\", \"weights\": [[0.5, -1, 2], [0, 0.25, -0.75]], \"offset\": [1, -2],"
+        "  \"featureMean\": [1, 2, 3], \"outputs\": [\"vx\", \"vy\"] }";
+
+    void checkLinearModel()
+    {
+        DecoderModel model;
+        expect(loadModel(model, linearModel).isEmpty(), "a linear model loads");
+        expect(model.getType() == DecoderModel::LINEAR && model.getNumInputs() == 3 && model.getNumOutputs() == 2,
+            "the linear model is 3>2, got " + model.getDescription());
+        expect(model.getOutputName(1) == "vy", "output names are read");
+
+        const float y[] = { 4.0f, -1.0f, 0.5f };
+        model.step(y);
+
+        // W (y - mean) + c
+        const double expected[] = { 0.5 * 3 - 1 * -3 + 2 * -2.5 + 1, 0.25 * -3 - 0.75 * -2.5 - 2 };
+        for (int i = 0; i < 2; i++)
+            expect(std::abs(model.getState()[i] - expected[i]) < 1e-5,
+                "linear output " + String(i) + " is " + String(expected[i]) + ", got " + String(model.getState()[i]));
+    }
+
+    void checkKalmanModel()
+    {
+        const int m = 2;
+        const int n = 3;
+        const Matrix A = { 0.95, 0.1, -0.05, 0.9 };
+        const Matrix W = { 0.02, 0.005, 0.005, 0.03 };
+        const Matrix H = { 1.0, 0.0, 0.5, 1.5, -0.7, 0.3 };
+        const Matrix Q = { 0.4, 0.05, 0.0, 0.05, 0.3, 0.02, 0.0, 0.02, 0.5 };
+
+        const String json = "{ \"type\": \"kalman\", \"A\": " + toJson(A, m, m) + ", \"W\": " + toJson(W, m, m)
+            + ", \"H\": " + toJson(H, n, m) + ", \"Q\": " + toJson(Q, n, n) + " }";
+
+        DecoderModel model;
+        expect(loadModel(model, json).isEmpty(), "a Kalman model without a gain loads");
+        expect(model.getType() == DecoderModel::KALMAN && model.getNumInputs() == n && model.getNumOutputs() == m,
+            "the Kalman model is 3>2, got " + model.getDescription());
+
+        KalmanFilter filter(A, W, H, Q, m, n);
+        Random random(42);
+        double largestError = 0;
+
+        for (int t = 0; t < 400; t++)
+        {
+            float y[n];
+            Matrix yd((size_t) n);
+            for (int i = 0; i < n; i++)
+                yd[i] = y[i] = random.nextFloat() * 4.0f - 2.0f;
+
+            model.step(y);
+            filter.step(yd);
+
+            // the steady-state gain only matches once the covariance has converged
+            if (t >= 100)
+                for (int i = 0; i < m; i++)
+                    largestError = jmax(largestError, std::abs(model.getState()[i] - filter.x[i]));
+        }
+
+        expect(largestError < 1e-4, "the steady-state decoder follows the Kalman filter, error " + String(largestError));
+
+        model.reset();
+        expect(model.getState()[0] == 0 && model.getState()[1] == 0, "reset returns to x0");
+    }
+
+    void checkMalformedModels()
+    {
+        const char* models[] = {
+            "not json",
+            "{ \"type\": \"quadratic\" }",
+            "{ \"type\": \"linear\", \"weights\": [[1, 2], [3]] }",
+            "{ \"type\": \"linear\", \"weights\": [[1, 2]], \"offset\": [1, 2] }",
+            "{ \"type\": \"linear\", \"weights\": [[1, 2]], \"featureMean\": [1] }",
+            "{ \"type\": \"kalman\", \"A\": [[1, 0]], \"W\": [[1]], \"H\": [[1]], \"Q\": [[1]] }",
+            "{ \"type\": \"kalman\", \"A\": [[1]], \"W\": [[1]], \"H\": [[1]], \"Q\": [[-2]] }",
+            "{ \"type\": \"kalman\", \"A\": [[1]], \"W\": [[1]], \"H\": [[1]], \"Q\": [[1]], \"K\": [[1, 2]] }"
+        };
+
+        for (int i = 0; i < (int) (sizeof(models) / sizeof(models[0])); i++)
+        {
+            DecoderModel model;
+            const String error = loadModel(model, models[i]);
+            expect(error.isNotEmpty() && model.getNumOutputs() == 0, "model " + String(i) + " is rejected");
+        }
+    }
+
+    void checkEvents()
+    {
+        const int numFeatures = 3;
+        SimulatedSource source(30000.0f, EventChannel::UINT16_ARRAY, numFeatures);
+        PopulationDecoder decoder;
+
+        File file = writeModel(linearModel);
+        const String status = decoder.loadModel(file);
+        file.deleteFile();
+        expect(status.startsWith("Loaded"), "the processor loads the model: " + status);
+
+        Array<GenericProcessor*> chain;
+        chain.add(&decoder);
+        source.connect(chain);
+
+        expect(decoder.isDecoding(), "the model matches the features of the source");
+        const EventChannel* output = decoder.getEventChannel(decoder.getTotalEventChannels() - 1);
+        expect(output->getChannelType() == EventChannel::FLOAT_ARRAY && output->getLength() == 2,
+            "the output channel holds the two decoded values");
+
+        expect(source.enableChain(), "acquisition starts");
+
+        DecoderModel reference;
+        loadModel(reference, linearModel);
+
+        const int blockSize = 1024;
+        int numDecoded = 0;
+
+        for (int block = 0; block < 4; block++)
+        {
+            const juce::int64 timestamp = block * blockSize + 100 * block + 7;
+            const uint16 features[numFeatures] = { (uint16) block, (uint16) (2 * block + 1), 5 };
+            source.queueBinaryEvent(timestamp, features);
+
+            MidiBuffer events;
+            source.runBlock(block * blockSize, blockSize, events);
+
+            MidiBuffer::Iterator it(events);
+            MidiMessage message;
+            int samplePosition;
+
+            while (it.getNextEvent(message, samplePosition))
+            {
+                const int channel = SimulatedSource::findEventChannel(&decoder, message);
+                if (channel < 0 || decoder.getEventChannel(channel) != output)
+                    continue;
+
+                BinaryEventPtr event = BinaryEvent::deserializeFromMessage(message, output);
+                expect(event != nullptr, "a decoded state deserializes");
+                if (event == nullptr)
+                    continue;
+
+                expect(event->getTimestamp() == timestamp, "the state has the timestamp of its features");
+                expect(samplePosition == (int) (timestamp - block * blockSize), "the state is sent at the sample of its features");
+
+                float y[numFeatures];
+                for (int i = 0; i < numFeatures; i++)
+                    y[i] = features[i];
+                reference.step(y);
+
+                const float* state = static_cast<const float*>(event->getBinaryDataPointer());
+                for (int i = 0; i < 2; i++)
+                    expect(state[i] == reference.getState()[i],
+                        "decoded value " + String(i) + " is " + String(reference.getState()[i]) + ", got " + String(state[i]));
+
+                float microseconds = -1.0f;
+                event->getMetaDataValue(0)->getValue(microseconds);
+                expect(microseconds >= 0.0f, "the compute time is attached");
+
+                numDecoded++;
+            }
+        }
+
+        source.disableChain();
+
+        expect(numDecoded == 4, "every feature vector is decoded, got " + String(numDecoded));
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    checkLinearModel();
+    checkKalmanModel();
+    checkMalformedModels();
+    checkEvents();
+
+    std::cout << (failures == 0 ? "all population decoder checks passed" : "population decoder checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
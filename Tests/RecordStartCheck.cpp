@@ -0,0 +1,267 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the order in which the record thread opens the files of its
+    engines. Engines that open their files before the data must see
+    openFiles before the first block is queued; if any engine needs the
+    first timestamps, every engine waits for the first block and sees its
+    timestamps. Either way, every sample queued from the first block on
+    must be written once, in order, starting at the first timestamp.
+*/
+
+#include "../Source/Processors/RecordNode/RecordThread.h"
+#include "../Source/Processors/RecordNode/RecordEngine.h"
+#include "../Source/Processors/RecordNode/DataQueue.h"
+#include "../Source/Processors/RecordNode/EventQueue.h"
+
+#include <atomic>
+#include <iostream>
+
+namespace
+{
+    const int numChannels = 2;
+    const int blockSize = 512;
+    const int numBlocks = 20;
+    const juce::int64 firstTimestamp = 1000;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    /** The number of blocks the simulated audio thread has queued */
+    std::atomic<int> blocksQueued(0);
+
+    /** Keeps what the record thread hands to it */
+    class LoggingEngine : public RecordEngine
+    {
+    public:
+        LoggingEngine(bool opensEarly_)
+            : opensEarly(opensEarly_)
+            , opened(false)
+            , closed(false)
+            , blocksWhenOpened(-1)
+            , timestampWhenOpened(-1)
+        {
+            for (int c = 0; c < numChannels; c++)
+            {
+                samples.add(Array<float>());
+                firstWriteTimestamps.add(-1);
+            }
+        }
+
+        String getEngineID() const override { return "LOGGING"; }
+
+        bool opensFilesBeforeData() const override { return opensEarly; }
+
+        void openFiles(File, int, int) override
+        {
+            blocksWhenOpened = blocksQueued.load();
+            timestampWhenOpened = getTimestamp(0);
+            opened = true;
+        }
+
+        void closeFiles() override { closed = true; }
+
+        void writeData(int writeChannel, int, const float* buffer, int size) override
+        {
+            if (samples.getReference(writeChannel).isEmpty())
+                firstWriteTimestamps.set(writeChannel, getTimestamp(writeChannel));
+
+            samples.getReference(writeChannel).addArray(buffer, size);
+        }
+
+        void writeEvent(int, const MidiMessage&) override {}
+        void writeTimestampSyncText(uint16, uint16, int64, float, String) override {}
+        void addSpikeElectrode(int, const SpikeChannel*) override {}
+        void writeSpike(int, const SpikeEvent*) override {}
+
+        const bool opensEarly;
+        std::atomic<bool> opened;
+        std::atomic<bool> closed;
+        int blocksWhenOpened;
+        juce::int64 timestampWhenOpened;
+
+        Array<Array<float>> samples;
+        Array<juce::int64> firstWriteTimestamps;
+    };
+
+    /** The value of a channel at a timestamp */
+    float sampleValue(juce::int64 timestamp, int channel)
+    {
+        return (float) (timestamp - firstTimestamp) + channel * 0.5f;
+    }
+
+    bool waitUntilOpened(const OwnedArray<RecordEngine>& engines)
+    {
+        for (int ms = 0; ms < 2000; ms++)
+        {
+            bool allOpened = true;
+            for (int e = 0; e < engines.size(); e++)
+                allOpened = static_cast<LoggingEngine*>(engines[e])->opened && allOpened;
+
+            if (allOpened)
+                return true;
+
+            Thread::sleep(1);
+        }
+
+        return false;
+    }
+
+    /** Records numBlocks blocks with engines that do or do not open their files early */
+    void record(const String& name, const Array<bool>& opensEarly)
+    {
+        OwnedArray<RecordEngine> engines;
+        bool allEarly = true;
+
+        for (int e = 0; e < opensEarly.size(); e++)
+        {
+            engines.add(new LoggingEngine(opensEarly[e]));
+            allEarly = allEarly && opensEarly[e];
+        }
+
+        DataQueue dataQueue(1024, 32);
+        EventMsgQueue eventQueue(64);
+        SpikeMsgQueue spikeQueue(64);
+
+        Array<int> channelMap;
+        for (int c = 0; c < numChannels; c++)
+            channelMap.add(c);
+
+        dataQueue.setChannels(numChannels);
+        blocksQueued = 0;
+
+        RecordThread thread(engines);
+        thread.setFileComponents(File::getSpecialLocation(File::tempDirectory), 1, 0);
+        thread.setChannelMap(channelMap);
+        thread.setQueuePointers(&dataQueue, &eventQueue, &spikeQueue);
+        thread.setFirstBlockFlag(false);
+        thread.startThread();
+
+        if (allEarly)
+        {
+            expect(waitUntilOpened(engines), name + ": files open before the first block");
+        }
+        else
+        {
+            Thread::sleep(50);
+            for (int e = 0; e < engines.size(); e++)
+                expect(!static_cast<LoggingEngine*>(engines[e])->opened, name + ": engine " + String(e) + " waits for the first block");
+        }
+
+        AudioSampleBuffer buffer(numChannels, blockSize);
+
+        for (int block = 0; block < numBlocks; block++)
+        {
+            const juce::int64 timestamp = firstTimestamp + block * blockSize;
+
+            for (int c = 0; c < numChannels; c++)
+                for (int i = 0; i < blockSize; i++)
+                    buffer.setSample(c, i, sampleValue(timestamp + i, c));
+
+            for (int c = 0; c < numChannels; c++)
+                dataQueue.writeChannel(buffer, c, c, blockSize, timestamp);
+
+            blocksQueued = block + 1;
+
+            if (block == 0)
+                thread.setFirstBlockFlag(true);
+
+            Thread::sleep(1);
+        }
+
+        expect(waitUntilOpened(engines), name + ": files open");
+
+        thread.signalThreadShouldExit();
+        expect(thread.waitForThreadToExit(2000), name + ": the record thread exits");
+
+        for (int e = 0; e < engines.size(); e++)
+        {
+            const LoggingEngine* engine = static_cast<LoggingEngine*>(engines[e]);
+            const String prefix = name + ": engine " + String(e) + " ";
+
+            expect(engine->closed, prefix + "closes its files");
+
+            if (allEarly)
+            {
+                expect(engine->blocksWhenOpened == 0, prefix + "opens before any block, opened after " + String(engine->blocksWhenOpened));
+            }
+            else
+            {
+                expect(engine->blocksWhenOpened >= 1, prefix + "opens after the first block");
+                expect(engine->timestampWhenOpened == firstTimestamp,
+                       prefix + "sees the first timestamp when opening, got " + String(engine->timestampWhenOpened));
+            }
+
+            for (int c = 0; c < numChannels; c++)
+            {
+                const Array<float>& written = engine->samples.getReference(c);
+                int mismatches = 0;
+
+                for (int i = 0; i < written.size(); i++)
+                    if (written[i] != sampleValue(firstTimestamp + i, c))
+                        mismatches++;
+
+                expect(written.size() == numBlocks * blockSize,
+                       prefix + "channel " + String(c) + " writes every sample, wrote " + String(written.size()));
+                expect(mismatches == 0, prefix + "channel " + String(c) + " writes the samples in order, " + String(mismatches) + " out of place");
+                expect(engine->firstWriteTimestamps[c] == firstTimestamp,
+                       prefix + "channel " + String(c) + " starts at the first timestamp, got " + String(engine->firstWriteTimestamps[c]));
+            }
+        }
+    }
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    Array<bool> early;
+    early.add(true);
+    early.add(true);
+    record("early engines", early);
+
+    Array<bool> late;
+    late.add(false);
+    record("late engine", late);
+
+    Array<bool> mixed;
+    mixed.add(true);
+    mixed.add(false);
+    record("mixed engines", mixed);
+
+    if (failures == 0)
+        std::cout << "all record start checks passed" << std::endl;
+    else
+        std::cout << failures << " record start checks failed" << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the impedance demodulation of the RhythmNode against the direct
+    correlation it replaced. A simulated board fills Rhythm data blocks with
+    test sines of known amplitude and phase on every stream; the blocks go
+    through the same conversion and Goertzel demodulation as a measurement,
+    with the window the measurement would use.
+*/
+
+#include "ImpedanceDemodulator.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+
+using namespace RhythmNode;
+
+#define TWO_PI  6.28318530718
+#define RADIANS_TO_DEGREES  57.2957795132
+
+namespace
+{
+    /** Stands in for the acquisition board: every stream carries a sine of its own amplitude and phase */
+    class SimulatedBoard
+    {
+    public:
+        SimulatedBoard(int numStreams_, bool usb3_, double sampleRate_, unsigned int seed)
+            : numStreams(numStreams_), usb3(usb3_), sampleRate(sampleRate_), generator(seed)
+        {
+            std::uniform_real_distribution<double> amplitudes(20.0, 2000.0);
+            std::uniform_real_distribution<double> phases(-180.0, 180.0);
+
+            for (int stream = 0; stream < numStreams; ++stream)
+            {
+                amplitude.push_back(amplitudes(generator));
+                phase.push_back(phases(generator));
+            }
+        }
+
+        int getSamplesPerBlock() const { return SAMPLES_PER_DATA_BLOCK(usb3); }
+
+        /** Acquires numBlocks blocks of a chip channel, like Rhd2000EvalBoard::readDataBlocks */
+        void readDataBlocks(int numBlocks, int chipChannel, double frequency, queue<Rhd2000DataBlock>& dataQueue)
+        {
+            std::normal_distribution<double> noise(0.0, 2.0);
+            const double k = TWO_PI * frequency / sampleRate;
+            int t = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                Rhd2000DataBlock dataBlock(numStreams, usb3);
+
+                for (int i = 0; i < getSamplesPerBlock(); ++i, ++t)
+                {
+                    for (int stream = 0; stream < numStreams; ++stream)
+                    {
+                        // a correlation with cos(k t) and -sin(k t) measures A cos(k t + phase)
+                        const double microvolts = amplitude[stream] * cos(k * t + phase[stream] / RADIANS_TO_DEGREES) + noise(generator);
+                        dataBlock.amplifierData[stream][chipChannel][i] = 32768 + (int) std::lround(microvolts / 0.195);
+                    }
+                }
+
+                dataQueue.push(dataBlock);
+            }
+        }
+
+        const int numStreams;
+        const bool usb3;
+        const double sampleRate;
+        std::vector<double> amplitude;
+        std::vector<double> phase;
+
+    private:
+        std::mt19937 generator;
+    };
+
+    /** The demodulation the RhythmNode used before, on one stream of doubles */
+    void directCorrelation(double& realComponent, double& imagComponent, const std::vector<double>& data,
+        int startIndex, int endIndex, double sampleRate, double frequency)
+    {
+        int length = endIndex - startIndex + 1;
+        const double k = TWO_PI * frequency / sampleRate;
+
+        double meanI = 0.0;
+        double meanQ = 0.0;
+        for (int t = startIndex; t <= endIndex; ++t)
+        {
+            meanI += data.at(t) * cos(k * t);
+            meanQ += data.at(t) * -1.0 * sin(k * t);
+        }
+        meanI /= (double)length;
+        meanQ /= (double)length;
+
+        realComponent = 2.0 * meanI;
+        imagComponent = 2.0 * meanQ;
+    }
+
+    /** Runs one channel the way RHDImpedanceMeasure does, returns the number of failures */
+    int checkMeasurement(int numStreams, bool usb3, double sampleRate, int chipChannel, unsigned int seed)
+    {
+        SimulatedBoard board(numStreams, usb3, sampleRate, seed);
+        const int samplesPerBlock = board.getSamplesPerBlock();
+
+        // same test frequency, block count and window as RHDImpedanceMeasure::runImpedanceMeasurement
+        const int impedancePeriod = (int) (sampleRate / 1000.0);
+        const double frequency = sampleRate / impedancePeriod;
+        int numPeriods = (int) (0.020 * frequency);
+        if (numPeriods < 5) numPeriods = 5;
+        const double period = sampleRate / frequency;
+        int numBlocks = (int) ceil((numPeriods + 2.0) * period / 60.0);
+        if (numBlocks < 2) numBlocks = 2;
+
+        const int intPeriod = int(period);
+        int windowStart = 0;
+        int windowEnd = windowStart + numPeriods * intPeriod - 1;
+        while (windowEnd < samplesPerBlock * numBlocks - intPeriod)
+        {
+            windowStart += intPeriod;
+            windowEnd += intPeriod;
+        }
+
+        queue<Rhd2000DataBlock> dataQueue;
+        board.readDataBlocks(numBlocks, chipChannel, frequency, dataQueue);
+
+        // the reference converts the same words, to double, one stream at a time
+        std::vector<std::vector<double>> reference(numStreams);
+        queue<Rhd2000DataBlock> copy = dataQueue;
+        while (!copy.empty())
+        {
+            for (int stream = 0; stream < numStreams; ++stream)
+                for (int t = 0; t < samplesPerBlock; ++t)
+                    reference[stream].push_back(0.195 * (copy.front().amplifierData[stream][chipChannel][t] - 32768));
+            copy.pop();
+        }
+
+        std::vector<float> samples(numStreams * samplesPerBlock * numBlocks);
+        std::vector<double> iComponents(numStreams);
+        std::vector<double> qComponents(numStreams);
+
+        ImpedanceDemodulator::loadAmplifierData(dataQueue, numStreams, samplesPerBlock, chipChannel, samples.data());
+        ImpedanceDemodulator::amplitudeOfFreqComponent(iComponents.data(), qComponents.data(), samples.data(), numStreams,
+            windowStart, windowEnd, sampleRate, frequency);
+
+        int failures = 0;
+        double largestDifference = 0;
+
+        for (int stream = 0; stream < numStreams; ++stream)
+        {
+            double iReference, qReference;
+            directCorrelation(iReference, qReference, reference[stream], windowStart, windowEnd, sampleRate, frequency);
+
+            const double difference = std::hypot(iComponents[stream] - iReference, qComponents[stream] - qReference);
+            largestDifference = std::max(largestDifference, difference);
+
+            const double magnitude = std::hypot(iComponents[stream], qComponents[stream]);
+            const double phase = RADIANS_TO_DEGREES * atan2(qComponents[stream], iComponents[stream]);
+            double phaseError = std::fabs(phase - board.phase[stream]);
+            phaseError = std::min(phaseError, 360.0 - phaseError);
+
+            // single precision samples against the double reference, and the known test signal
+            if (difference > 1e-6 * board.amplitude[stream] + 1e-3
+                || std::fabs(magnitude - board.amplitude[stream]) > 0.01 * board.amplitude[stream] + 2.0
+                || phaseError > 1.0)
+                failures++;
+        }
+
+        std::cout << (failures == 0 ? "ok   " : "FAIL ") << numStreams << " streams, " << (usb3 ? "USB3" : "USB2")
+                  << ", " << sampleRate << " Hz, channel " << chipChannel << ": largest difference from the direct correlation "
+                  << largestDifference << " uV" << std::endl;
+
+        return failures;
+    }
+}
+
+int main()
+{
+    const double sampleRates[] = { 3333.0, 5000.0, 10000.0, 15000.0, 20000.0, 25000.0, 30000.0 };
+    int failures = 0;
+    unsigned int seed = 1;
+
+    for (double sampleRate : sampleRates)
+    {
+        failures += checkMeasurement(1, false, sampleRate, 0, seed++);
+        failures += checkMeasurement(8, false, sampleRate, 17, seed++);
+        failures += checkMeasurement(16, true, sampleRate, 31, seed++);
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SIMULATEDSOURCE_H_INCLUDED
+#define SIMULATEDSOURCE_H_INCLUDED
+
+#include <ProcessorHeaders.h>
+
+/**
+    A source processor for processor checks. It has one continuous channel,
+    one single-channel electrode and, if asked, one binary event channel, and
+    puts the spikes and events queued for a block into that block's event
+    buffer, with the timestamp and sample count of the block.
+
+    Processors under test are connected with connect() and driven with
+    runBlock(), which returns the events of the whole chain. They run without
+    editors, so no component needs a display.
+*/
+class SimulatedSource : public GenericProcessor
+{
+public:
+    SimulatedSource(float sampleRate_ = 30000.0f, EventChannel::EventChannelTypes eventType_ = EventChannel::INVALID, int eventLength_ = 0)
+        : GenericProcessor("Simulated Source")
+        , sampleRate(sampleRate_)
+        , eventType(eventType_)
+        , eventLength(eventLength_)
+        , blockStart(0)
+        , blockSamples(0)
+    {
+        setProcessorType(PROCESSOR_TYPE_SOURCE);
+        setNodeId(100);
+    }
+
+    void process(AudioSampleBuffer&) override
+    {
+        setTimestampAndSamples(blockStart, blockSamples);
+
+        for (int i = 0; i < spikes.size(); i++)
+        {
+            SpikeEvent::SpikeBuffer waveform(spikeChannelArray[0]);
+            Array<float> thresholds;
+            thresholds.add(-50.0f);
+
+            SpikeEventPtr spike = SpikeEvent::createSpikeEvent(spikeChannelArray[0], spikes[i].timestamp, thresholds, waveform, spikes[i].sortedID);
+            addSpike(spikeChannelArray[0], spike, (int) (spikes[i].timestamp - blockStart));
+        }
+
+        for (int i = 0; i < events.size(); i++)
+            addEvent(eventChannelArray[0], events[i], (int) (events[i]->getTimestamp() - blockStart));
+
+        spikes.clearQuick();
+        events.clear();
+    }
+
+    /** Queues a spike for the block that contains its timestamp */
+    void queueSpike(juce::int64 timestamp, uint16 sortedID)
+    {
+        spikes.add(QueuedSpike(timestamp, sortedID));
+    }
+
+    /** Queues an event on the binary channel, for the block that contains its timestamp */
+    template <typename T>
+    void queueBinaryEvent(juce::int64 timestamp, const T* values)
+    {
+        events.add(BinaryEvent::createBinaryEvent(eventChannelArray[0], timestamp, values, eventLength * (int) sizeof(T)).release());
+    }
+
+    /** Connects a chain of processors to this source and updates their settings */
+    void connect(const Array<GenericProcessor*>& chain)
+    {
+        processors.clear();
+        processors.add(this);
+        processors.addArray(chain);
+
+        for (int i = 0; i < processors.size(); i++)
+        {
+            GenericProcessor* processor = processors[i];
+
+            if (i > 0)
+            {
+                processor->setNodeId(100 + i);
+                processor->setSourceNode(processors[i - 1]);
+            }
+
+            processor->update();
+        }
+    }
+
+    /** Starts acquisition on every processor of the chain */
+    bool enableChain()
+    {
+        bool enabled = true;
+
+        for (int i = 0; i < processors.size(); i++)
+            enabled = processors[i]->enableProcessor() && enabled;
+
+        return enabled;
+    }
+
+    void disableChain()
+    {
+        for (int i = 0; i < processors.size(); i++)
+            processors[i]->disableProcessor();
+    }
+
+    /** Runs one block through the chain and returns every event it ends up with */
+    void runBlock(juce::int64 timestamp, int numSamples, MidiBuffer& eventBuffer)
+    {
+        blockStart = timestamp;
+        blockSamples = numSamples;
+
+        AudioSampleBuffer buffer(1, numSamples);
+        buffer.clear();
+        eventBuffer.clear();
+
+        // as the processor graph does, through the AudioProcessor interface
+        for (int i = 0; i < processors.size(); i++)
+            static_cast<AudioProcessor*>(processors[i])->processBlock(buffer, eventBuffer);
+    }
+
+    /** Returns the index of the event channel an event was sent on, in the event channels of a processor */
+    static int findEventChannel(const GenericProcessor* processor, const MidiMessage& message)
+    {
+        if (EventBase::getBaseType(message) != PROCESSOR_EVENT)
+            return -1;
+
+        return processor->getEventChannelIndex(EventBase::getSourceIndex(message),
+                                               EventBase::getSourceID(message),
+                                               EventBase::getSubProcessorIdx(message));
+    }
+
+private:
+    void createDataChannels() override
+    {
+        dataChannelArray.add(new DataChannel(DataChannel::HEADSTAGE_CHANNEL, sampleRate, this));
+    }
+
+    void createSpikeChannels() override
+    {
+        Array<const DataChannel*> sources;
+        sources.add(dataChannelArray[0]);
+
+        SpikeChannel* electrode = new SpikeChannel(SpikeChannel::SINGLE, this, sources);
+        electrode->setNumSamples(8, 32);
+        spikeChannelArray.add(electrode);
+    }
+
+    void createEventChannels() override
+    {
+        if (eventType != EventChannel::INVALID)
+            eventChannelArray.add(new EventChannel(eventType, 1, eventLength, dataChannelArray[0], this));
+    }
+
+    struct QueuedSpike
+    {
+        QueuedSpike(juce::int64 t = 0, uint16 id = 0) : timestamp(t), sortedID(id) {}
+        juce::int64 timestamp;
+        uint16 sortedID;
+    };
+
+    const float sampleRate;
+    const EventChannel::EventChannelTypes eventType;
+    const int eventLength;
+
+    juce::int64 blockStart;
+    int blockSamples;
+
+    Array<QueuedSpike> spikes;
+    OwnedArray<BinaryEvent> events;
+
+    Array<GenericProcessor*> processors;
+};
+
+#endif  // SIMULATEDSOURCE_H_INCLUDED
@@ -0,0 +1,214 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the events of the Spike Binner. A simulated source sends spikes
+    of a few units, some of them a block after their bin ended, and every
+    count vector and unit announcement the binner sends is deserialized and
+    compared with the counts expected for its bin.
+*/
+
+#include "SimulatedSource.h"
+#include "../Plugins/SpikeBinner/SpikeBinner.h"
+
+#include <iostream>
+
+namespace
+{
+    const int binSamples = 300;     // 10 ms at 30 kHz
+    const int closeDelay = 60;      // 2 ms
+    const int blockSize = 1024;
+    const int numBlocks = 4;
+    const int numUnits = 8;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    struct Spike
+    {
+        juce::int64 timestamp;
+        uint16 sortedID;
+        int deliveredInBlock;
+        int slot;
+    };
+
+    // slots are given in the order the units first arrive
+    const Spike spikes[] = {
+        { 10, 1, 0, 0 },
+        { 150, 1, 0, 0 },
+        { 200, 2, 0, 1 },
+        { 320, 0, 0, 2 },       // unsorted, counted as the multi-unit of the electrode
+        { 590, 2, 0, 1 },
+        { 1010, 1, 1, 0 },      // detected in the next block, before its bin closes
+        { 1100, 3, 1, 3 },
+        { 1230, 1, 1, 0 },
+        { 2500, 2, 2, 1 },
+        { 2999, 3, 2, 3 },
+        { 3000, 3, 2, 3 }
+    };
+    const int numSpikes = sizeof(spikes) / sizeof(spikes[0]);
+}
+
+int main()
+{
+    ScopedJuceInitialiser_GUI juce;
+
+    SimulatedSource source;
+    SpikeBinner binner;
+    binner.setParameter(SpikeBinner::BIN_MS, 10.0f);
+    binner.setParameter(SpikeBinner::CLOSE_DELAY_MS, 2.0f);
+    binner.setParameter(SpikeBinner::NUM_UNITS, (float) numUnits);
+
+    Array<GenericProcessor*> chain;
+    chain.add(&binner);
+    source.connect(chain);
+
+    expect(binner.getTotalEventChannels() == 2, "count and unit channels, got " + String(binner.getTotalEventChannels()));
+    const EventChannel* counts = binner.getEventChannel(0);
+    const EventChannel* units = binner.getEventChannel(1);
+    expect(counts->getChannelType() == EventChannel::UINT16_ARRAY && counts->getLength() == numUnits,
+        "the count channel holds " + String(numUnits) + " uint16 values");
+
+    expect(source.enableChain(), "acquisition starts");
+
+    HashMap<int, int> countsByBin[numUnits];
+    int numCountEvents = 0;
+    int numAnnouncements = 0;
+    juce::int64 lastBinEnd = 0;
+
+    for (int block = 0; block < numBlocks; block++)
+    {
+        for (int i = 0; i < numSpikes; i++)
+            if (spikes[i].deliveredInBlock == block)
+                source.queueSpike(spikes[i].timestamp, spikes[i].sortedID);
+
+        // the announcements are built by the timer on the message thread
+        if (block == 2)
+            binner.timerCallback();
+
+        MidiBuffer events;
+        source.runBlock(block * blockSize, blockSize, events);
+
+        MidiBuffer::Iterator it(events);
+        MidiMessage message;
+        int samplePosition;
+
+        while (it.getNextEvent(message, samplePosition))
+        {
+            const int channel = SimulatedSource::findEventChannel(&binner, message);
+
+            if (channel >= 0 && binner.getEventChannel(channel) == counts)
+            {
+                BinaryEventPtr event = BinaryEvent::deserializeFromMessage(message, counts);
+                expect(event != nullptr, "a count vector deserializes");
+                if (event == nullptr)
+                    continue;
+
+                const juce::int64 binEnd = event->getTimestamp();
+                expect(binEnd == lastBinEnd + binSamples, "bins are sent in order, got " + String(binEnd) + " after " + String(lastBinEnd));
+                expect(samplePosition == (int) (binEnd + closeDelay - block * blockSize),
+                    "a bin is sent where it closes, got sample " + String(samplePosition));
+                lastBinEnd = binEnd;
+
+                const uint16* values = static_cast<const uint16*>(event->getBinaryDataPointer());
+                for (int unit = 0; unit < numUnits; unit++)
+                    countsByBin[unit].set((int) (binEnd / binSamples - 1), values[unit]);
+
+                numCountEvents++;
+            }
+            else if (channel >= 0 && binner.getEventChannel(channel) == units)
+            {
+                TextEventPtr event = TextEvent::deserializeFromMessage(message, units);
+                expect(event != nullptr && event->getText().startsWith(String(numAnnouncements) + ": "),
+                    "units are announced by slot, got " + (event != nullptr ? event->getText() : String("nothing")));
+                numAnnouncements++;
+            }
+        }
+    }
+
+    source.disableChain();
+    const int assignedUnits = binner.getNumAssignedUnits();
+
+    // a new acquisition assigns and announces the slots again
+    {
+        expect(source.enableChain(), "acquisition starts again");
+
+        MidiBuffer events;
+        source.queueSpike(20, 3);
+        source.runBlock(0, blockSize, events);
+        binner.timerCallback();
+        source.runBlock(blockSize, blockSize, events);
+
+        int announced = 0;
+        MidiBuffer::Iterator it(events);
+        MidiMessage message;
+        int samplePosition;
+
+        while (it.getNextEvent(message, samplePosition))
+        {
+            const int channel = SimulatedSource::findEventChannel(&binner, message);
+
+            if (channel >= 0 && binner.getEventChannel(channel) == units)
+            {
+                TextEventPtr event = TextEvent::deserializeFromMessage(message, units);
+                expect(event != nullptr && event->getText().startsWith("0: "), "the first unit of a new acquisition gets slot 0");
+                announced++;
+            }
+        }
+
+        expect(announced == 1, "the new acquisition announces its unit once, got " + String(announced));
+        source.disableChain();
+    }
+
+    // bins close 2 ms after their end, so the last block closes bins up to its end minus the delay
+    const int expectedBins = (numBlocks * blockSize - closeDelay - 1) / binSamples;
+    expect(numCountEvents == expectedBins, "every closed bin is sent, got " + String(numCountEvents) + " of " + String(expectedBins));
+    expect(numAnnouncements == 4, "every unit is announced, got " + String(numAnnouncements));
+    expect(assignedUnits == 4, "four units have a slot, got " + String(assignedUnits));
+
+    for (int bin = 0; bin < expectedBins; bin++)
+    {
+        for (int unit = 0; unit < numUnits; unit++)
+        {
+            int expected = 0;
+            for (int i = 0; i < numSpikes; i++)
+                if (spikes[i].timestamp / binSamples == bin && spikes[i].slot == unit)
+                    expected++;
+
+            expect(countsByBin[unit][bin] == expected,
+                "bin " + String(bin) + " unit " + String(unit) + " counts " + String(expected) + ", got " + String(countsByBin[unit][bin]));
+        }
+    }
+
+    std::cout << (failures == 0 ? "all spike binner checks passed" : "spike binner checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
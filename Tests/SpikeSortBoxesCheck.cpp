@@ -0,0 +1,223 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the unit boundary index of the Spike Sorter. Random PCA polygons,
+    some of them self-intersecting, and random boxes are indexed, and random
+    tetrode spikes are classified both through the index and by testing
+    every unit in order, as sortSpike did before the index. Many spikes are
+    projected exactly onto polygon vertices and edges, where rounding would
+    show first.
+*/
+
+#include "../Plugins/SpikeSorter/SpikeSortBoxes.h"
+
+#include <iostream>
+
+namespace
+{
+    const int numTrials = 100;
+    const int spikesPerTrial = 4000;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    /** Owns the tetrode the spikes are recorded on */
+    class TetrodeSource : public GenericProcessor
+    {
+    public:
+        TetrodeSource() : GenericProcessor("Tetrode Source")
+        {
+            setProcessorType(PROCESSOR_TYPE_SOURCE);
+            setNodeId(100);
+        }
+
+        void process(AudioSampleBuffer&) override {}
+
+        const SpikeChannel* getTetrode() const { return spikeChannelArray[0]; }
+
+    private:
+        void createDataChannels() override
+        {
+            for (int c = 0; c < 4; c++)
+                dataChannelArray.add(new DataChannel(DataChannel::HEADSTAGE_CHANNEL, 30000.0f, this));
+        }
+
+        void createSpikeChannels() override
+        {
+            Array<const DataChannel*> sources;
+            for (int c = 0; c < 4; c++)
+                sources.add(dataChannelArray[c]);
+
+            SpikeChannel* tetrode = new SpikeChannel(SpikeChannel::TETRODE, this, sources);
+            tetrode->setNumSamples(8, 32);
+            spikeChannelArray.add(tetrode);
+        }
+    };
+
+    float uniform(Random& random)
+    {
+        return random.nextFloat() * 2.0f - 1.0f;
+    }
+}
+
+int main()
+{
+    TetrodeSource source;
+    source.update();
+    const SpikeChannel* tetrode = source.getTetrode();
+
+    Random random(1);
+    int mismatches = 0;
+    int pcaHits = 0;
+    int boxHits = 0;
+
+    for (int trial = 0; trial < numTrials; trial++)
+    {
+        std::vector<PCAUnit> pcaUnits(1 + random.nextInt(6));
+        std::vector<PointD> vertices;
+
+        for (size_t u = 0; u < pcaUnits.size(); u++)
+        {
+            const int numPoints = 3 + random.nextInt(10);
+            const float cx = uniform(random) * 300.0f;
+            const float cy = uniform(random) * 300.0f;
+            const float radius = 20.0f + std::abs(uniform(random)) * 200.0f;
+            const bool selfIntersecting = random.nextInt(3) == 0;
+
+            for (int i = 0; i < numPoints; i++)
+            {
+                const float angle = selfIntersecting ? uniform(random) * float_Pi : 2.0f * float_Pi * i / numPoints;
+                const float r = radius * (0.3f + std::abs(uniform(random)));
+                pcaUnits[u].poly.pts.push_back(PointD(cx + r * std::cos(angle), cy + r * std::sin(angle)));
+                vertices.push_back(pcaUnits[u].poly.pts.back());
+            }
+
+            pcaUnits[u].poly.offset = PointD(uniform(random) * 10.0f, uniform(random) * 10.0f);
+        }
+
+        std::vector<BoxUnit> boxUnits(random.nextInt(5));
+        for (size_t u = 0; u < boxUnits.size(); u++)
+        {
+            const int numBoxes = random.nextInt(3);
+            for (int i = 0; i < numBoxes; i++)
+            {
+                boxUnits[u].lstBoxes.push_back(Box(std::abs(uniform(random)) * 1000.0f, uniform(random) * 100.0f,
+                                                   std::abs(uniform(random)) * 600.0f, uniform(random) * 80.0f, random.nextInt(4)));
+            }
+        }
+
+        UnitBoundaryIndex index;
+        index.rebuild(boxUnits, pcaUnits);
+
+        SpikeEvent::SpikeBuffer waveform(tetrode);
+
+        for (int s = 0; s < spikesPerTrial; s++)
+        {
+            for (int i = 0; i < tetrode->getNumChannels() * tetrode->getTotalSamples(); i++)
+                waveform.set(i, uniform(random) * 120.0f);
+
+            SorterSpikePtr spike = new SorterSpikeContainer(tetrode, waveform, s);
+
+            const PCAUnit& unit = pcaUnits[random.nextInt((int) pcaUnits.size())];
+            switch (random.nextInt(4))
+            {
+                case 0:
+                    spike->pcProj[0] = uniform(random) * 600.0f;
+                    spike->pcProj[1] = uniform(random) * 600.0f;
+                    break;
+                case 1:
+                {
+                    // a vertex of any polygon, moved by the offset of the first one
+                    const PointD vertex = vertices[random.nextInt((int) vertices.size())];
+                    spike->pcProj[0] = vertex.X + pcaUnits[0].poly.offset.X;
+                    spike->pcProj[1] = vertex.Y + pcaUnits[0].poly.offset.Y;
+                    break;
+                }
+                case 2:
+                {
+                    const int i = random.nextInt((int) unit.poly.pts.size());
+                    const PointD a = unit.poly.pts[i];
+                    const PointD b = unit.poly.pts[(i + 1) % unit.poly.pts.size()];
+                    const float t = random.nextFloat();
+                    spike->pcProj[0] = a.X + (b.X - a.X) * t + unit.poly.offset.X;
+                    spike->pcProj[1] = a.Y + (b.Y - a.Y) * t + unit.poly.offset.Y;
+                    break;
+                }
+                default:
+                    spike->pcProj[0] = uniform(random) * 300.0f + std::numeric_limits<float>::denorm_min();
+                    spike->pcProj[1] = uniform(random) * 300.0f;
+                    break;
+            }
+
+            // the first unit that holds the spike, testing all of them in order
+            int expectedPCA = -1;
+            for (size_t u = 0; u < pcaUnits.size() && expectedPCA < 0; u++)
+            {
+                if (pcaUnits[u].isWaveFormInsidePolygon(spike))
+                    expectedPCA = (int) u;
+            }
+
+            int expectedBox = -1;
+            int indexedBox = -1;
+            for (size_t u = 0; u < boxUnits.size(); u++)
+            {
+                if (expectedBox < 0 && boxUnits[u].isWaveFormInsideAllBoxes(spike))
+                    expectedBox = (int) u;
+                if (indexedBox < 0 && index.isWaveFormInsideAllBoxes((int) u, spike, boxUnits))
+                    indexedBox = (int) u;
+            }
+
+            const int indexedPCA = index.findPCAUnit(spike, pcaUnits);
+
+            if ((indexedPCA != expectedPCA || indexedBox != expectedBox) && mismatches++ == 0)
+            {
+                expect(false, "trial " + String(trial) + " spike " + String(s) + " at ("
+                    + String(spike->pcProj[0]) + ", " + String(spike->pcProj[1]) + "): PCA unit "
+                    + String(indexedPCA) + " instead of " + String(expectedPCA) + ", box unit "
+                    + String(indexedBox) + " instead of " + String(expectedBox));
+            }
+
+            pcaHits += expectedPCA >= 0 ? 1 : 0;
+            boxHits += expectedBox >= 0 ? 1 : 0;
+        }
+    }
+
+    expect(mismatches == 0, String(mismatches) + " of " + String(numTrials * spikesPerTrial) + " spikes are sorted differently through the index");
+
+    // otherwise the comparison says little
+    expect(pcaHits > numTrials * spikesPerTrial / 10, "polygons hold some of the spikes, got " + String(pcaHits));
+    expect(boxHits > 0, "boxes hold some of the spikes");
+
+    std::cout << (failures == 0 ? "all spike sorting checks passed" : "spike sorting checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}
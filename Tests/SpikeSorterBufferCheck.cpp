@@ -0,0 +1,166 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Open Ephys GUI
+    Copyright (C) 2018 Open Ephys
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+    Checks the lock-free circular buffer of the Spike Sorter. One thread
+    writes blocks of varying length into a short buffer, so it wraps around
+    many times while three threads read snapshots of random length. Every
+    sample and timestamp a snapshot returns must be the one written with
+    its sequence number.
+*/
+
+#include "../Plugins/SpikeSorter/SpikeSorter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    const int numChannels = 4;
+    const int numBlocks = 40000;
+    const int maxBlockSize = 512;
+    const int numReaders = 3;
+    const float sampleRate = 30000.0f;
+
+    int failures = 0;
+
+    void expect(bool condition, const String& description)
+    {
+        if (!condition)
+        {
+            std::cout << "FAIL " << description << std::endl;
+            failures++;
+        }
+    }
+
+    /** The value written to a channel with a sequence number */
+    float sampleValue(juce::int64 sequence, int channel)
+    {
+        return (float) ((sequence * 7 + channel) % 100000);
+    }
+}
+
+int main()
+{
+    ContinuousCircularBuffer buffer(numChannels, sampleRate, 1, 0.05f);
+    const int bufferLength = buffer.getBufferLength();
+    const double ticksPerSecond = (double) Time::getHighResolutionTicksPerSecond();
+
+    // block lengths run through 1..maxBlockSize, the buffer holds 1500 samples
+    std::vector<juce::int64> blockStarts(numBlocks + 1, 0);
+    for (int b = 0; b < numBlocks; b++)
+        blockStarts[b + 1] = blockStarts[b] + 1 + b % maxBlockSize;
+
+    // software timestamps count from the block, in high resolution ticks
+    auto softwareTimestamp = [&](juce::int64 sequence)
+    {
+        const juce::int64 blockStart = *(std::upper_bound(blockStarts.begin(), blockStarts.end(), sequence) - 1);
+        return 2 * blockStart + juce::int64(float(sequence - blockStart) / sampleRate * ticksPerSecond);
+    };
+
+    std::atomic<bool> done(false);
+    std::atomic<int> inconsistentSnapshots(0);
+    std::atomic<int> snapshots(0);
+    std::atomic<int> shortSnapshots(0);
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < numReaders; r++)
+    {
+        readers.emplace_back([&, r]()
+        {
+            Random random(r + 1);
+            HeapBlock<float> samples(bufferLength + 100);
+            HeapBlock<juce::int64> hardwareTimestamps(bufferLength + 100);
+            HeapBlock<juce::int64> softwareTimestamps(bufferLength + 100);
+
+            while (!done)
+            {
+                const int channel = random.nextInt(numChannels);
+                const int requested = 1 + random.nextInt(bufferLength + 100);
+                const ContinuousCircularBuffer::Snapshot snapshot =
+                    buffer.readLatest(channel, requested, samples, hardwareTimestamps, softwareTimestamps);
+
+                for (int i = 0; i < snapshot.numSamples; i++)
+                {
+                    const juce::int64 sequence = snapshot.first + i;
+                    if (samples[i] != sampleValue(sequence, channel) || hardwareTimestamps[i] != sequence
+                        || softwareTimestamps[i] != softwareTimestamp(sequence))
+                    {
+                        inconsistentSnapshots++;
+                        break;
+                    }
+                }
+
+                snapshots++;
+                if (snapshot.numSamples < jmin(requested, bufferLength))
+                    shortSnapshots++;
+            }
+        });
+    }
+
+    AudioSampleBuffer block(numChannels, maxBlockSize);
+    juce::int64 sequence = 0;
+
+    for (int b = 0; b < numBlocks; b++)
+    {
+        const int n = (int) (blockStarts[b + 1] - blockStarts[b]);
+        for (int c = 0; c < numChannels; c++)
+            for (int i = 0; i < n; i++)
+                block.setSample(c, i, sampleValue(sequence + i, c));
+
+        buffer.update(block, sequence, 2 * sequence, n);
+        sequence += n;
+    }
+
+    done = true;
+    for (size_t r = 0; r < readers.size(); r++)
+        readers[r].join();
+
+    expect(buffer.getNumSamplesWritten() == sequence, "every sample is counted, got " + String(buffer.getNumSamplesWritten()) + " of " + String(sequence));
+    expect(snapshots > 0, "the readers ran while the buffer was written");
+    expect(inconsistentSnapshots == 0, String(inconsistentSnapshots.load()) + " of " + String(snapshots.load()) + " snapshots hold samples that do not belong together");
+
+    // once writing stopped, the whole buffer can be read back
+    HeapBlock<float> samples(bufferLength);
+    HeapBlock<juce::int64> hardwareTimestamps(bufferLength);
+    const ContinuousCircularBuffer::Snapshot last = buffer.readLatest(numChannels - 1, bufferLength, samples, hardwareTimestamps);
+
+    expect(last.numSamples == bufferLength && last.first == sequence - bufferLength,
+        "the newest " + String(bufferLength) + " samples are kept, got " + String(last.numSamples) + " from " + String(last.first));
+
+    bool lastMatches = true;
+    for (int i = 0; i < last.numSamples; i++)
+        lastMatches &= samples[i] == sampleValue(last.first + i, numChannels - 1) && hardwareTimestamps[i] == last.first + i;
+    expect(lastMatches, "the newest samples read back as written");
+
+    // a range that was overwritten is not returned at all
+    const ContinuousCircularBuffer::Snapshot old = buffer.read(0, 0, 100, samples);
+    expect(old.numSamples == 0, "samples that were overwritten are dropped, got " + String(old.numSamples));
+
+    std::cout << snapshots.load() << " snapshots, " << shortSnapshots.load() << " of them cut short by the writer" << std::endl;
+    std::cout << (failures == 0 ? "all circular buffer checks passed" : "circular buffer checks failed") << std::endl;
+
+    return failures == 0 ? 0 : 1;
+}